@@ -0,0 +1,337 @@
+// 协议与上行载荷热点路径微基准
+//
+// 用法: robot_bench [--filter=名称子串] [--min-time-ms=N]
+//
+// 在仓库根目录运行（上行模板读取 doc/uplink_template.json），无需 MQTT 服务器。
+// 以典型的 E4（机器人数据）/E5（电流数据）上报帧测量各环节单次耗时与堆分配次数，
+// 结果以 JSON 输出到标准输出，便于跨版本对比；Base64 相关项对本机支持的每种实现各测一次。
+
+#include <glog/logging.h>
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "base64.h"
+#include "envelope_codec.h"
+#include "frame_writer.h"
+#include "protocol.h"
+#include "robot.h"
+#include "robot_frames.h"
+#include "version.h"
+
+using json = nlohmann::json;
+
+// ─── 堆分配计数（替换全局 operator new/delete）──────────────────────────────
+
+static std::atomic<uint64_t> g_alloc_count{0};
+static std::atomic<uint64_t> g_alloc_bytes{0};
+
+void* operator new(size_t size) {
+  g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// ─── 计时框架 ────────────────────────────────────────────────────────────────
+
+// 阻止编译器将结果视为无用而优化掉被测代码
+template <typename T>
+static inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchOptions {
+  std::string filter;    // 只运行名称包含该子串的项
+  int64_t min_time_ms = 200;
+};
+
+class BenchRunner {
+ public:
+  explicit BenchRunner(const BenchOptions& options) : options_(options) {}
+
+  // 自适应迭代次数：不断加倍直到单轮耗时达到 min_time_ms，以最后一轮计算结果
+  template <typename Fn>
+  void Run(const std::string& name, Fn&& fn) {
+    if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) return;
+
+    fn();  // 预热（含线程局部缓冲区的首次分配）
+    const auto min_time = std::chrono::milliseconds(options_.min_time_ms);
+    uint64_t iterations = 1;
+    while (true) {
+      const uint64_t allocs_before = g_alloc_count.load(std::memory_order_relaxed);
+      const uint64_t bytes_before = g_alloc_bytes.load(std::memory_order_relaxed);
+      const auto start = std::chrono::steady_clock::now();
+      for (uint64_t i = 0; i < iterations; ++i) fn();
+      const auto elapsed = std::chrono::steady_clock::now() - start;
+      const uint64_t allocs = g_alloc_count.load(std::memory_order_relaxed) - allocs_before;
+      const uint64_t bytes = g_alloc_bytes.load(std::memory_order_relaxed) - bytes_before;
+
+      if (elapsed >= min_time || iterations >= (uint64_t{1} << 32)) {
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        results_.push_back({
+            {"name", name},
+            {"iterations", iterations},
+            {"ns_per_op", ns / iterations},
+            {"allocs_per_op", static_cast<double>(allocs) / iterations},
+            {"alloc_bytes_per_op", static_cast<double>(bytes) / iterations},
+        });
+        std::fprintf(stderr, "%-48s %12.1f ns/op %8.2f allocs/op\n", name.c_str(),
+                     ns / iterations, static_cast<double>(allocs) / iterations);
+        return;
+      }
+      iterations *= 2;
+    }
+  }
+
+  const json& Results() const { return results_; }
+
+ private:
+  BenchOptions options_;
+  json results_ = json::array();
+};
+
+// ─── 测试帧 ──────────────────────────────────────────────────────────────────
+
+struct BenchFrame {
+  const char* name;
+  std::vector<uint8_t> data;  // 数据域（标识 + 参数）
+  std::vector<uint8_t> raw;   // 完整协议帧
+  std::string base64;         // 完整协议帧的 Base64 编码
+};
+
+// 清扫途中的典型机器人状态（E4/E5 字段均为非零值，与现场上报量级相当）
+static void FillTypicalRobotData(RobotData* data) {
+  data->alarm_fa = 0x00000010;
+  data->alarm_fc = 0x00000200;
+  data->main_motor_current = 18;
+  data->slave_motor_current = 17;
+  data->battery_voltage = 262;
+  data->battery_current = 21;
+  data->battery_status = 1;
+  data->battery_level = 76;
+  data->battery_temperature = 31;
+  data->position = 1375;
+  data->direction = 1;
+  data->solar_voltage = 198;
+  data->solar_current = 12;
+  data->total_run_count = 1284;
+  data->current_lap_count = 3;
+  data->board_temperature = 42;
+  for (size_t i = 0; i < data->master_currents.size(); ++i) {
+    data->master_currents[i] = 15 + static_cast<int>(i % 5);
+    data->slave_currents[i] = 14 + static_cast<int>(i % 4);
+  }
+}
+
+static BenchFrame MakeFrame(const char* name, const FrameWriter& w) {
+  BenchFrame frame;
+  frame.name = name;
+  frame.data.assign(w.DataField(), w.DataField() + w.DataSize());
+  frame.raw.assign(w.Data(), w.Data() + w.Size());
+  frame.base64 = Protocol::BytesToBase64(frame.raw);
+  return frame;
+}
+
+static BenchFrame MakeRobotDataFrame(Robot* robot) {
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  w.Begin(CONTROL_CODE_DOWNLINK, robot->GetDataSnapshot()->robot_number, 0x2A);
+  robot->BuildRobotDataField(robot_frames::RobotDataReportSchema::kIdentifier, &w);
+  w.Finish();
+  return MakeFrame("E4", w);
+}
+
+static void EncodeCurrentDataField(const RobotData& data, FrameWriter* w) {
+  using robot_frames::CurrentPairFields;
+  frame_schema::Array<CurrentPairFields, 10>::Value currents;
+  for (size_t i = 0; i < currents.size(); ++i) {
+    currents[i] = CurrentPairFields::Value(data.master_currents[i], data.slave_currents[i]);
+  }
+  robot_frames::CurrentDataReportSchema::Encode(w, data.position, data.direction, 30, currents);
+}
+
+static BenchFrame MakeCurrentDataFrame(const Robot& robot) {
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  const auto data = robot.GetDataSnapshot();
+  w.Begin(CONTROL_CODE_DOWNLINK, data->robot_number, 0x2B);
+  EncodeCurrentDataField(*data, &w);
+  w.Finish();
+  return MakeFrame("E5", w);
+}
+
+// ─── 各项基准 ────────────────────────────────────────────────────────────────
+
+static void BenchProtocol(BenchRunner* runner, const BenchFrame& f) {
+  const std::string suffix = std::string("/") + f.name;
+  Protocol protocol;
+
+  runner->Run("Protocol::Encode" + suffix, [&] {
+    DoNotOptimize(protocol.Encode(CONTROL_CODE_DOWNLINK, 513, 0x2A, f.data));
+  });
+  runner->Run("FrameWriter" + suffix, [&] {
+    FrameBuffer buffer;
+    FrameWriter w(buffer);
+    w.Begin(CONTROL_CODE_DOWNLINK, 513, 0x2A);
+    w.PutBytes(f.data.data(), f.data.size());
+    DoNotOptimize(w.Finish());
+    DoNotOptimize(buffer);
+  });
+
+  runner->Run("Protocol::Decode" + suffix, [&] {
+    ProtocolFrame frame;
+    DoNotOptimize(protocol.Decode(f.raw, frame));
+    DoNotOptimize(frame);
+  });
+  runner->Run("Protocol::DecodeView" + suffix, [&] {
+    FrameView view;
+    DoNotOptimize(Protocol::DecodeView(f.raw.data(), f.raw.size(), &view));
+    DoNotOptimize(view);
+  });
+
+  runner->Run("Protocol::BytesToHexString" + suffix, [&] {
+    DoNotOptimize(Protocol::BytesToHexString(f.raw));
+  });
+}
+
+static void BenchBase64(BenchRunner* runner, const BenchFrame& f, const std::string& impl) {
+  const std::string suffix = std::string("/") + f.name + "/" + impl;
+
+  runner->Run("Protocol::BytesToBase64" + suffix, [&] {
+    DoNotOptimize(Protocol::BytesToBase64(f.raw));
+  });
+  runner->Run("Protocol::BytesToBase64(buffer)" + suffix, [&] {
+    char out[Protocol::Base64EncodedSize(kMaxFrameSize)];
+    DoNotOptimize(Protocol::BytesToBase64(f.raw.data(), f.raw.size(), out));
+    DoNotOptimize(out);
+  });
+
+  runner->Run("Protocol::Base64ToBytes" + suffix, [&] {
+    DoNotOptimize(Protocol::Base64ToBytes(f.base64));
+  });
+  runner->Run("Protocol::Base64ToBytes(buffer)" + suffix, [&] {
+    FrameBuffer out;
+    size_t out_size = 0;
+    DoNotOptimize(Protocol::Base64ToBytes(f.base64.data(), f.base64.size(), out.data(),
+                                          out.size(), &out_size));
+    DoNotOptimize(out);
+  });
+}
+
+static void BenchRobot(BenchRunner* runner, Robot* robot, const BenchFrame& f) {
+  const std::string suffix = std::string("/") + f.name;
+
+  runner->Run("Robot::GenerateUplinkPayload" + suffix, [&] {
+    DoNotOptimize(robot->GenerateUplinkPayload(f.base64));
+  });
+  std::string payload;
+  runner->Run("Robot::GenerateUplinkPayload(reuse)" + suffix, [&] {
+    robot->GenerateUplinkPayload(f.base64.data(), f.base64.size(), &payload);
+    DoNotOptimize(payload);
+  });
+  for (EnvelopeFormat format : {EnvelopeFormat::kJson, EnvelopeFormat::kRaw, EnvelopeFormat::kProtobuf}) {
+    runner->Run(std::string("Robot::EncodeUplink(") + envelope_codec::FormatName(format) + ")" + suffix,
+                [&] {
+                  robot->EncodeUplink(format, f.raw.data(), f.raw.size(), &payload);
+                  DoNotOptimize(payload);
+                });
+  }
+}
+
+static void BenchFieldBuilders(BenchRunner* runner, Robot* robot) {
+  const auto data = robot->GetDataSnapshot();
+  const uint16_t number = data->robot_number;
+
+  runner->Run("Robot::BuildRobotDataField/E4", [&] {
+    FrameBuffer buffer;
+    FrameWriter w(buffer);
+    w.Begin(CONTROL_CODE_DOWNLINK, number, 0x2A);
+    robot->BuildRobotDataField(robot_frames::RobotDataReportSchema::kIdentifier, &w);
+    DoNotOptimize(w.Finish());
+    DoNotOptimize(buffer);
+  });
+  runner->Run("CurrentDataReportSchema::Encode/E5", [&] {
+    FrameBuffer buffer;
+    FrameWriter w(buffer);
+    w.Begin(CONTROL_CODE_DOWNLINK, number, 0x2B);
+    EncodeCurrentDataField(*data, &w);
+    DoNotOptimize(w.Finish());
+    DoNotOptimize(buffer);
+  });
+}
+
+static bool ParseArgs(int argc, char* argv[], BenchOptions* options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg.rfind("--filter=", 0) == 0) {
+      options->filter = arg.substr(9);
+    } else if (arg.rfind("--min-time-ms=", 0) == 0) {
+      options->min_time_ms = std::atoll(arg.c_str() + 14);
+      if (options->min_time_ms <= 0) return false;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  BenchOptions options;
+  if (!ParseArgs(argc, argv, &options)) {
+    std::fprintf(stderr, "用法: %s [--filter=名称子串] [--min-time-ms=N]\n", argv[0]);
+    return 2;
+  }
+
+  // 被测函数中的 INFO 日志照常格式化，但不写文件、不刷终端
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+  FLAGS_minloglevel = google::GLOG_WARNING;
+
+  Robot robot("3039303063507210", 513);
+  robot.UpdateData([](RobotData& d) { FillTypicalRobotData(&d); });
+  const std::vector<BenchFrame> frames = {MakeRobotDataFrame(&robot), MakeCurrentDataFrame(robot)};
+
+  const std::string default_impl = Base64::ImplName();
+  BenchRunner runner(options);
+  for (const auto& f : frames) BenchProtocol(&runner, f);
+  for (const char* impl : {"scalar", "ssse3", "avx2"}) {
+    if (!Base64::SetImpl(impl)) continue;  // 本机不支持
+    for (const auto& f : frames) BenchBase64(&runner, f, impl);
+  }
+  Base64::SetImpl("auto");
+
+  std::string probe;
+  robot.GenerateUplinkPayload(frames[0].base64.data(), frames[0].base64.size(), &probe);
+  if (probe.empty()) {
+    std::fprintf(stderr, "上行模板为空（需在仓库根目录运行），跳过 GenerateUplinkPayload\n");
+  } else {
+    for (const auto& f : frames) BenchRobot(&runner, &robot, f);
+  }
+  BenchFieldBuilders(&runner, &robot);
+
+  json report;
+  report["version"] = APP_VERSION_STR;
+  report["base64_impl"] = default_impl;
+  report["min_time_ms"] = options.min_time_ms;
+  report["frames"] = json::array();
+  for (const auto& f : frames) {
+    report["frames"].push_back({{"name", f.name},
+                                {"frame_size", f.raw.size()},
+                                {"hex", Protocol::BytesToHexString(f.raw)}});
+  }
+  report["benchmarks"] = runner.Results();
+  std::cout << report.dump(2) << std::endl;
+  return 0;
+}
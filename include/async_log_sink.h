@@ -0,0 +1,128 @@
+#ifndef ASYNC_LOG_SINK_H_
+#define ASYNC_LOG_SINK_H_
+
+#include <glog/logging.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 异步日志输出
+//
+// 作为 glog 的 LogSink 安装后接管文件与终端输出：日志线程（上报、收发、HTTP）只把
+// 日志记录写入无锁环形缓冲区，由单个后台线程批量格式化并写入文件/终端，不再阻塞在 I/O 上。
+// 日志文件沿用 glog 的命名（<程序>.<主机>.<用户>.log.<级别>.<日期-时间>.<pid>），
+// 每个级别的文件包含该级别及以上的日志，超过 FLAGS_max_log_size 后滚动，
+// 因此按 ".INFO." 等匹配的日志清理逻辑不受影响。
+//
+// 缓冲区满时的处理由 OverflowPolicy 决定：
+//   kDrop  丢弃 INFO/WARNING 日志并计数，ERROR 及以上仍等待写入（不丢失错误日志）；
+//   kBlock 所有日志都等待缓冲区有空位。
+// FATAL 日志会等待后台线程写盘后才返回，保证进程终止前落盘。
+class AsyncLogSink : public google::LogSink {
+ public:
+  enum class OverflowPolicy { kDrop, kBlock };
+
+  struct Options {
+    std::string program_name;       // 日志文件名前缀（通常为 argv[0] 的文件名部分）
+    size_t capacity = 4096;         // 环形缓冲区记录数（向上取整为 2 的幂）
+    OverflowPolicy overflow = OverflowPolicy::kDrop;
+    bool also_stderr = true;        // 同时输出到终端（对应 FLAGS_alsologtostderr）
+  };
+
+  struct Stats {
+    uint64_t written = 0;           // 已写出的日志条数
+    uint64_t dropped = 0;           // 缓冲区满被丢弃的条数
+    uint64_t blocked = 0;           // 缓冲区满时等待空位的次数
+    uint64_t truncated = 0;         // 超过单条长度上限被截断的条数
+    size_t queued = 0;              // 当前缓冲区中待写出的条数
+    size_t capacity = 0;
+    OverflowPolicy overflow = OverflowPolicy::kDrop;
+  };
+
+  // 单条日志消息的最大长度（超出部分截断）
+  static constexpr size_t kMaxMessageSize = 2000;
+
+  // 安装为 glog 的输出：关闭 glog 自身的文件与终端输出并启动后台写线程
+  // 进程内只安装一次，重复调用返回已安装的实例
+  static AsyncLogSink* Install(const Options& options);
+  // 已安装的实例（未安装时为 nullptr）
+  static AsyncLogSink* Installed();
+
+  static const char* PolicyName(OverflowPolicy policy);
+  static bool ParsePolicy(const std::string& name, OverflowPolicy* policy);
+
+  ~AsyncLogSink() override;
+
+  void SetOverflowPolicy(OverflowPolicy policy);
+  Stats GetStats() const;
+
+  // 等待当前已入队的日志全部写出并刷新文件
+  void Flush();
+
+  using google::LogSink::send;
+  void send(google::LogSeverity severity, const char* full_filename,
+            const char* base_filename, int line, const struct ::tm* tm_time,
+            const char* message, size_t message_len) override;
+
+ private:
+  struct Record {
+    int severity;
+    int line;
+    int64_t time_us;                // 系统时间（微秒）
+    long thread_id;
+    const char* file;               // glog 传入的源文件名（静态存储）
+    uint16_t size;
+    char message[kMaxMessageSize];
+  };
+
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    Record record;
+  };
+
+  static constexpr int kNumSeverities = 4;
+
+  explicit AsyncLogSink(const Options& options);
+
+  // 有界多生产者队列（Vyukov）：生产者 CAS 领取位置，消费者只有后台线程一个
+  bool TryPush(int severity, const char* file, int line, const char* message, size_t size,
+               uint64_t* position);
+
+  void WriterLoop();
+  void WriteRecord(const Record& record);
+  bool OpenLogFile(int severity);
+
+  Options options_;
+  size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> enqueue_pos_{0};
+  std::atomic<uint64_t> flushed_pos_{0};      // 已写出并刷新的位置
+
+  std::atomic<int> overflow_;
+  std::atomic<uint64_t> written_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> blocked_{0};
+  std::atomic<uint64_t> truncated_{0};
+
+  // 后台线程空闲时等待；生产者仅在其等待时唤醒
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cv_;
+  std::atomic<bool> writer_idle_{false};
+  std::atomic<bool> stop_{false};
+  std::thread writer_;
+
+  // 以下仅后台线程访问
+  uint64_t dequeue_pos_ = 0;
+  FILE* files_[kNumSeverities] = {};
+  size_t file_bytes_[kNumSeverities] = {};
+  bool stderr_color_ = false;
+  std::string line_buffer_;
+};
+
+#endif  // ASYNC_LOG_SINK_H_
@@ -0,0 +1,38 @@
+#ifndef BASE64_H_
+#define BASE64_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// 查表 Base64 编解码（标准字母表，带'='填充）
+//
+// x86 上按运行时 CPU 特性选择 AVX2 / SSSE3 / 标量实现，结果逐字节一致：
+//   - 编码：每 24/12 字节输入一次生成 32/16 个字符，尾部由标量补齐并填充'='；
+//   - 解码：整块字符全部合法时按 32/16 字符一块解码，遇到非法字符或'='的块
+//     交给标量逻辑（跳过非法字符、遇'='结束），与原实现的宽松规则相同。
+class Base64 {
+ public:
+  // 编码 size 字节所需的字符数
+  static constexpr size_t EncodedSize(size_t size) { return (size + 2) / 3 * 4; }
+
+  // 编码到 out（至少 EncodedSize(size) 字节，不追加'\0'），返回写入的字符数
+  static size_t Encode(const uint8_t* data, size_t size, char* out);
+
+  // 解码到 out，结果超过 capacity 时返回 false；成功时 out_size 为写入字节数
+  static bool Decode(const char* base64, size_t size, uint8_t* out, size_t capacity,
+                     size_t* out_size);
+
+  // 当前使用的实现（"avx2" / "ssse3" / "scalar"）
+  static const char* ImplName();
+
+  // 强制指定实现（"avx2" / "ssse3" / "scalar" / "auto"，供测试与基准使用）
+  // 名称未知或当前 CPU 不支持时返回 false，保持原实现不变
+  static bool SetImpl(const char* name);
+
+  // 标量实现（供测试与基准对比）
+  static size_t EncodeScalar(const uint8_t* data, size_t size, char* out);
+  static bool DecodeScalar(const char* base64, size_t size, uint8_t* out, size_t capacity,
+                           size_t* out_size);
+};
+
+#endif  // BASE64_H_
@@ -0,0 +1,56 @@
+#ifndef ENVELOPE_CODEC_H_
+#define ENVELOPE_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "frame_writer.h"
+#include "uplink_template.h"
+
+// MQTT 消息封装格式（mqtt_config 中的 envelope_format，按部署选择）
+//   json      ChirpStack JSON 事件，帧数据 Base64 编码（默认，见 doc/uplink_template.json）
+//   raw       直接发布/接收协议帧字节，主题用于区分机器人
+//   protobuf  ChirpStack v4 的 protobuf 编码：上行为 integration.UplinkEvent，
+//             下行为 api.DeviceQueueItem
+enum class EnvelopeFormat { kJson, kRaw, kProtobuf };
+
+namespace envelope_codec {
+
+const char* FormatName(EnvelopeFormat format);
+bool ParseFormat(const std::string& name, EnvelopeFormat* format);
+
+// 解码下行消息：取出 devEui（raw 格式无此字段，置空）与协议帧字节
+// 封装本身不合法时返回 false；帧数据无法解码（如 Base64 非法、超长）时返回 true 且 *raw_size 为 0
+bool DecodeDownlink(EnvelopeFormat format, const std::string& payload, std::string* dev_eui,
+                    FrameBuffer* raw, size_t* raw_size);
+
+// 解码上行消息（通信记录用），约定同 DecodeDownlink
+bool DecodeUplink(EnvelopeFormat format, const std::string& payload, std::string* dev_eui,
+                  FrameBuffer* raw, size_t* raw_size);
+
+}  // namespace envelope_codec
+
+// ChirpStack integration.UplinkEvent 的手写 protobuf 编码
+//
+// 设备/网关/射频等不随消息变化的字段从 JSON 上行模板中读取（与 json 格式发布的内容一致），
+// 加载时预编码为字节片段；每条消息只编码 deduplicationId、时间、fCnt、信号质量与帧数据。
+class UplinkProtobufEncoder {
+ public:
+  // 从 JSON 上行模板文本加载静态字段（占位符视为空值）；模板无法解析时返回 false
+  bool Load(const std::string& template_text);
+
+  bool empty() const { return !loaded_; }
+
+  // dev_eui/dev_addr 为设备标识，fields.data 为原始协议帧字节（protobuf 中 data 为 bytes，不做 Base64）
+  void Encode(const std::string& dev_eui, const char* dev_addr, size_t dev_addr_size,
+              const UplinkFields& fields, std::string* out) const;
+
+ private:
+  bool loaded_ = false;
+  std::string device_info_;  // DeviceInfo 中除 dev_eui 外的字段
+  std::string event_;        // UplinkEvent 中的 adr/dr/f_port/confirmed/tx_info/region_config_id
+  std::string rx_info_;      // UplinkRxInfo 中除时间与信号质量外的字段
+};
+
+#endif  // ENVELOPE_CODEC_H_
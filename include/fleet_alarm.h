@@ -0,0 +1,110 @@
+#ifndef FLEET_ALARM_H_
+#define FLEET_ALARM_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+struct SimConfig;
+class Robot;
+
+// 全车队告警模拟调度器
+//
+// 所有机器人的模拟告警事件放在同一个最小堆中，按 (到期tick, 类型) 排序：
+//   - 产生事件：每个机器人从上报定时器启动起每6000 tick（10分钟）一次，按
+//     AlarmSimConfig 随机置位若干FC告警位，并为每一位压入一个清除事件；
+//   - 清除事件：到期时清除对应告警位。
+// 事件的产生与清除均为 O(log n)，不再对每个机器人逐 tick 扫描；可触发告警位表
+// 只在模拟配置版本变化时重建。每批事件按机器人合并为置位/清除掩码，经
+// Robot::ApplyAlarmFcBits 在该机器人的写锁下一次写入；告警值实际发生变化的机器人
+// 在释放 mutex_ 之后再写数据库，数据库写入不阻塞 Register/Start/Stop。
+class FleetAlarmScheduler {
+ public:
+  using Slot = int;
+
+  // 告警产生周期（tick，100ms/tick）
+  static constexpr uint64_t kRaisePeriodTicks = 6000;
+
+  FleetAlarmScheduler();
+
+  // 分配/释放槽位（槽位可复用），serial 为机器人编号（随机数流标识）
+  // Unregister 返回后调度器不会再访问该机器人
+  Slot Register(Robot* robot, uint32_t serial);
+  void Unregister(Slot slot);
+
+  // 上报定时器启动/停止：启动时以当前时刻为告警产生相位起点；
+  // 停止后不再产生新告警，已产生告警仍按时清除
+  void Start(Slot slot);
+  void Stop(Slot slot);
+
+  // 处理所有已到期事件，返回距下一事件的延迟（最长 kIdlePoll）
+  // version 为模拟配置版本号，变化时重建告警位表
+  std::chrono::milliseconds Process(const SimConfig& sim, uint64_t version);
+
+  // 堆中待处理事件数（含已失效、尚未弹出的事件）
+  size_t GetPendingEventCount() const;
+
+ private:
+  enum EventKind : uint8_t {
+    kClear = 0,  // 同一 tick 先清除到期告警再产生新告警
+    kRaise = 1,
+  };
+
+  struct Event {
+    uint64_t tick;
+    uint8_t kind;
+    uint8_t bit;
+    Slot slot;
+    uint32_t generation;        // 槽位代数（释放/复用后旧事件失效）
+    uint32_t raise_generation;  // 产生周期代数（启动/停止/重新启用后旧的产生事件失效）
+  };
+
+  struct Later {
+    bool operator()(const Event& a, const Event& b) const {
+      return a.tick != b.tick ? a.tick > b.tick : a.kind > b.kind;
+    }
+  };
+
+  struct SlotState {
+    Robot* robot = nullptr;
+    uint32_t serial = 0;
+    uint32_t generation = 0;
+    uint32_t raise_generation = 0;
+    bool started = false;
+    uint64_t start_tick = 0;     // 告警产生相位起点（随机数以相对 tick 为计数器）
+    bool touched = false;        // 本批事件中已有告警位变化
+    uint32_t set_bits = 0;       // 本批合并后的置位/清除掩码（按事件顺序，后者覆盖前者）
+    uint32_t clear_bits = 0;
+  };
+
+  // 无事件时的最长检查间隔（用于发现配置启用/新机器人启动）
+  static constexpr std::chrono::milliseconds kIdlePoll{1000};
+
+  uint64_t NowTick() const;
+
+  // 持 mutex_ 处理到期事件并写入各机器人告警位，需持久化的任务追加到 persist_tasks
+  std::chrono::milliseconds ProcessEvents(const SimConfig& sim, uint64_t version,
+                                          std::vector<std::function<void()>>* persist_tasks);
+
+  // 以下函数要求持有 mutex_
+  void RebuildLocked(const SimConfig& sim, uint64_t version, uint64_t now_tick);
+  void ScheduleRaiseLocked(Slot slot, uint64_t tick);
+  void RaiseLocked(const SimConfig& sim, const Event& event, std::vector<Slot>* touched);
+  void TouchLocked(Slot slot, std::vector<Slot>* touched);
+
+  mutable std::mutex mutex_;
+  std::chrono::steady_clock::time_point epoch_;
+  std::priority_queue<Event, std::vector<Event>, Later> events_;
+  std::vector<SlotState> slots_;
+  std::vector<Slot> free_slots_;
+
+  // 由 fc_bits_mask 预计算的可触发告警位表（配置版本变化时重建）
+  std::vector<uint8_t> bit_table_;
+  uint64_t bit_table_version_ = UINT64_MAX;
+  bool active_ = false;  // 数据模拟与告警模拟均启用
+};
+
+#endif  // FLEET_ALARM_H_
@@ -0,0 +1,140 @@
+#ifndef FLEET_SCHEDULER_H_
+#define FLEET_SCHEDULER_H_
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 全局定时调度器
+//
+// 所有机器人共享一个分层时间轮 + 固定大小的工作线程池（线程数 = CPU 核数），
+// 取代"每个机器人一个 100ms 轮询线程"的模型。每个定时器只在自己的下一个
+// 截止时间被唤醒，回调返回距离下一次触发的延迟，由调度器重新挂入时间轮。
+//
+// 时间轮精度为 100ms（与机器人模拟 tick 一致），共 4 层：
+//   第0层 256 槽 × 100ms   ≈ 25.6 秒
+//   第1层  64 槽 × 25.6s   ≈ 27 分钟
+//   第2层  64 槽 × 27min   ≈ 29 小时
+//   第3层  64 槽 × 29h     ≈ 77 天（更远的截止时间按最大值截断）
+//
+// 同一个定时器的回调永远不会并发执行。
+//
+// tick 按 SimClock 的模拟时间计算：加速模式下按倍速缩短真实等待时间；
+// 离散事件模式下，所有回调执行完毕且没有就绪定时器时，模拟时间直接跳到
+// 下一个截止时刻；存在模拟时间保持（等待平台真实回复）时不跳跃，按真实时间
+// 等到保持全部释放或到达各自的真实截止时刻。
+class FleetScheduler {
+ public:
+  using TimerId = uint64_t;
+  using HoldId = uint64_t;
+  // 回调返回距下一次触发的延迟；返回负值表示定时器结束并自动移除。
+  // 回调抛出异常时定时器不会被移除，按 kCallbackRetryDelay 重试
+  using TimerCallback = std::function<std::chrono::milliseconds()>;
+
+  static constexpr std::chrono::milliseconds kTickInterval{100};
+  static constexpr std::chrono::milliseconds kCallbackRetryDelay{5000};
+
+  // 进程级单例（首次调用时启动驱动线程和工作线程池）
+  static FleetScheduler& Instance();
+
+  // 添加定时器，delay 后首次触发
+  TimerId AddTimer(std::chrono::milliseconds delay, TimerCallback callback);
+
+  // 立即触发定时器（回调正在执行时，执行结束后立即再触发一次）
+  void WakeTimer(TimerId id);
+
+  // 取消定时器；若回调正在其他线程执行，则等待其执行结束后返回
+  // （在回调内部取消自身时不等待，回调返回后移除）
+  void CancelTimer(TimerId id);
+
+  // 模拟时间保持：real_deadline（真实时间）之前离散事件模式不跳跃模拟时间，
+  // 用于等待平台的真实回复；其它模式下无影响。释放可重复调用，0 表示无保持
+  HoldId HoldSimTime(std::chrono::steady_clock::time_point real_deadline);
+  void ReleaseSimTime(HoldId id);
+
+  // 当前注册的定时器数量
+  size_t GetTimerCount() const;
+
+  // 工作线程数量
+  int GetWorkerCount() const { return static_cast<int>(workers_.size()); }
+
+ private:
+  FleetScheduler();
+  ~FleetScheduler();
+  FleetScheduler(const FleetScheduler&) = delete;
+  FleetScheduler& operator=(const FleetScheduler&) = delete;
+
+  enum class TimerState { kWaiting, kQueued, kRunning };
+
+  struct TimerEntry {
+    TimerId id = 0;
+    TimerCallback callback;
+    uint64_t expire_tick = 0;
+    uint64_t generation = 0;       // 每次重新挂入时间轮时递增，用于识别槽中的过期引用
+    TimerState state = TimerState::kWaiting;
+    bool wake_pending = false;
+    bool cancelled = false;
+    std::thread::id running_thread;
+  };
+
+  // 时间轮槽中的引用（定时器被唤醒/取消后旧引用通过 generation 失效）
+  struct SlotRef {
+    TimerId id;
+    uint64_t generation;
+  };
+  using Slot = std::vector<SlotRef>;
+
+  static constexpr int kLevel0Bits = 8;
+  static constexpr int kLevelNBits = 6;
+  static constexpr int kLevelCount = 4;
+  static constexpr uint64_t kLevel0Size = 1ULL << kLevel0Bits;
+  static constexpr uint64_t kLevelNSize = 1ULL << kLevelNBits;
+
+  uint64_t NowTick() const;
+  std::chrono::steady_clock::time_point TickToTime(uint64_t tick) const;
+
+  // 以下函数要求持有 mutex_
+  uint64_t DeadlineTickLocked(std::chrono::milliseconds delay) const;
+  void ScheduleLocked(TimerEntry* entry, uint64_t expire_tick);
+  void InsertIntoWheelLocked(const SlotRef& ref, uint64_t expire_tick);
+  void CascadeLocked(int level, uint64_t index);
+  void AdvanceOneTickLocked();
+  void EnqueueReadyLocked(TimerEntry* entry);
+  uint64_t NextWakeTickLocked() const;
+  // 移除已到期的模拟时间保持，返回最早的真实截止时刻（无保持时返回 max）
+  std::chrono::steady_clock::time_point PruneSimTimeHoldsLocked();
+
+  void DriverThreadFunc();
+  void WorkerThreadFunc();
+
+  const std::chrono::steady_clock::time_point start_time_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable driver_cv_;    // 新定时器插入/唤醒/回调全部结束时通知驱动线程
+  std::condition_variable worker_cv_;    // 有就绪定时器时通知工作线程
+  std::condition_variable finished_cv_;  // 回调执行结束时通知（CancelTimer 等待用）
+
+  TimerId next_id_ = 1;
+  uint64_t current_tick_ = 0;  // 时间轮已推进到的 tick
+  std::unordered_map<TimerId, std::shared_ptr<TimerEntry>> timers_;
+  std::vector<Slot> level0_;
+  std::array<std::vector<Slot>, kLevelCount - 1> upper_levels_;
+  std::deque<TimerId> ready_queue_;
+  int running_callbacks_ = 0;  // 正在执行的回调数量（离散事件模式判断空闲用）
+  HoldId next_hold_id_ = 1;
+  std::unordered_map<HoldId, std::chrono::steady_clock::time_point> sim_time_holds_;
+  bool running_ = true;
+
+  std::thread driver_thread_;
+  std::vector<std::thread> workers_;
+};
+
+#endif  // FLEET_SCHEDULER_H_
@@ -0,0 +1,81 @@
+#ifndef FLEET_SIM_H_
+#define FLEET_SIM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+struct SimConfig;
+
+// 单个机器人的模拟采样结果（与 RobotData 中对应字段同单位）
+struct SimSample {
+  int main_motor_current = 0;   // 主电机电流 (0.1A)
+  int slave_motor_current = 0;  // 从电机电流 (0.1A)
+  int solar_voltage = 0;        // 光伏电压 (0.1V)
+  int solar_current = 0;        // 光伏电流 (0.1A)
+  int board_temperature = 0;    // 主板温度 (℃)
+  int battery_voltage = 0;      // 电池电压 (0.1V)
+  int battery_temperature = 0;  // 电池温度 (℃)
+};
+
+// 全车队模拟引擎
+//
+// 按字段分别存放所有机器人的模拟量（结构体数组 -> 数组结构体），每个 tick
+// 对整个车队做一遍连续内存上的无分支循环，按 SimConfig 的 min/max/fixed
+// 规则生成采样；机器人在自己的定时器触发时读取本槽位的采样写回 RobotData。
+class FleetSimEngine {
+ public:
+  using Slot = int;
+
+  FleetSimEngine();
+
+  // 分配/释放槽位（槽位可复用），serial 为机器人编号（随机数流标识）
+  Slot Register(uint32_t serial);
+  void Unregister(Slot slot);
+
+  // 更新机器人运动状态（决定电机电流/光伏输出是否有效）
+  void SetMotion(Slot slot, bool is_moving, bool at_dock);
+
+  // 读取槽位最近一次采样；尚未生成过采样时返回 false
+  bool ReadSample(Slot slot, SimSample* sample) const;
+
+  // 对全部槽位执行一遍采样（随机数由 全局种子/机器人编号/采样序号/字段 计算）
+  void Step(const SimConfig& sim);
+
+  // 当前占用的槽位数量
+  size_t GetActiveCount() const;
+
+  // 按与 Step 相同的规则为单个机器人生成一次采样（惰性模拟模式下按需调用）
+  static void SampleOne(const SimConfig& sim, uint32_t serial, uint64_t tick,
+                        bool is_moving, bool at_dock, SimSample* sample);
+
+ private:
+  // 生成一个字段：out[i] = mask[i] ? round(value_i * scale) : 0（mask 为空表示始终有效）
+  void FillField(uint32_t field, bool random, float lo, float hi, float fixed, float scale,
+                 const uint8_t* mask, int32_t* out, size_t n);
+
+  mutable std::mutex mutex_;
+  std::vector<Slot> free_slots_;
+
+  // 槽位状态
+  std::vector<uint8_t> active_;
+  std::vector<uint8_t> sampled_;
+  std::vector<uint8_t> moving_;
+  std::vector<uint8_t> at_dock_;
+  std::vector<uint32_t> serials_;
+
+  // 采样结果（每个字段一段连续数组）
+  std::vector<int32_t> main_current_;
+  std::vector<int32_t> slave_current_;
+  std::vector<int32_t> solar_voltage_;
+  std::vector<int32_t> solar_current_;
+  std::vector<int32_t> board_temp_;
+  std::vector<int32_t> battery_voltage_;
+  std::vector<int32_t> battery_temp_;
+
+  std::vector<float> uniform_;  // 本字段的 [0,1) 随机数缓冲
+  uint64_t tick_ = 0;           // 采样序号（每次 Step 递增）
+};
+
+#endif  // FLEET_SIM_H_
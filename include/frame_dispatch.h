@@ -0,0 +1,87 @@
+#ifndef FRAME_DISPATCH_H_
+#define FRAME_DISPATCH_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+// 下行帧处理统计：按键（标识字节或控制码）累计处理次数与耗时
+// 计数器均为原子量，处理线程记录与 HTTP 线程读取互不阻塞
+class FrameHandlerStats {
+ public:
+  // 处理耗时直方图分桶上限（微秒），最后一个桶为"超过最大上限"
+  static constexpr std::array<int64_t, 6> kLatencyBucketsUs = {10, 50, 100, 500, 1000, 10000};
+
+  struct Snapshot {
+    uint8_t key = 0;
+    const char* name = nullptr;  // 处理函数名称（未注册的键为空）
+    uint64_t count = 0;          // 累计处理次数
+    uint64_t total_ns = 0;       // 累计处理耗时
+    uint64_t max_ns = 0;         // 最大单次耗时
+    std::array<uint64_t, kLatencyBucketsUs.size() + 1> latency_histogram{};
+  };
+
+  void Record(uint8_t key, std::chrono::nanoseconds elapsed);
+  Snapshot Get(uint8_t key) const;
+  void Reset();
+
+ private:
+  struct Counters {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+    std::array<std::atomic<uint64_t>, kLatencyBucketsUs.size() + 1> latency_histogram{};
+  };
+
+  std::array<Counters, 256> counters_{};
+};
+
+// 下行帧分发表：以标识字节或控制码直接索引处理函数（O(1) 查找），并为每个键记录处理统计
+// 处理函数在构造时注册，之后只读
+template <typename Handler>
+class FrameDispatchTable {
+ public:
+  struct Entry {
+    Handler handler = nullptr;
+    const char* name = nullptr;
+  };
+
+  struct Registration {
+    uint8_t key;
+    const char* name;
+    Handler handler;
+  };
+
+  FrameDispatchTable(std::initializer_list<Registration> registrations) {
+    for (const auto& r : registrations) entries_[r.key] = Entry{r.handler, r.name};
+  }
+
+  // 未注册的键返回 nullptr
+  const Entry* Find(uint8_t key) const {
+    return entries_[key].handler ? &entries_[key] : nullptr;
+  }
+
+  void Record(uint8_t key, std::chrono::nanoseconds elapsed) const { stats_.Record(key, elapsed); }
+  void ResetStats() const { stats_.Reset(); }
+
+  // 已注册的键及收到过的未注册键的统计，按键升序
+  std::vector<FrameHandlerStats::Snapshot> GetStats() const {
+    std::vector<FrameHandlerStats::Snapshot> result;
+    for (size_t key = 0; key < entries_.size(); ++key) {
+      FrameHandlerStats::Snapshot snapshot = stats_.Get(static_cast<uint8_t>(key));
+      if (entries_[key].handler == nullptr && snapshot.count == 0) continue;
+      snapshot.name = entries_[key].name;
+      result.push_back(snapshot);
+    }
+    return result;
+  }
+
+ private:
+  std::array<Entry, 256> entries_{};
+  mutable FrameHandlerStats stats_;
+};
+
+#endif  // FRAME_DISPATCH_H_
@@ -0,0 +1,166 @@
+#ifndef FRAME_SCHEMA_H_
+#define FRAME_SCHEMA_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+#include "frame_writer.h"
+#include "protocol.h"
+
+// 编译期数据域布局描述
+//
+// 每个标识的数据域声明为一组字段类型（多字节整数为大端序），由模板生成定长编解码：
+//   - 字段偏移与数据域长度在编译期确定，超过 255 字节时编译失败；
+//   - 编码先按固定偏移写入栈上定长数组（按字节展开，无循环与分支），再整体写入 FrameWriter；
+//   - 解码按固定偏移从数据域读取，返回各字段值组成的 tuple（可直接 std::tie 到目标字段）。
+// 新增标识只需在 robot_frames.h 中声明其布局。
+namespace frame_schema {
+
+// 无符号整数（大端序）
+template <typename T>
+struct UInt {
+  using Value = T;
+  static constexpr size_t kSize = sizeof(T);
+
+  static void Store(uint8_t* out, Value value) {
+    StoreBytes(out, value, std::make_index_sequence<kSize>());
+  }
+  static Value Load(const uint8_t* in) {
+    return LoadBytes(in, std::make_index_sequence<kSize>());
+  }
+
+ private:
+  template <size_t... I>
+  static void StoreBytes(uint8_t* out, Value value, std::index_sequence<I...>) {
+    ((out[I] = static_cast<uint8_t>(value >> (8 * (kSize - 1 - I)))), ...);
+  }
+  template <size_t... I>
+  static Value LoadBytes(const uint8_t* in, std::index_sequence<I...>) {
+    return static_cast<Value>(((static_cast<uint32_t>(in[I]) << (8 * (kSize - 1 - I))) | ...));
+  }
+};
+
+using U8 = UInt<uint8_t>;
+using U16 = UInt<uint16_t>;
+using U32 = UInt<uint32_t>;
+
+// 定长原始字节
+template <size_t N>
+struct Bytes {
+  using Value = std::array<uint8_t, N>;
+  static constexpr size_t kSize = N;
+
+  static void Store(uint8_t* out, const Value& value) { std::memcpy(out, value.data(), N); }
+  static Value Load(const uint8_t* in) {
+    Value value;
+    std::memcpy(value.data(), in, N);
+    return value;
+  }
+};
+
+// 字段组合（可嵌套），值为各字段值组成的 tuple
+template <typename... Fields>
+struct Record {
+  using Value = std::tuple<typename Fields::Value...>;
+  static constexpr size_t kSize = (size_t{0} + ... + Fields::kSize);
+
+  static void Store(uint8_t* out, const Value& value) {
+    StoreFields(out, value, std::index_sequence_for<Fields...>());
+  }
+  static Value Load(const uint8_t* in) {
+    return LoadFields(in, std::index_sequence_for<Fields...>());
+  }
+
+ private:
+  template <size_t I>
+  using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+  static constexpr std::array<size_t, sizeof...(Fields)> Offsets() {
+    std::array<size_t, sizeof...(Fields)> offsets{};
+    const size_t sizes[] = {Fields::kSize..., 0};
+    size_t offset = 0;
+    for (size_t i = 0; i < sizeof...(Fields); ++i) {
+      offsets[i] = offset;
+      offset += sizes[i];
+    }
+    return offsets;
+  }
+  static constexpr std::array<size_t, sizeof...(Fields)> kOffsets = Offsets();
+
+  template <size_t... I>
+  static void StoreFields(uint8_t* out, const Value& value, std::index_sequence<I...>) {
+    (Field<I>::Store(out + kOffsets[I], std::get<I>(value)), ...);
+    (void)out;
+    (void)value;
+  }
+  template <size_t... I>
+  static Value LoadFields(const uint8_t* in, std::index_sequence<I...>) {
+    (void)in;
+    return Value(Field<I>::Load(in + kOffsets[I])...);
+  }
+};
+
+// 定长重复组
+template <typename Element, size_t N>
+struct Array {
+  using Value = std::array<typename Element::Value, N>;
+  static constexpr size_t kSize = Element::kSize * N;
+
+  static void Store(uint8_t* out, const Value& value) {
+    StoreElements(out, value, std::make_index_sequence<N>());
+  }
+  static Value Load(const uint8_t* in) {
+    return LoadElements(in, std::make_index_sequence<N>());
+  }
+
+ private:
+  template <size_t... I>
+  static void StoreElements(uint8_t* out, const Value& value, std::index_sequence<I...>) {
+    (Element::Store(out + I * Element::kSize, value[I]), ...);
+  }
+  template <size_t... I>
+  static Value LoadElements(const uint8_t* in, std::index_sequence<I...>) {
+    return Value{{Element::Load(in + I * Element::kSize)...}};
+  }
+};
+
+// 数据域布局：标识(1字节) + Fields
+template <typename... Fields>
+struct FrameLayout {
+  using Body = Record<Fields...>;
+  using Values = typename Body::Value;
+
+  // 数据域长度（含标识）
+  static constexpr size_t kSize = 1 + Body::kSize;
+  static_assert(kSize <= kMaxFrameDataSize, "数据域超过协议帧长度上限(255字节)");
+
+  // 以指定标识写入数据域（同一布局可用于多个标识）
+  static void EncodeAs(uint8_t identifier, FrameWriter* writer,
+                       const typename Fields::Value&... values) {
+    std::array<uint8_t, kSize> bytes;
+    bytes[0] = identifier;
+    Body::Store(bytes.data() + 1, Values(values...));
+    writer->PutBytes(bytes.data(), kSize);
+  }
+
+  // 读取标识之后的各字段，调用方须先确认 data.size() >= kSize
+  static Values Decode(ByteSpan data) { return Body::Load(data.data() + 1); }
+};
+
+}  // namespace frame_schema
+
+// 单个标识的数据域描述
+template <uint8_t Identifier, typename... Fields>
+struct FrameSchema : frame_schema::FrameLayout<Fields...> {
+  static constexpr uint8_t kIdentifier = Identifier;
+
+  static void Encode(FrameWriter* writer, const typename Fields::Value&... values) {
+    frame_schema::FrameLayout<Fields...>::EncodeAs(kIdentifier, writer, values...);
+  }
+};
+
+#endif  // FRAME_SCHEMA_H_
@@ -0,0 +1,105 @@
+#ifndef FRAME_WRITER_H_
+#define FRAME_WRITER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "protocol.h"
+
+// 协议帧最大长度：帧头(1) + 控制码(1) + 编号(2) + 帧计数(1) + 长度(1) + 数据域(<=255) + 校验(1) + 帧尾(1)
+constexpr size_t kFrameHeaderSize = 6;
+constexpr size_t kMaxFrameDataSize = 255;
+constexpr size_t kMaxFrameSize = kFrameHeaderSize + kMaxFrameDataSize + 2;
+
+// 可容纳任意一帧的定长缓冲区（放在栈上即可，无需堆分配）
+using FrameBuffer = std::array<uint8_t, kMaxFrameSize>;
+
+// 零分配协议帧编码器
+//
+// 直接在调用方提供的缓冲区中依次写入帧头、数据域、校验和与帧尾，校验和随写入
+// 累加，不产生任何中间 vector。数据长度字节在 Finish 时回填。
+// 数据域超过 255 字节或缓冲区不足时置溢出标志，之后的写入被忽略，Finish 返回 0。
+class FrameWriter {
+ public:
+  FrameWriter(uint8_t* buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {}
+  explicit FrameWriter(FrameBuffer& buffer) : FrameWriter(buffer.data(), buffer.size()) {}
+
+  // 开始一帧：写入帧头、控制码、编号（大端）、帧计数，并为数据长度预留1字节
+  void Begin(uint8_t control_code, uint16_t number, uint8_t frame_count) {
+    size_ = 0;
+    checksum_ = 0;
+    overflow_ = capacity_ < kFrameHeaderSize + 2;
+    if (overflow_) return;
+    Raw(FRAME_HEADER);
+    Raw(control_code);
+    Raw(static_cast<uint8_t>(number >> 8));
+    Raw(static_cast<uint8_t>(number & 0xFF));
+    Raw(frame_count);
+    buffer_[size_++] = 0;  // 数据长度，Finish 时回填
+  }
+
+  // 数据域写入（多字节整数按大端序）
+  void PutU8(uint8_t value) {
+    if (!Reserve(1)) return;
+    Raw(value);
+  }
+  void PutU16(uint16_t value) {
+    if (!Reserve(2)) return;
+    Raw(static_cast<uint8_t>(value >> 8));
+    Raw(static_cast<uint8_t>(value));
+  }
+  void PutU32(uint32_t value) {
+    if (!Reserve(4)) return;
+    Raw(static_cast<uint8_t>(value >> 24));
+    Raw(static_cast<uint8_t>(value >> 16));
+    Raw(static_cast<uint8_t>(value >> 8));
+    Raw(static_cast<uint8_t>(value));
+  }
+  void PutBytes(const uint8_t* data, size_t size) {
+    if (!Reserve(size)) return;
+    for (size_t i = 0; i < size; ++i) Raw(data[i]);
+  }
+
+  // 回填数据长度，写入校验和与帧尾；返回整帧长度，溢出时返回 0
+  size_t Finish() {
+    if (overflow_) return 0;
+    const uint8_t length = static_cast<uint8_t>(DataSize());
+    buffer_[kFrameHeaderSize - 1] = length;
+    checksum_ += length;
+    const uint8_t checksum = checksum_;
+    buffer_[size_++] = checksum;
+    buffer_[size_++] = FRAME_TAIL;
+    return size_;
+  }
+
+  const uint8_t* Data() const { return buffer_; }
+  size_t Size() const { return size_; }
+  // 当前数据域长度（标识 + 参数）
+  size_t DataSize() const { return size_ >= kFrameHeaderSize ? size_ - kFrameHeaderSize : 0; }
+  const uint8_t* DataField() const { return buffer_ + kFrameHeaderSize; }
+  bool Overflowed() const { return overflow_; }
+
+ private:
+  bool Reserve(size_t size) {
+    // 为校验和与帧尾保留2字节
+    if (overflow_ || size_ < kFrameHeaderSize || DataSize() + size > kMaxFrameDataSize ||
+        size_ + size + 2 > capacity_) {
+      overflow_ = true;
+      return false;
+    }
+    return true;
+  }
+  void Raw(uint8_t value) {
+    buffer_[size_++] = value;
+    checksum_ += value;
+  }
+
+  uint8_t* buffer_;
+  size_t capacity_;
+  size_t size_ = 0;
+  uint8_t checksum_ = 0;
+  bool overflow_ = true;  // 未调用 Begin 前不可写入
+};
+
+#endif  // FRAME_WRITER_H_
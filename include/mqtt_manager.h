@@ -2,7 +2,9 @@
 #define MQTT_MANAGER_H_
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
 #include <map>
 #include <memory>
@@ -13,15 +15,14 @@
 #include <vector>
 
 #include "config_db.h"
-#include "mqtt/async_client.h"
+#include "envelope_codec.h"
+#include "fleet_alarm.h"
+#include "fleet_scheduler.h"
+#include "fleet_sim.h"
+#include "mqtt_shard.h"
 #include "robot.h"
-
-// 待发送的消息结构
-struct PendingMessage {
-  std::string topic;
-  std::string payload;
-  int qos;
-};
+#include "schedule_index.h"
+#include "start_admission.h"
 
 // 接收到的消息结构
 struct ReceivedMessage {
@@ -39,8 +40,7 @@ struct MqttCommMessage {
   std::string data;
 };
 
-class MqttManager : public virtual mqtt::callback,
-                    public std::enable_shared_from_this<MqttManager> {
+class MqttManager : public std::enable_shared_from_this<MqttManager> {
  public:
   MqttManager(const std::string& broker, const std::string& client_id, int qos,
               std::shared_ptr<ConfigDb> config_db);
@@ -67,9 +67,9 @@ class MqttManager : public virtual mqtt::callback,
   // 发布消息
   void Publish(const std::string& robot_id);
 
-  // 将消息加入发送队列（线程安全，供Robot调用）
-  void EnqueueMessage(const std::string& topic, const std::string& payload,
-                      int qos);
+  // 将消息加入机器人所属分片的发送队列（线程安全，供Robot调用）
+  void EnqueueMessage(const std::string& robot_id, const std::string& topic,
+                      const std::string& payload, int qos);
 
   // 从配置库加载当前启用的机器人并注册（非阻塞）
   void RefreshRobots();
@@ -80,7 +80,7 @@ class MqttManager : public virtual mqtt::callback,
   // 停止运行（停止后台线程并断开）
   void Stop();
 
-  // 实时更新所有运行中机器人的三类上报间隔并重启其上报线程
+  // 实时更新所有运行中机器人的三类上报间隔（立即生效）
   void UpdateAllRobotsReportIntervals(int robot_data_s, int motor_params_s, int lora_clean_s);
 
   // 获取当前管理的机器人数量（供 Robot 内部计算错峰偏移用）
@@ -89,7 +89,7 @@ class MqttManager : public virtual mqtt::callback,
   // 获取 MQTT 连接配置
   std::string GetBroker() const { return broker_; }
   std::string GetUsername() const { return username_; }
-  bool IsConnected() const { return client_ && client_->is_connected(); }
+  bool IsConnected() const;
 
   // 更新 MQTT 服务配置并重新连接（保存到数据库）
   bool ReconfigureAndReconnect(const std::string& broker,
@@ -97,10 +97,8 @@ class MqttManager : public virtual mqtt::callback,
                                const std::string& password,
                                int keepalive = 60);
 
-  // MQTT回调
-  void connection_lost(const std::string& cause) override;
-  void message_arrived(mqtt::const_message_ptr msg) override;
-  void delivery_complete(mqtt::delivery_token_ptr token) override;
+  // 各连接分片的发布统计（队列深度、在途窗口、送达/失败计数与速率）
+  std::vector<MqttShard::Stats> GetShardStats();
 
   // Recent MQTT communication records (max 100)
   std::vector<MqttCommMessage> GetRecentMqttMessages(const std::string& robot_id,
@@ -110,9 +108,33 @@ class MqttManager : public virtual mqtt::callback,
                                                      size_t limit = 100);
 
   // 全局数据模拟配置（对所有机器人通用）
-  SimConfig GetGlobalSimConfig() const;
+  // 配置以不可变快照发布：读取方无需加锁，修改时整体替换快照并递增版本号
+  SimConfig GetGlobalSimConfig() const { return *GetSimConfigSnapshot(); }
+  std::shared_ptr<const SimConfig> GetSimConfigSnapshot() const;
+  uint64_t GetSimConfigVersion() const { return sim_config_version_.load(std::memory_order_acquire); }
   void SetGlobalSimConfig(const SimConfig& config);
 
+  // 车队模拟引擎（所有机器人的模拟采样在此统一生成）
+  std::shared_ptr<FleetSimEngine> GetFleetSimEngine() const { return fleet_sim_; }
+
+  // 全车队告警模拟调度器（所有机器人的模拟告警产生/清除事件在此统一调度）
+  std::shared_ptr<FleetAlarmScheduler> GetFleetAlarmScheduler() const { return fleet_alarm_; }
+
+  // 惰性模拟模式：机器人状态在读取时按经过时间解析推算，车队引擎不再逐 tick 采样
+  // （需在 Run 创建机器人之前设置）
+  void SetLazySimulation(bool enabled) { lazy_simulation_.store(enabled); }
+  bool IsLazySimulation() const { return lazy_simulation_.load(); }
+
+  // MQTT 消息封装格式（mqtt_config 的 envelope_format，需在 Run 之前设置），上下行对称
+  void SetEnvelopeFormat(EnvelopeFormat format) { envelope_format_.store(format); }
+  EnvelopeFormat GetEnvelopeFormat() const { return envelope_format_.load(std::memory_order_relaxed); }
+
+  // 清扫启动准入控制（并发F0上限、每秒启动速率、启动抖动）
+  StartAdmission& GetStartAdmission() { return start_admission_; }
+
+  // 全车队定时任务索引（机器人定时任务变化时调用，由每分钟的定时器统一触发清扫）
+  void UpdateScheduleIndex(const std::string& robot_id, const ScheduleTaskList& tasks);
+
  private:
   std::string broker_;
   std::string username_;
@@ -120,33 +142,52 @@ class MqttManager : public virtual mqtt::callback,
   std::string client_id_;
   int qos_;
   std::shared_ptr<ConfigDb> config_db_;
-  std::unique_ptr<mqtt::async_client> client_;
+
+  // MQTT 连接分片（mqtt_connections 个，每个分片独立的客户端、发送队列与发送线程）
+  // 机器人按 robot_id 的一致性哈希分配到分片：环上每个分片 kShardVirtualNodes 个虚拟节点
+  std::vector<std::unique_ptr<MqttShard>> shards_;
+  std::vector<std::pair<uint32_t, size_t>> shard_ring_;  // (哈希, 分片下标)，按哈希排序
+  MqttShard& ShardFor(const std::string& robot_id) const;
   std::map<std::string, std::shared_ptr<Robot>> robots_;  // robot_id -> Robot
   std::map<std::string, std::string>
       topic_to_robot_;  // subscribe_topic -> robot_id
   mutable std::mutex robots_mutex_;
-  std::thread sender_thread_;    // 消息发送线程
   std::thread receiver_thread_;  // 消息接收处理线程
-  std::atomic<bool> stop_sender_{false};
   std::atomic<bool> stop_receiver_{false};
   std::atomic<bool> running_{false};
 
-  // 发送消息队列相关
-  std::queue<PendingMessage> message_queue_;
-  std::mutex queue_mutex_;
-  std::condition_variable queue_cv_;
-
   // 接收消息队列相关
   std::queue<ReceivedMessage> received_queue_;
   std::mutex received_queue_mutex_;
   std::condition_variable received_queue_cv_;
 
-  // 全局数据模拟配置
-  SimConfig global_sim_config_;
-  mutable std::mutex sim_config_mutex_;
-
-  // 后台发送线程函数
-  void SenderThreadFunc();
+  // 全局数据模拟配置（只读快照，通过 std::atomic_load/atomic_store 原子替换）
+  std::shared_ptr<const SimConfig> sim_config_{std::make_shared<const SimConfig>()};
+  std::atomic<uint64_t> sim_config_version_{1};
+  std::mutex sim_config_write_mutex_;  // 仅串行化写入方（保证版本号与快照顺序一致）
+
+  // 车队模拟引擎及其每 tick 的采样定时器
+  std::shared_ptr<FleetSimEngine> fleet_sim_;
+  FleetScheduler::TimerId fleet_sim_timer_id_{0};
+  std::atomic<bool> lazy_simulation_{false};
+  std::atomic<EnvelopeFormat> envelope_format_{EnvelopeFormat::kJson};
+
+  // 告警模拟调度器及其事件定时器
+  std::shared_ptr<FleetAlarmScheduler> fleet_alarm_;
+  FleetScheduler::TimerId fleet_alarm_timer_id_{0};
+
+  StartAdmission start_admission_;
+
+  // 定时任务索引及每分钟触发一次的检查定时器
+  ScheduleIndex schedule_index_;
+  FleetScheduler::TimerId schedule_timer_id_{0};
+  int64_t last_schedule_minute_{-1};  // 已检查到的分钟（自纪元起），下次从其后一分钟补齐，防止重复或遗漏触发
+  std::chrono::milliseconds OnScheduleTimer();
+  std::chrono::milliseconds OnFleetSimTimer();
+  std::chrono::milliseconds OnFleetAlarmTimer();
+
+  // 收到下行消息（各分片的 Paho 回调线程），放入接收队列
+  void OnMessageArrived(const std::string& topic, const std::string& payload);
 
   // 后台接收处理线程函数
   void ReceiverThreadFunc();
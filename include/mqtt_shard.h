@@ -0,0 +1,141 @@
+#ifndef MQTT_SHARD_H_
+#define MQTT_SHARD_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "mqtt/async_client.h"
+
+// 待发送的消息结构
+struct PendingMessage {
+  std::string topic;
+  std::string payload;
+  int qos;
+  int attempts = 0;  // 已失败的发布次数（发布回调失败后重新入队时递增）
+};
+
+// MQTT 连接分片
+//
+// 每个分片拥有独立的客户端连接（client_id 带分片后缀）、发送队列、发送线程与在途窗口，
+// 由 MqttManager 按 robot_id 的一致性哈希把机器人分配到分片：同一机器人的上行消息
+// 始终经同一队列、同一连接按序发布，下行主题也只在该分片上订阅。
+//
+// 发送线程异步发布，不等待 broker 确认；在途消息数不超过 max_inflight（同时设置为 Paho
+// 的 max_inflight）。送达在 delivery_complete（QoS1/2）或 on_success（QoS0）中统计，
+// 失败在 on_failure 中放入重试队列，超过重试次数后丢弃。重试队列先于发送队列发布，
+// 重试消息不会排到其后入队的新消息之后（同一机器人的消息尽量保持顺序）。
+class MqttShard : public virtual mqtt::callback,
+                  public virtual mqtt::iaction_listener {
+ public:
+  struct Options {
+    int index = 0;
+    std::string broker;
+    std::string client_id;
+    std::string username;
+    std::string password;
+    int max_inflight = 64;
+  };
+
+  struct Stats {
+    int index = 0;
+    std::string client_id;
+    bool connected = false;
+    size_t queued = 0;       // 发送队列与重试队列中等待发布的消息数
+    int max_inflight = 0;    // 在途窗口上限
+    int inflight = 0;        // 已发布、尚未确认的消息数
+    uint64_t delivered = 0;  // 已确认送达（QoS0 为写出完成）
+    uint64_t failed = 0;     // 发布回调报告失败的次数（含重试）
+    uint64_t dropped = 0;    // 重试次数耗尽后丢弃的消息数
+    double rate = 0;         // 送达速率（条/秒，两次查询之间、至少 1 秒内的平均值）
+  };
+
+  // 收到下行消息 / 上行消息已送达（通信记录用），均在 Paho 回调线程中调用
+  using MessageHandler = std::function<void(const std::string& topic, const std::string& payload)>;
+
+  MqttShard(const Options& options, MessageHandler on_message, MessageHandler on_delivered);
+  ~MqttShard() override;
+
+  int index() const { return options_.index; }
+  const std::string& client_id() const { return options_.client_id; }
+
+  bool Connect(int keepalive);
+  void Disconnect();
+  bool IsConnected() const;
+
+  // 更换 broker/账号并重建客户端（旧客户端的在途消息作废），需重新 Connect。
+  // 发送线程会使用客户端，须在 Stop 之后调用，重连后再 Start
+  void Reconfigure(const std::string& broker, const std::string& username,
+                   const std::string& password);
+
+  bool Subscribe(const std::string& topic, int qos);
+  bool Unsubscribe(const std::string& topic);
+
+  // 启动/停止发送线程；Stop 会等待在途消息确认（最多 5 秒）
+  void Start();
+  void Stop();
+
+  // 将消息加入发送队列（线程安全）
+  void Enqueue(PendingMessage message);
+
+  Stats GetStats();
+
+  // MQTT回调
+  void connection_lost(const std::string& cause) override;
+  void message_arrived(mqtt::const_message_ptr msg) override;
+  void delivery_complete(mqtt::delivery_token_ptr token) override;
+
+  // 发布动作回调（由 publish 的 token 触发）
+  void on_success(const mqtt::token& token) override;
+  void on_failure(const mqtt::token& token) override;
+
+ private:
+  void SenderThreadFunc();
+
+  // 发布失败的消息放入重试队列（发布失败回调中调用，按失败顺序排队）
+  void EnqueueRetry(PendingMessage message);
+
+  // 在途窗口：等待空闲名额（停止时返回 false）与释放名额
+  bool AcquireInflightSlot();
+  void ReleaseInflightSlot();
+  // 发布完成（QoS1/2 在 delivery_complete，QoS0 在 on_success）：释放名额并记录通信
+  void OnPublishComplete(const mqtt::delivery_token& token);
+
+  Options options_;
+  int keepalive_ = 60;
+  std::unique_ptr<mqtt::async_client> client_;
+  MessageHandler on_message_;
+  MessageHandler on_delivered_;
+
+  std::thread sender_thread_;
+  std::atomic<bool> stop_sender_{false};
+
+  // 发送消息队列与重试队列（均由 queue_mutex_ 保护，重试队列优先发布）
+  std::deque<PendingMessage> message_queue_;
+  std::deque<PendingMessage> retry_queue_;
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+
+  // 在途窗口：发送线程发布前占用一个名额，送达/失败回调中释放
+  int inflight_ = 0;
+  std::mutex inflight_mutex_;
+  std::condition_variable inflight_cv_;
+  std::atomic<uint64_t> delivered_{0};
+  std::atomic<uint64_t> failed_{0};
+  std::atomic<uint64_t> dropped_{0};
+
+  // 送达速率采样（GetStats 中更新）
+  std::mutex rate_mutex_;
+  std::chrono::steady_clock::time_point rate_time_;
+  uint64_t rate_delivered_ = 0;
+  double rate_ = 0;
+};
+
+#endif  // MQTT_SHARD_H_
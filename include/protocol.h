@@ -1,6 +1,7 @@
 #ifndef PROTOCOL_H_
 #define PROTOCOL_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -34,6 +35,31 @@ struct ProtocolFrame {
         tail(FRAME_TAIL) {}
 };
 
+// 只读字节区间（指向外部缓冲区，不拥有数据）
+struct ByteSpan {
+  const uint8_t* ptr = nullptr;
+  size_t len = 0;
+
+  const uint8_t* data() const { return ptr; }
+  size_t size() const { return len; }
+  bool empty() const { return len == 0; }
+  uint8_t operator[](size_t i) const { return ptr[i]; }
+  const uint8_t* begin() const { return ptr; }
+  const uint8_t* end() const { return ptr + len; }
+  std::vector<uint8_t> ToVector() const { return std::vector<uint8_t>(begin(), end()); }
+};
+
+// 协议帧视图：字段与 ProtocolFrame 相同，数据域直接指向原始缓冲区
+// 原始缓冲区须在视图使用期间保持有效
+struct FrameView {
+  uint8_t control_code = 0;
+  uint16_t number = 0;
+  uint8_t frame_count = 0;
+  uint8_t length = 0;
+  ByteSpan data;  // 数据域（标识1字节+参数N字节）
+  uint8_t checksum = 0;
+};
+
 class Protocol {
  public:
   Protocol();
@@ -47,6 +73,11 @@ class Protocol {
   // 解码：解析协议帧
   bool Decode(const std::vector<uint8_t>& raw_data, ProtocolFrame& frame);
 
+  // 零拷贝解码：校验帧头、长度、校验和与帧尾，view 的数据域指向 raw_data
+  // 不分配内存、不输出日志；失败时 error（可为空）返回原因
+  static bool DecodeView(const uint8_t* raw_data, size_t size, FrameView* view,
+                         const char** error = nullptr);
+
   // 计算校验和（累加和）
   static uint8_t CalculateChecksum(const std::vector<uint8_t>& data);
 
@@ -55,6 +86,7 @@ class Protocol {
 
   // 将字节数组转换为十六进制字符串
   static std::string BytesToHexString(const std::vector<uint8_t>& bytes);
+  static std::string BytesToHexString(const uint8_t* bytes, size_t size);
 
   // 将十六进制字符串转换为字节数组
   static std::vector<uint8_t> HexStringToBytes(const std::string& hex_str);
@@ -62,9 +94,19 @@ class Protocol {
   // 将字节数组转换为Base64编码字符串
   static std::string BytesToBase64(const std::vector<uint8_t>& bytes);
 
+  // Base64编码写入调用方缓冲区（至少 Base64EncodedSize(size) 字节，不追加'\0'），
+  // 返回写入的字符数
+  static size_t BytesToBase64(const uint8_t* bytes, size_t size, char* out);
+  static constexpr size_t Base64EncodedSize(size_t size) { return (size + 2) / 3 * 4; }
+
   // 将Base64编码字符串转换为字节数组
   static std::vector<uint8_t> Base64ToBytes(const std::string& base64_str);
 
+  // Base64解码写入调用方缓冲区，规则与上面相同（跳过非法字符，遇'='结束）
+  // 解码结果超过 capacity 时返回 false
+  static bool Base64ToBytes(const char* base64, size_t size, uint8_t* out,
+                            size_t capacity, size_t* out_size);
+
  private:
   // 计算帧的校验和（不包括帧头、校验和、帧尾）
   uint8_t CalculateFrameChecksum(const ProtocolFrame& frame);
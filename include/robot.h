@@ -1,18 +1,26 @@
 #ifndef ROBOT_H_
 #define ROBOT_H_
 
+#include <array>
 #include <atomic>
 #include <cstdint>
-#include <fstream>
+#include <functional>
 #include <memory>
-#include <random>
 #include <string>
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 
+#include "fleet_alarm.h"
+#include "fleet_scheduler.h"
+#include "fleet_sim.h"
+#include "envelope_codec.h"
+#include "frame_dispatch.h"
+#include "frame_writer.h"
 #include "protocol.h"
+#include "sim_rng.h"
+#include "uplink_template.h"
 #include <chrono>
 
 // 指令类型
@@ -46,6 +54,9 @@ struct ScheduleTask {
   int run_count = 0;  // 运行次数
 };
 
+// 定时任务表（固定7组，编号1~7对应下标0~6）
+using ScheduleTaskList = std::array<ScheduleTask, 7>;
+
 // 电机参数
 struct MotorParams {
   int walk_motor_speed = 0;                    // 行走电机速率
@@ -310,11 +321,11 @@ struct RobotData {
 
   // 配置参数
   LoraParams lora_params{};                   // LoRa参数
-  std::string robot_number;                   // 机器人编号
+  uint16_t robot_number = 0;                  // 机器人编号（数值，组帧时直接使用）
   std::string software_version;               // 软件版本
   int parking_position = 0;                   // 停机位
   bool daytime_scan_protect = false;          // 白天防误扫开关
-  std::vector<ScheduleTask> schedule_tasks;   // 定时任务
+  ScheduleTaskList schedule_tasks{};          // 定时任务
   bool enabled = true;                        // 启用/停用
 
   // 电机和保护参数
@@ -325,9 +336,9 @@ struct RobotData {
   RobotLocalTime local_time{};
   EnvironmentInfo environment_info{};
 
-  // 数组数据
-  std::vector<int> master_currents;  // 主机电流
-  std::vector<int> slave_currents;   // 从机电流
+  // 数组数据（固定16个采样点）
+  std::array<int, 16> master_currents{};  // 主机电流
+  std::array<int, 16> slave_currents{};   // 从机电流
   int position = 0;                  // 位置
   int direction = 0;                 // 方向
 
@@ -340,7 +351,7 @@ struct RobotData {
     uint8_t result = 0;    // 清扫结果 (1字节)
     uint8_t energy = 0;    // 耗电量 (1字节, 单位按协议定义)
   };
-  std::vector<CleanRecord> clean_records; // 最多5条清扫记录
+  std::array<CleanRecord, 5> clean_records{};  // 最近5条清扫记录（[0]为最新）
 
   int board_humidity = 0; // 主板湿度（％，可用1字节或按需扩展）
   // 设备标识
@@ -392,6 +403,10 @@ class Robot {
   // 更新告警到数据库（当告警内容发生变化时调用）
   void UpdateAlarmsToDb();
 
+  // 持写锁对FC告警位先清除 clear_bits 再置位 set_bits（告警调度器调用）。告警值有变化时
+  // 发布新快照并返回持久化任务，否则返回空；任务不引用本对象，可在调用方释放锁后执行
+  std::function<void()> ApplyAlarmFcBits(uint32_t set_bits, uint32_t clear_bits);
+
   // 设置上报间隔（秒）- 兼容旧接口，等同于设置机器人数据上报间隔
   void SetReportInterval(int interval_seconds);
 
@@ -407,6 +422,13 @@ class Robot {
   // 停止定时上报
   void StopReport();
 
+  // 定时任务变化后调用，同步到 MqttManager 的全车队定时任务索引
+  void NotifyScheduleChanged();
+
+  // 惰性模拟模式下，把位置/电量/采样推算到当前时刻（非惰性模式下无操作）
+  // 上报组帧前会自动调用，HTTP 查询实时数据前也应调用
+  void RefreshSimulatedState();
+
   // 获取发布主题
   std::string GetPublishTopic() const { return publish_topic_; }
 
@@ -415,13 +437,46 @@ class Robot {
 
   // 生成上行数据（使用模板）
   std::string GenerateUplinkPayload(const std::string& data);
-
-  // 处理接收到的订阅消息
-  void HandleMessage(const std::string& data);
-
-  // 获取和设置机器人数据
-  RobotData& GetData() { return data_; }
-  const RobotData& GetData() const { return data_; }
+  // 同上，结果写入 out（复用 out 已有容量，稳态下不分配内存）
+  void GenerateUplinkPayload(const char* data, size_t size, std::string* out);
+
+  // 按封装格式编码一帧上行协议帧（json 为 Base64 + 上行模板，raw 为帧字节本身，protobuf 为 UplinkEvent）
+  void EncodeUplink(EnvelopeFormat format, const uint8_t* frame, size_t size, std::string* out);
+
+  // 构建机器人数据域（标识符 + 46字节机器人状态数据），直接写入帧
+  void BuildRobotDataField(uint8_t identifier, FrameWriter* writer);
+
+  // 构建Lora参数&清扫设置 / 电机参数&温度电压参数数据域（主动上报与查询回复共用布局）
+  void BuildLoraCleanField(uint8_t identifier, FrameWriter* writer) const;
+  void BuildMotorParamsField(uint8_t identifier, FrameWriter* writer) const;
+
+  // 处理接收到的协议帧字节（解析失败时记录日志并发布当前数据）
+  void HandleMessage(const uint8_t* data, size_t size);
+  // 处理已解码的协议帧（数据域指向调用方缓冲区，不拷贝）
+  void HandleFrame(const FrameView& frame);
+
+  // 下行帧处理函数表：按标识字节（数据域首字节）与控制码分别注册，
+  // 每个键带处理次数与耗时统计（进程内所有机器人共享）
+  using FrameHandler = void (Robot::*)(const FrameView&);
+  using FrameHandlerTable = FrameDispatchTable<FrameHandler>;
+  static const FrameHandlerTable& IdentifierHandlers();
+  static const FrameHandlerTable& ControlCodeHandlers();
+
+  // 修改机器人数据：持有本机器人的写锁调用 fn(data)，完成后发布新快照。
+  // 外部写入方（HTTP、MqttManager、告警调度器）均须经此修改；fn 内不得调用
+  // CancelTimer/StopReport 或告警调度器的 Start/Stop/Register/Unregister
+  template <typename Fn>
+  void UpdateData(Fn&& fn) {
+    std::lock_guard<std::recursive_mutex> lock(data_mutex_);
+    fn(data_);
+    PublishData();
+  }
+
+  // 已发布的数据快照：读取方（HTTP查询、持久化）无锁获取一致的只读副本，
+  // 不会读到写入一半的数据；版本号每次发布递增，可作为下游缓存的键
+  std::shared_ptr<const RobotData> GetDataSnapshot() const;
+  uint64_t GetDataVersion() const { return data_version_.load(std::memory_order_acquire); }
+  void PublishData();
 
   // 请求回复跟踪（用于前端轮询）
   uint64_t BeginRequestReplyTracking();
@@ -464,7 +519,7 @@ class Robot {
                                 uint8_t protection_battery_level,
                                 uint8_t limit_run_battery_level,
                                 uint8_t recovery_battery_level);
-  void SendScheduleParamsRequest(const std::vector<ScheduleTask>& tasks);
+  void SendScheduleParamsRequest(const ScheduleTaskList& tasks);
   void SendParkingPositionRequest(uint8_t parking_position);
   void SendScheduleStartRequest(uint8_t schedule_id, uint8_t weekday,
                                 uint8_t hour, uint8_t minute, uint8_t run_count);
@@ -501,6 +556,9 @@ class Robot {
 
  private:
   std::string robot_id_;                   // 机器人ID
+  // 机器人序号（数字，模拟随机数流标识）：构造时确定，仿真/告警槽位与启动抖动都以此登记，
+  // 运行中不随 E0 设置变化；E0 修改的是 data_.robot_number（组帧使用的编号）
+  uint16_t robot_number_{0};
   std::string publish_topic_;              // 发布主题
   std::string subscribe_topic_;            // 订阅主题
   std::atomic<int> sequence_{0};           // 序列号
@@ -511,9 +569,11 @@ class Robot {
 
   // 配置数据库（用于持久化告警数据）
   std::weak_ptr<ConfigDb> config_db_;
+  // 生成告警持久化任务（要求持有 data_mutex_ 且已发布；ConfigDb 不可用时返回空）
+  std::function<void()> MakeAlarmPersistTaskLocked() const;
 
-  // 上报线程相关
-  std::thread report_thread_;              // 上报线程
+  // 定时上报（由全局 FleetScheduler 驱动，不再占用独立线程）
+  FleetScheduler::TimerId report_timer_id_{0};  // 上报定时器ID（0 表示未注册）
   std::atomic<bool> stop_report_{false};   // 停止上报标志
   int robot_data_report_interval_s_{600};     // 机器人数据上报间隔（秒）
   int motor_params_report_interval_s_{3600};  // 电机参数上报间隔（秒）
@@ -525,33 +585,103 @@ class Robot {
   std::chrono::system_clock::time_point creation_time_;
 
   // 更新时间相关字段（本地时间、当前时间戳、工作时长）
-  void UpdateTimeFields();
+  void UpdateTimeFields() { FillTimeFields(&data_); }
+  void FillTimeFields(RobotData* data) const;
+
+  // 开始一帧主动上报（控制码0x82，编号与帧计数取当前值）
+  void BeginReportFrame(FrameWriter* writer) const;
+
+  // 结束帧并发送：按 MqttManager 的封装格式编码后加入发送队列，帧计数累加
+  // 编码缓冲区按线程复用，稳态下不分配内存
+  bool SendFrame(MqttManager* mqtt_manager, FrameWriter* writer);
+
+  // 结束帧并发送，不累加帧计数（查询回复沿用请求中的编号与帧计数）
+  bool PublishFrame(MqttManager* mqtt_manager, FrameWriter* writer);
+
+  // 将已编码的协议帧按封装格式编码后加入发送队列
+  void PublishUplink(MqttManager* mqtt_manager, const uint8_t* frame, size_t size);
+  void PublishUplink(MqttManager* mqtt_manager, const std::vector<uint8_t>& frame) {
+    PublishUplink(mqtt_manager, frame.data(), frame.size());
+  }
+
+  // 上报定时器回调：补齐自上次触发以来经过的 tick，返回距下一个事件的延迟
+  std::chrono::milliseconds OnReportTimer();
 
-  // 构建机器人数据域（标识符 + 46字节机器人状态数据）
-  std::vector<uint8_t> BuildRobotDataField(uint8_t identifier);
+  // 推进 ticks 个 tick（调用方保证区间内最多只有一个事件到期）
+  void RunReportTicks(const SimConfig& sim, int ticks);
 
-  // 上报线程函数
-  void ReportThreadFunc();
+  // 距下一个事件（上报/位置/电量/告警）还有多少 tick
+  // 惰性模拟模式下只考虑上报，模拟状态在读取时推算
+  int TicksUntilNextEvent(const SimConfig& sim) const;
+
+  // 状态变化后立即唤醒上报定时器，重新计算下一个事件
+  void WakeReportTimer();
+
+  // 设置运动方向并唤醒上报定时器
+  void SetMoveDirection(int direction);
+
+  // 上报定时器的 tick 状态（原上报线程的局部变量）
+  bool report_timer_started_{false};          // 首次触发时计算错峰偏移
+  std::chrono::steady_clock::time_point last_tick_time_;  // 已补齐到的 tick 时刻
+  int robot_data_ticks_{0};                   // 机器人数据上报计时
+  int motor_params_ticks_{0};                 // 电机参数上报计时
+  int lora_clean_ticks_{0};                   // Lora参数&清扫设置上报计时
+
+  // 数据快照双缓冲：published_data_ 为当前发布的快照，spare_data_ 为上一次发布的
+  // 缓冲，没有读取方持有时下次发布直接复用（避免每次发布都重新分配）
+  std::shared_ptr<const RobotData> published_data_;
+  std::shared_ptr<RobotData> spare_data_;
+  std::atomic<uint64_t> data_version_{0};
+
+  // 写锁：data_ 的所有修改与 PublishData 的拷贝均须持有（可重入，公共入口各自加锁）。
+  // 加锁顺序：告警调度器 mutex_ → data_mutex_ → request_reply_mutex_ / lazy_sim_mutex_
+  mutable std::recursive_mutex data_mutex_;
 
   // 读取上行数据模板
   static std::string LoadUplinkTemplate();
-  static std::string uplink_template_;  // 静态模板缓存
+  static UplinkTemplate uplink_template_;  // 静态模板缓存（加载时解析为文本段与槽位）
+  static UplinkProtobufEncoder uplink_protobuf_;  // 同一模板的 protobuf 静态字段
+  UplinkEnvelope uplink_envelope_;         // 本机器人预渲染的上行数据（只剩逐条消息字段）
+  std::atomic<uint32_t> uplink_fcnt_{0};   // 上行帧计数（fCnt）
+
+  // 填充逐条上行消息的动态字段（时间、fCnt、deduplicationId、信号质量），data 由调用方设置
+  void FillUplinkFields(UplinkFields* fields);
 
   std::atomic<int> move_direction_{0};    // 运动方向：1=前进, -1=后退, 0=停止
   int position_tick_{0};                   // 位置更新计时器（每300 tick=30s更新一次位置）
   int max_bracket_count_{50};              // 支架总数（默认50），前进到此值时自动折返
   int battery_level_tick_{0};              // 电量计时器（每600 tick=1分钟更新一次）
   float battery_level_f_{100.0f};          // 浮点电量（用于精确计算放电/充电）
-  std::mt19937 rng_{std::random_device{}()};  // 随机数生成器
 
-  // 告警模拟
-  int alarm_sim_tick_{0};                  // 告警计时器（每6000 tick=10分钟触发）
-  int total_ticks_{0};                     // 累计tick数（用于告警到期判断）
-  struct AlarmEntry { int bit; int expire_tick; };
-  std::vector<AlarmEntry> alarm_entries_;  // 当前活跃的模拟告警
+  // 车队模拟引擎（电流/光伏/温度/电压采样由引擎统一生成）
+  std::shared_ptr<FleetSimEngine> fleet_sim_;
+  FleetSimEngine::Slot sim_slot_{-1};
 
-  // 更新模拟数据（每 tick 调用）
-  void UpdateSimulatedData();
+  // 将运动状态同步到车队模拟引擎
+  void PublishSimMotion();
+
+  // 告警模拟（产生/清除事件由全车队告警调度器统一调度）
+  std::shared_ptr<FleetAlarmScheduler> fleet_alarm_;
+  FleetAlarmScheduler::Slot alarm_slot_{-1};
+  int total_ticks_{0};                     // 累计模拟tick数（惰性模式下作为采样随机数计数器）
+
+  // 更新模拟数据（读取车队模拟引擎的最新采样，计时类状态推进 ticks 个 tick）
+  void UpdateSimulatedData(const SimConfig& sim, int ticks);
+
+  // 以下函数由逐 tick 模式和惰性模式共用
+  void ApplySimSample(const SimSample& sample);
+  // 按当前运动状态结算 minutes 分钟的电量变化
+  void ApplyBatteryMinutes(const SimConfig& sim, int minutes, bool is_moving, bool at_dock);
+  // 沿 direction 移动 steps 个支架，处理末端折返/回到停靠位停止
+  void ApplyPositionSteps(int direction, int steps);
+
+  // 惰性模拟：保存 (已推算时刻, 方向, 计时相位)，读取时解析推算经过的 ticks
+  bool lazy_sim_{false};                   // 是否为惰性模拟模式（关联 MqttManager 时确定）
+  bool lazy_sim_started_{false};           // 上报定时器首次触发后开始推算
+  std::chrono::steady_clock::time_point lazy_sim_time_;  // 模拟状态已推算到的 tick 时刻
+  std::mutex lazy_sim_mutex_;
+  // 分段解析推算位置与电量（每段内方向不变，段数 = 折返/停止次数 + 1）
+  void AdvanceLazyMotion(const SimConfig& sim, int ticks);
 
   // 请求回复跟踪状态（F0/F1/F2）
   void MarkRequestReplyReceived();
@@ -560,24 +690,58 @@ class Robot {
   uint64_t request_reply_token_{0};
   uint64_t request_reply_completed_token_{0};
 
-  // 清扫任务（异步线程）
-  std::thread cleaning_task_thread_;
+  // 清扫任务（状态机，由全局 FleetScheduler 定时器和F0回复事件驱动，不占用线程）
+  enum class CleaningState {
+    kIdle,              // 空闲
+    kWaitAdmission,     // 排队等待启动许可（准入控制：并发F0上限/每秒启动速率）
+    kSendStartRequest,  // 待发送F0请求
+    kWaitStartReply,    // 已发送F0，等待平台回复（超时30秒）
+    kRunning,           // 清扫中，周期上报E5
+  };
+  std::atomic<FleetScheduler::TimerId> cleaning_timer_id_{0};  // 清扫任务定时器ID
   std::atomic<bool> cleaning_task_running_{false};
+  CleaningState cleaning_state_{CleaningState::kIdle};
+  uint8_t cleaning_schedule_id_{0};                             // 触发任务的定时器编号
+  uint64_t cleaning_reply_token_{0};                            // F0请求回复跟踪令牌
+  // F0回复截止时间（真实时间：平台回复不随模拟时钟加速或跳跃）
+  std::chrono::steady_clock::time_point cleaning_reply_deadline_;
+  FleetScheduler::HoldId cleaning_sim_hold_{0};                 // 等待F0回复期间的模拟时间保持
+  std::chrono::steady_clock::time_point cleaning_run_start_;       // 开始清扫的时间
+  int cleaning_next_report_s_{0};                               // 下一次E5上报时机（秒）
+  bool cleaning_admitted_{false};                               // 是否持有启动许可（F0在途名额）
+
+  // 归还启动许可与模拟时间保持（F0请求结束时调用，可重复调用）
+  void ReleaseStartAdmission();
   int clean_task_duration_min_{30};         // 清扫持续时间（分钟），默认30分钟
   int clean_current_report_interval_s_{30}; // 清扫期间E5上报间隔（秒），默认30秒
 
-  // 清扫任务线程函数
-  void CleaningTaskThreadFunc(uint8_t schedule_id);
-
-  // OTA固件升级
-  void HandleFirmwareDataFrame(const ProtocolFrame& frame);
-  bool upgrade_in_progress_{false};
-  uint8_t upgrade_version_high_{0};
-  uint8_t upgrade_version_low_{0};
-  uint32_t upgrade_expected_size_{0};
-  size_t upgrade_received_bytes_{0};
-  std::string upgrade_save_path_;
-  std::ofstream upgrade_file_;
+  // 清扫任务定时器回调：按当前状态推进一步，返回距下一次触发的延迟
+  std::chrono::milliseconds OnCleaningTimer();
+
+  // 清扫任务结束（成功/失败/中断均调用）
+  std::chrono::milliseconds FinishCleaningTask();
+
+  // 下行命令处理（由 HandleFrame 经处理函数表分发）
+  void HandleLocalTimeEnvQuery(const FrameView& frame);     // C2
+  void HandleMotorParamsQuery(const FrameView& frame);      // C1
+  void HandleLoraCleanQuery(const FrameView& frame);        // C0
+  void HandleMotorParamsSet(const FrameView& frame);        // A0
+  void HandleBatteryParamsSet(const FrameView& frame);      // A1
+  void HandleScheduleSet(const FrameView& frame);           // A2
+  void HandleParkingPositionSet(const FrameView& frame);    // A3
+  void HandleBroadcastSet(const FrameView& frame);          // A8
+  void HandleLoraParamsSet(const FrameView& frame);         // A4
+  void HandleScheduleStartReply(const FrameView& frame);    // F0
+  void HandleStartReply(const FrameView& frame);            // F1
+  void HandleTimeSyncReply(const FrameView& frame);         // F2
+  void HandleControlCommand(const FrameView& frame);        // B0-B6
+  void HandleRestartCommand(const FrameView& frame);        // BA
+  void HandleFirmwareUpgradeStart(const FrameView& frame);  // FD
+
+  // OTA固件升级（升级状态只在升级期间分配，平时每个机器人只占一个指针）
+  struct UpgradeState;
+  void HandleFirmwareDataFrame(const FrameView& frame);     // 控制码 0x50/0x60/0x70
+  std::unique_ptr<UpgradeState> upgrade_;
 };
 
 #endif  // ROBOT_H_
@@ -0,0 +1,121 @@
+#ifndef ROBOT_FRAMES_H_
+#define ROBOT_FRAMES_H_
+
+#include "frame_schema.h"
+
+// 各标识的数据域布局（均为大端序，长度含1字节标识）
+//
+// 编码：Schema::Encode(&writer, 字段值...)，同布局不同标识用 Schema::EncodeAs(标识, ...)
+// 解码：先校验 data.size() 与 Schema::kSize，再 Schema::Decode(data)
+
+namespace robot_frames {
+
+using frame_schema::Array;
+using frame_schema::Bytes;
+using frame_schema::Record;
+using frame_schema::U16;
+using frame_schema::U32;
+using frame_schema::U8;
+
+// 电机参数(23字节)：行走/毛刷/防风速率，三路停机电流，三路预警电流，
+// 行走里程，毛刷/防风超时，反转时间，保护角度
+using MotorParamsFields = Record<U8, U8, U8, U16, U16, U16, U16, U16, U16, U16, U16, U16, U8, U8>;
+
+// 电池参数(11字节)：保护电流，高/低温阈值，保护/恢复温度，保护/恢复电压，
+// 保护/限制运行/恢复电量
+using BatteryParamsFields = Record<U16, U8, U8, U8, U8, U8, U8, U8, U8, U8>;
+
+// 温度电压参数(15字节)：电池参数 + 主板保护/恢复温度
+using TempVoltageFields = Record<BatteryParamsFields, U16, U16>;
+
+// 定时任务(4字节)：星期，时，分，运行次数
+using ScheduleTaskFields = Record<U8, U8, U8, U8>;
+using ScheduleTableFields = Array<ScheduleTaskFields, 7>;
+
+// 平台时间与保护信息(13字节)：年(两位)，月，日，时，分，秒，星期，风速，
+// 通信箱数量，机器人数量，后台保护信息
+using PlatformInfoFields = Record<U8, U8, U8, U8, U8, U8, U8, U8, U16, U16, U8>;
+
+// 主/从机电流(2字节)
+using CurrentPairFields = Record<U8, U8>;
+
+// 清扫记录(7字节)：日，时，分，清扫分钟数，结果，耗电量
+using CleanRecordFields = Record<U8, U8, U8, U16, U8, U8>;
+
+// ── 平台下发 ────────────────────────────────────────────────────────────────
+
+using MotorParamsSetSchema = FrameSchema<0xA0, MotorParamsFields>;
+using BatteryParamsSetSchema = FrameSchema<0xA1, BatteryParamsFields>;
+using ScheduleSetSchema = FrameSchema<0xA2, ScheduleTableFields>;
+using ParkingSetSchema = FrameSchema<0xA3, U8>;
+using BroadcastSetSchema = FrameSchema<0xA8, PlatformInfoFields>;
+
+// 请求回复：定时启动/启动回复带启动运行标志，校时回复不带
+using ScheduleStartReplySchema = FrameSchema<0xF0, U8, PlatformInfoFields>;
+using StartReplySchema = FrameSchema<0xF1, U8, PlatformInfoFields>;
+using TimeSyncReplySchema = FrameSchema<0xF2, PlatformInfoFields>;
+
+// ── 机器人上行 ──────────────────────────────────────────────────────────────
+
+// 请求（与回复同标识，方向不同布局不同）：定时启动请求为 定时编号 + 定时任务
+using ScheduleStartRequestSchema = FrameSchema<0xF0, U8, ScheduleTaskFields>;
+using StartRequestSchema = FrameSchema<0xF1>;
+using TimeSyncRequestSchema = FrameSchema<0xF2>;
+
+// Lora参数&清扫设置(E0，C0查询回复同布局)：功率，频率，速率，机器人编号，
+// 软件版本(主/次)，启用/停用，保留，停机位，白天防误扫，定时任务1-7
+using LoraCleanReportSchema =
+    FrameSchema<0xE0, U8, U8, U8, U16, U8, U8, U8, U8, U8, U8, ScheduleTableFields>;
+
+// 电机参数&温度电压参数(E1，C1查询回复同布局)
+using MotorParamsReportSchema = FrameSchema<0xE1, MotorParamsFields, TempVoltageFields>;
+
+// 机器人数据(E4，控制指令响应同布局)：FA/FB/FC/FD告警，主/从电机电流，电池电压/电流/
+// 状态/电量/温度，位置，工作时长，光伏电压/电流，累计运行次数，当前圈数，
+// 当前时间戳(时/分/秒)，主板温度
+using RobotDataReportSchema =
+    FrameSchema<0xE4, U32, U16, U32, U16, U16, U16, U16, U16, U16, U16, U16, U16, U16, U16,
+                U16, U16, U32, U8, U8, U8, U16>;
+
+// 电流数据(E5)：位置，方向，上报间隔，10组主/从机电流
+using CurrentDataReportSchema = FrameSchema<0xE5, U16, U8, U16, Array<CurrentPairFields, 10>>;
+
+// 定时请求/未运行原因(E6)：定时编号 + 定时任务 + 原因 + 故障信息
+using ScheduledNotRunReportSchema = FrameSchema<0xE6, U8, ScheduleTaskFields, U8, U32>;
+
+// 未启动原因(E7)：原因 + 故障信息
+using NotStartedReportSchema = FrameSchema<0xE7, U8, U32>;
+
+// 启动请求回复接收后确认(E8)：定时编号
+using StartupConfirmReportSchema = FrameSchema<0xE8, U8>;
+
+// 清扫记录(E9)：5条记录，机器人编码(6字节)，本地时间(年/月/日/时/分/秒)，主板温度，主板湿度
+using CleanRecordReportSchema = FrameSchema<0xE9, Array<CleanRecordFields, 5>, Bytes<6>,
+                                            U8, U8, U8, U8, U8, U8, U16, U8>;
+
+// 本地时间&环境信息查询回复(C2)：本地时间(年/月/日/时/分/秒/星期)，
+// 传感器温度/湿度，环境温度，白夜状态
+using LocalTimeEnvReplySchema = FrameSchema<0xC2, U8, U8, U8, U8, U8, U8, U8, U16, U16, U16, U8>;
+
+// 协议文档中的数据域长度
+static_assert(MotorParamsSetSchema::kSize == 24, "A0");
+static_assert(BatteryParamsSetSchema::kSize == 12, "A1");
+static_assert(ScheduleSetSchema::kSize == 29, "A2");
+static_assert(ParkingSetSchema::kSize == 2, "A3");
+static_assert(BroadcastSetSchema::kSize == 14, "A8");
+static_assert(ScheduleStartReplySchema::kSize == 15, "F0");
+static_assert(StartReplySchema::kSize == 15, "F1");
+static_assert(TimeSyncReplySchema::kSize == 14, "F2");
+static_assert(LoraCleanReportSchema::kSize == 40, "E0");
+static_assert(MotorParamsReportSchema::kSize == 39, "E1");
+static_assert(RobotDataReportSchema::kSize == 46, "E4");
+static_assert(CurrentDataReportSchema::kSize == 26, "E5");
+static_assert(ScheduledNotRunReportSchema::kSize == 11, "E6");
+static_assert(NotStartedReportSchema::kSize == 6, "E7");
+static_assert(StartupConfirmReportSchema::kSize == 2, "E8");
+static_assert(CleanRecordReportSchema::kSize == 51, "E9");
+static_assert(LocalTimeEnvReplySchema::kSize == 15, "C2");
+
+}  // namespace robot_frames
+
+#endif  // ROBOT_FRAMES_H_
@@ -0,0 +1,57 @@
+#ifndef SCHEDULE_INDEX_H_
+#define SCHEDULE_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "robot.h"
+
+// 全车队定时任务索引
+//
+// 以"周内分钟"为键索引所有机器人的有效定时任务（run_count > 0）：
+//   weekday 0（每天）  -> 桶 hour*60+minute
+//   weekday 1~6        -> 桶 weekday*1440 + hour*60+minute
+// 每分钟只需查两个桶即可得到需要启动清扫的机器人，不再逐个机器人扫描任务。
+class ScheduleIndex {
+ public:
+  struct Match {
+    std::string robot_id;
+    uint8_t schedule_id = 0;  // 定时任务编号（1~7，对应 schedule_tasks 下标+1）
+    int weekday = 0;
+  };
+
+  // 用机器人当前的定时任务整体替换其索引项
+  void Update(const std::string& robot_id, const ScheduleTaskList& tasks);
+
+  // 删除机器人的全部索引项
+  void Remove(const std::string& robot_id);
+
+  // 查找在 (weekday, hour, minute) 触发的任务，每个机器人只返回编号最小的一个
+  // weekday 为 tm_wday（0~6）
+  std::vector<Match> Find(int weekday, int hour, int minute) const;
+
+  // 索引中的任务总数
+  size_t GetEntryCount() const;
+
+ private:
+  static constexpr int kMinutesPerDay = 24 * 60;
+
+  struct Entry {
+    std::string robot_id;
+    uint8_t schedule_id;
+    int weekday;
+  };
+
+  void RemoveLocked(const std::string& robot_id);
+
+  mutable std::mutex mutex_;
+  std::unordered_map<int, std::vector<Entry>> buckets_;             // 周内分钟 -> 任务
+  std::unordered_map<std::string, std::vector<int>> robot_buckets_;  // 机器人 -> 所在桶
+  size_t entry_count_ = 0;
+};
+
+#endif  // SCHEDULE_INDEX_H_
@@ -0,0 +1,61 @@
+#ifndef SIM_CLOCK_H_
+#define SIM_CLOCK_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// 模拟时钟
+//
+// 机器人与 MqttManager 的所有模拟时间（调度器 tick、本地时间、清扫超时、
+// 工作时长、消息时间戳）都从这里读取，支持三种模式：
+//   realtime    真实时间（默认）
+//   accelerated 按 speed 倍速流逝（如 speed=100 时 1 分钟真实时间 = 100 分钟模拟时间）
+//   discrete    离散事件：没有待执行的定时器回调时，模拟时间直接跳到下一个定时器截止时刻
+//
+// 与平台之间的真实交互（MQTT 重连、HTTP 等待回复、清扫任务等待F0回复）仍使用真实时间。
+class SimClock {
+ public:
+  enum class Mode { kRealtime, kAccelerated, kDiscreteEvent };
+
+  static SimClock& Instance();
+
+  // 设置时钟模式（须在全局调度器和机器人启动之前调用）；speed 仅在加速模式下生效
+  void Configure(Mode mode, double speed);
+
+  Mode GetMode() const { return mode_; }
+  double GetSpeed() const { return speed_; }
+  bool IsDiscreteEvent() const { return mode_ == Mode::kDiscreteEvent; }
+
+  // 配置字符串 <-> 模式（"realtime" / "accelerated" / "discrete"）
+  static bool ParseMode(const std::string& name, Mode* mode);
+  static const char* ModeName(Mode mode);
+
+  // 当前模拟时间（单调时钟 / 墙上时钟）
+  std::chrono::steady_clock::time_point SteadyNow() const;
+  std::chrono::system_clock::time_point SystemNow() const;
+
+  // 模拟时刻对应的真实等待截止时间（离散事件模式下不等待，返回真实当前时刻）
+  std::chrono::steady_clock::time_point ToRealDeadline(
+      std::chrono::steady_clock::time_point sim_time) const;
+
+  // 真实时长对应的模拟时长（加速模式乘以 speed，其它模式按 1:1 换算）
+  std::chrono::steady_clock::duration ToSimDuration(std::chrono::steady_clock::duration real) const;
+
+  // 离散事件模式：把模拟时间推进到 sim_time（只前进不后退）
+  void AdvanceTo(std::chrono::steady_clock::time_point sim_time);
+
+ private:
+  SimClock();
+  SimClock(const SimClock&) = delete;
+  SimClock& operator=(const SimClock&) = delete;
+
+  Mode mode_ = Mode::kRealtime;
+  double speed_ = 1.0;
+  std::chrono::steady_clock::time_point real_base_;  // 配置时的真实单调时刻
+  std::chrono::system_clock::time_point wall_base_;  // 配置时的真实墙上时刻
+  std::atomic<int64_t> discrete_elapsed_ns_{0};     // 离散事件模式下已推进的模拟时长
+};
+
+#endif  // SIM_CLOCK_H_
@@ -0,0 +1,99 @@
+#ifndef SIM_RNG_H_
+#define SIM_RNG_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 模拟用计数器随机数发生器（Philox4x32-10）
+//
+// 随机数由 (全局种子, 机器人编号, tick, 字段) 直接计算得到，不保存任何
+// 每机器人状态：同一组输入永远得到同一组输出，因此相同种子可完整复现
+// 一次模拟运行；批量生成时各机器人之间没有数据依赖，循环可被向量化。
+class SimRng {
+ public:
+  using Block = std::array<uint32_t, 4>;
+
+  // 随机字段编号（同一 tick 内不同用途的随机数使用不同字段）
+  enum Field : uint32_t {
+    kMainCurrent = 1,
+    kSlaveCurrent,
+    kSolarVoltage,
+    kSolarCurrent,
+    kBoardTemp,
+    kBatteryVoltage,
+    kBatteryTemp,
+    kAlarmBase = 0x100,  // 告警模拟：kAlarmBase + 第i个告警
+    kStartJitter = 0x200,  // 清扫启动抖动
+    kUplinkId = 0x300,     // 上行消息 deduplicationId（tick 为 fCnt）
+    kUplinkRadio,          // 上行消息 RSSI/SNR 抖动、网络服务器延迟（tick 为 fCnt）
+    kUplinkRadioBase,      // 每台机器人的基准 RSSI
+  };
+
+  // 全局种子（启动时从配置 sim_seed 设置）
+  static void SetGlobalSeed(uint64_t seed) { GlobalSeedRef().store(seed); }
+  static uint64_t GetGlobalSeed() { return GlobalSeedRef().load(); }
+
+  // 计算一个 Philox 块（4 个独立的 32 位随机数）
+  static inline Block Generate(uint64_t seed, uint32_t serial, uint64_t tick, uint32_t field) {
+    uint32_t c0 = static_cast<uint32_t>(tick);
+    uint32_t c1 = static_cast<uint32_t>(tick >> 32);
+    uint32_t c2 = serial;
+    uint32_t c3 = field;
+    uint32_t k0 = static_cast<uint32_t>(seed);
+    uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+    for (int round = 0; round < 10; ++round) {
+      const uint64_t p0 = static_cast<uint64_t>(kMul0) * c0;
+      const uint64_t p1 = static_cast<uint64_t>(kMul1) * c2;
+      const uint32_t hi0 = static_cast<uint32_t>(p0 >> 32);
+      const uint32_t lo0 = static_cast<uint32_t>(p0);
+      const uint32_t hi1 = static_cast<uint32_t>(p1 >> 32);
+      const uint32_t lo1 = static_cast<uint32_t>(p1);
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = lo0;
+      k0 += kWeyl0;
+      k1 += kWeyl1;
+    }
+    return Block{c0, c1, c2, c3};
+  }
+
+  // 32 位随机数映射到 [0,1)（取高 24 位，保证 float 精确表示）
+  static inline float ToUniform(uint32_t x) {
+    return static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+  }
+
+  // 32 位随机数映射到 [0, range)
+  static inline uint32_t ToRange(uint32_t x, uint32_t range) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(x) * range) >> 32);
+  }
+
+  // 单个 [0,1) 随机数（使用块的第 0 个输出）
+  static inline float Uniform(uint64_t seed, uint32_t serial, uint64_t tick, uint32_t field) {
+    return ToUniform(Generate(seed, serial, tick, field)[0]);
+  }
+
+  // 批量生成：out[i] = Uniform(seed, serials[i], tick, field)
+  // 各元素相互独立，无分支，编译器可向量化
+  static void UniformBatch(uint64_t seed, const uint32_t* serials, size_t n,
+                           uint64_t tick, uint32_t field, float* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = ToUniform(Generate(seed, serials[i], tick, field)[0]);
+    }
+  }
+
+ private:
+  static constexpr uint32_t kMul0 = 0xD2511F53;
+  static constexpr uint32_t kMul1 = 0xCD9E8D57;
+  static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+  static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+  static std::atomic<uint64_t>& GlobalSeedRef() {
+    static std::atomic<uint64_t> seed{0};
+    return seed;
+  }
+};
+
+#endif  // SIM_RNG_H_
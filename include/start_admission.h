@@ -0,0 +1,87 @@
+#ifndef START_ADMISSION_H_
+#define START_ADMISSION_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// 清扫启动准入控制
+//
+// 大量机器人配置相同定时时间时，同一分钟内会同时发出F0请求。准入控制在
+// 发送F0前排队（FIFO），限制同时在途的F0请求数量和每秒启动数量（令牌桶），
+// 并按机器人编号生成确定性的启动抖动，使启动时刻在 [0, jitter_max_ms] 内错开。
+// 所有限制为 0 时不做任何限制（与未启用准入控制时行为一致）。
+class StartAdmission {
+ public:
+  struct Config {
+    int max_inflight = 0;          // 同时在途的F0请求上限（0=不限）
+    int rate_per_second = 0;       // 每秒允许的启动数（0=不限）
+    int jitter_max_ms = 0;         // 启动抖动上限（毫秒，0=不抖动）
+  };
+
+  // 排队延迟直方图分桶上限（毫秒），最后一个桶为"超过最大上限"
+  static constexpr std::array<int64_t, 5> kDelayBucketsMs = {100, 1000, 5000, 30000, 120000};
+
+  struct Metrics {
+    uint64_t admitted = 0;         // 累计获准启动数
+    uint64_t delayed = 0;          // 其中需要排队等待的次数
+    uint64_t cancelled = 0;        // 排队中被取消（机器人停止）的次数
+    size_t waiting = 0;            // 当前排队数
+    size_t inflight = 0;           // 当前在途F0数
+    double avg_delay_ms = 0.0;     // 平均排队延迟
+    int64_t max_delay_ms = 0;      // 最大排队延迟
+    int64_t last_delay_ms = 0;     // 最近一次排队延迟
+    std::array<uint64_t, kDelayBucketsMs.size() + 1> delay_histogram{};
+  };
+
+  void SetConfig(const Config& config);
+  Config GetConfig() const;
+
+  // 申请启动许可。获准返回 true；否则返回 false 并在 retry_after 中给出建议的
+  // 重试延迟，轮到该机器人时也会调用 wake 提前唤醒。同一机器人重复调用不会重复排队。
+  // 只有受令牌桶限制的队首会得到精确的重试延迟；其余等待者依赖 wake，retry_after 仅为兜底。
+  // wake 在释放内部锁后调用，可能晚于该机器人的 Cancel，不能捕获可能已销毁的对象。
+  bool TryAcquire(const std::string& robot_id, std::function<void()> wake,
+                  std::chrono::milliseconds* retry_after);
+
+  // F0请求结束（收到回复或超时），归还在途名额
+  void Release(const std::string& robot_id);
+
+  // 机器人停止：退出排队并归还在途名额
+  void Cancel(const std::string& robot_id);
+
+  // 由机器人编号和定时任务编号得到确定性的启动抖动
+  std::chrono::milliseconds JitterFor(uint32_t serial, uint8_t schedule_id) const;
+
+  Metrics GetMetrics() const;
+
+ private:
+  struct Waiter {
+    std::string robot_id;
+    std::chrono::steady_clock::time_point enqueue_time;
+    std::function<void()> wake;
+  };
+
+  // 以下函数要求持有 mutex_
+  void RefillLocked(std::chrono::steady_clock::time_point now);
+  std::function<void()> HeadWakeLocked() const;
+
+  mutable std::mutex mutex_;
+  Config config_;
+  std::list<Waiter> waiting_;
+  // robot_id → waiting_ 中的位置（list 迭代器在其他元素增删时保持有效）
+  std::unordered_map<std::string, std::list<Waiter>::iterator> waiter_index_;
+  std::unordered_set<std::string> inflight_;
+  double tokens_ = 0.0;
+  std::chrono::steady_clock::time_point last_refill_;
+  Metrics metrics_;
+  double total_delay_ms_ = 0.0;
+};
+
+#endif  // START_ADMISSION_H_
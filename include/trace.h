@@ -0,0 +1,78 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <glog/logging.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 分模块追踪日志
+//
+// 每个模块有独立的追踪级别，可在运行时调整（HTTP 接口 /api/v1/system/trace_levels）：
+//   0 关闭；1 摘要（收发事件、API 访问）；2 详细（额外输出帧的十六进制/Base64 内容、完整载荷）
+//
+//   TRACE(kRobot, 1) << "...";       级别未开启时不求值 << 之后的参数（同 LOG_IF）
+//   TRACE_HOT(kProtocol, 2) << ...;  每帧执行的热点路径；定义 ROBOT_STRIP_HOT_TRACES 时编译期去除
+//
+// 帧内容用 HexDump 包装后写入日志流，只在实际输出时逐字节格式化，不产生临时字符串。
+enum class TraceModule : int {
+  kProtocol = 0,  // 协议帧编解码
+  kRobot,         // 机器人收发与上报
+  kMqtt,          // MQTT 收发队列
+  kHttp,          // HTTP 接口访问
+  kCount,
+};
+
+class Trace {
+ public:
+  static constexpr int kOff = 0;
+  static constexpr int kSummary = 1;
+  static constexpr int kDetail = 2;
+  static constexpr int kDefaultLevel = kSummary;
+
+  static bool Enabled(TraceModule module, int level) {
+    return levels_[static_cast<int>(module)].load(std::memory_order_relaxed) >= level;
+  }
+
+  static int GetLevel(TraceModule module);
+  static void SetLevel(TraceModule module, int level);
+
+  static const char* ModuleName(TraceModule module);
+  static bool ParseModule(const std::string& name, TraceModule* module);
+
+  // 按 "protocol=2,mqtt=0" 形式设置级别，未列出的模块保持不变
+  // 格式错误时返回 false，且不修改任何级别
+  static bool Configure(const std::string& spec);
+  // 当前各模块级别，格式同 Configure
+  static std::string ToString();
+
+ private:
+  static std::atomic<int> levels_[static_cast<int>(TraceModule::kCount)];
+};
+
+// 字节序列的十六进制输出（"68 82 00 0B"，与 Protocol::BytesToHexString 相同），写入流时才格式化
+class HexDump {
+ public:
+  HexDump(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+  explicit HexDump(const std::vector<uint8_t>& bytes) : HexDump(bytes.data(), bytes.size()) {}
+
+  friend std::ostream& operator<<(std::ostream& os, const HexDump& dump);
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+};
+
+#define TRACE(module, level) LOG_IF(INFO, ::Trace::Enabled(::TraceModule::module, level))
+
+#ifdef ROBOT_STRIP_HOT_TRACES
+#define TRACE_HOT(module, level) LOG_IF(INFO, false)
+#else
+#define TRACE_HOT(module, level) TRACE(module, level)
+#endif
+
+#endif  // TRACE_H_
@@ -0,0 +1,109 @@
+#ifndef UPLINK_TEMPLATE_H_
+#define UPLINK_TEMPLATE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class UplinkEnvelope;
+
+// 单条上行消息的动态字段
+struct UplinkFields {
+  const char* data = nullptr;                  // 帧数据（JSON 模板为 Base64 文本，protobuf 为原始帧字节）
+  size_t data_size = 0;
+  std::chrono::system_clock::time_point time;  // 网关接收时刻（time / gwTime / timeSinceGpsEpoch）
+  int64_t ns_delay_us = 0;                     // 网络服务器接收延迟（nsTime = time + ns_delay_us）
+  uint32_t fcnt = 0;                           // 上行帧计数
+  uint32_t id[4] = {};                         // deduplicationId 的 128 位随机数
+  int rssi = 0;                                // 信号强度 (dBm)
+  int snr_tenths = 0;                          // 信噪比 (0.1dB)
+
+  // deduplicationId 文本（UUID 版本 4，小写 8-4-4-4-12），写入 kIdSize 个字符
+  static constexpr size_t kIdSize = 36;
+  void FormatId(char* out) const;
+
+  int64_t TimeNs() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+  }
+  // 自 GPS 纪元（1980-01-06，计入闰秒）以来的纳秒数
+  int64_t GpsTimeNs() const;
+};
+
+// 上行数据模板
+//
+// 模板文本（doc/uplink_template.json）加载时一次性解析为文本段与占位符槽位：
+//   {{DEV_EUI}}           设备 EUI（机器人ID）
+//   {{DEV_ADDR}}          设备地址（机器人ID的后8个字符）
+//   {{DATA}}              Base64 编码的帧数据（只识别第一个，之后的按普通文本保留）
+//   {{DEDUPLICATION_ID}}  UUID（版本 4）
+//   {{TIME}}              ISO-8601 时间，毫秒精度（2026-02-03T04:25:19.371+00:00）
+//   {{GW_TIME}}           同上，微秒精度
+//   {{NS_TIME}}           网络服务器接收时间，纳秒精度
+//   {{GPS_TIME}}          GPS 纪元以来的秒数（1454127937.371s）
+//   {{FCNT}} {{RSSI}} {{SNR}}  帧计数、信号强度、信噪比（JSON 数字）
+// 设备相关的槽位由 Bind 为每台机器人预先填好，得到只剩逐条消息字段的 UplinkEnvelope。
+class UplinkTemplate {
+ public:
+  // 解析模板文本；source 为空时返回 false（模板保持为空）
+  bool Parse(const std::string& source);
+
+  bool empty() const { return segments_.empty(); }
+
+  // 用设备标识填充模板，预渲染逐条消息字段之外的全部文本
+  UplinkEnvelope Bind(const std::string& dev_eui, const std::string& dev_addr) const;
+
+ private:
+  friend class UplinkEnvelope;
+
+  enum class SegmentType : uint8_t {
+    kLiteral,
+    kDevEui,
+    kDevAddr,
+    // 以下为逐条消息字段
+    kData,
+    kDeduplicationId,
+    kTime,
+    kGwTime,
+    kNsTime,
+    kGpsTime,
+    kFCnt,
+    kRssi,
+    kSnr,
+    kCount,
+  };
+
+  struct Segment {
+    SegmentType type;
+    std::string text;  // 仅 kLiteral 使用
+  };
+
+  std::vector<Segment> segments_;
+};
+
+// 单台设备预渲染的上行数据：逐条消息字段之外的文本连续存放在 text_ 中，
+// 生成上行消息时先格式化各字段（数字用 std::to_chars，时间按秒缓存），
+// 再按最终长度一次分配（或复用已有缓冲区）依次拷贝
+class UplinkEnvelope {
+ public:
+  bool empty() const { return text_.empty(); }
+
+  std::string Render(const UplinkFields& fields) const;
+  // 同上，结果写入 out（复用 out 已有容量，稳态下不分配内存）
+  void Render(const UplinkFields& fields, std::string* out) const;
+
+ private:
+  friend class UplinkTemplate;
+
+  struct Slot {
+    uint32_t offset;                   // 在 text_ 中的插入位置
+    UplinkTemplate::SegmentType type;
+  };
+
+  std::string text_;
+  std::vector<Slot> slots_;
+  uint32_t slot_mask_ = 0;             // 用到的字段类型（按位）
+};
+
+#endif  // UPLINK_TEMPLATE_H_
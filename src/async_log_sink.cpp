@@ -0,0 +1,303 @@
+#include "async_log_sink.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+constexpr const char* kSeverityNames[] = {"INFO", "WARNING", "ERROR", "FATAL"};
+constexpr char kSeverityChars[] = "IWEF";
+
+// 单批最多写出的条数，写完一批统一刷新文件
+constexpr size_t kMaxBatch = 512;
+// 后台线程空闲时的最长等待（生产者唤醒丢失时的兜底）
+constexpr auto kIdleWait = std::chrono::milliseconds(50);
+// 缓冲区满时生产者的重试间隔
+constexpr auto kFullRetryInterval = std::chrono::microseconds(100);
+
+// 安装后在进程生命周期内一直存在（其他线程可能在静态析构期间仍在写日志），不释放
+std::mutex g_install_mutex;
+std::atomic<AsyncLogSink*> g_installed{nullptr};
+
+long CurrentThreadId() {
+  thread_local const long tid = static_cast<long>(syscall(SYS_gettid));
+  return tid;
+}
+
+}  // namespace
+
+AsyncLogSink* AsyncLogSink::Install(const Options& options) {
+  std::lock_guard<std::mutex> lock(g_install_mutex);
+  if (AsyncLogSink* sink = g_installed.load()) return sink;
+
+  auto* sink = new AsyncLogSink(options);
+
+  // 文件与终端输出全部交给后台线程，glog 只负责格式化消息并调用 send
+  for (int severity = 0; severity < kNumSeverities; ++severity) {
+    google::SetLogDestination(static_cast<google::LogSeverity>(severity), "");
+  }
+  FLAGS_logtostderr = false;
+  FLAGS_alsologtostderr = false;
+  FLAGS_stderrthreshold = kNumSeverities;
+  google::AddLogSink(sink);
+
+  g_installed.store(sink);
+  return sink;
+}
+
+AsyncLogSink* AsyncLogSink::Installed() { return g_installed.load(); }
+
+const char* AsyncLogSink::PolicyName(OverflowPolicy policy) {
+  return policy == OverflowPolicy::kBlock ? "block" : "drop";
+}
+
+bool AsyncLogSink::ParsePolicy(const std::string& name, OverflowPolicy* policy) {
+  if (name == "drop") {
+    *policy = OverflowPolicy::kDrop;
+  } else if (name == "block") {
+    *policy = OverflowPolicy::kBlock;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+AsyncLogSink::AsyncLogSink(const Options& options)
+    : options_(options), overflow_(static_cast<int>(options.overflow)) {
+  size_t capacity = 2;
+  while (capacity < options.capacity) capacity <<= 1;
+  mask_ = capacity - 1;
+  slots_.reset(new Slot[capacity]);
+  for (size_t i = 0; i < capacity; ++i) {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  stderr_color_ = FLAGS_colorlogtostderr && isatty(STDERR_FILENO);
+  writer_ = std::thread(&AsyncLogSink::WriterLoop, this);
+}
+
+AsyncLogSink::~AsyncLogSink() {
+  google::RemoveLogSink(this);
+  stop_.store(true);
+  wake_cv_.notify_one();
+  if (writer_.joinable()) writer_.join();
+  for (FILE*& file : files_) {
+    if (file) fclose(file);
+    file = nullptr;
+  }
+}
+
+void AsyncLogSink::SetOverflowPolicy(OverflowPolicy policy) {
+  overflow_.store(static_cast<int>(policy), std::memory_order_relaxed);
+}
+
+AsyncLogSink::Stats AsyncLogSink::GetStats() const {
+  Stats stats;
+  stats.written = written_.load(std::memory_order_relaxed);
+  stats.dropped = dropped_.load(std::memory_order_relaxed);
+  stats.blocked = blocked_.load(std::memory_order_relaxed);
+  stats.truncated = truncated_.load(std::memory_order_relaxed);
+  const uint64_t enqueued = enqueue_pos_.load(std::memory_order_relaxed);
+  const uint64_t flushed = flushed_pos_.load(std::memory_order_relaxed);
+  stats.queued = enqueued > flushed ? static_cast<size_t>(enqueued - flushed) : 0;
+  stats.capacity = mask_ + 1;
+  stats.overflow = static_cast<OverflowPolicy>(overflow_.load(std::memory_order_relaxed));
+  return stats;
+}
+
+void AsyncLogSink::Flush() {
+  const uint64_t target = enqueue_pos_.load(std::memory_order_acquire);
+  while (flushed_pos_.load(std::memory_order_acquire) < target && !stop_.load()) {
+    wake_cv_.notify_one();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+void AsyncLogSink::send(google::LogSeverity severity, const char* /*full_filename*/,
+                        const char* base_filename, int line, const struct ::tm* /*tm_time*/,
+                        const char* message, size_t message_len) {
+  uint64_t position = 0;
+  bool waited = false;
+  while (!TryPush(severity, base_filename, line, message, message_len, &position)) {
+    const bool may_drop = severity < google::GLOG_ERROR &&
+        overflow_.load(std::memory_order_relaxed) == static_cast<int>(OverflowPolicy::kDrop);
+    if (may_drop || stop_.load()) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (!waited) {
+      blocked_.fetch_add(1, std::memory_order_relaxed);
+      waited = true;
+    }
+    wake_cv_.notify_one();
+    std::this_thread::sleep_for(kFullRetryInterval);
+  }
+
+  if (writer_idle_.load()) wake_cv_.notify_one();
+
+  // FATAL 之后 glog 会终止进程，等待写盘
+  if (severity >= google::GLOG_FATAL) {
+    while (flushed_pos_.load(std::memory_order_acquire) <= position && !stop_.load()) {
+      wake_cv_.notify_one();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+}
+
+bool AsyncLogSink::TryPush(int severity, const char* file, int line, const char* message,
+                           size_t size, uint64_t* position) {
+  uint64_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  Slot* slot = nullptr;
+  while (true) {
+    slot = &slots_[pos & mask_];
+    const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      return false;  // 缓冲区满
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  Record& record = slot->record;
+  record.severity = severity;
+  record.line = line;
+  record.time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  record.thread_id = CurrentThreadId();
+  record.file = file;
+  if (size > kMaxMessageSize) {
+    size = kMaxMessageSize;
+    truncated_.fetch_add(1, std::memory_order_relaxed);
+  }
+  record.size = static_cast<uint16_t>(size);
+  std::memcpy(record.message, message, size);
+
+  slot->sequence.store(pos + 1, std::memory_order_release);
+  *position = pos;
+  return true;
+}
+
+void AsyncLogSink::WriterLoop() {
+  while (true) {
+    size_t batch = 0;
+    while (batch < kMaxBatch) {
+      Slot& slot = slots_[dequeue_pos_ & mask_];
+      if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) break;
+      WriteRecord(slot.record);
+      slot.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+      ++dequeue_pos_;
+      ++batch;
+    }
+
+    if (batch > 0) {
+      for (FILE* file : files_) {
+        if (file) fflush(file);
+      }
+      if (options_.also_stderr) fflush(stderr);
+      written_.fetch_add(batch, std::memory_order_relaxed);
+      flushed_pos_.store(dequeue_pos_, std::memory_order_release);
+      continue;
+    }
+
+    if (stop_.load()) break;
+
+    // 置空闲标志后再检查一次，避免与生产者入队交错导致多等一个周期
+    writer_idle_.store(true);
+    if (slots_[dequeue_pos_ & mask_].sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      wake_cv_.wait_for(lock, kIdleWait);
+    }
+    writer_idle_.store(false, std::memory_order_relaxed);
+  }
+}
+
+void AsyncLogSink::WriteRecord(const Record& record) {
+  // glog 格式：I20260101 12:00:00.000000  1234 file.cpp:42] message
+  const time_t seconds = static_cast<time_t>(record.time_us / 1000000);
+  struct ::tm tm;
+  localtime_r(&seconds, &tm);
+  char prefix[128];
+  const int prefix_size = snprintf(
+      prefix, sizeof(prefix), "%c%04d%02d%02d %02d:%02d:%02d.%06d %5ld %s:%d] ",
+      kSeverityChars[record.severity], tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+      tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(record.time_us % 1000000),
+      record.thread_id, record.file ? record.file : "", record.line);
+
+  line_buffer_.assign(prefix, std::min<size_t>(prefix_size, sizeof(prefix) - 1));
+  line_buffer_.append(record.message, record.size);
+  line_buffer_.push_back('\n');
+
+  // 与 glog 相同：每个级别的文件包含该级别及以上的日志
+  const size_t max_bytes = static_cast<size_t>(FLAGS_max_log_size) << 20;
+  for (int severity = 0; severity <= record.severity && severity < kNumSeverities; ++severity) {
+    if (files_[severity] == nullptr && !OpenLogFile(severity)) continue;
+    fwrite(line_buffer_.data(), 1, line_buffer_.size(), files_[severity]);
+    file_bytes_[severity] += line_buffer_.size();
+    if (max_bytes > 0 && file_bytes_[severity] >= max_bytes) {
+      fclose(files_[severity]);  // 下一条日志写入新文件
+      files_[severity] = nullptr;
+    }
+  }
+
+  if (options_.also_stderr) {
+    const char* color = nullptr;
+    if (stderr_color_ && record.severity >= google::GLOG_ERROR) {
+      color = "\033[0;31m";
+    } else if (stderr_color_ && record.severity == google::GLOG_WARNING) {
+      color = "\033[0;33m";
+    }
+    if (color) fputs(color, stderr);
+    fwrite(line_buffer_.data(), 1, line_buffer_.size() - 1, stderr);
+    if (color) fputs("\033[m", stderr);
+    fputc('\n', stderr);
+  }
+}
+
+bool AsyncLogSink::OpenLogFile(int severity) {
+  const std::string dir = FLAGS_log_dir.empty() ? "/tmp" : FLAGS_log_dir;
+
+  char hostname[256] = "(unknown)";
+  gethostname(hostname, sizeof(hostname) - 1);
+  const char* user = getenv("USER");
+
+  const time_t now = time(nullptr);
+  struct ::tm tm;
+  localtime_r(&now, &tm);
+  char time_pid[64];
+  snprintf(time_pid, sizeof(time_pid), "%04d%02d%02d-%02d%02d%02d.%d", tm.tm_year + 1900,
+           tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+           static_cast<int>(getpid()));
+
+  const std::string filename = options_.program_name + "." + hostname + "." +
+                               (user ? user : "invalid-user") + ".log." +
+                               kSeverityNames[severity] + "." + time_pid;
+  FILE* file = fopen((dir + "/" + filename).c_str(), "a");
+  if (file == nullptr) return false;
+  setvbuf(file, nullptr, _IOFBF, 64 * 1024);
+
+  char created[32];
+  strftime(created, sizeof(created), "%Y/%m/%d %H:%M:%S", &tm);
+  file_bytes_[severity] = static_cast<size_t>(fprintf(
+      file,
+      "Log file created at: %s\n"
+      "Running on machine: %s\n"
+      "Log line format: [IWEF]yyyymmdd hh:mm:ss.uuuuuu threadid file:line] msg\n",
+      created, hostname));
+  files_[severity] = file;
+
+  // 与 glog 相同的最新日志软链接：<程序>.<级别>
+  const std::string link = dir + "/" + options_.program_name + "." + kSeverityNames[severity];
+  unlink(link.c_str());
+  const int link_result = symlink(filename.c_str(), link.c_str());
+  (void)link_result;  // 软链接仅为方便查看，失败不影响写日志
+  return true;
+}
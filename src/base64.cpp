@@ -0,0 +1,355 @@
+#include "base64.h"
+
+#include <atomic>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BASE64_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const char kEncodeChars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// 字符 -> 6位值，非Base64字符为 0xFF
+struct DecodeTable {
+  uint8_t value[256];
+  DecodeTable() {
+    for (auto& v : value) v = 0xFF;
+    for (uint8_t i = 0; i < 64; ++i) value[static_cast<uint8_t>(kEncodeChars[i])] = i;
+  }
+};
+
+const DecodeTable& GetDecodeTable() {
+  static const DecodeTable table;
+  return table;
+}
+
+enum class Impl : int { kScalar = 0, kSsse3 = 1, kAvx2 = 2 };
+
+bool CpuSupports(Impl impl) {
+#ifdef BASE64_HAVE_X86_SIMD
+  __builtin_cpu_init();
+  switch (impl) {
+    case Impl::kAvx2:  return __builtin_cpu_supports("avx2");
+    case Impl::kSsse3: return __builtin_cpu_supports("ssse3");
+    case Impl::kScalar: return true;
+  }
+  return false;
+#else
+  return impl == Impl::kScalar;
+#endif
+}
+
+Impl DetectImpl() {
+  if (CpuSupports(Impl::kAvx2)) return Impl::kAvx2;
+  if (CpuSupports(Impl::kSsse3)) return Impl::kSsse3;
+  return Impl::kScalar;
+}
+
+std::atomic<int>& ActiveImpl() {
+  static std::atomic<int> impl{static_cast<int>(DetectImpl())};
+  return impl;
+}
+
+// 从 (i, written) 处继续标量解码，调用时 SIMD 路径只消费了完整的合法块，分组状态为空
+bool DecodeScalarFrom(const char* base64, size_t size, size_t i, uint8_t* out,
+                      size_t capacity, size_t written, size_t* out_size) {
+  const DecodeTable& table = GetDecodeTable();
+  uint32_t group = 0;
+  int count = 0;
+  for (; i < size; ++i) {
+    const char c = base64[i];
+    if (c == '=') break;
+    const uint8_t v = table.value[static_cast<uint8_t>(c)];
+    if (v == 0xFF) continue;
+
+    group = (group << 6) | v;
+    if (++count == 4) {
+      if (written + 3 > capacity) return false;
+      out[written++] = static_cast<uint8_t>(group >> 16);
+      out[written++] = static_cast<uint8_t>(group >> 8);
+      out[written++] = static_cast<uint8_t>(group);
+      group = 0;
+      count = 0;
+    }
+  }
+
+  // 剩余2~3个字符分别输出1~2字节
+  if (count > 1) {
+    group <<= 6 * (4 - count);
+    if (written + count - 1 > capacity) return false;
+    out[written++] = static_cast<uint8_t>(group >> 16);
+    if (count == 3) out[written++] = static_cast<uint8_t>(group >> 8);
+  }
+
+  *out_size = written;
+  return true;
+}
+
+#ifdef BASE64_HAVE_X86_SIMD
+
+// ── SSSE3：每块 12 字节 <-> 16 字符 ─────────────────────────────────────────
+
+// 3字节组拆成 4 个 6 位索引（输入已按 [b1 b0 b2 b1] 重排）
+__attribute__((target("ssse3"))) inline __m128i EncodeIndices128(__m128i in) {
+  const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(t1, t3);
+}
+
+// 6 位索引 -> ASCII：按区间（A-Z / a-z / 0-9 / + / /）查偏移表后相加
+__attribute__((target("ssse3"))) inline __m128i EncodeTranslate128(__m128i indices) {
+  const __m128i shift_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+  result = _mm_shuffle_epi8(shift_lut, result);
+  return _mm_add_epi8(result, indices);
+}
+
+__attribute__((target("ssse3")))
+void EncodeBlocksSsse3(const uint8_t* data, size_t size, size_t* pos, char* out, size_t* written) {
+  const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+  size_t i = *pos;
+  size_t w = *written;
+  // 每次读取16字节、使用其中12字节，保证不越界读
+  for (; i + 16 <= size; i += 12, w += 16) {
+    const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    const __m128i indices = EncodeIndices128(_mm_shuffle_epi8(in, shuffle));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + w), EncodeTranslate128(indices));
+  }
+  *pos = i;
+  *written = w;
+}
+
+// 16 个字符全部合法时解码为 12 字节（写入 16 字节，后 4 字节无效）
+__attribute__((target("ssse3"))) inline bool DecodeBlock128(__m128i str, __m128i* packed) {
+  const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                       0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                       0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                         0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i mask_2f = _mm_set1_epi8(0x2f);
+
+  // 校验：高/低半字节查表结果有交集即为非法字符（含'='与非ASCII）
+  const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2f);
+  const __m128i lo_nibbles = _mm_and_si128(str, mask_2f);
+  const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+  const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+  const __m128i valid = _mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128());
+  if (_mm_movemask_epi8(valid) != 0xFFFF) return false;
+
+  // 转换：按高半字节查偏移（'/' 单独处理）得到 6 位值
+  const __m128i eq_2f = _mm_cmpeq_epi8(str, mask_2f);
+  const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+  const __m128i values = _mm_add_epi8(str, roll);
+
+  // 合并：4 个 6 位值 -> 24 位，再按大端重排为连续字节
+  const __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  const __m128i words = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+  *packed = _mm_shuffle_epi8(words, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                                  -1, -1, -1, -1));
+  return true;
+}
+
+__attribute__((target("ssse3")))
+void DecodeBlocksSsse3(const char* base64, size_t size, size_t* pos, uint8_t* out,
+                       size_t capacity, size_t* written) {
+  size_t i = *pos;
+  size_t w = *written;
+  for (; i + 16 <= size && w + 16 <= capacity; i += 16, w += 12) {
+    const __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base64 + i));
+    __m128i packed;
+    if (!DecodeBlock128(str, &packed)) break;  // 含非法字符或'='，交给标量逻辑
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + w), packed);
+  }
+  *pos = i;
+  *written = w;
+}
+
+// ── AVX2：每块 24 字节 <-> 32 字符（两个 128 位通道各处理 12 字节）────────────
+
+__attribute__((target("avx2")))
+void EncodeBlocksAvx2(const uint8_t* data, size_t size, size_t* pos, char* out, size_t* written) {
+  const __m256i shuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                          10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+  const __m256i shift_lut = _mm256_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  size_t i = *pos;
+  size_t w = *written;
+  // 高通道读取 [i+12, i+28)，保证不越界读
+  for (; i + 28 <= size; i += 24, w += 32) {
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 12));
+    __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    in = _mm256_shuffle_epi8(in, shuffle);
+
+    const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i indices = _mm256_or_si256(t1, t3);
+
+    __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    result = _mm256_shuffle_epi8(shift_lut, result);
+    result = _mm256_add_epi8(result, indices);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w), result);
+  }
+  *pos = i;
+  *written = w;
+}
+
+__attribute__((target("avx2")))
+void DecodeBlocksAvx2(const char* base64, size_t size, size_t* pos, uint8_t* out,
+                      size_t capacity, size_t* written) {
+  const __m256i lut_lo = _mm256_setr_epi8(
+      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m256i lut_hi = _mm256_setr_epi8(
+      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i lut_roll = _mm256_setr_epi8(
+      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i pack_shuffle = _mm256_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+
+  size_t i = *pos;
+  size_t w = *written;
+  for (; i + 32 <= size && w + 32 <= capacity; i += 32, w += 24) {
+    const __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base64 + i));
+    const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+    const __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+    const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+    const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+    if (!_mm256_testz_si256(lo, hi)) break;  // 含非法字符或'='，交给后续路径
+
+    const __m256i eq_2f = _mm256_cmpeq_epi8(str, mask_2f);
+    const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+    const __m256i values = _mm256_add_epi8(str, roll);
+    const __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    const __m256i words = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+    const __m256i packed = _mm256_shuffle_epi8(words, pack_shuffle);
+    // 两个通道各 12 字节，拼接为连续 24 字节
+    const __m256i joined =
+        _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w), joined);
+  }
+  *pos = i;
+  *written = w;
+}
+
+#endif  // BASE64_HAVE_X86_SIMD
+
+}  // namespace
+
+size_t Base64::EncodeScalar(const uint8_t* data, size_t size, char* out) {
+  char* p = out;
+  size_t i = 0;
+  for (; i + 3 <= size; i += 3) {
+    const uint32_t v = (static_cast<uint32_t>(data[i]) << 16) |
+                       (static_cast<uint32_t>(data[i + 1]) << 8) | data[i + 2];
+    *p++ = kEncodeChars[(v >> 18) & 0x3f];
+    *p++ = kEncodeChars[(v >> 12) & 0x3f];
+    *p++ = kEncodeChars[(v >> 6) & 0x3f];
+    *p++ = kEncodeChars[v & 0x3f];
+  }
+
+  // 剩余1~2字节，补'='
+  const size_t rest = size - i;
+  if (rest > 0) {
+    uint32_t v = static_cast<uint32_t>(data[i]) << 16;
+    if (rest == 2) v |= static_cast<uint32_t>(data[i + 1]) << 8;
+    *p++ = kEncodeChars[(v >> 18) & 0x3f];
+    *p++ = kEncodeChars[(v >> 12) & 0x3f];
+    *p++ = rest == 2 ? kEncodeChars[(v >> 6) & 0x3f] : '=';
+    *p++ = '=';
+  }
+  return static_cast<size_t>(p - out);
+}
+
+bool Base64::DecodeScalar(const char* base64, size_t size, uint8_t* out, size_t capacity,
+                          size_t* out_size) {
+  return DecodeScalarFrom(base64, size, 0, out, capacity, 0, out_size);
+}
+
+size_t Base64::Encode(const uint8_t* data, size_t size, char* out) {
+  size_t i = 0;
+  size_t written = 0;
+#ifdef BASE64_HAVE_X86_SIMD
+  switch (static_cast<Impl>(ActiveImpl().load(std::memory_order_relaxed))) {
+    case Impl::kAvx2:
+      EncodeBlocksAvx2(data, size, &i, out, &written);
+      EncodeBlocksSsse3(data, size, &i, out, &written);
+      break;
+    case Impl::kSsse3:
+      EncodeBlocksSsse3(data, size, &i, out, &written);
+      break;
+    case Impl::kScalar:
+      break;
+  }
+#endif
+  return written + EncodeScalar(data + i, size - i, out + written);
+}
+
+bool Base64::Decode(const char* base64, size_t size, uint8_t* out, size_t capacity,
+                    size_t* out_size) {
+  size_t i = 0;
+  size_t written = 0;
+#ifdef BASE64_HAVE_X86_SIMD
+  switch (static_cast<Impl>(ActiveImpl().load(std::memory_order_relaxed))) {
+    case Impl::kAvx2:
+      DecodeBlocksAvx2(base64, size, &i, out, capacity, &written);
+      DecodeBlocksSsse3(base64, size, &i, out, capacity, &written);
+      break;
+    case Impl::kSsse3:
+      DecodeBlocksSsse3(base64, size, &i, out, capacity, &written);
+      break;
+    case Impl::kScalar:
+      break;
+  }
+#endif
+  return DecodeScalarFrom(base64, size, i, out, capacity, written, out_size);
+}
+
+const char* Base64::ImplName() {
+  switch (static_cast<Impl>(ActiveImpl().load(std::memory_order_relaxed))) {
+    case Impl::kAvx2:  return "avx2";
+    case Impl::kSsse3: return "ssse3";
+    case Impl::kScalar: break;
+  }
+  return "scalar";
+}
+
+bool Base64::SetImpl(const char* name) {
+  Impl impl;
+  if (std::strcmp(name, "avx2") == 0) {
+    impl = Impl::kAvx2;
+  } else if (std::strcmp(name, "ssse3") == 0) {
+    impl = Impl::kSsse3;
+  } else if (std::strcmp(name, "scalar") == 0) {
+    impl = Impl::kScalar;
+  } else if (std::strcmp(name, "auto") == 0) {
+    impl = DetectImpl();
+  } else {
+    return false;
+  }
+  if (!CpuSupports(impl)) return false;
+  ActiveImpl().store(static_cast<int>(impl), std::memory_order_relaxed);
+  return true;
+}
@@ -157,7 +157,19 @@ void ConfigDb::InsertDefaultConfig() {
       ('subscribe_topic', 'application/902d7d6e-d3ac-44c0-a128-6d6743ba2b59/device/{robot_id}/command/down'),
       ('robot_data_report_interval', '600'),
       ('motor_params_report_interval', '3600'),
-      ('lora_clean_report_interval', '3600')
+      ('lora_clean_report_interval', '3600'),
+      ('sim_seed', '0'),
+      ('sim_lazy_mode', '0'),
+      ('sim_clock_mode', 'realtime'),
+      ('sim_clock_speed', '1'),
+      ('clean_start_max_inflight', '0'),
+      ('clean_start_rate', '0'),
+      ('clean_start_jitter_ms', '0'),
+      ('envelope_format', 'json'),
+      ('publish_max_inflight', '64'),
+      ('mqtt_connections', '1'),
+      ('trace_levels', ''),
+      ('log_overflow', 'drop')
     )";
 
     char* err_msg = nullptr;
@@ -168,17 +180,29 @@ void ConfigDb::InsertDefaultConfig() {
       LOG(INFO) << "默认MQTT配置插入成功";
     }
   } else {
-    // 已有配置时，通过 INSERT OR IGNORE 补充新增的上报间隔配置项（兼容旧数据库）
+    // 已有配置时，通过 INSERT OR IGNORE 补充新增的配置项（兼容旧数据库）
     LOG(INFO) << "mqtt_config表已有配置，检查并补充新增配置项...";
     const char* new_keys_sql = R"(
       INSERT OR IGNORE INTO mqtt_config (key, value) VALUES
       ('robot_data_report_interval', '600'),
       ('motor_params_report_interval', '3600'),
-      ('lora_clean_report_interval', '3600')
+      ('lora_clean_report_interval', '3600'),
+      ('sim_seed', '0'),
+      ('sim_lazy_mode', '0'),
+      ('sim_clock_mode', 'realtime'),
+      ('sim_clock_speed', '1'),
+      ('clean_start_max_inflight', '0'),
+      ('clean_start_rate', '0'),
+      ('clean_start_jitter_ms', '0'),
+      ('envelope_format', 'json'),
+      ('publish_max_inflight', '64'),
+      ('mqtt_connections', '1'),
+      ('trace_levels', ''),
+      ('log_overflow', 'drop')
     )";
     char* err_msg = nullptr;
     if (sqlite3_exec(db_, new_keys_sql, nullptr, nullptr, &err_msg) != SQLITE_OK) {
-      LOG(ERROR) << "补充新增上报间隔配置失败: " << err_msg;
+      LOG(ERROR) << "补充新增配置项失败: " << err_msg;
       sqlite3_free(err_msg);
     }
   }
@@ -0,0 +1,512 @@
+#include "envelope_codec.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#include "protocol.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+// ─── protobuf 编码 ──────────────────────────────────────────────────────────
+
+constexpr int kWireVarint = 0;
+constexpr int kWireFixed64 = 1;
+constexpr int kWireLengthDelimited = 2;
+constexpr int kWireFixed32 = 5;
+
+size_t EncodeVarint(char* p, uint64_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    p[n++] = static_cast<char>(value | 0x80);
+    value >>= 7;
+  }
+  p[n++] = static_cast<char>(value);
+  return n;
+}
+
+size_t VarintSize(uint64_t value) {
+  size_t n = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++n;
+  }
+  return n;
+}
+
+// 写入调用方预留好空间的缓冲区（不检查容量），与 std::string 一样作为 Put* 的输出
+struct BufferWriter {
+  char* p;
+
+  void append(const char* data, size_t size) {
+    std::memcpy(p, data, size);
+    p += size;
+  }
+  void append(const std::string& data) { append(data.data(), data.size()); }
+};
+
+template <typename Out>
+void PutVarint(Out* out, uint64_t value) {
+  char buffer[10];
+  out->append(buffer, EncodeVarint(buffer, value));
+}
+
+template <typename Out>
+void PutTag(Out* out, uint32_t field, int wire_type) {
+  PutVarint(out, (static_cast<uint64_t>(field) << 3) | wire_type);
+}
+
+// proto3 标量字段为默认值（0/false/空）时不编码
+template <typename Out>
+void PutUint(Out* out, uint32_t field, uint64_t value) {
+  if (value == 0) return;
+  PutTag(out, field, kWireVarint);
+  PutVarint(out, value);
+}
+
+template <typename Out>
+void PutInt(Out* out, uint32_t field, int64_t value) {
+  if (value == 0) return;
+  PutTag(out, field, kWireVarint);
+  PutVarint(out, static_cast<uint64_t>(value));  // 负数按 64 位补码编码（10 字节）
+}
+
+template <typename Out>
+void PutBytes(Out* out, uint32_t field, const void* data, size_t size) {
+  if (size == 0) return;
+  PutTag(out, field, kWireLengthDelimited);
+  PutVarint(out, size);
+  out->append(static_cast<const char*>(data), size);
+}
+
+template <typename Out>
+void PutBytes(Out* out, uint32_t field, const std::string& value) {
+  PutBytes(out, field, value.data(), value.size());
+}
+
+// PutBytes 写入的字节数（用于预先计算嵌套消息长度）
+size_t BytesFieldSize(uint32_t field, size_t size) {
+  if (size == 0) return 0;
+  return VarintSize(static_cast<uint64_t>(field) << 3) + VarintSize(size) + size;
+}
+
+template <typename Out>
+void PutFixed(Out* out, uint32_t field, int wire_type, uint64_t bits, int size) {
+  PutTag(out, field, wire_type);
+  char buffer[8];
+  for (int i = 0; i < size; ++i) buffer[i] = static_cast<char>(bits >> (8 * i));  // 小端序
+  out->append(buffer, size);
+}
+
+template <typename Out>
+void PutFloat(Out* out, uint32_t field, float value) {
+  if (value == 0.0f) return;
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  PutFixed(out, field, kWireFixed32, bits, 4);
+}
+
+template <typename Out>
+void PutDouble(Out* out, uint32_t field, double value) {
+  if (value == 0.0) return;
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  PutFixed(out, field, kWireFixed64, bits, 8);
+}
+
+// google.protobuf.Timestamp / Duration：seconds = 1, nanos = 2
+template <typename Out>
+void PutTime(Out* out, uint32_t field, int64_t ns) {
+  int64_t seconds = ns / 1000000000;
+  int64_t nanos = ns % 1000000000;
+  if (nanos < 0) {
+    nanos += 1000000000;
+    --seconds;
+  }
+  char body[24];
+  size_t n = 0;
+  if (seconds != 0) {
+    body[n++] = 0x08;
+    n += EncodeVarint(body + n, static_cast<uint64_t>(seconds));
+  }
+  if (nanos != 0) {
+    body[n++] = 0x10;
+    n += EncodeVarint(body + n, static_cast<uint64_t>(nanos));
+  }
+  PutBytes(out, field, body, n);
+}
+
+// ─── protobuf 解码 ──────────────────────────────────────────────────────────
+
+bool ReadVarint(const uint8_t** p, const uint8_t* end, uint64_t* value) {
+  uint64_t result = 0;
+  for (int shift = 0; shift < 64 && *p < end; shift += 7) {
+    const uint8_t byte = *(*p)++;
+    result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+// 查找长度分隔字段（string/bytes/嵌套消息）；编码不合法时返回 false，未找到时 *value 为 nullptr
+bool FindLengthDelimited(const uint8_t* data, size_t size, uint32_t field,
+                         const uint8_t** value, size_t* value_size) {
+  *value = nullptr;
+  *value_size = 0;
+  const uint8_t* p = data;
+  const uint8_t* const end = data + size;
+  while (p < end) {
+    uint64_t key;
+    if (!ReadVarint(&p, end, &key)) return false;
+    uint64_t length = 0;
+    switch (key & 0x07) {
+      case kWireVarint:
+        if (!ReadVarint(&p, end, &length)) return false;
+        length = 0;
+        break;
+      case kWireFixed64: length = 8; break;
+      case kWireFixed32: length = 4; break;
+      case kWireLengthDelimited:
+        if (!ReadVarint(&p, end, &length)) return false;
+        break;
+      default: return false;
+    }
+    if (length > static_cast<uint64_t>(end - p)) return false;
+    if ((key & 0x07) == kWireLengthDelimited && (key >> 3) == field) {
+      *value = p;  // 重复出现时以最后一个为准（与 protobuf 标量字段的合并规则一致）
+      *value_size = static_cast<size_t>(length);
+    }
+    p += length;
+  }
+  return true;
+}
+
+bool FindLengthDelimited(const std::string& message, uint32_t field, const uint8_t** value,
+                         size_t* value_size) {
+  return FindLengthDelimited(reinterpret_cast<const uint8_t*>(message.data()), message.size(),
+                             field, value, value_size);
+}
+
+// ─── 公共 ──────────────────────────────────────────────────────────────────
+
+// 帧字节拷贝到调用方缓冲区，超长时视为无法解码
+void CopyFrame(const void* data, size_t size, FrameBuffer* raw, size_t* raw_size) {
+  if (data == nullptr || size > raw->size()) {
+    *raw_size = 0;
+    return;
+  }
+  std::memcpy(raw->data(), data, size);
+  *raw_size = size;
+}
+
+void DecodeBase64Frame(const json& data, FrameBuffer* raw, size_t* raw_size) {
+  const std::string& text = data.get_ref<const std::string&>();
+  if (!Protocol::Base64ToBytes(text.data(), text.size(), raw->data(), raw->size(), raw_size)) {
+    *raw_size = 0;
+  }
+}
+
+const json& Member(const json& object, const char* key) {
+  static const json kNull;
+  if (!object.is_object()) return kNull;
+  auto it = object.find(key);
+  return it == object.end() ? kNull : *it;
+}
+
+std::string String(const json& value) {
+  return value.is_string() ? value.get<std::string>() : std::string();
+}
+
+bool Bool(const json& value) {
+  return value.is_boolean() && value.get<bool>();
+}
+
+double Number(const json& value) {
+  return value.is_number() ? value.get<double>() : 0.0;
+}
+
+uint64_t Unsigned(const json& value) {
+  if (value.is_number_unsigned()) return value.get<uint64_t>();
+  if (value.is_number_integer() && value.get<int64_t>() > 0) return value.get<uint64_t>();
+  return 0;
+}
+
+// 按名称取 protobuf 枚举值（名称在列表中的下标），未知名称为 0
+int EnumValue(const json& value, std::initializer_list<const char*> names) {
+  if (!value.is_string()) return 0;
+  const std::string& name = value.get_ref<const std::string&>();
+  int index = 0;
+  for (const char* candidate : names) {
+    if (name == candidate) return index;
+    ++index;
+  }
+  return 0;
+}
+
+}  // namespace
+
+namespace envelope_codec {
+
+const char* FormatName(EnvelopeFormat format) {
+  switch (format) {
+    case EnvelopeFormat::kRaw: return "raw";
+    case EnvelopeFormat::kProtobuf: return "protobuf";
+    case EnvelopeFormat::kJson: break;
+  }
+  return "json";
+}
+
+bool ParseFormat(const std::string& name, EnvelopeFormat* format) {
+  if (name == "json") {
+    *format = EnvelopeFormat::kJson;
+  } else if (name == "raw") {
+    *format = EnvelopeFormat::kRaw;
+  } else if (name == "protobuf") {
+    *format = EnvelopeFormat::kProtobuf;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool DecodeDownlink(EnvelopeFormat format, const std::string& payload, std::string* dev_eui,
+                    FrameBuffer* raw, size_t* raw_size) {
+  *raw_size = 0;
+  switch (format) {
+    case EnvelopeFormat::kRaw:
+      dev_eui->clear();
+      CopyFrame(payload.data(), payload.size(), raw, raw_size);
+      return !payload.empty();
+
+    case EnvelopeFormat::kProtobuf: {
+      // api.DeviceQueueItem: dev_eui = 2, data = 5
+      const uint8_t* eui;
+      size_t eui_size;
+      const uint8_t* data;
+      size_t data_size;
+      if (!FindLengthDelimited(payload, 2, &eui, &eui_size) ||
+          !FindLengthDelimited(payload, 5, &data, &data_size) || eui_size == 0) {
+        return false;
+      }
+      dev_eui->assign(reinterpret_cast<const char*>(eui), eui_size);
+      CopyFrame(data, data_size, raw, raw_size);
+      return true;
+    }
+
+    case EnvelopeFormat::kJson: {
+      const json j = json::parse(payload, nullptr, false);
+      const json& eui = Member(j, "devEui");
+      const json& data = Member(j, "data");
+      if (!eui.is_string() || !data.is_string()) return false;
+      *dev_eui = eui.get<std::string>();
+      DecodeBase64Frame(data, raw, raw_size);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool DecodeUplink(EnvelopeFormat format, const std::string& payload, std::string* dev_eui,
+                  FrameBuffer* raw, size_t* raw_size) {
+  *raw_size = 0;
+  dev_eui->clear();
+  switch (format) {
+    case EnvelopeFormat::kRaw:
+      CopyFrame(payload.data(), payload.size(), raw, raw_size);
+      return !payload.empty();
+
+    case EnvelopeFormat::kProtobuf: {
+      // integration.UplinkEvent: device_info = 3 (DeviceInfo.dev_eui = 8), data = 10
+      const uint8_t* device_info;
+      size_t device_info_size;
+      const uint8_t* data;
+      size_t data_size;
+      if (!FindLengthDelimited(payload, 3, &device_info, &device_info_size) ||
+          !FindLengthDelimited(payload, 10, &data, &data_size)) {
+        return false;
+      }
+      const uint8_t* eui = nullptr;
+      size_t eui_size = 0;
+      if (device_info &&
+          FindLengthDelimited(device_info, device_info_size, 8, &eui, &eui_size) && eui) {
+        dev_eui->assign(reinterpret_cast<const char*>(eui), eui_size);
+      }
+      CopyFrame(data, data_size, raw, raw_size);
+      return true;
+    }
+
+    case EnvelopeFormat::kJson: {
+      const json j = json::parse(payload, nullptr, false);
+      const json& data = Member(j, "data");
+      if (!data.is_string()) return false;
+      const json& eui = Member(j, "devEui");
+      *dev_eui = eui.is_string() ? eui.get<std::string>() : String(Member(Member(j, "deviceInfo"), "devEui"));
+      DecodeBase64Frame(data, raw, raw_size);
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace envelope_codec
+
+// ChirpStack v4 protobuf 字段编号（api/proto/integration/integration.proto、gw/gw.proto）：
+//   UplinkEvent   deduplication_id=1 time=2 device_info=3 dev_addr=4 adr=5 dr=6 f_cnt=7
+//                 f_port=8 confirmed=9 data=10 rx_info=12 tx_info=13 region_config_id=14
+//   DeviceInfo    tenant_id=1 tenant_name=2 application_id=3 application_name=4
+//                 device_profile_id=5 device_profile_name=6 device_name=7 dev_eui=8
+//                 tags=9 device_class_enabled=10
+//   UplinkRxInfo  gateway_id=1 uplink_id=2 gw_time=3 time_since_gps_epoch=4 rssi=6 snr=7
+//                 channel=8 rf_chain=9 board=10 antenna=11 location=12 context=13
+//                 crc_status=16 ns_time=17
+//   UplinkTxInfo  frequency=1 modulation=2 (Modulation.lora=3: bandwidth=1
+//                 spreading_factor=2 polarization_inversion=4 code_rate=5)
+bool UplinkProtobufEncoder::Load(const std::string& template_text) {
+  loaded_ = false;
+  device_info_.clear();
+  event_.clear();
+  rx_info_.clear();
+
+  // 占位符替换为可解析的值：引号内的保持原样（按字符串处理），数值位置替换为 0
+  std::string text;
+  text.reserve(template_text.size());
+  size_t pos = 0;
+  while (pos < template_text.size()) {
+    const size_t open = template_text.find("{{", pos);
+    const size_t close = open == std::string::npos ? open : template_text.find("}}", open);
+    if (close == std::string::npos) {
+      text.append(template_text, pos, std::string::npos);
+      break;
+    }
+    text.append(template_text, pos, open - pos);
+    if (open > 0 && template_text[open - 1] == '"') {
+      text.append(template_text, open, close + 2 - open);
+    } else {
+      text += '0';
+    }
+    pos = close + 2;
+  }
+
+  const json root = json::parse(text, nullptr, false);
+  if (!root.is_object()) return false;
+
+  const json& device = Member(root, "deviceInfo");
+  PutBytes(&device_info_, 1, String(Member(device, "tenantId")));
+  PutBytes(&device_info_, 2, String(Member(device, "tenantName")));
+  PutBytes(&device_info_, 3, String(Member(device, "applicationId")));
+  PutBytes(&device_info_, 4, String(Member(device, "applicationName")));
+  PutBytes(&device_info_, 5, String(Member(device, "deviceProfileId")));
+  PutBytes(&device_info_, 6, String(Member(device, "deviceProfileName")));
+  PutBytes(&device_info_, 7, String(Member(device, "deviceName")));
+  const json& tags = Member(device, "tags");
+  if (tags.is_object()) {
+    for (auto it = tags.begin(); it != tags.end(); ++it) {
+      std::string entry;  // map<string, string> 的每一项编码为 {key = 1, value = 2}
+      PutBytes(&entry, 1, it.key());
+      PutBytes(&entry, 2, String(it.value()));
+      PutBytes(&device_info_, 9, entry);
+    }
+  }
+  PutUint(&device_info_, 10,
+          EnumValue(Member(device, "deviceClassEnabled"), {"CLASS_A", "CLASS_B", "CLASS_C"}));
+
+  const json& rx_list = Member(root, "rxInfo");
+  const json& rx = rx_list.is_array() && !rx_list.empty() ? rx_list[0] : rx_list;
+  PutBytes(&rx_info_, 1, String(Member(rx, "gatewayId")));
+  PutUint(&rx_info_, 2, Unsigned(Member(rx, "uplinkId")));
+  PutUint(&rx_info_, 8, Unsigned(Member(rx, "channel")));
+  PutUint(&rx_info_, 9, Unsigned(Member(rx, "rfChain")));
+  PutUint(&rx_info_, 10, Unsigned(Member(rx, "board")));
+  PutUint(&rx_info_, 11, Unsigned(Member(rx, "antenna")));
+  const json& location = Member(rx, "location");
+  if (location.is_object() && !location.empty()) {
+    std::string body;  // common.Location: latitude = 1, longitude = 2, altitude = 3
+    PutDouble(&body, 1, Number(Member(location, "latitude")));
+    PutDouble(&body, 2, Number(Member(location, "longitude")));
+    PutDouble(&body, 3, Number(Member(location, "altitude")));
+    PutBytes(&rx_info_, 12, body);
+  }
+  const std::string context = String(Member(rx, "context"));
+  if (!context.empty()) {
+    const std::vector<uint8_t> bytes = Protocol::Base64ToBytes(context);
+    PutBytes(&rx_info_, 13, bytes.data(), bytes.size());
+  }
+  PutUint(&rx_info_, 16, EnumValue(Member(rx, "crcStatus"), {"NO_CRC", "BAD_CRC", "CRC_OK"}));
+
+  PutUint(&event_, 5, Bool(Member(root, "adr")));
+  PutUint(&event_, 6, Unsigned(Member(root, "dr")));
+  PutUint(&event_, 8, Unsigned(Member(root, "fPort")));
+  PutUint(&event_, 9, Bool(Member(root, "confirmed")));
+  const json& tx = Member(root, "txInfo");
+  if (tx.is_object()) {
+    const json& lora = Member(Member(tx, "modulation"), "lora");
+    std::string lora_body;
+    PutUint(&lora_body, 1, Unsigned(Member(lora, "bandwidth")));
+    PutUint(&lora_body, 2, Unsigned(Member(lora, "spreadingFactor")));
+    PutUint(&lora_body, 4, Bool(Member(lora, "polarizationInversion")));
+    PutUint(&lora_body, 5, EnumValue(Member(lora, "codeRate"),
+                                     {"CR_UNDEFINED", "CR_4_5", "CR_4_6", "CR_4_7", "CR_4_8",
+                                      "CR_3_8", "CR_2_6", "CR_1_4", "CR_1_6", "CR_5_6",
+                                      "CR_LI_4_5", "CR_LI_4_6", "CR_LI_4_8"}));
+    std::string modulation;
+    if (lora.is_object()) PutBytes(&modulation, 3, lora_body);
+    std::string tx_body;
+    PutUint(&tx_body, 1, Unsigned(Member(tx, "frequency")));
+    PutBytes(&tx_body, 2, modulation);
+    PutBytes(&event_, 13, tx_body);
+  }
+  PutBytes(&event_, 14, String(Member(root, "regionConfigId")));
+
+  loaded_ = true;
+  return true;
+}
+
+void UplinkProtobufEncoder::Encode(const std::string& dev_eui, const char* dev_addr,
+                                   size_t dev_addr_size, const UplinkFields& fields,
+                                   std::string* out) const {
+  // 嵌套消息 = 预编码的静态字段 + 本条消息的动态字段，长度前缀直接按两部分之和写出
+  const int64_t time_ns = fields.TimeNs();
+  char rx_dynamic[128];
+  BufferWriter rx{rx_dynamic};
+  PutTime(&rx, 3, time_ns);
+  PutTime(&rx, 4, fields.GpsTimeNs());
+  PutInt(&rx, 6, fields.rssi);
+  PutFloat(&rx, 7, static_cast<float>(fields.snr_tenths) / 10.0f);
+  PutTime(&rx, 17, time_ns + fields.ns_delay_us * 1000);
+  const size_t rx_dynamic_size = static_cast<size_t>(rx.p - rx_dynamic);
+
+  char id[UplinkFields::kIdSize];
+  fields.FormatId(id);
+
+  const size_t device_info_size = device_info_.size() + BytesFieldSize(8, dev_eui.size());
+  const size_t rx_info_size = rx_info_.size() + rx_dynamic_size;
+
+  // 按上限一次调整长度（容量足够时不重新分配），逐字段写入后截到实际长度
+  const size_t max_size = device_info_size + rx_info_size + event_.size() + fields.data_size +
+                          dev_addr_size + UplinkFields::kIdSize + 80;
+  out->resize(max_size);
+  char* const begin = &(*out)[0];
+  BufferWriter w{begin};
+  PutBytes(&w, 1, id, sizeof(id));
+  PutTime(&w, 2, time_ns);
+  PutTag(&w, 3, kWireLengthDelimited);
+  PutVarint(&w, device_info_size);
+  w.append(device_info_);
+  PutBytes(&w, 8, dev_eui);
+  PutBytes(&w, 4, dev_addr, dev_addr_size);
+  PutUint(&w, 7, fields.fcnt);
+  PutBytes(&w, 10, fields.data, fields.data_size);
+  PutTag(&w, 12, kWireLengthDelimited);
+  PutVarint(&w, rx_info_size);
+  w.append(rx_info_);
+  w.append(rx_dynamic, rx_dynamic_size);
+  w.append(event_);  // 字段顺序不影响解析
+  out->resize(static_cast<size_t>(w.p - begin));
+}
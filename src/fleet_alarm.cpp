@@ -0,0 +1,193 @@
+#include "fleet_alarm.h"
+
+#include <algorithm>
+
+#include "fleet_scheduler.h"
+#include "robot.h"
+#include "sim_clock.h"
+#include "sim_rng.h"
+
+constexpr uint64_t FleetAlarmScheduler::kRaisePeriodTicks;
+constexpr std::chrono::milliseconds FleetAlarmScheduler::kIdlePoll;
+
+FleetAlarmScheduler::FleetAlarmScheduler()
+    : epoch_(SimClock::Instance().SteadyNow()) {}
+
+uint64_t FleetAlarmScheduler::NowTick() const {
+  return static_cast<uint64_t>((SimClock::Instance().SteadyNow() - epoch_) /
+                               FleetScheduler::kTickInterval);
+}
+
+FleetAlarmScheduler::Slot FleetAlarmScheduler::Register(Robot* robot, uint32_t serial) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Slot slot;
+  if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  } else {
+    slot = static_cast<Slot>(slots_.size());
+    slots_.emplace_back();
+  }
+  SlotState& s = slots_[slot];
+  s.robot = robot;
+  s.serial = serial;
+  s.started = false;
+  s.touched = false;
+  return slot;
+}
+
+void FleetAlarmScheduler::Unregister(Slot slot) {
+  // 事件处理全程持锁，返回后不会再访问该机器人
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (slot < 0 || static_cast<size_t>(slot) >= slots_.size() || slots_[slot].robot == nullptr) return;
+  SlotState& s = slots_[slot];
+  s.robot = nullptr;
+  s.started = false;
+  ++s.generation;  // 堆中该槽位的旧事件全部失效
+  free_slots_.push_back(slot);
+}
+
+void FleetAlarmScheduler::Start(Slot slot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (slot < 0 || static_cast<size_t>(slot) >= slots_.size() || slots_[slot].robot == nullptr) return;
+  SlotState& s = slots_[slot];
+  s.started = true;
+  s.start_tick = NowTick();
+  ++s.raise_generation;
+  if (active_) {
+    ScheduleRaiseLocked(slot, s.start_tick + kRaisePeriodTicks);
+  }
+}
+
+void FleetAlarmScheduler::Stop(Slot slot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (slot < 0 || static_cast<size_t>(slot) >= slots_.size()) return;
+  slots_[slot].started = false;
+  ++slots_[slot].raise_generation;
+}
+
+size_t FleetAlarmScheduler::GetPendingEventCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return events_.size();
+}
+
+void FleetAlarmScheduler::ScheduleRaiseLocked(Slot slot, uint64_t tick) {
+  const SlotState& s = slots_[slot];
+  events_.push(Event{tick, kRaise, 0, slot, s.generation, s.raise_generation});
+}
+
+void FleetAlarmScheduler::RebuildLocked(const SimConfig& sim, uint64_t version, uint64_t now_tick) {
+  bit_table_version_ = version;
+  bit_table_.clear();
+  for (int b = 0; b < 32; ++b) {
+    if (sim.alarm_sim.fc_bits_mask & (static_cast<uint32_t>(1) << b)) {
+      bit_table_.push_back(static_cast<uint8_t>(b));
+    }
+  }
+
+  const bool active = sim.enabled && sim.alarm_sim.enabled;
+  if (active && !active_) {
+    // 重新启用：已启动的机器人从当前时刻起按各自相位继续产生告警
+    for (size_t i = 0; i < slots_.size(); ++i) {
+      SlotState& s = slots_[i];
+      if (s.robot == nullptr || !s.started) continue;
+      ++s.raise_generation;
+      const uint64_t elapsed = now_tick - s.start_tick;
+      const uint64_t next = s.start_tick + (elapsed / kRaisePeriodTicks + 1) * kRaisePeriodTicks;
+      ScheduleRaiseLocked(static_cast<Slot>(i), next);
+    }
+  }
+  active_ = active;
+}
+
+void FleetAlarmScheduler::TouchLocked(Slot slot, std::vector<Slot>* touched) {
+  SlotState& s = slots_[slot];
+  if (s.touched) return;
+  s.touched = true;
+  s.set_bits = 0;
+  s.clear_bits = 0;
+  touched->push_back(slot);
+}
+
+void FleetAlarmScheduler::RaiseLocked(const SimConfig& sim, const Event& event,
+                                      std::vector<Slot>* touched) {
+  SlotState& s = slots_[event.slot];
+  // 下一次产生事件
+  ScheduleRaiseLocked(event.slot, event.tick + kRaisePeriodTicks);
+  if (bit_table_.empty()) return;
+
+  const auto& alm = sim.alarm_sim;
+  int dur_lo = std::min(alm.duration_min, alm.duration_max);
+  int dur_hi = std::max(alm.duration_min, alm.duration_max);
+  if (dur_lo == dur_hi) ++dur_hi;
+  const uint64_t seed = SimRng::GetGlobalSeed();
+  const uint64_t rel_tick = event.tick - s.start_tick;
+  const uint32_t bit_count = static_cast<uint32_t>(bit_table_.size());
+  const uint32_t dur_range = static_cast<uint32_t>(dur_hi - dur_lo + 1);
+
+  TouchLocked(event.slot, touched);
+  uint32_t raised = 0;
+  for (int i = 0; i < alm.frequency; ++i) {
+    // 由 (种子, 机器人编号, 相对tick, 告警序号) 计算，同一种子下可复现
+    const SimRng::Block r = SimRng::Generate(seed, s.serial, rel_tick, SimRng::kAlarmBase + i);
+    const uint8_t bit = bit_table_[SimRng::ToRange(r[0], bit_count)];
+    const uint64_t duration = static_cast<uint64_t>(dur_lo) + SimRng::ToRange(r[1], dur_range);
+    raised |= (static_cast<uint32_t>(1) << bit);
+    events_.push(Event{event.tick + duration * 600, kClear, bit, event.slot, s.generation, 0});
+  }
+  s.set_bits |= raised;
+  s.clear_bits &= ~raised;
+}
+
+std::chrono::milliseconds FleetAlarmScheduler::Process(const SimConfig& sim, uint64_t version) {
+  std::vector<std::function<void()>> persist_tasks;
+  const auto delay = ProcessEvents(sim, version, &persist_tasks);
+
+  // 持久化在释放 mutex_ 之后进行（任务不引用 Robot，机器人此时可能已注销）
+  for (const auto& task : persist_tasks) {
+    task();
+  }
+  return delay;
+}
+
+std::chrono::milliseconds FleetAlarmScheduler::ProcessEvents(
+    const SimConfig& sim, uint64_t version, std::vector<std::function<void()>>* persist_tasks) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint64_t now_tick = NowTick();
+  if (version != bit_table_version_) {
+    RebuildLocked(sim, version, now_tick);
+  }
+
+  std::vector<Slot> touched;
+  while (!events_.empty() && events_.top().tick <= now_tick) {
+    const Event event = events_.top();
+    events_.pop();
+    SlotState& s = slots_[event.slot];
+    if (s.robot == nullptr || event.generation != s.generation) continue;
+
+    if (event.kind == kClear) {
+      TouchLocked(event.slot, &touched);
+      const uint32_t cleared = static_cast<uint32_t>(1) << event.bit;
+      s.clear_bits |= cleared;
+      s.set_bits &= ~cleared;
+      continue;
+    }
+    if (!active_ || !s.started || event.raise_generation != s.raise_generation) continue;
+    RaiseLocked(sim, event, &touched);
+  }
+
+  // 在各机器人写锁下一次写入合并后的告警位，仅告警值实际发生变化的机器人需要持久化
+  for (Slot slot : touched) {
+    SlotState& s = slots_[slot];
+    s.touched = false;
+    if (auto task = s.robot->ApplyAlarmFcBits(s.set_bits, s.clear_bits)) {
+      persist_tasks->push_back(std::move(task));
+    }
+  }
+
+  if (events_.empty()) return kIdlePoll;
+  const auto next = epoch_ + FleetScheduler::kTickInterval * static_cast<int64_t>(events_.top().tick);
+  const auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+      next - SimClock::Instance().SteadyNow());
+  return std::clamp(delay, std::chrono::milliseconds(0), kIdlePoll);
+}
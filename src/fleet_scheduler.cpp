@@ -0,0 +1,312 @@
+#include "fleet_scheduler.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <exception>
+
+#include "sim_clock.h"
+
+constexpr std::chrono::milliseconds FleetScheduler::kTickInterval;
+constexpr std::chrono::milliseconds FleetScheduler::kCallbackRetryDelay;
+
+FleetScheduler& FleetScheduler::Instance() {
+  // 有意不析构：机器人可能在静态析构阶段仍持有定时器
+  static FleetScheduler* instance = new FleetScheduler();
+  return *instance;
+}
+
+FleetScheduler::FleetScheduler()
+    : start_time_(SimClock::Instance().SteadyNow()),
+      level0_(kLevel0Size) {
+  for (auto& level : upper_levels_) {
+    level.resize(kLevelNSize);
+  }
+
+  unsigned int worker_count = std::thread::hardware_concurrency();
+  if (worker_count == 0) worker_count = 1;
+
+  driver_thread_ = std::thread(&FleetScheduler::DriverThreadFunc, this);
+  for (unsigned int i = 0; i < worker_count; ++i) {
+    workers_.emplace_back(&FleetScheduler::WorkerThreadFunc, this);
+  }
+
+  LOG(INFO) << "[Scheduler] 全局定时调度器已启动，工作线程数: " << worker_count
+            << "，tick精度: " << kTickInterval.count() << "ms"
+            << "，时钟模式: " << SimClock::ModeName(SimClock::Instance().GetMode());
+}
+
+FleetScheduler::~FleetScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  driver_cv_.notify_all();
+  worker_cv_.notify_all();
+  if (driver_thread_.joinable()) driver_thread_.join();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) worker.join();
+  }
+}
+
+uint64_t FleetScheduler::NowTick() const {
+  auto elapsed = SimClock::Instance().SteadyNow() - start_time_;
+  return static_cast<uint64_t>(elapsed / kTickInterval);
+}
+
+std::chrono::steady_clock::time_point FleetScheduler::TickToTime(uint64_t tick) const {
+  return start_time_ + kTickInterval * static_cast<int64_t>(tick);
+}
+
+uint64_t FleetScheduler::DeadlineTickLocked(std::chrono::milliseconds delay) const {
+  if (delay.count() <= 0) return current_tick_;
+  // 以"当前时间 + 延迟"向上取整到 tick，保证不会早于截止时间触发
+  auto deadline = SimClock::Instance().SteadyNow() - start_time_ + delay;
+  return static_cast<uint64_t>((deadline + kTickInterval - std::chrono::nanoseconds(1)) / kTickInterval);
+}
+
+FleetScheduler::TimerId FleetScheduler::AddTimer(std::chrono::milliseconds delay,
+                                                 TimerCallback callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto entry = std::make_shared<TimerEntry>();
+  entry->id = next_id_++;
+  entry->callback = std::move(callback);
+  timers_[entry->id] = entry;
+  ScheduleLocked(entry.get(), DeadlineTickLocked(delay));
+  return entry->id;
+}
+
+void FleetScheduler::WakeTimer(TimerId id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = timers_.find(id);
+  if (it == timers_.end()) return;
+  TimerEntry* entry = it->second.get();
+  switch (entry->state) {
+    case TimerState::kWaiting:
+      ++entry->generation;  // 使时间轮中的旧引用失效
+      EnqueueReadyLocked(entry);
+      break;
+    case TimerState::kRunning:
+      entry->wake_pending = true;
+      break;
+    case TimerState::kQueued:
+      break;
+  }
+}
+
+void FleetScheduler::CancelTimer(TimerId id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = timers_.find(id);
+  if (it == timers_.end()) return;
+  TimerEntry* entry = it->second.get();
+  if (entry->state != TimerState::kRunning) {
+    timers_.erase(it);
+    return;
+  }
+
+  entry->cancelled = true;
+  if (entry->running_thread == std::this_thread::get_id()) {
+    return;  // 回调内部取消自身，由工作线程在回调返回后移除
+  }
+  finished_cv_.wait(lock, [this, id]() { return timers_.find(id) == timers_.end(); });
+}
+
+size_t FleetScheduler::GetTimerCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return timers_.size();
+}
+
+void FleetScheduler::ScheduleLocked(TimerEntry* entry, uint64_t expire_tick) {
+  ++entry->generation;
+  entry->expire_tick = expire_tick;
+  entry->state = TimerState::kWaiting;
+  if (expire_tick <= current_tick_) {
+    EnqueueReadyLocked(entry);
+    return;
+  }
+  InsertIntoWheelLocked(SlotRef{entry->id, entry->generation}, expire_tick);
+  driver_cv_.notify_one();
+}
+
+void FleetScheduler::InsertIntoWheelLocked(const SlotRef& ref, uint64_t expire_tick) {
+  uint64_t delta = expire_tick - current_tick_;
+  if (delta < kLevel0Size) {
+    level0_[expire_tick & (kLevel0Size - 1)].push_back(ref);
+    return;
+  }
+
+  for (int level = 1; level < kLevelCount; ++level) {
+    const int shift = kLevel0Bits + kLevelNBits * level;
+    if (level == kLevelCount - 1 && delta >= (1ULL << shift)) {
+      // 超出时间轮范围：截断到最大可表示的截止时间，到期后由回调重新计算
+      expire_tick = current_tick_ + (1ULL << shift) - 1;
+      delta = (1ULL << shift) - 1;
+    }
+    if (delta < (1ULL << shift)) {
+      const int slot_shift = kLevel0Bits + kLevelNBits * (level - 1);
+      upper_levels_[level - 1][(expire_tick >> slot_shift) & (kLevelNSize - 1)].push_back(ref);
+      return;
+    }
+  }
+}
+
+void FleetScheduler::CascadeLocked(int level, uint64_t index) {
+  Slot slot;
+  slot.swap(upper_levels_[level - 1][index]);
+  for (const auto& ref : slot) {
+    auto it = timers_.find(ref.id);
+    if (it == timers_.end()) continue;
+    TimerEntry* entry = it->second.get();
+    if (entry->generation != ref.generation || entry->state != TimerState::kWaiting) continue;
+    if (entry->expire_tick <= current_tick_) {
+      EnqueueReadyLocked(entry);
+    } else {
+      InsertIntoWheelLocked(ref, entry->expire_tick);
+    }
+  }
+}
+
+void FleetScheduler::AdvanceOneTickLocked() {
+  ++current_tick_;
+  const uint64_t index0 = current_tick_ & (kLevel0Size - 1);
+  if (index0 == 0) {
+    // 低层转满一圈时，把上一层对应槽中的定时器下放
+    for (int level = 1; level < kLevelCount; ++level) {
+      const int slot_shift = kLevel0Bits + kLevelNBits * (level - 1);
+      const uint64_t index = (current_tick_ >> slot_shift) & (kLevelNSize - 1);
+      CascadeLocked(level, index);
+      if (index != 0) break;
+    }
+  }
+
+  Slot slot;
+  slot.swap(level0_[index0]);
+  for (const auto& ref : slot) {
+    auto it = timers_.find(ref.id);
+    if (it == timers_.end()) continue;
+    TimerEntry* entry = it->second.get();
+    if (entry->generation != ref.generation || entry->state != TimerState::kWaiting) continue;
+    EnqueueReadyLocked(entry);
+  }
+}
+
+void FleetScheduler::EnqueueReadyLocked(TimerEntry* entry) {
+  entry->state = TimerState::kQueued;
+  ready_queue_.push_back(entry->id);
+  worker_cv_.notify_one();
+}
+
+uint64_t FleetScheduler::NextWakeTickLocked() const {
+  // 在第0层中查找下一个非空槽；找不到则在下一次层级下放时醒来
+  const uint64_t boundary = (current_tick_ | (kLevel0Size - 1)) + 1;
+  for (uint64_t tick = current_tick_ + 1; tick < boundary; ++tick) {
+    if (!level0_[tick & (kLevel0Size - 1)].empty()) return tick;
+  }
+  return boundary;
+}
+
+void FleetScheduler::DriverThreadFunc() {
+  SimClock& clock = SimClock::Instance();
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (running_) {
+    const uint64_t now_tick = NowTick();
+    while (current_tick_ < now_tick) {
+      AdvanceOneTickLocked();
+    }
+
+    if (!clock.IsDiscreteEvent()) {
+      driver_cv_.wait_until(lock, clock.ToRealDeadline(TickToTime(NextWakeTickLocked())));
+      continue;
+    }
+
+    // 离散事件模式：仍有回调待执行时等待其全部结束，空闲后直接跳到下一个截止时刻
+    if (!ready_queue_.empty() || running_callbacks_ > 0 || timers_.empty()) {
+      driver_cv_.wait(lock);
+      continue;
+    }
+    const auto hold_deadline = PruneSimTimeHoldsLocked();
+    if (hold_deadline != std::chrono::steady_clock::time_point::max()) {
+      driver_cv_.wait_until(lock, hold_deadline);
+      continue;
+    }
+    clock.AdvanceTo(TickToTime(NextWakeTickLocked()));
+  }
+}
+
+FleetScheduler::HoldId FleetScheduler::HoldSimTime(std::chrono::steady_clock::time_point real_deadline) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const HoldId id = next_hold_id_++;
+  sim_time_holds_[id] = real_deadline;
+  return id;
+}
+
+void FleetScheduler::ReleaseSimTime(HoldId id) {
+  if (id == 0) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (sim_time_holds_.erase(id) > 0) {
+    driver_cv_.notify_one();
+  }
+}
+
+std::chrono::steady_clock::time_point FleetScheduler::PruneSimTimeHoldsLocked() {
+  const auto real_now = std::chrono::steady_clock::now();
+  auto earliest = std::chrono::steady_clock::time_point::max();
+  for (auto it = sim_time_holds_.begin(); it != sim_time_holds_.end();) {
+    if (it->second <= real_now) {
+      it = sim_time_holds_.erase(it);
+      continue;
+    }
+    earliest = std::min(earliest, it->second);
+    ++it;
+  }
+  return earliest;
+}
+
+void FleetScheduler::WorkerThreadFunc() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    worker_cv_.wait(lock, [this]() { return !running_ || !ready_queue_.empty(); });
+    if (!running_) break;
+
+    const TimerId id = ready_queue_.front();
+    ready_queue_.pop_front();
+    auto it = timers_.find(id);
+    if (it == timers_.end() || it->second->state != TimerState::kQueued) continue;
+
+    std::shared_ptr<TimerEntry> entry = it->second;
+    entry->state = TimerState::kRunning;
+    entry->wake_pending = false;
+    entry->running_thread = std::this_thread::get_id();
+    ++running_callbacks_;
+    lock.unlock();
+
+    // 回调异常时不能移除定时器（否则机器人的上报/清扫流程会无声停止），延迟后重试
+    std::chrono::milliseconds next_delay(-1);
+    try {
+      next_delay = entry->callback();
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "[Scheduler] 定时器 #" << id << " 回调异常: " << e.what()
+                 << "，" << kCallbackRetryDelay.count() << "ms 后重试";
+      next_delay = kCallbackRetryDelay;
+    } catch (...) {
+      LOG(ERROR) << "[Scheduler] 定时器 #" << id << " 回调抛出未知异常，"
+                 << kCallbackRetryDelay.count() << "ms 后重试";
+      next_delay = kCallbackRetryDelay;
+    }
+
+    lock.lock();
+    --running_callbacks_;
+    entry->running_thread = std::thread::id();
+    if (entry->cancelled || next_delay.count() < 0) {
+      timers_.erase(id);
+    } else if (entry->wake_pending) {
+      ScheduleLocked(entry.get(), current_tick_);
+    } else {
+      ScheduleLocked(entry.get(), DeadlineTickLocked(next_delay));
+    }
+    finished_cv_.notify_all();
+    if (running_callbacks_ == 0 && ready_queue_.empty()) {
+      driver_cv_.notify_one();
+    }
+  }
+}
@@ -0,0 +1,171 @@
+#include "fleet_sim.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "robot.h"
+#include "sim_rng.h"
+
+namespace {
+
+// 四舍五入（远离零）：加上带符号的0.5后向零截断，与 std::round 一致
+// 无分支、无函数调用，内联进批量循环后可被编译器向量化
+inline int32_t RoundSample(float v) {
+  return static_cast<int32_t>(v + std::copysign(0.5f, v));
+}
+
+}  // namespace
+
+FleetSimEngine::FleetSimEngine() {}
+
+FleetSimEngine::Slot FleetSimEngine::Register(uint32_t serial) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Slot slot;
+  if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  } else {
+    slot = static_cast<Slot>(active_.size());
+    const size_t n = active_.size() + 1;
+    active_.resize(n);
+    sampled_.resize(n);
+    moving_.resize(n);
+    at_dock_.resize(n);
+    serials_.resize(n);
+    main_current_.resize(n);
+    slave_current_.resize(n);
+    solar_voltage_.resize(n);
+    solar_current_.resize(n);
+    board_temp_.resize(n);
+    battery_voltage_.resize(n);
+    battery_temp_.resize(n);
+  }
+  active_[slot] = 1;
+  sampled_[slot] = 0;
+  moving_[slot] = 0;
+  at_dock_[slot] = 1;  // 新机器人默认停靠在0号位
+  serials_[slot] = serial;
+  return slot;
+}
+
+void FleetSimEngine::Unregister(Slot slot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (slot < 0 || static_cast<size_t>(slot) >= active_.size() || !active_[slot]) return;
+  active_[slot] = 0;
+  sampled_[slot] = 0;
+  free_slots_.push_back(slot);
+}
+
+void FleetSimEngine::SetMotion(Slot slot, bool is_moving, bool at_dock) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (slot < 0 || static_cast<size_t>(slot) >= active_.size()) return;
+  moving_[slot] = is_moving ? 1 : 0;
+  at_dock_[slot] = at_dock ? 1 : 0;
+}
+
+bool FleetSimEngine::ReadSample(Slot slot, SimSample* sample) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (sample == nullptr || slot < 0 || static_cast<size_t>(slot) >= active_.size() ||
+      !sampled_[slot]) {
+    return false;
+  }
+  sample->main_motor_current  = main_current_[slot];
+  sample->slave_motor_current = slave_current_[slot];
+  sample->solar_voltage       = solar_voltage_[slot];
+  sample->solar_current       = solar_current_[slot];
+  sample->board_temperature   = board_temp_[slot];
+  sample->battery_voltage     = battery_voltage_[slot];
+  sample->battery_temperature = battery_temp_[slot];
+  return true;
+}
+
+size_t FleetSimEngine::GetActiveCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return active_.size() - free_slots_.size();
+}
+
+void FleetSimEngine::FillField(uint32_t field, bool random, float lo, float hi, float fixed, float scale,
+                               const uint8_t* mask, int32_t* out, size_t n) {
+  float* u = uniform_.data();
+  if (random) {
+    SimRng::UniformBatch(SimRng::GetGlobalSeed(), serials_.data(), n, tick_, field, u);
+  } else {
+    std::fill(u, u + n, 0.0f);
+    lo = fixed;
+    hi = fixed;
+  }
+
+  // 以下循环无分支，可被编译器向量化
+  const float span = hi - lo;
+  if (mask == nullptr) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = RoundSample((lo + u[i] * span) * scale);
+    }
+  } else {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = RoundSample((lo + u[i] * span) * scale) * static_cast<int32_t>(mask[i]);
+    }
+  }
+}
+
+void FleetSimEngine::SampleOne(const SimConfig& sim, uint32_t serial, uint64_t tick,
+                               bool is_moving, bool at_dock, SimSample* sample) {
+  const uint64_t seed = SimRng::GetGlobalSeed();
+  auto field = [&](uint32_t id, bool random, float lo, float hi, float fixed, float scale) {
+    if (!random) return RoundSample(fixed * scale);
+    return RoundSample((lo + SimRng::Uniform(seed, serial, tick, id) * (hi - lo)) * scale);
+  };
+
+  sample->main_motor_current = is_moving
+      ? field(SimRng::kMainCurrent, sim.main_current_random, sim.main_current_min,
+              sim.main_current_max, sim.main_current_fixed, 10.0f) : 0;
+  sample->slave_motor_current = is_moving
+      ? field(SimRng::kSlaveCurrent, sim.slave_current_random, sim.slave_current_min,
+              sim.slave_current_max, sim.slave_current_fixed, 10.0f) : 0;
+  sample->solar_voltage = at_dock
+      ? field(SimRng::kSolarVoltage, sim.solar_voltage_random, sim.solar_voltage_min,
+              sim.solar_voltage_max, sim.solar_voltage_fixed, 10.0f) : 0;
+  sample->solar_current = at_dock
+      ? field(SimRng::kSolarCurrent, sim.solar_current_random, sim.solar_current_min,
+              sim.solar_current_max, sim.solar_current_fixed, 10.0f) : 0;
+  sample->board_temperature = field(SimRng::kBoardTemp, sim.board_temp_random, sim.board_temp_min,
+                                    sim.board_temp_max, sim.board_temp_fixed, 1.0f);
+  sample->battery_voltage = field(SimRng::kBatteryVoltage, sim.battery_voltage_random,
+                                  sim.battery_voltage_min, sim.battery_voltage_max,
+                                  sim.battery_voltage_fixed, 10.0f);
+  sample->battery_temperature = field(SimRng::kBatteryTemp, sim.battery_temp_random,
+                                      sim.battery_temp_min, sim.battery_temp_max,
+                                      sim.battery_temp_fixed, 1.0f);
+}
+
+void FleetSimEngine::Step(const SimConfig& sim) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const size_t n = active_.size();
+  if (n == 0) return;
+  uniform_.resize(n);
+  ++tick_;
+
+  // 主/从电机电流（运行时有值，否则为0）
+  FillField(SimRng::kMainCurrent, sim.main_current_random, sim.main_current_min, sim.main_current_max,
+            sim.main_current_fixed, 10.0f, moving_.data(), main_current_.data(), n);
+  FillField(SimRng::kSlaveCurrent, sim.slave_current_random, sim.slave_current_min, sim.slave_current_max,
+            sim.slave_current_fixed, 10.0f, moving_.data(), slave_current_.data(), n);
+
+  // 光伏输出（停靠时有值，否则为0）
+  FillField(SimRng::kSolarVoltage, sim.solar_voltage_random, sim.solar_voltage_min, sim.solar_voltage_max,
+            sim.solar_voltage_fixed, 10.0f, at_dock_.data(), solar_voltage_.data(), n);
+  FillField(SimRng::kSolarCurrent, sim.solar_current_random, sim.solar_current_min, sim.solar_current_max,
+            sim.solar_current_fixed, 10.0f, at_dock_.data(), solar_current_.data(), n);
+
+  // 主板温度、电池电压、电池温度（始终有值）
+  FillField(SimRng::kBoardTemp, sim.board_temp_random, sim.board_temp_min, sim.board_temp_max,
+            sim.board_temp_fixed, 1.0f, nullptr, board_temp_.data(), n);
+  FillField(SimRng::kBatteryVoltage, sim.battery_voltage_random, sim.battery_voltage_min, sim.battery_voltage_max,
+            sim.battery_voltage_fixed, 10.0f, nullptr, battery_voltage_.data(), n);
+  FillField(SimRng::kBatteryTemp, sim.battery_temp_random, sim.battery_temp_min, sim.battery_temp_max,
+            sim.battery_temp_fixed, 1.0f, nullptr, battery_temp_.data(), n);
+
+  for (size_t i = 0; i < n; ++i) {
+    sampled_[i] = active_[i];
+  }
+}
@@ -0,0 +1,44 @@
+#include "frame_dispatch.h"
+
+#include <algorithm>
+
+constexpr std::array<int64_t, 6> FrameHandlerStats::kLatencyBucketsUs;
+
+void FrameHandlerStats::Record(uint8_t key, std::chrono::nanoseconds elapsed) {
+  Counters& c = counters_[key];
+  const uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0));
+  c.count.fetch_add(1, std::memory_order_relaxed);
+  c.total_ns.fetch_add(ns, std::memory_order_relaxed);
+
+  uint64_t max_ns = c.max_ns.load(std::memory_order_relaxed);
+  while (ns > max_ns &&
+         !c.max_ns.compare_exchange_weak(max_ns, ns, std::memory_order_relaxed)) {
+  }
+
+  const int64_t us = static_cast<int64_t>(ns / 1000);
+  size_t bucket = 0;
+  while (bucket < kLatencyBucketsUs.size() && us > kLatencyBucketsUs[bucket]) ++bucket;
+  c.latency_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameHandlerStats::Snapshot FrameHandlerStats::Get(uint8_t key) const {
+  const Counters& c = counters_[key];
+  Snapshot s;
+  s.key = key;
+  s.count = c.count.load(std::memory_order_relaxed);
+  s.total_ns = c.total_ns.load(std::memory_order_relaxed);
+  s.max_ns = c.max_ns.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < s.latency_histogram.size(); ++i) {
+    s.latency_histogram[i] = c.latency_histogram[i].load(std::memory_order_relaxed);
+  }
+  return s;
+}
+
+void FrameHandlerStats::Reset() {
+  for (Counters& c : counters_) {
+    c.count.store(0, std::memory_order_relaxed);
+    c.total_ns.store(0, std::memory_order_relaxed);
+    c.max_ns.store(0, std::memory_order_relaxed);
+    for (auto& bucket : c.latency_histogram) bucket.store(0, std::memory_order_relaxed);
+  }
+}
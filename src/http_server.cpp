@@ -12,8 +12,10 @@
 #include <iomanip>
 #include <set>
 
+#include "async_log_sink.h"
 #include "config_db.h"
 #include "mqtt_manager.h"
+#include "trace.h"
 #include "version.h"
 
 // 使用cpp-httplib库
@@ -75,6 +77,66 @@ static json BuildStartReplyJson(const RobotData::RequestReply& start_reply) {
   };
 }
 
+static json BuildFrameHandlerStatsJson(const Robot::FrameHandlerTable& table) {
+  json items = json::array();
+  for (const auto& stats : table.GetStats()) {
+    json histogram = json::array();
+    for (size_t i = 0; i < stats.latency_histogram.size(); ++i) {
+      json bucket;
+      if (i < FrameHandlerStats::kLatencyBucketsUs.size()) {
+        bucket["le_us"] = FrameHandlerStats::kLatencyBucketsUs[i];
+      } else {
+        bucket["le_us"] = nullptr;  // 超过最大分桶上限
+      }
+      bucket["count"] = stats.latency_histogram[i];
+      histogram.push_back(bucket);
+    }
+
+    char key[8];
+    snprintf(key, sizeof(key), "0x%02X", stats.key);
+    items.push_back({
+        {"key", key},
+        {"name", stats.name ? stats.name : "未知命令"},
+        {"count", stats.count},
+        {"total_ms", stats.total_ns / 1e6},
+        {"avg_us", stats.count > 0 ? stats.total_ns / 1e3 / stats.count : 0.0},
+        {"max_us", stats.max_ns / 1e3},
+        {"latency_histogram", histogram},
+    });
+  }
+  return items;
+}
+
+static json BuildTraceLevelsJson() {
+  json levels;
+  for (int i = 0; i < static_cast<int>(TraceModule::kCount); ++i) {
+    const auto module = static_cast<TraceModule>(i);
+    levels[Trace::ModuleName(module)] = Trace::GetLevel(module);
+  }
+  return levels;
+}
+
+// 解析 E0 设置中的 robot_number（十进制字符串或整数，0~65535），无法解析或超出范围时返回 false
+static bool ParseRobotNumber(const json& value, uint16_t* robot_number) {
+  unsigned long number = 0;
+  if (value.is_number_unsigned()) {
+    number = value.get<unsigned long>();
+  } else if (value.is_string()) {
+    const std::string text = value.get<std::string>();
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) return false;
+    try {
+      number = std::stoul(text);
+    } catch (const std::exception&) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  if (number > 0xFFFF) return false;
+  *robot_number = static_cast<uint16_t>(number);
+  return true;
+}
+
 static std::string ToLowerCopy(std::string text) {
   std::transform(text.begin(), text.end(), text.begin(), ::tolower);
   return text;
@@ -287,7 +349,8 @@ void HttpServer::ServerThreadFunc() {
         }
         auto live = mqtt_manager_->GetRobot(robot.robot_id);
         if (live) {
-          const auto& rd = live->GetData();
+          const auto snapshot = live->GetDataSnapshot();
+          const auto& rd = *snapshot;
           if (rd.alarm_fa != 0 || rd.alarm_fb != 0 || rd.alarm_fc != 0 || rd.alarm_fd != 0) {
             fault_count++;
           } else {
@@ -316,7 +379,8 @@ void HttpServer::ServerThreadFunc() {
         {
           auto live = mqtt_manager_->GetRobot(robot.robot_id);
           if (live) {
-            const auto& rd = live->GetData();
+            const auto snapshot = live->GetDataSnapshot();
+            const auto& rd = *snapshot;
             robot_json["software_version"] = rd.software_version;
             robot_json["fault_status"] = (rd.alarm_fa != 0 || rd.alarm_fb != 0 || rd.alarm_fc != 0 || rd.alarm_fd != 0);
           } else {
@@ -346,7 +410,7 @@ void HttpServer::ServerThreadFunc() {
 
       res.set_content(response.dump(), "application/json");
 
-      LOG(INFO) << "API: 获取机器人列表, 页: " << page << "/" << totalPages << ", 总数: " << total;
+      TRACE(kHttp, 1) << "API: 获取机器人列表, 页: " << page << "/" << totalPages << ", 总数: " << total;
     } catch (const std::exception& e) {
       LOG(ERROR) << "获取机器人列表失败: " << e.what();
       json error;
@@ -721,12 +785,14 @@ void HttpServer::ServerThreadFunc() {
       auto robot = mqtt_manager_->GetRobot(robot_id);
 
       if (robot) {
+        robot->RefreshSimulatedState();
         json robot_data;
         robot_data["robot_id"] = robot->GetId();
         robot_data["status"] = robot->IsRunning() ? "running" : "stopped";
         robot_data["last_data"] = robot->GetLastData();
-        robot_data["software_version"] = robot->GetData().software_version;
-        const auto& d = robot->GetData();
+        const auto snapshot = robot->GetDataSnapshot();
+        const auto& d = *snapshot;
+        robot_data["software_version"] = d.software_version;
         robot_data["fault_status"] = (d.alarm_fa != 0 || d.alarm_fb != 0 || d.alarm_fc != 0 || d.alarm_fd != 0);
 
         // 从数据库获取serial_number和robot_name
@@ -741,7 +807,7 @@ void HttpServer::ServerThreadFunc() {
         }
 
         res.set_content(robot_data.dump(), "application/json");
-        LOG(INFO) << "API: 获取机器人数据 - " << robot_id;
+        TRACE(kHttp, 1) << "API: 获取机器人数据 - " << robot_id;
       } else {
         // 机器人不在 MqttManager（可能已禁用）- 尝试从数据库读取快照
         auto all_robots = config_db_->GetAllRobots();
@@ -785,7 +851,7 @@ void HttpServer::ServerThreadFunc() {
                                         alarms.alarm_fc != 0 || alarms.alarm_fd != 0);
 
           res.set_content(robot_data.dump(), "application/json");
-          LOG(INFO) << "API: 获取机器人数据(已禁用) - " << robot_id;
+          TRACE(kHttp, 1) << "API: 获取机器人数据(已禁用) - " << robot_id;
         } else {
           json error;
           error["success"] = false;
@@ -820,13 +886,15 @@ void HttpServer::ServerThreadFunc() {
         return;
       }
 
+      robot->RefreshSimulatedState();
       json response;
       response["success"] = true;
       response["robot_id"] = robot_id;
-      response["alarm_fa"] = robot->GetData().alarm_fa;
-      response["alarm_fb"] = robot->GetData().alarm_fb;
-      response["alarm_fc"] = robot->GetData().alarm_fc;
-      response["alarm_fd"] = robot->GetData().alarm_fd;
+      const auto snapshot = robot->GetDataSnapshot();
+      response["alarm_fa"] = snapshot->alarm_fa;
+      response["alarm_fb"] = snapshot->alarm_fb;
+      response["alarm_fc"] = snapshot->alarm_fc;
+      response["alarm_fd"] = snapshot->alarm_fd;
       res.set_content(response.dump(), "application/json");
     } catch (const std::exception& e) {
       LOG(ERROR) << "获取机器人告警失败: " << e.what();
@@ -854,7 +922,7 @@ void HttpServer::ServerThreadFunc() {
       bool robot_found = false;
       auto live = mqtt_manager_->GetRobot(robot_id);
       if (live) {
-        software_version = live->GetData().software_version;
+        software_version = live->GetDataSnapshot()->software_version;
         robot_found = true;
       } else {
         auto all = config_db_->GetAllRobots();
@@ -900,7 +968,7 @@ void HttpServer::ServerThreadFunc() {
       response["software_version"] = software_version;
       response["files"]            = files_arr;
       res.set_content(response.dump(), "application/json");
-      LOG(INFO) << "API: 查询机器人版本 - " << robot_id << " v" << software_version;
+      TRACE(kHttp, 1) << "API: 查询机器人版本 - " << robot_id << " v" << software_version;
     } catch (const std::exception& e) {
       LOG(ERROR) << "查询机器人版本失败: " << e.what();
       json error; error["success"] = false; error["error"] = e.what();
@@ -971,6 +1039,8 @@ void HttpServer::ServerThreadFunc() {
       error["error"] = "机器人不存在或未运行";
       res.status = 404;
       res.set_content(error.dump(), "application/json");
+    } else {
+      robot->RefreshSimulatedState();
     }
     return robot;
   };
@@ -981,12 +1051,13 @@ void HttpServer::ServerThreadFunc() {
       std::string robot_id = req.get_param_value("robot_id");
       auto robot = findRobotOr404(robot_id, res);
       if (!robot) return;
-      const auto& d = robot->GetData();
+      const auto snapshot = robot->GetDataSnapshot();
+      const auto& d = *snapshot;
       json data;
       data["lora_power"]           = d.lora_params.power;
       data["lora_frequency"]       = d.lora_params.frequency;
       data["lora_rate"]            = d.lora_params.rate;
-      data["robot_number"]         = d.robot_number;
+      data["robot_number"]         = std::to_string(d.robot_number);
       data["software_version"]     = d.software_version;
       data["parking_position"]     = d.parking_position;
       data["daytime_scan_protect"] = d.daytime_scan_protect;
@@ -1010,7 +1081,7 @@ void HttpServer::ServerThreadFunc() {
       response["robot_id"] = robot_id;
       response["data"]     = data;
       res.set_content(response.dump(), "application/json");
-      LOG(INFO) << "API: 获取E0数据 - " << robot_id;
+      TRACE(kHttp, 1) << "API: 获取E0数据 - " << robot_id;
     } catch (const std::exception& e) {
       json error; error["success"] = false; error["error"] = e.what();
       res.status = 500; res.set_content(error.dump(), "application/json");
@@ -1024,42 +1095,50 @@ void HttpServer::ServerThreadFunc() {
       json body = json::parse(req.body);
       auto robot = findRobotOr404(robot_id, res);
       if (!robot) return;
-      auto& d = robot->GetData();
-      if (body.contains("lora_power"))           d.lora_params.power     = body["lora_power"].get<int>();
-      if (body.contains("lora_frequency"))       d.lora_params.frequency = body["lora_frequency"].get<int>();
-      if (body.contains("lora_rate"))            d.lora_params.rate      = body["lora_rate"].get<int>();
-      if (body.contains("robot_number"))         d.robot_number          = body["robot_number"].get<std::string>();
-      if (body.contains("software_version"))     d.software_version      = body["software_version"].get<std::string>();
-      if (body.contains("parking_position"))     d.parking_position      = body["parking_position"].get<int>();
-      if (body.contains("daytime_scan_protect")) d.daytime_scan_protect  = body["daytime_scan_protect"].get<bool>();
-      if (body.contains("enabled"))              d.enabled               = body["enabled"].get<bool>();
-      if (body.contains("schedule_tasks") && body["schedule_tasks"].is_array()) {
-        const auto& tasks_json = body["schedule_tasks"];
-        size_t count = std::min(tasks_json.size(), size_t(7));
-        if (d.schedule_tasks.size() < 7) d.schedule_tasks.resize(7);
-        for (size_t i = 0; i < count; ++i) {
-          const auto& item = tasks_json[i];
-          auto& task = d.schedule_tasks[i];
-          // weekday 数组 → 位掩码整数：1=周一(bit0), ..., 7=周日(bit6)
-          if (item.contains("weekday") && item["weekday"].is_array()) {
-            int mask = 0;
-            for (const auto& day : item["weekday"]) {
-              int v = day.get<int>();
-              if (v >= 1 && v <= 7) mask |= (1 << (v - 1));
+      // robot_number 只改组帧使用的编号；模拟随机数流、仿真/告警槽位仍用构造时的序号
+      uint16_t robot_number = 0;
+      const bool has_robot_number = body.contains("robot_number");
+      if (has_robot_number && !ParseRobotNumber(body["robot_number"], &robot_number)) {
+        json error; error["success"] = false; error["error"] = "robot_number 无效，须为 0~65535 的整数";
+        res.status = 400; res.set_content(error.dump(), "application/json"); return;
+      }
+      robot->UpdateData([&](RobotData& d) {
+        if (body.contains("lora_power"))           d.lora_params.power     = body["lora_power"].get<int>();
+        if (body.contains("lora_frequency"))       d.lora_params.frequency = body["lora_frequency"].get<int>();
+        if (body.contains("lora_rate"))            d.lora_params.rate      = body["lora_rate"].get<int>();
+        if (has_robot_number)                      d.robot_number          = robot_number;
+        if (body.contains("software_version"))     d.software_version      = body["software_version"].get<std::string>();
+        if (body.contains("parking_position"))     d.parking_position      = body["parking_position"].get<int>();
+        if (body.contains("daytime_scan_protect")) d.daytime_scan_protect  = body["daytime_scan_protect"].get<bool>();
+        if (body.contains("enabled"))              d.enabled               = body["enabled"].get<bool>();
+        if (body.contains("schedule_tasks") && body["schedule_tasks"].is_array()) {
+          const auto& tasks_json = body["schedule_tasks"];
+          size_t count = std::min(tasks_json.size(), size_t(7));
+          for (size_t i = 0; i < count; ++i) {
+            const auto& item = tasks_json[i];
+            auto& task = d.schedule_tasks[i];
+            // weekday 数组 → 位掩码整数：1=周一(bit0), ..., 7=周日(bit6)
+            if (item.contains("weekday") && item["weekday"].is_array()) {
+              int mask = 0;
+              for (const auto& day : item["weekday"]) {
+                int v = day.get<int>();
+                if (v >= 1 && v <= 7) mask |= (1 << (v - 1));
+              }
+              task.weekday = mask;
             }
-            task.weekday = mask;
-          }
-          if (item.contains("run_count")) task.run_count = item["run_count"].get<int>();
-          // time "HH:MM" → hour + minute
-          if (item.contains("time") && item["time"].is_string()) {
-            std::string t = item["time"].get<std::string>();
-            if (t.size() >= 5 && t[2] == ':') {
-              task.hour   = std::stoi(t.substr(0, 2));
-              task.minute = std::stoi(t.substr(3, 2));
+            if (item.contains("run_count")) task.run_count = item["run_count"].get<int>();
+            // time "HH:MM" → hour + minute
+            if (item.contains("time") && item["time"].is_string()) {
+              std::string t = item["time"].get<std::string>();
+              if (t.size() >= 5 && t[2] == ':') {
+                task.hour   = std::stoi(t.substr(0, 2));
+                task.minute = std::stoi(t.substr(3, 2));
+              }
             }
           }
+          robot->NotifyScheduleChanged();
         }
-      }
+      });
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
       json response;
       response["success"]  = true;
@@ -1079,7 +1158,8 @@ void HttpServer::ServerThreadFunc() {
       std::string robot_id = req.get_param_value("robot_id");
       auto robot = findRobotOr404(robot_id, res);
       if (!robot) return;
-      const auto& d = robot->GetData();
+      const auto snapshot = robot->GetDataSnapshot();
+      const auto& d = *snapshot;
       const auto& mp = d.motor_params;
       const auto& tvp = d.temp_voltage_protection;
       json data;
@@ -1114,7 +1194,7 @@ void HttpServer::ServerThreadFunc() {
       response["robot_id"] = robot_id;
       response["data"]     = data;
       res.set_content(response.dump(), "application/json");
-      LOG(INFO) << "API: 获取E1数据 - " << robot_id;
+      TRACE(kHttp, 1) << "API: 获取E1数据 - " << robot_id;
     } catch (const std::exception& e) {
       json error; error["success"] = false; error["error"] = e.what();
       res.status = 500; res.set_content(error.dump(), "application/json");
@@ -1128,35 +1208,36 @@ void HttpServer::ServerThreadFunc() {
       json body = json::parse(req.body);
       auto robot = findRobotOr404(robot_id, res);
       if (!robot) return;
-      auto& d   = robot->GetData();
-      auto& mp  = d.motor_params;
-      auto& tvp = d.temp_voltage_protection;
-      if (body.contains("walk_motor_speed"))                   mp.walk_motor_speed                   = body["walk_motor_speed"].get<int>();
-      if (body.contains("brush_motor_speed"))                  mp.brush_motor_speed                  = body["brush_motor_speed"].get<int>();
-      if (body.contains("windproof_motor_speed"))              mp.windproof_motor_speed              = body["windproof_motor_speed"].get<int>();
-      if (body.contains("walk_motor_max_current_ma"))          mp.walk_motor_max_current_ma          = body["walk_motor_max_current_ma"].get<int>();
-      if (body.contains("brush_motor_max_current_ma"))         mp.brush_motor_max_current_ma         = body["brush_motor_max_current_ma"].get<int>();
-      if (body.contains("windproof_motor_max_current_ma"))     mp.windproof_motor_max_current_ma     = body["windproof_motor_max_current_ma"].get<int>();
-      if (body.contains("walk_motor_warning_current_ma"))      mp.walk_motor_warning_current_ma      = body["walk_motor_warning_current_ma"].get<int>();
-      if (body.contains("brush_motor_warning_current_ma"))     mp.brush_motor_warning_current_ma     = body["brush_motor_warning_current_ma"].get<int>();
-      if (body.contains("windproof_motor_warning_current_ma")) mp.windproof_motor_warning_current_ma = body["windproof_motor_warning_current_ma"].get<int>();
-      if (body.contains("walk_motor_mileage_m"))               mp.walk_motor_mileage_m               = body["walk_motor_mileage_m"].get<int>();
-      if (body.contains("brush_motor_timeout_s"))              mp.brush_motor_timeout_s              = body["brush_motor_timeout_s"].get<int>();
-      if (body.contains("windproof_motor_timeout_s"))          mp.windproof_motor_timeout_s          = body["windproof_motor_timeout_s"].get<int>();
-      if (body.contains("reverse_time_s"))                     mp.reverse_time_s                     = body["reverse_time_s"].get<int>();
-      if (body.contains("protection_angle"))                   mp.protection_angle                   = body["protection_angle"].get<int>();
-      if (body.contains("protection_current_ma"))    tvp.protection_current_ma    = body["protection_current_ma"].get<int>();
-      if (body.contains("high_temp_threshold"))      tvp.high_temp_threshold      = body["high_temp_threshold"].get<int>();
-      if (body.contains("low_temp_threshold"))       tvp.low_temp_threshold       = body["low_temp_threshold"].get<int>();
-      if (body.contains("protection_temp"))          tvp.protection_temp          = body["protection_temp"].get<int>();
-      if (body.contains("recovery_temp"))            tvp.recovery_temp            = body["recovery_temp"].get<int>();
-      if (body.contains("protection_voltage"))       tvp.protection_voltage       = body["protection_voltage"].get<int>();
-      if (body.contains("recovery_voltage"))         tvp.recovery_voltage         = body["recovery_voltage"].get<int>();
-      if (body.contains("protection_battery_level")) tvp.protection_battery_level = body["protection_battery_level"].get<int>();
-      if (body.contains("limit_run_battery_level"))  tvp.limit_run_battery_level  = body["limit_run_battery_level"].get<int>();
-      if (body.contains("recovery_battery_level"))   tvp.recovery_battery_level   = body["recovery_battery_level"].get<int>();
-      if (body.contains("board_protection_temp"))    tvp.board_protection_temp    = body["board_protection_temp"].get<int>();
-      if (body.contains("board_recovery_temp"))      tvp.board_recovery_temp      = body["board_recovery_temp"].get<int>();
+      robot->UpdateData([&](RobotData& d) {
+        auto& mp  = d.motor_params;
+        auto& tvp = d.temp_voltage_protection;
+        if (body.contains("walk_motor_speed"))                   mp.walk_motor_speed                   = body["walk_motor_speed"].get<int>();
+        if (body.contains("brush_motor_speed"))                  mp.brush_motor_speed                  = body["brush_motor_speed"].get<int>();
+        if (body.contains("windproof_motor_speed"))              mp.windproof_motor_speed              = body["windproof_motor_speed"].get<int>();
+        if (body.contains("walk_motor_max_current_ma"))          mp.walk_motor_max_current_ma          = body["walk_motor_max_current_ma"].get<int>();
+        if (body.contains("brush_motor_max_current_ma"))         mp.brush_motor_max_current_ma         = body["brush_motor_max_current_ma"].get<int>();
+        if (body.contains("windproof_motor_max_current_ma"))     mp.windproof_motor_max_current_ma     = body["windproof_motor_max_current_ma"].get<int>();
+        if (body.contains("walk_motor_warning_current_ma"))      mp.walk_motor_warning_current_ma      = body["walk_motor_warning_current_ma"].get<int>();
+        if (body.contains("brush_motor_warning_current_ma"))     mp.brush_motor_warning_current_ma     = body["brush_motor_warning_current_ma"].get<int>();
+        if (body.contains("windproof_motor_warning_current_ma")) mp.windproof_motor_warning_current_ma = body["windproof_motor_warning_current_ma"].get<int>();
+        if (body.contains("walk_motor_mileage_m"))               mp.walk_motor_mileage_m               = body["walk_motor_mileage_m"].get<int>();
+        if (body.contains("brush_motor_timeout_s"))              mp.brush_motor_timeout_s              = body["brush_motor_timeout_s"].get<int>();
+        if (body.contains("windproof_motor_timeout_s"))          mp.windproof_motor_timeout_s          = body["windproof_motor_timeout_s"].get<int>();
+        if (body.contains("reverse_time_s"))                     mp.reverse_time_s                     = body["reverse_time_s"].get<int>();
+        if (body.contains("protection_angle"))                   mp.protection_angle                   = body["protection_angle"].get<int>();
+        if (body.contains("protection_current_ma"))    tvp.protection_current_ma    = body["protection_current_ma"].get<int>();
+        if (body.contains("high_temp_threshold"))      tvp.high_temp_threshold      = body["high_temp_threshold"].get<int>();
+        if (body.contains("low_temp_threshold"))       tvp.low_temp_threshold       = body["low_temp_threshold"].get<int>();
+        if (body.contains("protection_temp"))          tvp.protection_temp          = body["protection_temp"].get<int>();
+        if (body.contains("recovery_temp"))            tvp.recovery_temp            = body["recovery_temp"].get<int>();
+        if (body.contains("protection_voltage"))       tvp.protection_voltage       = body["protection_voltage"].get<int>();
+        if (body.contains("recovery_voltage"))         tvp.recovery_voltage         = body["recovery_voltage"].get<int>();
+        if (body.contains("protection_battery_level")) tvp.protection_battery_level = body["protection_battery_level"].get<int>();
+        if (body.contains("limit_run_battery_level"))  tvp.limit_run_battery_level  = body["limit_run_battery_level"].get<int>();
+        if (body.contains("recovery_battery_level"))   tvp.recovery_battery_level   = body["recovery_battery_level"].get<int>();
+        if (body.contains("board_protection_temp"))    tvp.board_protection_temp    = body["board_protection_temp"].get<int>();
+        if (body.contains("board_recovery_temp"))      tvp.board_recovery_temp      = body["board_recovery_temp"].get<int>();
+      });
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
       json response;
       response["success"]  = true;
@@ -1176,7 +1257,8 @@ void HttpServer::ServerThreadFunc() {
       std::string robot_id = req.get_param_value("robot_id");
       auto robot = findRobotOr404(robot_id, res);
       if (!robot) return;
-      const auto& d = robot->GetData();
+      const auto snapshot = robot->GetDataSnapshot();
+      const auto& d = *snapshot;
       json data;
       data["alarm_fa"]            = d.alarm_fa;
       data["alarm_fb"]            = d.alarm_fb;
@@ -1204,7 +1286,7 @@ void HttpServer::ServerThreadFunc() {
       response["robot_id"] = robot_id;
       response["data"]     = data;
       res.set_content(response.dump(), "application/json");
-      LOG(INFO) << "API: 获取E4数据 - " << robot_id;
+      TRACE(kHttp, 1) << "API: 获取E4数据 - " << robot_id;
     } catch (const std::exception& e) {
       json error; error["success"] = false; error["error"] = e.what();
       res.status = 500; res.set_content(error.dump(), "application/json");
@@ -1218,28 +1300,29 @@ void HttpServer::ServerThreadFunc() {
       json body = json::parse(req.body);
       auto robot = findRobotOr404(robot_id, res);
       if (!robot) return;
-      auto& d = robot->GetData();
-      if (body.contains("alarm_fa"))            d.alarm_fa            = body["alarm_fa"].get<uint32_t>();
-      if (body.contains("alarm_fb"))            d.alarm_fb            = static_cast<uint16_t>(body["alarm_fb"].get<uint32_t>());
-      if (body.contains("alarm_fc"))            d.alarm_fc            = body["alarm_fc"].get<uint32_t>();
-      if (body.contains("alarm_fd"))            d.alarm_fd            = static_cast<uint16_t>(body["alarm_fd"].get<uint32_t>());
-      if (body.contains("main_motor_current"))  d.main_motor_current  = body["main_motor_current"].get<int>();
-      if (body.contains("slave_motor_current")) d.slave_motor_current = body["slave_motor_current"].get<int>();
-      if (body.contains("battery_voltage"))     d.battery_voltage     = body["battery_voltage"].get<int>();
-      if (body.contains("battery_current"))     d.battery_current     = body["battery_current"].get<int>();
-      if (body.contains("battery_status"))      d.battery_status      = body["battery_status"].get<int>();
-      if (body.contains("battery_level"))       d.battery_level       = body["battery_level"].get<int>();
-      if (body.contains("battery_temperature")) d.battery_temperature = body["battery_temperature"].get<int>();
-      if (body.contains("position_info"))       d.position_info       = body["position_info"].get<std::string>();
-      if (body.contains("working_duration"))    d.working_duration    = body["working_duration"].get<int>();
-      if (body.contains("total_run_count"))     d.total_run_count     = body["total_run_count"].get<int>();
-      if (body.contains("current_lap_count"))   d.current_lap_count   = body["current_lap_count"].get<int>();
-      if (body.contains("solar_voltage"))       d.solar_voltage       = body["solar_voltage"].get<int>();
-      if (body.contains("solar_current"))       d.solar_current       = body["solar_current"].get<int>();
-      if (body.contains("board_temperature"))   d.board_temperature   = body["board_temperature"].get<int>();
-      if (body.contains("timestamp_hour"))      d.current_timestamp.hour   = body["timestamp_hour"].get<int>();
-      if (body.contains("timestamp_minute"))    d.current_timestamp.minute = body["timestamp_minute"].get<int>();
-      if (body.contains("timestamp_second"))    d.current_timestamp.second = body["timestamp_second"].get<int>();
+      robot->UpdateData([&](RobotData& d) {
+        if (body.contains("alarm_fa"))            d.alarm_fa            = body["alarm_fa"].get<uint32_t>();
+        if (body.contains("alarm_fb"))            d.alarm_fb            = static_cast<uint16_t>(body["alarm_fb"].get<uint32_t>());
+        if (body.contains("alarm_fc"))            d.alarm_fc            = body["alarm_fc"].get<uint32_t>();
+        if (body.contains("alarm_fd"))            d.alarm_fd            = static_cast<uint16_t>(body["alarm_fd"].get<uint32_t>());
+        if (body.contains("main_motor_current"))  d.main_motor_current  = body["main_motor_current"].get<int>();
+        if (body.contains("slave_motor_current")) d.slave_motor_current = body["slave_motor_current"].get<int>();
+        if (body.contains("battery_voltage"))     d.battery_voltage     = body["battery_voltage"].get<int>();
+        if (body.contains("battery_current"))     d.battery_current     = body["battery_current"].get<int>();
+        if (body.contains("battery_status"))      d.battery_status      = body["battery_status"].get<int>();
+        if (body.contains("battery_level"))       d.battery_level       = body["battery_level"].get<int>();
+        if (body.contains("battery_temperature")) d.battery_temperature = body["battery_temperature"].get<int>();
+        if (body.contains("position_info"))       d.position_info       = body["position_info"].get<std::string>();
+        if (body.contains("working_duration"))    d.working_duration    = body["working_duration"].get<int>();
+        if (body.contains("total_run_count"))     d.total_run_count     = body["total_run_count"].get<int>();
+        if (body.contains("current_lap_count"))   d.current_lap_count   = body["current_lap_count"].get<int>();
+        if (body.contains("solar_voltage"))       d.solar_voltage       = body["solar_voltage"].get<int>();
+        if (body.contains("solar_current"))       d.solar_current       = body["solar_current"].get<int>();
+        if (body.contains("board_temperature"))   d.board_temperature   = body["board_temperature"].get<int>();
+        if (body.contains("timestamp_hour"))      d.current_timestamp.hour   = body["timestamp_hour"].get<int>();
+        if (body.contains("timestamp_minute"))    d.current_timestamp.minute = body["timestamp_minute"].get<int>();
+        if (body.contains("timestamp_second"))    d.current_timestamp.second = body["timestamp_second"].get<int>();
+      });
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
       json response;
       response["success"]  = true;
@@ -1259,7 +1342,8 @@ void HttpServer::ServerThreadFunc() {
       std::string robot_id = req.get_param_value("robot_id");
       auto robot = findRobotOr404(robot_id, res);
       if (!robot) return;
-      const auto& d = robot->GetData();
+      const auto snapshot = robot->GetDataSnapshot();
+      const auto& d = *snapshot;
       json data;
       data["scheduled_not_run_id"]     = d.scheduled_not_run_id;
       data["scheduled_not_run_reason"] = d.scheduled_not_run_reason;
@@ -1283,7 +1367,7 @@ void HttpServer::ServerThreadFunc() {
       response["robot_id"] = robot_id;
       response["data"]     = data;
       res.set_content(response.dump(), "application/json");
-      LOG(INFO) << "API: 获取E6数据 - " << robot_id;
+      TRACE(kHttp, 1) << "API: 获取E6数据 - " << robot_id;
     } catch (const std::exception& e) {
       json error; error["success"] = false; error["error"] = e.what();
       res.status = 500; res.set_content(error.dump(), "application/json");
@@ -1297,21 +1381,23 @@ void HttpServer::ServerThreadFunc() {
       json body = json::parse(req.body);
       auto robot = findRobotOr404(robot_id, res);
       if (!robot) return;
-      auto& d = robot->GetData();
-      if (body.contains("scheduled_not_run_id"))
-        d.scheduled_not_run_id = static_cast<uint8_t>(body["scheduled_not_run_id"].get<int>());
-      if (body.contains("scheduled_not_run_reason"))
-        d.scheduled_not_run_reason = static_cast<uint8_t>(body["scheduled_not_run_reason"].get<int>());
-      if (body.contains("e6_alarm"))             d.e6_alarm            = body["e6_alarm"].get<uint32_t>();
-      // 写入对应定时任务的星期/时/分/运行次数
-      int task_idx = static_cast<int>(d.scheduled_not_run_id) - 1;
-      if (task_idx >= 0 && task_idx < static_cast<int>(d.schedule_tasks.size())) {
-        auto& t = d.schedule_tasks[task_idx];
-        if (body.contains("weekday"))   t.weekday   = body["weekday"].get<int>();
-        if (body.contains("hour"))      t.hour      = body["hour"].get<int>();
-        if (body.contains("minute"))    t.minute    = body["minute"].get<int>();
-        if (body.contains("run_count")) t.run_count = body["run_count"].get<int>();
-      }
+      robot->UpdateData([&](RobotData& d) {
+        if (body.contains("scheduled_not_run_id"))
+          d.scheduled_not_run_id = static_cast<uint8_t>(body["scheduled_not_run_id"].get<int>());
+        if (body.contains("scheduled_not_run_reason"))
+          d.scheduled_not_run_reason = static_cast<uint8_t>(body["scheduled_not_run_reason"].get<int>());
+        if (body.contains("e6_alarm"))             d.e6_alarm            = body["e6_alarm"].get<uint32_t>();
+        // 写入对应定时任务的星期/时/分/运行次数
+        int task_idx = static_cast<int>(d.scheduled_not_run_id) - 1;
+        if (task_idx >= 0 && task_idx < static_cast<int>(d.schedule_tasks.size())) {
+          auto& t = d.schedule_tasks[task_idx];
+          if (body.contains("weekday"))   t.weekday   = body["weekday"].get<int>();
+          if (body.contains("hour"))      t.hour      = body["hour"].get<int>();
+          if (body.contains("minute"))    t.minute    = body["minute"].get<int>();
+          if (body.contains("run_count")) t.run_count = body["run_count"].get<int>();
+          robot->NotifyScheduleChanged();
+        }
+      });
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
       json response;
       response["success"]  = true;
@@ -1331,7 +1417,8 @@ void HttpServer::ServerThreadFunc() {
       std::string robot_id = req.get_param_value("robot_id");
       auto robot = findRobotOr404(robot_id, res);
       if (!robot) return;
-      const auto& d = robot->GetData();
+      const auto snapshot = robot->GetDataSnapshot();
+      const auto& d = *snapshot;
       json data;
       data["not_started_reason"] = d.not_started_reason;
       data["e7_alarm"]           = d.e7_alarm;
@@ -1340,7 +1427,7 @@ void HttpServer::ServerThreadFunc() {
       response["robot_id"] = robot_id;
       response["data"]     = data;
       res.set_content(response.dump(), "application/json");
-      LOG(INFO) << "API: 获取E7数据 - " << robot_id;
+      TRACE(kHttp, 1) << "API: 获取E7数据 - " << robot_id;
     } catch (const std::exception& e) {
       json error; error["success"] = false; error["error"] = e.what();
       res.status = 500; res.set_content(error.dump(), "application/json");
@@ -1354,10 +1441,11 @@ void HttpServer::ServerThreadFunc() {
       json body = json::parse(req.body);
       auto robot = findRobotOr404(robot_id, res);
       if (!robot) return;
-      auto& d = robot->GetData();
-      if (body.contains("not_started_reason"))
-        d.not_started_reason = static_cast<uint8_t>(body["not_started_reason"].get<int>());
-      if (body.contains("e7_alarm"))             d.e7_alarm            = body["e7_alarm"].get<uint32_t>();
+      robot->UpdateData([&](RobotData& d) {
+        if (body.contains("not_started_reason"))
+          d.not_started_reason = static_cast<uint8_t>(body["not_started_reason"].get<int>());
+        if (body.contains("e7_alarm"))             d.e7_alarm            = body["e7_alarm"].get<uint32_t>();
+      });
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
       json response;
       response["success"]  = true;
@@ -1377,7 +1465,8 @@ void HttpServer::ServerThreadFunc() {
       std::string robot_id = req.get_param_value("robot_id");
       auto robot = findRobotOr404(robot_id, res);
       if (!robot) return;
-      const auto& d = robot->GetData();
+      const auto snapshot = robot->GetDataSnapshot();
+      const auto& d = *snapshot;
       json data;
       data["startup_confirm_id"] = d.startup_confirm_id;
       data["not_started_reason"] = d.not_started_reason;
@@ -1387,7 +1476,7 @@ void HttpServer::ServerThreadFunc() {
       response["robot_id"] = robot_id;
       response["data"]     = data;
       res.set_content(response.dump(), "application/json");
-      LOG(INFO) << "API: 获取E8数据 - " << robot_id;
+      TRACE(kHttp, 1) << "API: 获取E8数据 - " << robot_id;
     } catch (const std::exception& e) {
       json error; error["success"] = false; error["error"] = e.what();
       res.status = 500; res.set_content(error.dump(), "application/json");
@@ -1401,12 +1490,13 @@ void HttpServer::ServerThreadFunc() {
       json body = json::parse(req.body);
       auto robot = findRobotOr404(robot_id, res);
       if (!robot) return;
-      auto& d = robot->GetData();
-      if (body.contains("startup_confirm_id"))
-        d.startup_confirm_id = static_cast<uint8_t>(body["startup_confirm_id"].get<int>());
-      if (body.contains("not_started_reason"))
-        d.not_started_reason = static_cast<uint8_t>(body["not_started_reason"].get<int>());
-      if (body.contains("e8_alarm"))             d.e8_alarm            = body["e8_alarm"].get<uint32_t>();
+      robot->UpdateData([&](RobotData& d) {
+        if (body.contains("startup_confirm_id"))
+          d.startup_confirm_id = static_cast<uint8_t>(body["startup_confirm_id"].get<int>());
+        if (body.contains("not_started_reason"))
+          d.not_started_reason = static_cast<uint8_t>(body["not_started_reason"].get<int>());
+        if (body.contains("e8_alarm"))             d.e8_alarm            = body["e8_alarm"].get<uint32_t>();
+      });
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
       json response;
       response["success"]  = true;
@@ -1506,18 +1596,20 @@ void HttpServer::ServerThreadFunc() {
       }
 
       // 更新告警值
-      if (body.contains("alarm_fa")) {
-        robot->GetData().alarm_fa = body["alarm_fa"].get<uint32_t>();
-      }
-      if (body.contains("alarm_fb")) {
-        robot->GetData().alarm_fb = body["alarm_fb"].get<uint16_t>();
-      }
-      if (body.contains("alarm_fc")) {
-        robot->GetData().alarm_fc = body["alarm_fc"].get<uint32_t>();
-      }
-      if (body.contains("alarm_fd")) {
-        robot->GetData().alarm_fd = body["alarm_fd"].get<uint16_t>();
-      }
+      robot->UpdateData([&](RobotData& d) {
+        if (body.contains("alarm_fa")) {
+          d.alarm_fa = body["alarm_fa"].get<uint32_t>();
+        }
+        if (body.contains("alarm_fb")) {
+          d.alarm_fb = body["alarm_fb"].get<uint16_t>();
+        }
+        if (body.contains("alarm_fc")) {
+          d.alarm_fc = body["alarm_fc"].get<uint32_t>();
+        }
+        if (body.contains("alarm_fd")) {
+          d.alarm_fd = body["alarm_fd"].get<uint16_t>();
+        }
+      });
 
       // 通过Robot统一接口更新告警到数据库
       robot->UpdateAlarmsToDb();
@@ -1547,7 +1639,8 @@ void HttpServer::ServerThreadFunc() {
         json error; error["success"] = false; error["error"] = "机器人不存在或未运行";
         res.status = 404; res.set_content(error.dump(), "application/json"); return;
       }
-      const auto& mp = robot->GetData().motor_params;
+      const auto snapshot = robot->GetDataSnapshot();
+      const auto& mp = snapshot->motor_params;
       json data;
       data["walk_motor_speed"]                   = mp.walk_motor_speed;
       data["brush_motor_speed"]                  = mp.brush_motor_speed;
@@ -1633,21 +1726,23 @@ void HttpServer::ServerThreadFunc() {
 
       // 同步到内存 data_ 并持久化到数据库
       {
-        auto& mp = robot->GetData().motor_params;
-        mp.walk_motor_speed                   = static_cast<uint8_t>(body["walk_motor_speed"].get<int>());
-        mp.brush_motor_speed                  = static_cast<uint8_t>(body["brush_motor_speed"].get<int>());
-        mp.windproof_motor_speed              = static_cast<uint8_t>(body["windproof_motor_speed"].get<int>());
-        mp.walk_motor_max_current_ma          = static_cast<uint16_t>(body["walk_motor_max_current_ma"].get<int>());
-        mp.brush_motor_max_current_ma         = static_cast<uint16_t>(body["brush_motor_max_current_ma"].get<int>());
-        mp.windproof_motor_max_current_ma     = static_cast<uint16_t>(body["windproof_motor_max_current_ma"].get<int>());
-        mp.walk_motor_warning_current_ma      = static_cast<uint16_t>(body["walk_motor_warning_current_ma"].get<int>());
-        mp.brush_motor_warning_current_ma     = static_cast<uint16_t>(body["brush_motor_warning_current_ma"].get<int>());
-        mp.windproof_motor_warning_current_ma = static_cast<uint16_t>(body["windproof_motor_warning_current_ma"].get<int>());
-        mp.walk_motor_mileage_m               = static_cast<uint16_t>(body["walk_motor_mileage_m"].get<int>());
-        mp.brush_motor_timeout_s              = static_cast<uint16_t>(body["brush_motor_timeout_s"].get<int>());
-        mp.windproof_motor_timeout_s          = static_cast<uint16_t>(body["windproof_motor_timeout_s"].get<int>());
-        mp.reverse_time_s                     = static_cast<uint8_t>(body["reverse_time_s"].get<int>());
-        mp.protection_angle                   = static_cast<uint8_t>(body["protection_angle"].get<int>());
+        robot->UpdateData([&](RobotData& d) {
+          auto& mp = d.motor_params;
+          mp.walk_motor_speed                   = static_cast<uint8_t>(body["walk_motor_speed"].get<int>());
+          mp.brush_motor_speed                  = static_cast<uint8_t>(body["brush_motor_speed"].get<int>());
+          mp.windproof_motor_speed              = static_cast<uint8_t>(body["windproof_motor_speed"].get<int>());
+          mp.walk_motor_max_current_ma          = static_cast<uint16_t>(body["walk_motor_max_current_ma"].get<int>());
+          mp.brush_motor_max_current_ma         = static_cast<uint16_t>(body["brush_motor_max_current_ma"].get<int>());
+          mp.windproof_motor_max_current_ma     = static_cast<uint16_t>(body["windproof_motor_max_current_ma"].get<int>());
+          mp.walk_motor_warning_current_ma      = static_cast<uint16_t>(body["walk_motor_warning_current_ma"].get<int>());
+          mp.brush_motor_warning_current_ma     = static_cast<uint16_t>(body["brush_motor_warning_current_ma"].get<int>());
+          mp.windproof_motor_warning_current_ma = static_cast<uint16_t>(body["windproof_motor_warning_current_ma"].get<int>());
+          mp.walk_motor_mileage_m               = static_cast<uint16_t>(body["walk_motor_mileage_m"].get<int>());
+          mp.brush_motor_timeout_s              = static_cast<uint16_t>(body["brush_motor_timeout_s"].get<int>());
+          mp.windproof_motor_timeout_s          = static_cast<uint16_t>(body["windproof_motor_timeout_s"].get<int>());
+          mp.reverse_time_s                     = static_cast<uint8_t>(body["reverse_time_s"].get<int>());
+          mp.protection_angle                   = static_cast<uint8_t>(body["protection_angle"].get<int>());
+        });
         config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
       }
 
@@ -1676,7 +1771,8 @@ void HttpServer::ServerThreadFunc() {
         json error; error["success"] = false; error["error"] = "机器人不存在或未运行";
         res.status = 404; res.set_content(error.dump(), "application/json"); return;
       }
-      const auto& tv = robot->GetData().temp_voltage_protection;
+      const auto snapshot = robot->GetDataSnapshot();
+      const auto& tv = snapshot->temp_voltage_protection;
       json data;
       data["protection_current_ma"]    = tv.protection_current_ma;
       data["high_temp_threshold"]      = tv.high_temp_threshold;
@@ -1743,17 +1839,19 @@ void HttpServer::ServerThreadFunc() {
 
       // 同步到内存 data_ 并持久化到数据库
       {
-        auto& tv = robot->GetData().temp_voltage_protection;
-        tv.protection_current_ma    = static_cast<uint16_t>(body["protection_current_ma"].get<int>());
-        tv.high_temp_threshold      = static_cast<uint8_t>(body["high_temp_threshold"].get<int>());
-        tv.low_temp_threshold       = static_cast<uint8_t>(body["low_temp_threshold"].get<int>());
-        tv.protection_temp          = static_cast<uint8_t>(body["protection_temp"].get<int>());
-        tv.recovery_temp            = static_cast<uint8_t>(body["recovery_temp"].get<int>());
-        tv.protection_voltage       = static_cast<uint8_t>(body["protection_voltage"].get<int>());
-        tv.recovery_voltage         = static_cast<uint8_t>(body["recovery_voltage"].get<int>());
-        tv.protection_battery_level = static_cast<uint8_t>(body["protection_battery_level"].get<int>());
-        tv.limit_run_battery_level  = static_cast<uint8_t>(body["limit_run_battery_level"].get<int>());
-        tv.recovery_battery_level   = static_cast<uint8_t>(body["recovery_battery_level"].get<int>());
+        robot->UpdateData([&](RobotData& d) {
+          auto& tv = d.temp_voltage_protection;
+          tv.protection_current_ma    = static_cast<uint16_t>(body["protection_current_ma"].get<int>());
+          tv.high_temp_threshold      = static_cast<uint8_t>(body["high_temp_threshold"].get<int>());
+          tv.low_temp_threshold       = static_cast<uint8_t>(body["low_temp_threshold"].get<int>());
+          tv.protection_temp          = static_cast<uint8_t>(body["protection_temp"].get<int>());
+          tv.recovery_temp            = static_cast<uint8_t>(body["recovery_temp"].get<int>());
+          tv.protection_voltage       = static_cast<uint8_t>(body["protection_voltage"].get<int>());
+          tv.recovery_voltage         = static_cast<uint8_t>(body["recovery_voltage"].get<int>());
+          tv.protection_battery_level = static_cast<uint8_t>(body["protection_battery_level"].get<int>());
+          tv.limit_run_battery_level  = static_cast<uint8_t>(body["limit_run_battery_level"].get<int>());
+          tv.recovery_battery_level   = static_cast<uint8_t>(body["recovery_battery_level"].get<int>());
+        });
         config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
       }
 
@@ -1783,7 +1881,8 @@ void HttpServer::ServerThreadFunc() {
         res.status = 404; res.set_content(error.dump(), "application/json"); return;
       }
       json tasks_json = json::array();
-      for (const auto& task : robot->GetData().schedule_tasks) {
+      const auto snapshot = robot->GetDataSnapshot();
+      for (const auto& task : snapshot->schedule_tasks) {
         json t;
         t["weekday"]   = task.weekday;
         t["hour"]      = task.hour;
@@ -1824,8 +1923,7 @@ void HttpServer::ServerThreadFunc() {
         return;
       }
 
-      std::vector<ScheduleTask> tasks;
-      tasks.reserve(7);
+      ScheduleTaskList tasks;
       for (size_t i = 0; i < 7; ++i) {
         const auto& item = tasks_json[i];
         if (!item.contains("weekday") || !item.contains("hour") ||
@@ -1838,12 +1936,11 @@ void HttpServer::ServerThreadFunc() {
           return;
         }
 
-        ScheduleTask task;
+        ScheduleTask& task = tasks[i];
         task.weekday = item["weekday"].get<int>();
         task.hour = item["hour"].get<int>();
         task.minute = item["minute"].get<int>();
         task.run_count = item["run_count"].get<int>();
-        tasks.push_back(task);
       }
 
       auto robot = mqtt_manager_->GetRobot(robot_id);
@@ -1859,7 +1956,8 @@ void HttpServer::ServerThreadFunc() {
       robot->SendScheduleParamsRequest(tasks);
 
       // 同步到内存 data_ 并持久化到数据库
-      robot->GetData().schedule_tasks = tasks;
+      robot->UpdateData([&](RobotData& d) { d.schedule_tasks = tasks; });
+      robot->NotifyScheduleChanged();
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
 
       json response;
@@ -1888,7 +1986,7 @@ void HttpServer::ServerThreadFunc() {
         res.status = 404; res.set_content(error.dump(), "application/json"); return;
       }
       json response; response["success"] = true; response["robot_id"] = robot_id;
-      response["parking_position"] = robot->GetData().parking_position;
+      response["parking_position"] = robot->GetDataSnapshot()->parking_position;
       res.set_content(response.dump(), "application/json");
     } catch (const std::exception& e) {
       json error; error["success"] = false; error["error"] = e.what();
@@ -1924,7 +2022,7 @@ void HttpServer::ServerThreadFunc() {
       robot->SendParkingPositionRequest(parking_position);
 
       // 同步到内存 data_ 并持久化到数据库
-      robot->GetData().parking_position = parking_position;
+      robot->UpdateData([&](RobotData& d) { d.parking_position = parking_position; });
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
 
       json response;
@@ -1953,7 +2051,8 @@ void HttpServer::ServerThreadFunc() {
         json error; error["success"] = false; error["error"] = "机器人不存在或未运行";
         res.status = 404; res.set_content(error.dump(), "application/json"); return;
       }
-      const auto& lp = robot->GetData().lora_params;
+      const auto snapshot = robot->GetDataSnapshot();
+      const auto& lp = snapshot->lora_params;
       json response; response["success"] = true; response["robot_id"] = robot_id;
       response["power"]     = lp.power;
       response["frequency"] = lp.frequency;
@@ -1990,9 +2089,11 @@ void HttpServer::ServerThreadFunc() {
         return;
       }
 
-      robot->GetData().lora_params.power     = body["power"].get<int>();
-      robot->GetData().lora_params.frequency = body["frequency"].get<int>();
-      robot->GetData().lora_params.rate      = body["rate"].get<int>();
+      robot->UpdateData([&](RobotData& d) {
+        d.lora_params.power     = body["power"].get<int>();
+        d.lora_params.frequency = body["frequency"].get<int>();
+        d.lora_params.rate      = body["rate"].get<int>();
+      });
       robot->SendLoraAndCleanSettingsReport();
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
 
@@ -2022,7 +2123,7 @@ void HttpServer::ServerThreadFunc() {
         res.status = 404; res.set_content(error.dump(), "application/json"); return;
       }
       json response; response["success"] = true; response["robot_id"] = robot_id;
-      response["enabled"] = robot->GetData().daytime_scan_protect;
+      response["enabled"] = robot->GetDataSnapshot()->daytime_scan_protect;
       res.set_content(response.dump(), "application/json");
     } catch (const std::exception& e) {
       json error; error["success"] = false; error["error"] = e.what();
@@ -2055,7 +2156,8 @@ void HttpServer::ServerThreadFunc() {
         return;
       }
 
-      robot->GetData().daytime_scan_protect = body["enabled"].get<bool>();
+      const bool enabled = body["enabled"].get<bool>();
+      robot->UpdateData([&](RobotData& d) { d.daytime_scan_protect = enabled; });
       robot->SendLoraAndCleanSettingsReport();
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
 
@@ -2063,7 +2165,7 @@ void HttpServer::ServerThreadFunc() {
       response["success"] = true;
       response["message"] = "白天防误扫设置已发送";
       response["robot_id"] = robot_id;
-      response["enabled"] = robot->GetData().daytime_scan_protect;
+      response["enabled"] = enabled;
       res.set_content(response.dump(), "application/json");
       LOG(INFO) << "API: 设置白天防误扫 - 机器人: " << robot_id;
     } catch (const std::exception& e) {
@@ -2085,7 +2187,8 @@ void HttpServer::ServerThreadFunc() {
         json error; error["success"] = false; error["error"] = "机器人不存在或未运行";
         res.status = 404; res.set_content(error.dump(), "application/json"); return;
       }
-      const auto& d = robot->GetData();
+      const auto snapshot = robot->GetDataSnapshot();
+      const auto& d = *snapshot;
       json data;
       data["main_motor_current"]  = d.main_motor_current;
       data["slave_motor_current"] = d.slave_motor_current;
@@ -2110,7 +2213,7 @@ void HttpServer::ServerThreadFunc() {
       response["robot_id"] = robot_id;
       response["data"]     = data;
       res.set_content(response.dump(), "application/json");
-      LOG(INFO) << "API: 获取机器人运行数据 - " << robot_id;
+      TRACE(kHttp, 1) << "API: 获取机器人运行数据 - " << robot_id;
     } catch (const std::exception& e) {
       json error; error["success"] = false; error["error"] = e.what();
       res.status = 500; res.set_content(error.dump(), "application/json");
@@ -2127,25 +2230,26 @@ void HttpServer::ServerThreadFunc() {
         json error; error["success"] = false; error["error"] = "机器人不存在或未运行";
         res.status = 404; res.set_content(error.dump(), "application/json"); return;
       }
-      auto& d = robot->GetData();
-      if (body.contains("main_motor_current"))  d.main_motor_current  = body["main_motor_current"].get<int>();
-      if (body.contains("slave_motor_current")) d.slave_motor_current = body["slave_motor_current"].get<int>();
-      if (body.contains("battery_voltage"))     d.battery_voltage     = body["battery_voltage"].get<int>();
-      if (body.contains("battery_current"))     d.battery_current     = body["battery_current"].get<int>();
-      if (body.contains("battery_status"))      d.battery_status      = body["battery_status"].get<int>();
-      if (body.contains("battery_level"))       d.battery_level       = body["battery_level"].get<int>();
-      if (body.contains("battery_temperature")) d.battery_temperature = body["battery_temperature"].get<int>();
-      if (body.contains("position"))            d.position            = body["position"].get<int>();
-      if (body.contains("working_duration"))    d.working_duration    = body["working_duration"].get<int>();
-      if (body.contains("solar_voltage"))       d.solar_voltage       = body["solar_voltage"].get<int>();
-      if (body.contains("solar_current"))       d.solar_current       = body["solar_current"].get<int>();
-      if (body.contains("total_run_count"))     d.total_run_count     = body["total_run_count"].get<int>();
-      if (body.contains("current_lap_count"))   d.current_lap_count   = body["current_lap_count"].get<int>();
-      if (body.contains("board_temperature"))   d.board_temperature   = body["board_temperature"].get<int>();
-      if (body.contains("alarm_fa"))            d.alarm_fa            = body["alarm_fa"].get<int>();
-      if (body.contains("alarm_fb"))            d.alarm_fb            = body["alarm_fb"].get<int>();
-      if (body.contains("alarm_fc"))            d.alarm_fc            = body["alarm_fc"].get<int>();
-      if (body.contains("alarm_fd"))            d.alarm_fd            = body["alarm_fd"].get<int>();
+      robot->UpdateData([&](RobotData& d) {
+        if (body.contains("main_motor_current"))  d.main_motor_current  = body["main_motor_current"].get<int>();
+        if (body.contains("slave_motor_current")) d.slave_motor_current = body["slave_motor_current"].get<int>();
+        if (body.contains("battery_voltage"))     d.battery_voltage     = body["battery_voltage"].get<int>();
+        if (body.contains("battery_current"))     d.battery_current     = body["battery_current"].get<int>();
+        if (body.contains("battery_status"))      d.battery_status      = body["battery_status"].get<int>();
+        if (body.contains("battery_level"))       d.battery_level       = body["battery_level"].get<int>();
+        if (body.contains("battery_temperature")) d.battery_temperature = body["battery_temperature"].get<int>();
+        if (body.contains("position"))            d.position            = body["position"].get<int>();
+        if (body.contains("working_duration"))    d.working_duration    = body["working_duration"].get<int>();
+        if (body.contains("solar_voltage"))       d.solar_voltage       = body["solar_voltage"].get<int>();
+        if (body.contains("solar_current"))       d.solar_current       = body["solar_current"].get<int>();
+        if (body.contains("total_run_count"))     d.total_run_count     = body["total_run_count"].get<int>();
+        if (body.contains("current_lap_count"))   d.current_lap_count   = body["current_lap_count"].get<int>();
+        if (body.contains("board_temperature"))   d.board_temperature   = body["board_temperature"].get<int>();
+        if (body.contains("alarm_fa"))            d.alarm_fa            = body["alarm_fa"].get<int>();
+        if (body.contains("alarm_fb"))            d.alarm_fb            = body["alarm_fb"].get<int>();
+        if (body.contains("alarm_fc"))            d.alarm_fc            = body["alarm_fc"].get<int>();
+        if (body.contains("alarm_fd"))            d.alarm_fd            = body["alarm_fd"].get<int>();
+      });
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
       json response;
       response["success"]  = true;
@@ -2177,26 +2281,27 @@ void HttpServer::ServerThreadFunc() {
         return;
       }
 
-      auto& d = robot->GetData();
-      if (body.contains("main_motor_current"))  d.main_motor_current  = body["main_motor_current"].get<int>();
-      if (body.contains("slave_motor_current")) d.slave_motor_current = body["slave_motor_current"].get<int>();
-      if (body.contains("battery_voltage"))     d.battery_voltage     = body["battery_voltage"].get<int>();
-      if (body.contains("battery_current"))     d.battery_current     = body["battery_current"].get<int>();
-      if (body.contains("battery_status"))      d.battery_status      = body["battery_status"].get<int>();
-      if (body.contains("battery_level"))       d.battery_level       = body["battery_level"].get<int>();
-      if (body.contains("battery_temperature")) d.battery_temperature = body["battery_temperature"].get<int>();
-      if (body.contains("position"))            d.position            = body["position"].get<int>();
-      if (body.contains("working_duration"))    d.working_duration    = body["working_duration"].get<int>();
-      if (body.contains("solar_voltage"))       d.solar_voltage       = body["solar_voltage"].get<int>();
-      if (body.contains("solar_current"))       d.solar_current       = body["solar_current"].get<int>();
-      if (body.contains("total_run_count"))     d.total_run_count     = body["total_run_count"].get<int>();
-      if (body.contains("current_lap_count"))   d.current_lap_count   = body["current_lap_count"].get<int>();
-      if (body.contains("board_temperature"))   d.board_temperature   = body["board_temperature"].get<int>();
-      if (body.contains("alarm_fa"))            d.alarm_fa            = body["alarm_fa"].get<int>();
-      if (body.contains("alarm_fb"))            d.alarm_fb            = body["alarm_fb"].get<int>();
-      if (body.contains("alarm_fc"))            d.alarm_fc            = body["alarm_fc"].get<int>();
-      if (body.contains("alarm_fd"))            d.alarm_fd            = body["alarm_fd"].get<int>();
-
+      robot->UpdateData([&](RobotData& d) {
+        if (body.contains("main_motor_current"))  d.main_motor_current  = body["main_motor_current"].get<int>();
+        if (body.contains("slave_motor_current")) d.slave_motor_current = body["slave_motor_current"].get<int>();
+        if (body.contains("battery_voltage"))     d.battery_voltage     = body["battery_voltage"].get<int>();
+        if (body.contains("battery_current"))     d.battery_current     = body["battery_current"].get<int>();
+        if (body.contains("battery_status"))      d.battery_status      = body["battery_status"].get<int>();
+        if (body.contains("battery_level"))       d.battery_level       = body["battery_level"].get<int>();
+        if (body.contains("battery_temperature")) d.battery_temperature = body["battery_temperature"].get<int>();
+        if (body.contains("position"))            d.position            = body["position"].get<int>();
+        if (body.contains("working_duration"))    d.working_duration    = body["working_duration"].get<int>();
+        if (body.contains("solar_voltage"))       d.solar_voltage       = body["solar_voltage"].get<int>();
+        if (body.contains("solar_current"))       d.solar_current       = body["solar_current"].get<int>();
+        if (body.contains("total_run_count"))     d.total_run_count     = body["total_run_count"].get<int>();
+        if (body.contains("current_lap_count"))   d.current_lap_count   = body["current_lap_count"].get<int>();
+        if (body.contains("board_temperature"))   d.board_temperature   = body["board_temperature"].get<int>();
+        if (body.contains("alarm_fa"))            d.alarm_fa            = body["alarm_fa"].get<int>();
+        if (body.contains("alarm_fb"))            d.alarm_fb            = body["alarm_fb"].get<int>();
+        if (body.contains("alarm_fc"))            d.alarm_fc            = body["alarm_fc"].get<int>();
+        if (body.contains("alarm_fd"))            d.alarm_fd            = body["alarm_fd"].get<int>();
+
+      });
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
 
       json response;
@@ -2247,7 +2352,9 @@ void HttpServer::ServerThreadFunc() {
 
         // 发送定时启动请求
         robot->SendScheduleStartRequest(schedule_id, weekday, hour, minute, run_count);
-        const auto& start_reply = robot->GetData().request_reply;
+        RobotData::RequestReply start_reply{};
+        bool reply_received = false;
+        robot->GetRequestReplyStatus(request_id, &start_reply, &reply_received);
 
         json response;
         response["success"] = true;
@@ -2293,7 +2400,9 @@ void HttpServer::ServerThreadFunc() {
 
         // 发送启动请求
         robot->SendStartRequest();
-        const auto& start_reply = robot->GetData().request_reply;
+        RobotData::RequestReply start_reply{};
+        bool reply_received = false;
+        robot->GetRequestReplyStatus(request_id, &start_reply, &reply_received);
 
         json response;
         response["success"] = true;
@@ -2344,7 +2453,9 @@ void HttpServer::ServerThreadFunc() {
 
       // 发送校时请求
       robot->SendTimeSyncRequest();
-      const auto& start_reply = robot->GetData().request_reply;
+      RobotData::RequestReply start_reply{};
+      bool reply_received = false;
+      robot->GetRequestReplyStatus(request_id, &start_reply, &reply_received);
 
       json response;
       response["success"] = true;
@@ -2858,6 +2969,7 @@ void HttpServer::ServerThreadFunc() {
           res.status = 400; res.set_content(error.dump(), "application/json"); return;
         }
       }
+      robot->PublishData();
       config_db_->UpdateRobotDataSnapshot(robot_id, robot->SerializeDataSnapshot());
       json response;
       response["success"]  = true;
@@ -2957,6 +3069,258 @@ void HttpServer::ServerThreadFunc() {
     }
   });
 
+  // ─── 清扫启动准入控制 ───────────────────────────────────────────────────────
+
+  // GET /api/v1/system/clean_start_admission - 获取启动准入配置及排队延迟指标
+  svr.Get("/api/v1/system/clean_start_admission", [this](const httplib::Request&, httplib::Response& res) {
+    try {
+      auto& admission = mqtt_manager_->GetStartAdmission();
+      const StartAdmission::Config cfg = admission.GetConfig();
+      const StartAdmission::Metrics m = admission.GetMetrics();
+
+      json histogram = json::array();
+      for (size_t i = 0; i < m.delay_histogram.size(); ++i) {
+        json bucket;
+        if (i < StartAdmission::kDelayBucketsMs.size()) {
+          bucket["le_ms"] = StartAdmission::kDelayBucketsMs[i];
+        } else {
+          bucket["le_ms"] = nullptr;  // 超过最大分桶上限
+        }
+        bucket["count"] = m.delay_histogram[i];
+        histogram.push_back(bucket);
+      }
+
+      json response;
+      response["success"] = true;
+      response["max_inflight"]    = cfg.max_inflight;
+      response["rate_per_second"] = cfg.rate_per_second;
+      response["jitter_max_ms"]   = cfg.jitter_max_ms;
+      response["metrics"] = {
+          {"admitted", m.admitted},
+          {"delayed", m.delayed},
+          {"cancelled", m.cancelled},
+          {"waiting", m.waiting},
+          {"inflight", m.inflight},
+          {"avg_delay_ms", m.avg_delay_ms},
+          {"max_delay_ms", m.max_delay_ms},
+          {"last_delay_ms", m.last_delay_ms},
+          {"delay_histogram", histogram},
+      };
+      res.set_content(response.dump(), "application/json");
+    } catch (const std::exception& e) {
+      json error;
+      error["success"] = false;
+      error["error"] = e.what();
+      res.status = 500;
+      res.set_content(error.dump(), "application/json");
+    }
+  });
+
+  // POST /api/v1/system/clean_start_admission - 更新启动准入配置（并实时生效）
+  svr.Post("/api/v1/system/clean_start_admission", [this](const httplib::Request& req, httplib::Response& res) {
+    try {
+      json body = json::parse(req.body);
+      auto& admission = mqtt_manager_->GetStartAdmission();
+      StartAdmission::Config cfg = admission.GetConfig();
+      cfg.max_inflight    = body.value("max_inflight",    cfg.max_inflight);
+      cfg.rate_per_second = body.value("rate_per_second", cfg.rate_per_second);
+      cfg.jitter_max_ms   = body.value("jitter_max_ms",   cfg.jitter_max_ms);
+
+      if (cfg.max_inflight < 0 || cfg.rate_per_second < 0 || cfg.jitter_max_ms < 0) {
+        json error;
+        error["success"] = false;
+        error["error"] = "参数不能为负数";
+        res.status = 400;
+        res.set_content(error.dump(), "application/json");
+        return;
+      }
+
+      bool ok = config_db_->SetValue("clean_start_max_inflight", std::to_string(cfg.max_inflight))
+             && config_db_->SetValue("clean_start_rate",         std::to_string(cfg.rate_per_second))
+             && config_db_->SetValue("clean_start_jitter_ms",    std::to_string(cfg.jitter_max_ms));
+      if (!ok) {
+        json error;
+        error["success"] = false;
+        error["error"] = "数据库写入失败";
+        res.status = 500;
+        res.set_content(error.dump(), "application/json");
+        return;
+      }
+
+      admission.SetConfig(cfg);
+
+      json response;
+      response["success"] = true;
+      response["message"] = "启动准入配置已更新并实时生效";
+      response["max_inflight"]    = cfg.max_inflight;
+      response["rate_per_second"] = cfg.rate_per_second;
+      response["jitter_max_ms"]   = cfg.jitter_max_ms;
+      res.set_content(response.dump(), "application/json");
+
+      LOG(INFO) << "启动准入配置已更新 - 在途F0上限:" << cfg.max_inflight
+                << ", 每秒启动数:" << cfg.rate_per_second << ", 抖动上限:" << cfg.jitter_max_ms << "ms";
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "更新启动准入配置失败: " << e.what();
+      json error;
+      error["success"] = false;
+      error["error"] = e.what();
+      res.status = 500;
+      res.set_content(error.dump(), "application/json");
+    }
+  });
+
+  // ─── 追踪日志级别 ───────────────────────────────────────────────────────────
+
+  // GET /api/v1/system/trace_levels - 获取各模块追踪级别（0 关闭，1 摘要，2 详细）
+  svr.Get("/api/v1/system/trace_levels", [](const httplib::Request&, httplib::Response& res) {
+    json response;
+    response["success"] = true;
+    response["levels"] = BuildTraceLevelsJson();
+    res.set_content(response.dump(), "application/json");
+  });
+
+  // POST /api/v1/system/trace_levels - 更新追踪级别（实时生效），如 {"protocol": 2, "mqtt": 0}
+  svr.Post("/api/v1/system/trace_levels", [this](const httplib::Request& req, httplib::Response& res) {
+    try {
+      json body = json::parse(req.body);
+      std::string spec;
+      for (auto it = body.begin(); it != body.end(); ++it) {
+        if (!it.value().is_number_integer()) {
+          throw std::invalid_argument("级别必须为整数: " + it.key());
+        }
+        if (!spec.empty()) spec += ',';
+        spec += it.key() + "=" + std::to_string(it.value().get<int>());
+      }
+
+      // 先校验再持久化，格式错误时不修改任何级别
+      const std::string previous = Trace::ToString();
+      if (!Trace::Configure(spec)) {
+        json error;
+        error["success"] = false;
+        error["error"] = "未知模块或级别超出范围(0-2)";
+        res.status = 400;
+        res.set_content(error.dump(), "application/json");
+        return;
+      }
+      if (!config_db_->SetValue("trace_levels", Trace::ToString())) {
+        Trace::Configure(previous);
+        json error;
+        error["success"] = false;
+        error["error"] = "数据库写入失败";
+        res.status = 500;
+        res.set_content(error.dump(), "application/json");
+        return;
+      }
+
+      json response;
+      response["success"] = true;
+      response["message"] = "追踪级别已更新并实时生效";
+      response["levels"] = BuildTraceLevelsJson();
+      res.set_content(response.dump(), "application/json");
+
+      LOG(INFO) << "追踪级别已更新: " << Trace::ToString();
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "更新追踪级别失败: " << e.what();
+      json error;
+      error["success"] = false;
+      error["error"] = e.what();
+      res.status = 500;
+      res.set_content(error.dump(), "application/json");
+    }
+  });
+
+  // ─── 异步日志输出 ───────────────────────────────────────────────────────────
+
+  // GET /api/v1/system/log_sink - 获取异步日志缓冲区状态及丢弃计数
+  svr.Get("/api/v1/system/log_sink", [](const httplib::Request&, httplib::Response& res) {
+    AsyncLogSink* sink = AsyncLogSink::Installed();
+    json response;
+    response["success"] = true;
+    response["enabled"] = sink != nullptr;
+    if (sink) {
+      const AsyncLogSink::Stats stats = sink->GetStats();
+      response["overflow"] = AsyncLogSink::PolicyName(stats.overflow);
+      response["capacity"] = stats.capacity;
+      response["queued"] = stats.queued;
+      response["written"] = stats.written;
+      response["dropped"] = stats.dropped;
+      response["blocked"] = stats.blocked;
+      response["truncated"] = stats.truncated;
+    }
+    res.set_content(response.dump(), "application/json");
+  });
+
+  // POST /api/v1/system/log_sink - 设置缓冲区满时的处理方式 {"overflow": "drop" | "block"}
+  svr.Post("/api/v1/system/log_sink", [this](const httplib::Request& req, httplib::Response& res) {
+    try {
+      json body = json::parse(req.body);
+      const std::string overflow = body.value("overflow", "");
+      AsyncLogSink::OverflowPolicy policy;
+      AsyncLogSink* sink = AsyncLogSink::Installed();
+      if (!sink || !AsyncLogSink::ParsePolicy(overflow, &policy)) {
+        json error;
+        error["success"] = false;
+        error["error"] = sink ? "overflow 只能为 drop 或 block" : "异步日志未启用";
+        res.status = 400;
+        res.set_content(error.dump(), "application/json");
+        return;
+      }
+      if (!config_db_->SetValue("log_overflow", overflow)) {
+        json error;
+        error["success"] = false;
+        error["error"] = "数据库写入失败";
+        res.status = 500;
+        res.set_content(error.dump(), "application/json");
+        return;
+      }
+      sink->SetOverflowPolicy(policy);
+
+      json response;
+      response["success"] = true;
+      response["message"] = "日志缓冲区溢出策略已更新并实时生效";
+      response["overflow"] = overflow;
+      res.set_content(response.dump(), "application/json");
+
+      LOG(INFO) << "日志缓冲区溢出策略已更新: " << overflow;
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "更新日志缓冲区溢出策略失败: " << e.what();
+      json error;
+      error["success"] = false;
+      error["error"] = e.what();
+      res.status = 500;
+      res.set_content(error.dump(), "application/json");
+    }
+  });
+
+  // ─── 下行帧处理统计 ─────────────────────────────────────────────────────────
+
+  // GET /api/v1/system/frame_handlers - 获取各标识/控制码的处理次数与耗时分布
+  svr.Get("/api/v1/system/frame_handlers", [](const httplib::Request&, httplib::Response& res) {
+    try {
+      json response;
+      response["success"] = true;
+      response["identifiers"] = BuildFrameHandlerStatsJson(Robot::IdentifierHandlers());
+      response["control_codes"] = BuildFrameHandlerStatsJson(Robot::ControlCodeHandlers());
+      res.set_content(response.dump(), "application/json");
+    } catch (const std::exception& e) {
+      json error;
+      error["success"] = false;
+      error["error"] = e.what();
+      res.status = 500;
+      res.set_content(error.dump(), "application/json");
+    }
+  });
+
+  // POST /api/v1/system/frame_handlers/reset - 清零下行帧处理统计
+  svr.Post("/api/v1/system/frame_handlers/reset", [](const httplib::Request&, httplib::Response& res) {
+    Robot::IdentifierHandlers().ResetStats();
+    Robot::ControlCodeHandlers().ResetStats();
+    json response;
+    response["success"] = true;
+    response["message"] = "下行帧处理统计已清零";
+    res.set_content(response.dump(), "application/json");
+  });
+
   // ─── MQTT 服务配置 ─────────────────────────────────────────────────────────
 
   // GET /api/v1/system/mqtt_config - 获取 MQTT 服务地址、用户名及连接状态
@@ -2967,6 +3331,22 @@ void HttpServer::ServerThreadFunc() {
       response["broker"]    = mqtt_manager_->GetBroker();
       response["username"]  = mqtt_manager_->GetUsername();
       response["connected"] = mqtt_manager_->IsConnected();
+      response["envelope_format"] = envelope_codec::FormatName(mqtt_manager_->GetEnvelopeFormat());
+      // 各连接分片的发布统计
+      json shards = json::array();
+      for (const auto& shard : mqtt_manager_->GetShardStats()) {
+        shards.push_back({{"index", shard.index},
+                          {"client_id", shard.client_id},
+                          {"connected", shard.connected},
+                          {"queued", shard.queued},
+                          {"max_inflight", shard.max_inflight},
+                          {"inflight", shard.inflight},
+                          {"delivered", shard.delivered},
+                          {"failed", shard.failed},
+                          {"dropped", shard.dropped},
+                          {"rate", shard.rate}});
+      }
+      response["shards"] = shards;
       res.set_content(response.dump(), "application/json");
     } catch (const std::exception& e) {
       json error;
@@ -5,15 +5,22 @@
 #include <chrono>
 #include <filesystem>
 #include <memory>
+#include <random>
 #include <string>
 #include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include "async_log_sink.h"
+#include "base64.h"
 #include "config_db.h"
+#include "envelope_codec.h"
 #include "http_server.h"
 #include "mqtt_manager.h"
 #include "robot.h"
+#include "sim_clock.h"
+#include "sim_rng.h"
+#include "trace.h"
 #include "version.h"
 
 using namespace std::chrono_literals;
@@ -94,12 +101,17 @@ int main(int argc, char* argv[]) {
   google::InitGoogleLogging(argv[0]);
 
   // 配置日志输出到文件和终端
-  FLAGS_alsologtostderr = true;            // 同时输出到文件和终端
   FLAGS_colorlogtostderr = true;           // 终端输出带颜色
   FLAGS_log_dir = "./logs";                // 日志文件目录
   FLAGS_max_log_size = 100;                // 单个日志文件最大100MB
   FLAGS_stop_logging_if_full_disk = true;  // 磁盘满时停止日志
 
+  // 文件与终端输出由异步日志线程完成，写日志的线程不阻塞在 I/O 上
+  AsyncLogSink::Options log_options;
+  log_options.program_name = std::filesystem::path(argv[0]).filename().string();
+  log_options.also_stderr = true;          // 同时输出到文件和终端
+  AsyncLogSink* log_sink = AsyncLogSink::Install(log_options);
+
   // 按级别定时清理日志文件（每个级别最多保留10个）
   CleanupOldLogFiles(FLAGS_log_dir, kMaxLogFilesPerSeverity);
   StartPeriodicLogCleanup(FLAGS_log_dir, kMaxLogFilesPerSeverity,
@@ -127,6 +139,57 @@ int main(int argc, char* argv[]) {
   int publish_interval = config_db->GetIntValue("publish_interval", 10);
   int http_port = config_db->GetIntValue("http_port", 8080);
 
+  // 模拟随机数全局种子：0 表示每次启动随机生成（日志中打印，便于复现）
+  uint64_t sim_seed = 0;
+  try {
+    sim_seed = std::stoull(config_db->GetValue("sim_seed", "0"));
+  } catch (...) {
+    LOG(WARNING) << "sim_seed 配置无效，使用随机种子";
+  }
+  if (sim_seed == 0) {
+    std::random_device rd;
+    sim_seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+  }
+  SimRng::SetGlobalSeed(sim_seed);
+  bool sim_lazy_mode = config_db->GetIntValue("sim_lazy_mode", 0) != 0;
+
+  // 模拟时钟：realtime / accelerated（sim_clock_speed 倍速）/ discrete（离散事件）
+  // 必须在创建 MqttManager（启动全局调度器）之前设置
+  SimClock::Mode sim_clock_mode = SimClock::Mode::kRealtime;
+  const std::string sim_clock_mode_str = config_db->GetValue("sim_clock_mode", "realtime");
+  if (!SimClock::ParseMode(sim_clock_mode_str, &sim_clock_mode)) {
+    LOG(WARNING) << "sim_clock_mode 配置无效: " << sim_clock_mode_str << "，使用 realtime";
+  }
+  double sim_clock_speed = 1.0;
+  try {
+    sim_clock_speed = std::stod(config_db->GetValue("sim_clock_speed", "1"));
+  } catch (...) {
+    LOG(WARNING) << "sim_clock_speed 配置无效，使用 1";
+  }
+  SimClock::Instance().Configure(sim_clock_mode, sim_clock_speed);
+
+  // 日志缓冲区满时的处理：drop（丢弃 INFO/WARNING 并计数）/ block（等待写出）
+  const std::string log_overflow = config_db->GetValue("log_overflow", "drop");
+  AsyncLogSink::OverflowPolicy log_overflow_policy;
+  if (AsyncLogSink::ParsePolicy(log_overflow, &log_overflow_policy)) {
+    log_sink->SetOverflowPolicy(log_overflow_policy);
+  } else {
+    LOG(WARNING) << "log_overflow 配置无效: " << log_overflow << "，使用 drop";
+  }
+
+  // 追踪日志级别，如 "protocol=2,mqtt=0"；未列出的模块使用默认级别（1 摘要）
+  const std::string trace_levels = config_db->GetValue("trace_levels", "");
+  if (!Trace::Configure(trace_levels)) {
+    LOG(WARNING) << "trace_levels 配置无效: " << trace_levels << "，使用默认级别";
+  }
+
+  // MQTT 消息封装格式：json（ChirpStack JSON）/ raw（协议帧字节）/ protobuf（ChirpStack protobuf）
+  const std::string envelope_format_str = config_db->GetValue("envelope_format", "json");
+  EnvelopeFormat envelope_format = EnvelopeFormat::kJson;
+  if (!envelope_codec::ParseFormat(envelope_format_str, &envelope_format)) {
+    LOG(WARNING) << "envelope_format 配置无效: " << envelope_format_str << "，使用 json";
+  }
+
   // 获取启用的机器人列表
   auto enabled_robots = config_db->GetEnabledRobots();
   if (enabled_robots.empty()) {
@@ -141,6 +204,14 @@ int main(int argc, char* argv[]) {
   LOG(INFO) << "Client ID: " << client_id;
   LOG(INFO) << "QoS: " << qos;
   LOG(INFO) << "HTTP Port: " << http_port;
+  LOG(INFO) << "Sim Seed: " << sim_seed;
+  LOG(INFO) << "Sim Lazy Mode: " << (sim_lazy_mode ? "on" : "off");
+  LOG(INFO) << "Sim Clock: " << SimClock::ModeName(SimClock::Instance().GetMode())
+            << " x" << SimClock::Instance().GetSpeed();
+  LOG(INFO) << "Envelope: " << envelope_codec::FormatName(envelope_format);
+  LOG(INFO) << "Base64: " << Base64::ImplName();
+  LOG(INFO) << "Trace: " << Trace::ToString();
+  LOG(INFO) << "Log Overflow: " << AsyncLogSink::PolicyName(log_sink->GetStats().overflow);
   LOG(INFO) << "启用的机器人 (" << enabled_robots.size() << "):";
   for (const auto& id : enabled_robots) LOG(INFO) << "  - " << id;
   LOG(INFO) << "==================";
@@ -148,6 +219,8 @@ int main(int argc, char* argv[]) {
   // 优先启动HTTP服务器，使Web页面尽快可用
   auto mqtt_manager =
       std::make_shared<MqttManager>(broker, client_id, qos, config_db);
+  mqtt_manager->SetLazySimulation(sim_lazy_mode);
+  mqtt_manager->SetEnvelopeFormat(envelope_format);
   auto http_server =
       std::make_shared<HttpServer>(config_db, mqtt_manager, http_port);
   http_server->Start();
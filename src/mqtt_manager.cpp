@@ -3,12 +3,40 @@
 #include <glog/logging.h>
 
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <iomanip>
 #include <sstream>
 
+#include "frame_writer.h"
+#include "sim_clock.h"
+#include "trace.h"
+
 using json = nlohmann::json;
 
+namespace {
+
+// 一致性哈希环上每个分片的虚拟节点数
+constexpr int kShardVirtualNodes = 64;
+
+// FNV-1a 后接 murmur3 的 fmix32 混合（robot_id 前缀相同、只有末几位不同，需要充分扩散）
+uint32_t HashKey(const std::string& key) {
+  uint32_t h = 2166136261u;
+  for (unsigned char c : key) {
+    h ^= c;
+    h *= 16777619u;
+  }
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h;
+}
+
+}  // namespace
+
 MqttManager::MqttManager(const std::string& broker,
                          const std::string& client_id, int qos,
                          std::shared_ptr<ConfigDb> config_db)
@@ -16,43 +44,104 @@ MqttManager::MqttManager(const std::string& broker,
   // 从数据库加载用户名/密码
   username_ = config_db_->GetValue("mqtt_username", "");
   password_ = config_db_->GetValue("mqtt_password", "");
-  client_ = std::make_unique<mqtt::async_client>(broker_, client_id_);
-  client_->set_callback(*this);
+
+  // MQTT 连接分片：只有一个连接时沿用原 client_id，多个连接时依次加 "-<序号>" 后缀
+  const int connections = std::max(1, std::min(config_db_->GetIntValue("mqtt_connections", 1), 64));
+  MqttShard::Options shard_options;
+  shard_options.broker = broker_;
+  shard_options.username = username_;
+  shard_options.password = password_;
+  // 每个连接的异步发布在途窗口（Paho 的 max_inflight 上限为 65535）
+  shard_options.max_inflight =
+      std::max(1, std::min(config_db_->GetIntValue("publish_max_inflight", 64), 65535));
+  for (int i = 0; i < connections; ++i) {
+    shard_options.index = i;
+    shard_options.client_id = connections == 1 ? client_id_ : client_id_ + "-" + std::to_string(i);
+    shards_.push_back(std::make_unique<MqttShard>(
+        shard_options,
+        [this](const std::string& topic, const std::string& payload) {
+          OnMessageArrived(topic, payload);
+        },
+        [this](const std::string& topic, const std::string& payload) {
+          RecordMqttMessage("up", topic, payload);
+        }));
+    for (int v = 0; v < kShardVirtualNodes; ++v) {
+      shard_ring_.emplace_back(HashKey("shard-" + std::to_string(i) + "#" + std::to_string(v)),
+                               static_cast<size_t>(i));
+    }
+  }
+  std::sort(shard_ring_.begin(), shard_ring_.end());
+
+  // 车队模拟引擎：每 tick 对所有机器人做一遍采样
+  fleet_sim_ = std::make_shared<FleetSimEngine>();
+  fleet_sim_timer_id_ = FleetScheduler::Instance().AddTimer(
+      FleetScheduler::kTickInterval, [this]() { return OnFleetSimTimer(); });
+
+  // 告警模拟调度器：定时器只在最近一个告警事件到期时触发
+  fleet_alarm_ = std::make_shared<FleetAlarmScheduler>();
+  fleet_alarm_timer_id_ = FleetScheduler::Instance().AddTimer(
+      std::chrono::milliseconds(0), [this]() { return OnFleetAlarmTimer(); });
+
+  // 清扫启动准入控制配置
+  StartAdmission::Config admission;
+  admission.max_inflight = config_db_->GetIntValue("clean_start_max_inflight", 0);
+  admission.rate_per_second = config_db_->GetIntValue("clean_start_rate", 0);
+  admission.jitter_max_ms = config_db_->GetIntValue("clean_start_jitter_ms", 0);
+  start_admission_.SetConfig(admission);
+
+  // 定时任务：每分钟查一次全车队索引
+  schedule_timer_id_ = FleetScheduler::Instance().AddTimer(
+      std::chrono::milliseconds(0), [this]() { return OnScheduleTimer(); });
 }
 
 MqttManager::~MqttManager() {
-  if (client_ && client_->is_connected()) {
+  FleetScheduler::Instance().CancelTimer(schedule_timer_id_);
+  FleetScheduler::Instance().CancelTimer(fleet_alarm_timer_id_);
+  FleetScheduler::Instance().CancelTimer(fleet_sim_timer_id_);
+  if (IsConnected()) {
     Disconnect();
   }
+  // 先于接收队列等成员销毁分片，避免析构期间的回调访问已销毁的成员
+  shards_.clear();
 }
 
 bool MqttManager::Connect(int keepalive) {
-  try {
-    mqtt::connect_options conn_opts;
-    conn_opts.set_keep_alive_interval(keepalive);
-    if (!username_.empty()) {
-      conn_opts.set_user_name(username_);
-      conn_opts.set_password(password_);
-    }
-
-    LOG(INFO) << "正在连接到 broker: " << broker_;
-    client_->connect(conn_opts)->wait();
-    LOG(INFO) << "连接成功!";
-    return true;
-  } catch (const mqtt::exception& exc) {
-    LOG(ERROR) << "连接失败: " << exc.what();
-    return false;
+  bool ok = true;
+  for (auto& shard : shards_) {
+    if (!shard->Connect(keepalive)) ok = false;
   }
+  return ok;
 }
 
 void MqttManager::Disconnect() {
-  try {
-    LOG(INFO) << "正在断开连接...";
-    client_->disconnect()->wait();
-    LOG(INFO) << "已断开连接";
-  } catch (const mqtt::exception& exc) {
-    LOG(ERROR) << "断开连接失败: " << exc.what();
+  for (auto& shard : shards_) {
+    shard->Disconnect();
+  }
+}
+
+bool MqttManager::IsConnected() const {
+  for (const auto& shard : shards_) {
+    if (!shard->IsConnected()) return false;
+  }
+  return !shards_.empty();
+}
+
+MqttShard& MqttManager::ShardFor(const std::string& robot_id) const {
+  if (shards_.size() == 1) return *shards_.front();
+  const uint32_t hash = HashKey(robot_id);
+  auto it = std::upper_bound(shard_ring_.begin(), shard_ring_.end(),
+                             std::make_pair(hash, shards_.size()));
+  if (it == shard_ring_.end()) it = shard_ring_.begin();
+  return *shards_[it->second];
+}
+
+std::vector<MqttShard::Stats> MqttManager::GetShardStats() {
+  std::vector<MqttShard::Stats> stats;
+  stats.reserve(shards_.size());
+  for (auto& shard : shards_) {
+    stats.push_back(shard->GetStats());
   }
+  return stats;
 }
 
 void MqttManager::AddRobot(std::shared_ptr<Robot> robot) {
@@ -70,7 +159,7 @@ void MqttManager::AddRobot(std::shared_ptr<Robot> robot) {
   int motor_params_interval = config_db_->GetIntValue("motor_params_report_interval", 3600);
   int lora_clean_interval = config_db_->GetIntValue("lora_clean_report_interval", 3600);
 
-  // 记录机器人索引，由 Robot 内部在线程启动时实时计算错峰偏移
+  // 记录机器人索引，由 Robot 在上报定时器首次触发时实时计算错峰偏移
   size_t robot_index;
   {
     std::lock_guard<std::mutex> lock(robots_mutex_);
@@ -80,7 +169,7 @@ void MqttManager::AddRobot(std::shared_ptr<Robot> robot) {
   robot->SetReportIntervals(robot_data_interval, motor_params_interval, lora_clean_interval);
   robot->SetRobotIndex(static_cast<int>(robot_index));
 
-  // 设置MQTT管理器（启动上报线程）
+  // 设置MQTT管理器（启动定时上报）
   robot->SetMqttManager(shared_from_this());
 
   {
@@ -93,6 +182,7 @@ void MqttManager::AddRobot(std::shared_ptr<Robot> robot) {
     topic_to_robot_[publish_topic] = robot_id;
     topic_to_robot_[subscribe_topic] = robot_id;
   }
+  schedule_index_.Update(robot_id, robot->GetDataSnapshot()->schedule_tasks);
 
   LOG(INFO) << "添加机器人: " << robot_id;
   LOG(INFO) << "  发布主题: " << publish_topic;
@@ -101,14 +191,8 @@ void MqttManager::AddRobot(std::shared_ptr<Robot> robot) {
             << "s, 电机参数:" << motor_params_interval
             << "s, Lora&清扫:" << lora_clean_interval << "s [索引" << robot_index << "]";
 
-  // 订阅该机器人的主题
-  try {
-    LOG(INFO) << "正在订阅主题: " << subscribe_topic;
-    client_->subscribe(subscribe_topic, qos_)->wait();
-    LOG(INFO) << "订阅完成!";
-  } catch (const mqtt::exception& exc) {
-    LOG(ERROR) << "订阅失败: " << exc.what();
-  }
+  // 在机器人所属分片的连接上订阅该机器人的主题
+  ShardFor(robot_id).Subscribe(subscribe_topic, qos_);
 }
 
 void MqttManager::AddRobot(const std::string& robot_id) {
@@ -143,10 +227,12 @@ void MqttManager::AddRobot(const std::string& robot_id) {
 
   // 从数据库加载告警值
   ConfigDb::AlarmData alarms = config_db_->GetRobotAlarms(robot_id);
-  robot->GetData().alarm_fa = alarms.alarm_fa;
-  robot->GetData().alarm_fb = alarms.alarm_fb;
-  robot->GetData().alarm_fc = alarms.alarm_fc;
-  robot->GetData().alarm_fd = alarms.alarm_fd;
+  robot->UpdateData([&](RobotData& d) {
+    d.alarm_fa = alarms.alarm_fa;
+    d.alarm_fb = alarms.alarm_fb;
+    d.alarm_fc = alarms.alarm_fc;
+    d.alarm_fd = alarms.alarm_fd;
+  });
   LOG(INFO) << "加载机器人告警 - " << robot_id
             << ", FA=0x" << std::hex << alarms.alarm_fa
             << ", FB=0x" << alarms.alarm_fb
@@ -158,7 +244,7 @@ void MqttManager::AddRobot(const std::string& robot_id) {
   int motor_params_interval = config_db_->GetIntValue("motor_params_report_interval", 3600);
   int lora_clean_interval = config_db_->GetIntValue("lora_clean_report_interval", 3600);
 
-  // 记录机器人索引，由 Robot 内部在线程启动时实时计算错峰偏移
+  // 记录机器人索引，由 Robot 在上报定时器首次触发时实时计算错峰偏移
   size_t robot_index;
   {
     std::lock_guard<std::mutex> lock(robots_mutex_);
@@ -171,7 +257,7 @@ void MqttManager::AddRobot(const std::string& robot_id) {
   // 设置ConfigDb（用于告警持久化）
   robot->SetConfigDb(config_db_);
 
-  // 设置MQTT管理器（启动上报线程）
+  // 设置MQTT管理器（启动定时上报）
   robot->SetMqttManager(shared_from_this());
 
   {
@@ -184,6 +270,7 @@ void MqttManager::AddRobot(const std::string& robot_id) {
     topic_to_robot_[publish_topic] = robot_id;
     topic_to_robot_[subscribe_topic] = robot_id;
   }
+  schedule_index_.Update(robot_id, robot->GetDataSnapshot()->schedule_tasks);
 
   LOG(INFO) << "添加机器人: " << robot_id;
   LOG(INFO) << "  发布主题: " << publish_topic;
@@ -192,14 +279,8 @@ void MqttManager::AddRobot(const std::string& robot_id) {
             << "s, 电机参数:" << motor_params_interval
             << "s, Lora&清扫:" << lora_clean_interval << "s [索引" << robot_index << "]";
 
-  // 订阅该机器人的主题
-  try {
-    LOG(INFO) << "正在订阅主题: " << subscribe_topic;
-    client_->subscribe(subscribe_topic, qos_)->wait();
-    LOG(INFO) << "订阅完成!";
-  } catch (const mqtt::exception& exc) {
-    LOG(ERROR) << "订阅失败: " << exc.what();
-  }
+  // 在机器人所属分片的连接上订阅该机器人的主题
+  ShardFor(robot_id).Subscribe(subscribe_topic, qos_);
 }
 
 void MqttManager::RemoveRobot(const std::string& robot_id) {
@@ -224,18 +305,13 @@ void MqttManager::RemoveRobot(const std::string& robot_id) {
     topic_to_robot_.erase(publish_topic);
     topic_to_robot_.erase(subscribe_topic);
   }
+  schedule_index_.Remove(robot_id);
 
   LOG(INFO) << "删除机器人: " << robot_id;
   LOG(INFO) << "  订阅主题: " << subscribe_topic;
 
   // 取消订阅该机器人的主题
-  try {
-    LOG(INFO) << "正在取消订阅主题: " << subscribe_topic;
-    client_->unsubscribe(subscribe_topic)->wait();
-    LOG(INFO) << "取消订阅完成!";
-  } catch (const mqtt::exception& exc) {
-    LOG(ERROR) << "取消订阅失败: " << exc.what();
-  }
+  ShardFor(robot_id).Unsubscribe(subscribe_topic);
 }
 
 std::shared_ptr<Robot> MqttManager::GetRobot(const std::string& robot_id) {
@@ -263,14 +339,9 @@ void MqttManager::Publish(const std::string& robot_id) {
   std::string payload = robot->GenerateUplinkPayload(data);
   std::string publish_topic = robot->GetPublishTopic();
 
-  try {
-    auto msg = mqtt::make_message(publish_topic, payload);
-    msg->set_qos(qos_);
-    client_->publish(msg);
-    LOG(INFO) << "[" << robot_id << "] 已发布: " << payload;
-  } catch (const mqtt::exception& exc) {
-    LOG(ERROR) << "发布失败: " << exc.what();
-  }
+  // 经发送队列发布，与其他上行消息共用在途窗口
+  EnqueueMessage(robot_id, publish_topic, payload, qos_);
+  TRACE(kMqtt, 2) << "[" << robot_id << "] 已加入发送队列: " << payload;
 }
 
 void MqttManager::RefreshRobots() {
@@ -345,8 +416,7 @@ bool MqttManager::Run(int keepalive) {
           s.alarm_sim.frequency    = aj.value("frequency",    s.alarm_sim.frequency);
           s.alarm_sim.fc_bits_mask = aj.value("fc_bits_mask", s.alarm_sim.fc_bits_mask);
         }
-        std::lock_guard<std::mutex> lock(sim_config_mutex_);
-        global_sim_config_ = s;
+        SetGlobalSimConfig(s);
         LOG(INFO) << "全局数据模拟配置已加载，启用状态: " << (s.enabled ? "是" : "否");
       } catch (const std::exception& e) {
         LOG(WARNING) << "加载全局数据模拟配置失败: " << e.what();
@@ -357,9 +427,10 @@ bool MqttManager::Run(int keepalive) {
   // 初始加载机器人并注册
   RefreshRobots();
 
-  // 启动后台发送线程
-  stop_sender_.store(false);
-  sender_thread_ = std::thread(&MqttManager::SenderThreadFunc, this);
+  // 启动各分片的后台发送线程
+  for (auto& shard : shards_) {
+    shard->Start();
+  }
 
   // 启动后台接收处理线程
   stop_receiver_.store(false);
@@ -378,7 +449,7 @@ void MqttManager::UpdateAllRobotsReportIntervals(int robot_data_s, int motor_par
   LOG(INFO) << "实时更新所有机器人上报间隔 - 机器人数据:" << robot_data_s
             << "s, 电机参数:" << motor_params_s << "s, Lora&清扫:" << lora_clean_s << "s";
   for (auto& [id, robot] : robots_) {
-    // 直接修改成员变量，上报线程每 tick 读取，自动生效，无需重启
+    // 直接修改成员变量并唤醒上报定时器，立即按新间隔重新计算，无需重启
     robot->SetReportIntervals(robot_data_s, motor_params_s, lora_clean_s);
     LOG(INFO) << "  已更新机器人: " << id;
   }
@@ -401,35 +472,37 @@ bool MqttManager::ReconfigureAndReconnect(const std::string& broker,
   username_ = username;
   password_ = password;
 
-  // 3. 断开旧连接
-  if (client_ && client_->is_connected()) {
-    try { client_->disconnect()->wait(); } catch (...) {}
+  // 3-4. 先停止各分片的发送线程（等待在途消息确认，未发送的消息留在队列中），
+  //      发送线程不再使用旧客户端后再断开旧连接并重建客户端
+  const bool senders_running = running_.load();
+  for (auto& shard : shards_) {
+    shard->Stop();
+    shard->Reconfigure(broker_, username_, password_);
   }
 
-  // 4. 重建客户端
-  client_ = std::make_unique<mqtt::async_client>(broker_, client_id_);
-  client_->set_callback(*this);
-
-  // 5. 重新连接
-  if (!Connect(keepalive)) {
+  // 5. 重新连接后恢复发送线程（连接失败时由发送线程继续重连）
+  const bool connected = Connect(keepalive);
+  if (senders_running) {
+    for (auto& shard : shards_) {
+      shard->Start();
+    }
+  }
+  if (!connected) {
     LOG(ERROR) << "MQTT 重连失败";
     return false;
   }
 
-  // 6. 重新订阅所有机器人的主题
-  std::vector<std::string> topics;
+  // 6. 在各机器人所属分片上重新订阅主题
+  std::vector<std::pair<std::string, std::string>> topics;  // (robot_id, 订阅主题)
   {
     std::lock_guard<std::mutex> lock(robots_mutex_);
     for (const auto& [id, robot] : robots_) {
-      topics.push_back(robot->GetSubscribeTopic());
+      topics.emplace_back(id, robot->GetSubscribeTopic());
     }
   }
-  for (const auto& topic : topics) {
-    try {
-      client_->subscribe(topic, qos_)->wait();
+  for (const auto& [id, topic] : topics) {
+    if (ShardFor(id).Subscribe(topic, qos_)) {
       LOG(INFO) << "已重新订阅: " << topic;
-    } catch (const mqtt::exception& e) {
-      LOG(ERROR) << "重订阅失败: " << topic << " - " << e.what();
     }
   }
 
@@ -438,7 +511,7 @@ bool MqttManager::ReconfigureAndReconnect(const std::string& broker,
 }
 
 std::string MqttManager::BuildTimestampString() const {
-  auto now = std::chrono::system_clock::now();
+  auto now = SimClock::Instance().SystemNow();
   auto time_t_now = std::chrono::system_clock::to_time_t(now);
   std::tm local_tm;
 #ifdef _WIN32
@@ -481,11 +554,11 @@ std::string MqttManager::ResolveCommandByIdentifier(uint8_t identifier) const {
   return oss.str();
 }
 
-static std::string BytesToHexString(const std::vector<uint8_t>& bytes) {
+static std::string BytesToHexString(const uint8_t* bytes, size_t size) {
   std::ostringstream oss;
   oss << std::uppercase << std::hex << std::setfill('0');
-  for (uint8_t value : bytes) {
-    oss << std::setw(2) << static_cast<int>(value);
+  for (size_t i = 0; i < size; ++i) {
+    oss << std::setw(2) << static_cast<int>(bytes[i]);
   }
   return oss.str();
 }
@@ -513,30 +586,26 @@ void MqttManager::RecordMqttMessage(const std::string& direction,
   item.direction = direction;
   item.topic = topic;
 
-  try {
-    auto parsed = json::parse(payload);
-    if (parsed.contains("devEui") && parsed["devEui"].is_string()) {
-      item.robot_id = parsed["devEui"].get<std::string>();
+  FrameBuffer raw;
+  size_t raw_size = 0;
+  std::string dev_eui;
+  const EnvelopeFormat format = GetEnvelopeFormat();
+  const bool decoded =
+      direction == "up"
+          ? envelope_codec::DecodeUplink(format, payload, &dev_eui, &raw, &raw_size)
+          : envelope_codec::DecodeDownlink(format, payload, &dev_eui, &raw, &raw_size);
+  if (decoded) {
+    item.robot_id = dev_eui;
+    if (raw_size > 0) {
+      item.data = BytesToHexString(raw.data(), raw_size);
     }
 
-    if (parsed.contains("data") && parsed["data"].is_string()) {
-      std::string data_b64 = parsed["data"].get<std::string>();
-      auto raw_bytes = Protocol::Base64ToBytes(data_b64);
-      if (!raw_bytes.empty()) {
-        item.data = BytesToHexString(raw_bytes);
-      } else {
-        item.data = data_b64;
-      }
-
-      Protocol protocol;
-      ProtocolFrame frame;
-      if (protocol.Decode(raw_bytes, frame) && !frame.data.empty()) {
-        uint8_t identifier = frame.data[0];
-        item.category = ResolveCategoryByIdentifier(identifier);
-        item.command = ResolveCommandByIdentifier(identifier);
-      }
+    FrameView frame;
+    if (Protocol::DecodeView(raw.data(), raw_size, &frame) && !frame.data.empty()) {
+      uint8_t identifier = frame.data[0];
+      item.category = ResolveCategoryByIdentifier(identifier);
+      item.command = ResolveCommandByIdentifier(identifier);
     }
-  } catch (...) {
   }
 
   if (item.robot_id.empty()) {
@@ -550,7 +619,11 @@ void MqttManager::RecordMqttMessage(const std::string& direction,
     item.command = "--";
   }
   if (item.data.empty()) {
-    item.data = payload;
+    // 二进制封装无法解码时按十六进制记录
+    item.data = format == EnvelopeFormat::kJson
+                    ? payload
+                    : BytesToHexString(reinterpret_cast<const uint8_t*>(payload.data()),
+                                       payload.size());
   }
 
   if (item.robot_id.empty()) {
@@ -611,23 +684,89 @@ std::vector<MqttCommMessage> MqttManager::GetRecentMqttMessages(const std::strin
   return result;
 }
 
-SimConfig MqttManager::GetGlobalSimConfig() const {
-  std::lock_guard<std::mutex> lock(sim_config_mutex_);
-  return global_sim_config_;
+std::shared_ptr<const SimConfig> MqttManager::GetSimConfigSnapshot() const {
+  return std::atomic_load_explicit(&sim_config_, std::memory_order_acquire);
 }
 
 void MqttManager::SetGlobalSimConfig(const SimConfig& config) {
-  std::lock_guard<std::mutex> lock(sim_config_mutex_);
-  global_sim_config_ = config;
+  auto snapshot = std::make_shared<const SimConfig>(config);
+  std::lock_guard<std::mutex> lock(sim_config_write_mutex_);
+  std::atomic_store_explicit(&sim_config_, std::move(snapshot), std::memory_order_release);
+  sim_config_version_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+std::chrono::milliseconds MqttManager::OnFleetSimTimer() {
+  const auto sim = GetSimConfigSnapshot();
+  if (!sim->enabled || lazy_simulation_.load()) {
+    // 无需逐 tick 采样时降低检查频率（离散事件模式下避免每个 tick 都成为事件）
+    return std::chrono::seconds(1);
+  }
+  fleet_sim_->Step(*sim);
+  return FleetScheduler::kTickInterval;
+}
+
+std::chrono::milliseconds MqttManager::OnFleetAlarmTimer() {
+  // 先读版本号再读快照：快照不会旧于版本号，版本变化时下一次必然重建
+  const uint64_t version = GetSimConfigVersion();
+  const auto sim = GetSimConfigSnapshot();
+  return fleet_alarm_->Process(*sim, version);
+}
+
+void MqttManager::UpdateScheduleIndex(const std::string& robot_id,
+                                      const ScheduleTaskList& tasks) {
+  schedule_index_.Update(robot_id, tasks);
+}
+
+std::chrono::milliseconds MqttManager::OnScheduleTimer() {
+  using namespace std::chrono;
+  const auto now = SimClock::Instance().SystemNow();
+  const int64_t now_minute = duration_cast<minutes>(now.time_since_epoch()).count();
+
+  if (now_minute != last_schedule_minute_) {
+    // 补齐上次检查之后错过的每一分钟（加速模式下一次 tick 可能跨过多个模拟分钟），最多回溯一周；
+    // 首次运行或时钟回拨时只检查当前分钟
+    constexpr int64_t kMaxCatchUpMinutes = 7 * 24 * 60;
+    int64_t first_minute = now_minute;
+    if (last_schedule_minute_ >= 0 && now_minute > last_schedule_minute_) {
+      first_minute = last_schedule_minute_ + 1;
+      if (now_minute - first_minute >= kMaxCatchUpMinutes) {
+        LOG(WARNING) << "[Scheduler] 定时任务检查落后 " << (now_minute - last_schedule_minute_)
+                     << " 分钟，只补齐最近一周";
+        first_minute = now_minute - kMaxCatchUpMinutes + 1;
+      }
+    }
+    last_schedule_minute_ = now_minute;
+
+    for (int64_t minute = first_minute; minute <= now_minute; ++minute) {
+      std::time_t t = system_clock::to_time_t(system_clock::time_point{minutes(minute)});
+      std::tm tm;
+#ifdef _WIN32
+      localtime_s(&tm, &t);
+#else
+      localtime_r(&t, &tm);
+#endif
+      for (const auto& match : schedule_index_.Find(tm.tm_wday, tm.tm_hour, tm.tm_min)) {
+        auto robot = GetRobot(match.robot_id);
+        if (!robot) continue;
+        LOG(INFO) << "[Robot " << match.robot_id << "] 定时任务 #" << static_cast<int>(match.schedule_id)
+                  << " 触发 (weekday=" << match.weekday << " " << tm.tm_hour << ":" << tm.tm_min << ")";
+        robot->StartCleaningTask(match.schedule_id);
+      }
+    }
+  }
+
+  // 在下一分钟开始时再次检查
+  const system_clock::time_point next_minute{minutes(now_minute + 1)};
+  return duration_cast<milliseconds>(next_minute - now) + milliseconds(1);
 }
 
 void MqttManager::Stop() {  if (!running_.load()) return;
   running_.store(false);  // 停止主循环
 
-  // 停止发送线程
-  stop_sender_.store(true);
-  queue_cv_.notify_all();  // 唤醒发送线程
-  if (sender_thread_.joinable()) sender_thread_.join();
+  // 停止各分片的发送线程（并等待在途消息确认）
+  for (auto& shard : shards_) {
+    shard->Stop();
+  }
 
   // 停止接收线程
   stop_receiver_.store(true);
@@ -637,95 +776,10 @@ void MqttManager::Stop() {  if (!running_.load()) return;
   Disconnect();
 }
 
-void MqttManager::EnqueueMessage(const std::string& topic,
+void MqttManager::EnqueueMessage(const std::string& robot_id, const std::string& topic,
                                  const std::string& payload, int qos) {
-  {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    message_queue_.push({topic, payload, qos});
-  }
-  queue_cv_.notify_one();  // 通知发送线程
-}
-
-void MqttManager::SenderThreadFunc() {
-  LOG(INFO) << "消息发送线程已启动";
-
-  while (!stop_sender_.load()) {
-    std::unique_lock<std::mutex> lock(queue_mutex_);
-
-    // 等待队列中有消息或收到停止信号
-    queue_cv_.wait(lock, [this] {
-      return !message_queue_.empty() || stop_sender_.load();
-    });
-
-    // 处理队列中的所有消息
-    while (!message_queue_.empty() && !stop_sender_.load()) {
-      PendingMessage msg = message_queue_.front();
-      message_queue_.pop();
-      lock.unlock();  // 释放锁以便其他线程可以入队
-
-      // 发送消息
-      try {
-        const int kMaxAttempts = 3;
-        int attempts = 0;
-        bool sent = false;
-
-        auto mqtt_msg = mqtt::make_message(msg.topic, msg.payload);
-        mqtt_msg->set_qos(msg.qos);
-
-        while (attempts < kMaxAttempts && !stop_sender_.load()) {
-          // 确保连接，如无连接则尝试重连
-          if (!client_ || !client_->is_connected()) {
-            LOG(WARNING) << "客户端未连接，尝试重连... (尝试 " << (attempts + 1) << ")";
-            if (!Connect(60)) {
-              LOG(WARNING) << "重连失败";
-              attempts++;
-              std::this_thread::sleep_for(std::chrono::milliseconds(200 * attempts));
-              continue;
-            }
-            LOG(INFO) << "重连成功";
-          }
-
-          try {
-            auto tok = client_->publish(mqtt_msg);
-            // 等待发布完成（短超时），若需要可以调整为更长时间或不等待
-            if (tok) tok->wait_for(std::chrono::seconds(5));
-            RecordMqttMessage("up", msg.topic, msg.payload);
-            LOG(INFO) << "已从队列发送消息到主题: " << msg.topic;
-            sent = true;
-            break;
-          } catch (const mqtt::exception& exc_inner) {
-            LOG(WARNING) << "发布尝试失败: " << exc_inner.what();
-            attempts++;
-            // 等待指数退避的短暂停顿
-            std::this_thread::sleep_for(std::chrono::milliseconds(200 * attempts));
-            // 下一轮会尝试重连或再次 publish
-          }
-        }
-
-        if (!sent) {
-          LOG(ERROR) << "多次尝试后发送失败，消息重新入队: " << msg.topic;
-          std::lock_guard<std::mutex> push_lock(queue_mutex_);
-          message_queue_.push(msg);
-          // 等待以避免忙循环
-          std::this_thread::sleep_for(std::chrono::seconds(1));
-          break;  // 退出当前处理，让外层循环等待/重新调度
-        }
-      } catch (const mqtt::exception& exc) {
-        LOG(ERROR) << "发送队列消息失败（外层捕获）: " << exc.what();
-        // 出现不可预期的异常时，也将消息放回队列
-        {
-          std::lock_guard<std::mutex> push_lock(queue_mutex_);
-          message_queue_.push(msg);
-        }
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        break;
-      }
-
-      lock.lock();  // 重新获取锁以检查队列
-    }
-  }
-
-  LOG(INFO) << "消息发送线程已停止";
+  // 同一机器人的消息始终进入同一分片的队列，保持发布顺序
+  ShardFor(robot_id).Enqueue({topic, payload, qos});
 }
 
 void MqttManager::ReceiverThreadFunc() {
@@ -745,32 +799,34 @@ void MqttManager::ReceiverThreadFunc() {
       received_queue_.pop();
       lock.unlock();  // 释放锁以便其他线程可以入队
 
-      // 处理接收到的消息
+      // 处理接收到的消息：按封装格式取出 devEui 与协议帧，每条消息只解码一次，
+      // 广播判断与机器人处理共用同一帧视图
       try {
-        // 解析下行JSON数据
-        json j = json::parse(msg.payload);
-
-        // 提取devEui和data字段
-        if (!j.contains("devEui") || !j.contains("data")) {
-          LOG(WARNING) << "消息缺少必需字段 devEui 或 data";
+        std::string dev_eui;
+        FrameBuffer raw;
+        size_t raw_size = 0;
+        if (!envelope_codec::DecodeDownlink(GetEnvelopeFormat(), msg.payload, &dev_eui, &raw,
+                                            &raw_size)) {
+          LOG(WARNING) << "下行消息封装无效（" << envelope_codec::FormatName(GetEnvelopeFormat())
+                       << "），主题: " << msg.topic;
           lock.lock();
           continue;
         }
+        // raw 格式不带 devEui，按订阅主题确定机器人
+        if (dev_eui.empty()) {
+          dev_eui = ResolveRobotIdByTopic(msg.topic);
+        }
 
-        std::string dev_eui = j["devEui"].get<std::string>();
-        std::string data = j["data"].get<std::string>();
+        FrameView frame;
+        const bool frame_ok = Protocol::DecodeView(raw.data(), raw_size, &frame);
+        if (!frame_ok) {
+          LOG(WARNING) << "协议帧解析失败, devEui: " << dev_eui;
+        }
 
         // 广播参数设置(A8)需要所有机器人处理
-        bool is_a8_broadcast = false;
-        {
-          Protocol protocol;
-          ProtocolFrame frame;
-          std::vector<uint8_t> raw = Protocol::Base64ToBytes(data);
-          if (protocol.Decode(raw, frame) && !frame.data.empty() &&
-              frame.control_code == CONTROL_CODE_UPLINK && frame.data[0] == 0xA8) {
-            is_a8_broadcast = true;
-          }
-        }
+        const bool is_a8_broadcast = frame_ok && !frame.data.empty() &&
+                                     frame.control_code == CONTROL_CODE_UPLINK &&
+                                     frame.data[0] == 0xA8;
 
         if (is_a8_broadcast) {
           std::vector<std::pair<std::string, std::shared_ptr<Robot>>> robots_to_notify;
@@ -791,7 +847,7 @@ void MqttManager::ReceiverThreadFunc() {
               continue;
             }
 
-            robot->HandleMessage(data);
+            robot->HandleFrame(frame);
 
             if (!config_db_->UpdateRobotDataSnapshot(robot_id,
                                                      robot->SerializeDataSnapshot())) {
@@ -821,8 +877,12 @@ void MqttManager::ReceiverThreadFunc() {
         }
 
         if (robot) {
-          LOG(INFO) << "将消息路由到机器人: " << dev_eui;
-          robot->HandleMessage(data);
+          TRACE_HOT(kMqtt, 1) << "将消息路由到机器人: " << dev_eui;
+          if (frame_ok) {
+            robot->HandleFrame(frame);
+          } else {
+            robot->HandleMessage(raw.data(), raw_size);  // 由机器人记录解析失败并发布当前数据
+          }
 
           if (!config_db_->UpdateRobotDataSnapshot(dev_eui,
                                                    robot->SerializeDataSnapshot())) {
@@ -842,15 +902,8 @@ void MqttManager::ReceiverThreadFunc() {
   LOG(INFO) << "消息接收处理线程已停止";
 }
 
-void MqttManager::connection_lost(const std::string& cause) {
-  LOG(WARNING) << "Connection lost: " << cause;
-}
-
-void MqttManager::message_arrived(mqtt::const_message_ptr msg) {
-  std::string topic = msg->get_topic();
-  std::string payload = msg->to_string();
-
-  LOG(INFO) << "收到消息 - 主题: " << topic;
+void MqttManager::OnMessageArrived(const std::string& topic, const std::string& payload) {
+  TRACE_HOT(kMqtt, 1) << "收到消息 - 主题: " << topic;
   RecordMqttMessage("down", topic, payload);
 
   // 将接收到的消息放入接收队列，由接收线程处理
@@ -860,5 +913,3 @@ void MqttManager::message_arrived(mqtt::const_message_ptr msg) {
   }
   received_queue_cv_.notify_one();  // 通知接收处理线程
 }
-
-void MqttManager::delivery_complete(mqtt::delivery_token_ptr token) {}
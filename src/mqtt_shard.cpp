@@ -0,0 +1,358 @@
+#include "mqtt_shard.h"
+
+#include <glog/logging.h>
+
+#include <utility>
+
+#include "trace.h"
+
+namespace {
+
+// 单条消息的最大发布次数（同步发布异常与失败回调分别计数）
+constexpr int kMaxPublishAttempts = 3;
+
+}  // namespace
+
+MqttShard::MqttShard(const Options& options, MessageHandler on_message,
+                     MessageHandler on_delivered)
+    : options_(options),
+      on_message_(std::move(on_message)),
+      on_delivered_(std::move(on_delivered)),
+      rate_time_(std::chrono::steady_clock::now()) {
+  client_ = std::make_unique<mqtt::async_client>(options_.broker, options_.client_id);
+  client_->set_callback(*this);
+}
+
+MqttShard::~MqttShard() {
+  Stop();
+  if (client_ && client_->is_connected()) {
+    Disconnect();
+  }
+}
+
+bool MqttShard::Connect(int keepalive) {
+  keepalive_ = keepalive;
+  try {
+    mqtt::connect_options conn_opts;
+    conn_opts.set_keep_alive_interval(keepalive);
+    conn_opts.set_max_inflight(options_.max_inflight);
+    if (!options_.username.empty()) {
+      conn_opts.set_user_name(options_.username);
+      conn_opts.set_password(options_.password);
+    }
+
+    LOG(INFO) << "[" << options_.client_id << "] 正在连接到 broker: " << options_.broker;
+    client_->connect(conn_opts)->wait();
+    LOG(INFO) << "[" << options_.client_id << "] 连接成功!";
+    return true;
+  } catch (const mqtt::exception& exc) {
+    LOG(ERROR) << "[" << options_.client_id << "] 连接失败: " << exc.what();
+    return false;
+  }
+}
+
+void MqttShard::Disconnect() {
+  try {
+    LOG(INFO) << "[" << options_.client_id << "] 正在断开连接...";
+    client_->disconnect()->wait();
+    LOG(INFO) << "[" << options_.client_id << "] 已断开连接";
+  } catch (const mqtt::exception& exc) {
+    LOG(ERROR) << "[" << options_.client_id << "] 断开连接失败: " << exc.what();
+  }
+}
+
+bool MqttShard::IsConnected() const {
+  return client_ && client_->is_connected();
+}
+
+void MqttShard::Reconfigure(const std::string& broker, const std::string& username,
+                            const std::string& password) {
+  if (client_ && client_->is_connected()) {
+    try { client_->disconnect()->wait(); } catch (...) {}
+  }
+
+  // 先销毁旧客户端：析构返回后旧客户端不会再有回调，此时才能清零在途计数
+  client_.reset();
+  {
+    std::lock_guard<std::mutex> lock(inflight_mutex_);
+    inflight_ = 0;
+  }
+  inflight_cv_.notify_all();
+
+  options_.broker = broker;
+  options_.username = username;
+  options_.password = password;
+  client_ = std::make_unique<mqtt::async_client>(options_.broker, options_.client_id);
+  client_->set_callback(*this);
+}
+
+bool MqttShard::Subscribe(const std::string& topic, int qos) {
+  try {
+    LOG(INFO) << "[" << options_.client_id << "] 正在订阅主题: " << topic;
+    client_->subscribe(topic, qos)->wait();
+    LOG(INFO) << "订阅完成!";
+    return true;
+  } catch (const mqtt::exception& exc) {
+    LOG(ERROR) << "订阅失败: " << topic << " - " << exc.what();
+    return false;
+  }
+}
+
+bool MqttShard::Unsubscribe(const std::string& topic) {
+  try {
+    LOG(INFO) << "[" << options_.client_id << "] 正在取消订阅主题: " << topic;
+    client_->unsubscribe(topic)->wait();
+    LOG(INFO) << "取消订阅完成!";
+    return true;
+  } catch (const mqtt::exception& exc) {
+    LOG(ERROR) << "取消订阅失败: " << topic << " - " << exc.what();
+    return false;
+  }
+}
+
+void MqttShard::Start() {
+  if (sender_thread_.joinable()) return;
+  stop_sender_.store(false);
+  sender_thread_ = std::thread(&MqttShard::SenderThreadFunc, this);
+}
+
+void MqttShard::Stop() {
+  if (!sender_thread_.joinable()) return;
+
+  stop_sender_.store(true);
+  queue_cv_.notify_all();  // 唤醒发送线程
+  inflight_cv_.notify_all();
+  sender_thread_.join();
+
+  // 等待在途消息确认（最多 5 秒）后再断开连接
+  std::unique_lock<std::mutex> lock(inflight_mutex_);
+  if (!inflight_cv_.wait_for(lock, std::chrono::seconds(5), [this] { return inflight_ == 0; })) {
+    LOG(WARNING) << "[" << options_.client_id << "] 停止时仍有 " << inflight_ << " 条消息未确认";
+  }
+}
+
+void MqttShard::Enqueue(PendingMessage message) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    message_queue_.push_back(std::move(message));
+  }
+  queue_cv_.notify_one();  // 通知发送线程
+}
+
+void MqttShard::EnqueueRetry(PendingMessage message) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    retry_queue_.push_back(std::move(message));
+  }
+  queue_cv_.notify_one();
+}
+
+MqttShard::Stats MqttShard::GetStats() {
+  Stats stats;
+  stats.index = options_.index;
+  stats.client_id = options_.client_id;
+  stats.connected = IsConnected();
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stats.queued = message_queue_.size() + retry_queue_.size();
+  }
+  stats.max_inflight = options_.max_inflight;
+  {
+    std::lock_guard<std::mutex> lock(inflight_mutex_);
+    stats.inflight = inflight_;
+  }
+  stats.delivered = delivered_.load(std::memory_order_relaxed);
+  stats.failed = failed_.load(std::memory_order_relaxed);
+  stats.dropped = dropped_.load(std::memory_order_relaxed);
+
+  // 距上次采样至少 1 秒时重新计算速率，否则沿用上次结果
+  {
+    std::lock_guard<std::mutex> lock(rate_mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed = std::chrono::duration<double>(now - rate_time_).count();
+    if (elapsed >= 1.0) {
+      rate_ = static_cast<double>(stats.delivered - rate_delivered_) / elapsed;
+      rate_time_ = now;
+      rate_delivered_ = stats.delivered;
+    }
+    stats.rate = rate_;
+  }
+  return stats;
+}
+
+void MqttShard::SenderThreadFunc() {
+  LOG(INFO) << "[" << options_.client_id << "] 消息发送线程已启动，在途窗口: "
+            << options_.max_inflight;
+
+  while (!stop_sender_.load()) {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+
+    // 等待队列中有消息或收到停止信号
+    queue_cv_.wait(lock, [this] {
+      return !message_queue_.empty() || !retry_queue_.empty() || stop_sender_.load();
+    });
+
+    // 处理队列中的所有消息：异步发布，不等待 broker 确认，
+    // 在途消息数由窗口限制，送达与失败在回调中处理
+    while ((!message_queue_.empty() || !retry_queue_.empty()) && !stop_sender_.load()) {
+      // 重试消息先于新消息发布
+      const bool from_retry = !retry_queue_.empty();
+      auto& source = from_retry ? retry_queue_ : message_queue_;
+      PendingMessage msg = std::move(source.front());
+      source.pop_front();
+      lock.unlock();  // 释放锁以便其他线程可以入队
+
+      // 未能发布的消息放回重试队列：取自重试队列的放回队首；取自发送队列的排在
+      // 期间失败回调放入的重试消息之后（那些消息更早发布），均先于发送队列中的新消息
+      auto requeue = [this, from_retry](PendingMessage message) {
+        std::lock_guard<std::mutex> push_lock(queue_mutex_);
+        if (from_retry) {
+          retry_queue_.push_front(std::move(message));
+        } else {
+          retry_queue_.push_back(std::move(message));
+        }
+      };
+
+      // 窗口已满时等待回调释放名额；停止时消息放回队列，不丢弃
+      if (!AcquireInflightSlot()) {
+        requeue(std::move(msg));
+        lock.lock();
+        break;
+      }
+
+      int attempts = 0;
+      bool sent = false;
+
+      auto mqtt_msg = mqtt::make_message(msg.topic, msg.payload);
+      mqtt_msg->set_qos(msg.qos);
+
+      while (attempts < kMaxPublishAttempts && !stop_sender_.load()) {
+        // 确保连接，如无连接则尝试重连
+        if (!client_ || !client_->is_connected()) {
+          LOG(WARNING) << "[" << options_.client_id << "] 客户端未连接，尝试重连... (尝试 "
+                       << (attempts + 1) << ")";
+          if (!Connect(keepalive_)) {
+            LOG(WARNING) << "重连失败";
+            attempts++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(200 * attempts));
+            continue;
+          }
+          LOG(INFO) << "重连成功";
+        }
+
+        try {
+          // 用户上下文携带该消息已失败的次数，失败回调据此决定是否重试
+          client_->publish(mqtt_msg, reinterpret_cast<void*>(static_cast<intptr_t>(msg.attempts)),
+                           *this);
+          TRACE_HOT(kMqtt, 2) << "已发布消息到主题: " << msg.topic;
+          sent = true;
+          break;
+        } catch (const mqtt::exception& exc) {
+          LOG(WARNING) << "发布尝试失败: " << exc.what();
+          attempts++;
+          // 等待指数退避的短暂停顿
+          std::this_thread::sleep_for(std::chrono::milliseconds(200 * attempts));
+          // 下一轮会尝试重连或再次 publish
+        }
+      }
+
+      if (!sent) {
+        ReleaseInflightSlot();
+        LOG(ERROR) << "多次尝试后发送失败，消息重新入队: " << msg.topic;
+        requeue(std::move(msg));
+        // 等待以避免忙循环（停止时不等待）
+        if (!stop_sender_.load()) {
+          std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+      }
+
+      lock.lock();  // 重新获取锁以检查队列
+    }
+  }
+
+  LOG(INFO) << "[" << options_.client_id << "] 消息发送线程已停止";
+}
+
+bool MqttShard::AcquireInflightSlot() {
+  std::unique_lock<std::mutex> lock(inflight_mutex_);
+  while (inflight_ >= options_.max_inflight && !stop_sender_.load()) {
+    if (inflight_cv_.wait_for(lock, std::chrono::seconds(5)) == std::cv_status::timeout &&
+        inflight_ >= options_.max_inflight) {
+      // 长时间没有回调（如断线后会话被清除，在途消息不再回调），按 Paho 实际待确认数校正
+      lock.unlock();
+      const int pending = static_cast<int>(client_->get_pending_delivery_tokens().size());
+      lock.lock();
+      if (pending < inflight_) {
+        LOG(WARNING) << "[" << options_.client_id << "] 在途消息计数校正: " << inflight_
+                     << " -> " << pending;
+        inflight_ = pending;
+      }
+    }
+  }
+  if (stop_sender_.load()) return false;
+  ++inflight_;
+  return true;
+}
+
+void MqttShard::ReleaseInflightSlot() {
+  {
+    std::lock_guard<std::mutex> lock(inflight_mutex_);
+    if (inflight_ > 0) --inflight_;
+  }
+  inflight_cv_.notify_all();  // 发送线程与 Stop 都可能在等待
+}
+
+void MqttShard::connection_lost(const std::string& cause) {
+  LOG(WARNING) << "[" << options_.client_id << "] Connection lost: " << cause;
+}
+
+void MqttShard::message_arrived(mqtt::const_message_ptr msg) {
+  on_message_(msg->get_topic(), msg->to_string());
+}
+
+void MqttShard::delivery_complete(mqtt::delivery_token_ptr token) {
+  // QoS1/2 收到 broker 确认
+  if (token) OnPublishComplete(*token);
+}
+
+void MqttShard::on_success(const mqtt::token& token) {
+  // QoS1/2 的完成由 delivery_complete 统计，这里只处理写出即完成的 QoS0
+  const auto* delivery = dynamic_cast<const mqtt::delivery_token*>(&token);
+  if (!delivery) return;
+  auto msg = delivery->get_message();
+  if (msg && msg->get_qos() == 0) OnPublishComplete(*delivery);
+}
+
+void MqttShard::on_failure(const mqtt::token& token) {
+  ReleaseInflightSlot();
+  failed_.fetch_add(1, std::memory_order_relaxed);
+
+  const auto* delivery = dynamic_cast<const mqtt::delivery_token*>(&token);
+  auto msg = delivery ? delivery->get_message() : nullptr;
+  if (!msg) return;
+
+  const int attempts = static_cast<int>(reinterpret_cast<intptr_t>(token.get_user_context())) + 1;
+  if (attempts >= kMaxPublishAttempts) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    LOG(ERROR) << "发布 " << attempts << " 次均失败，丢弃消息: " << msg->get_topic()
+               << " (返回码 " << token.get_return_code() << ")";
+    return;
+  }
+
+  // 回调线程中不做等待，放入重试队列由发送线程优先重发（断线时由发送线程负责重连与退避）
+  LOG(WARNING) << "发布失败，消息重新入队: " << msg->get_topic() << " (第 " << attempts
+               << " 次，返回码 " << token.get_return_code() << ")";
+  EnqueueRetry({msg->get_topic(), msg->get_payload_str(), msg->get_qos(), attempts});
+}
+
+void MqttShard::OnPublishComplete(const mqtt::delivery_token& token) {
+  ReleaseInflightSlot();
+  delivered_.fetch_add(1, std::memory_order_relaxed);
+
+  // 通信记录在回调线程中完成，不占用发送线程
+  auto msg = token.get_message();
+  if (msg) {
+    on_delivered_(msg->get_topic(), msg->get_payload_str());
+    TRACE_HOT(kMqtt, 1) << "消息已送达主题: " << msg->get_topic();
+  }
+}
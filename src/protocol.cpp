@@ -5,6 +5,9 @@
 #include <iomanip>
 #include <sstream>
 
+#include "base64.h"
+#include "trace.h"
+
 Protocol::Protocol() {}
 
 Protocol::~Protocol() {}
@@ -40,75 +43,67 @@ std::vector<uint8_t> Protocol::Encode(uint8_t control_code, uint16_t number,
   result.push_back(frame.checksum);
   result.push_back(frame.tail);
 
-  LOG(INFO) << "编码帧: " << BytesToHexString(result);
+  TRACE_HOT(kProtocol, 2) << "编码帧: " << HexDump(result);
   return result;
 }
 
 bool Protocol::Decode(const std::vector<uint8_t>& raw_data,
                       ProtocolFrame& frame) {
-  // 最小帧长度：帧头(1) + 控制码(1) + 编号(2) + 帧计数(1) + 长度(1) + 数据(0+) + 校验(1) + 帧尾(1) = 8
-  if (raw_data.size() < 8) {
-    LOG(ERROR) << "帧长度不足: " << raw_data.size();
+  FrameView view;
+  const char* error = nullptr;
+  if (!DecodeView(raw_data.data(), raw_data.size(), &view, &error)) {
+    LOG(ERROR) << "协议帧解析失败: " << error << " (长度 " << raw_data.size() << ")";
     return false;
   }
 
-  // 验证帧头
-  if (raw_data[0] != FRAME_HEADER) {
-    LOG(ERROR) << "帧头错误: 0x" << std::hex << static_cast<int>(raw_data[0]);
-    return false;
-  }
+  frame.header = FRAME_HEADER;
+  frame.control_code = view.control_code;
+  frame.number = view.number;
+  frame.frame_count = view.frame_count;
+  frame.length = view.length;
+  frame.data.assign(view.data.begin(), view.data.end());
+  frame.checksum = view.checksum;
+  frame.tail = FRAME_TAIL;
 
-  // 验证帧尾
-  if (raw_data[raw_data.size() - 1] != FRAME_TAIL) {
-    LOG(ERROR) << "帧尾错误: 0x" << std::hex
-               << static_cast<int>(raw_data[raw_data.size() - 1]);
+  TRACE_HOT(kProtocol, 2) << "解码成功 - 控制码: 0x" << std::hex
+          << static_cast<int>(frame.control_code)
+          << ", 编号: 0x" << static_cast<int>(frame.number)
+          << ", 数据长度: " << std::dec << static_cast<int>(frame.length);
+  return true;
+}
+
+bool Protocol::DecodeView(const uint8_t* raw_data, size_t size, FrameView* view,
+                          const char** error) {
+  auto fail = [error](const char* reason) {
+    if (error) *error = reason;
     return false;
-  }
+  };
 
-  // 解析字段
-  size_t index = 0;
-  frame.header = raw_data[index++];                                      // 帧头
-  frame.control_code = raw_data[index++];                                // 控制码
-  frame.number = (static_cast<uint16_t>(raw_data[index]) << 8) |         // 编号（2字节）
-                 static_cast<uint16_t>(raw_data[index + 1]);
-  index += 2;
-  frame.frame_count = raw_data[index++];                                 // 帧计数
-  frame.length = raw_data[index++];                                      // 数据长度
+  // 最小帧长度：帧头(1) + 控制码(1) + 编号(2) + 帧计数(1) + 长度(1) + 数据(0+) + 校验(1) + 帧尾(1) = 8
+  if (size < 8) return fail("帧长度不足");
 
-  // 验证数据长度
-  if (raw_data.size() < index + frame.length + 2) {  // +2 for checksum and tail
-    LOG(ERROR) << "数据长度不匹配. 期望: " << static_cast<int>(frame.length)
-               << ", 实际: " << (raw_data.size() - index - 2);
-    return false;
-  }
+  // 验证帧头、帧尾
+  if (raw_data[0] != FRAME_HEADER) return fail("帧头错误");
+  if (raw_data[size - 1] != FRAME_TAIL) return fail("帧尾错误");
 
-  // 提取数据域
-  frame.data.clear();
-  frame.data.insert(frame.data.end(), raw_data.begin() + index,
-                    raw_data.begin() + index + frame.length);
-  index += frame.length;
+  // 解析字段
+  view->control_code = raw_data[1];
+  view->number = static_cast<uint16_t>((raw_data[2] << 8) | raw_data[3]);
+  view->frame_count = raw_data[4];
+  view->length = raw_data[5];
 
-  // 提取校验和
-  frame.checksum = raw_data[index++];
-  frame.tail = raw_data[index];
+  // 验证数据长度
+  const size_t index = 6;
+  if (size < index + view->length + 2) return fail("数据长度不匹配");  // +2 for checksum and tail
+  view->data = ByteSpan{raw_data + index, view->length};
+  view->checksum = raw_data[index + view->length];
 
   // 验证校验和（从帧头到数据域结束的累加和）
   uint8_t calculated_checksum = 0;
-  for (size_t i = 0; i < raw_data.size() - 2; ++i) {  // 包含帧头，跳过校验和、帧尾
+  for (size_t i = 0; i < size - 2; ++i) {  // 包含帧头，跳过校验和、帧尾
     calculated_checksum += raw_data[i];
   }
-
-  if (frame.checksum != calculated_checksum) {
-    LOG(ERROR) << "校验和错误. 期望: 0x" << std::hex
-               << static_cast<int>(calculated_checksum) << ", 实际: 0x"
-               << static_cast<int>(frame.checksum);
-    return false;
-  }
-
-  LOG(INFO) << "解码成功 - 控制码: 0x" << std::hex
-            << static_cast<int>(frame.control_code)
-            << ", 编号: 0x" << static_cast<int>(frame.number)
-            << ", 数据长度: " << std::dec << static_cast<int>(frame.length);
+  if (view->checksum != calculated_checksum) return fail("校验和错误");
   return true;
 }
 
@@ -136,9 +131,13 @@ bool Protocol::VerifyChecksum(const std::vector<uint8_t>& raw_data) {
 }
 
 std::string Protocol::BytesToHexString(const std::vector<uint8_t>& bytes) {
+  return BytesToHexString(bytes.data(), bytes.size());
+}
+
+std::string Protocol::BytesToHexString(const uint8_t* bytes, size_t size) {
   std::ostringstream oss;
   oss << std::hex << std::uppercase << std::setfill('0');
-  for (size_t i = 0; i < bytes.size(); ++i) {
+  for (size_t i = 0; i < size; ++i) {
     if (i > 0) oss << " ";
     oss << std::setw(2) << static_cast<int>(bytes[i]);
   }
@@ -161,108 +160,28 @@ std::vector<uint8_t> Protocol::HexStringToBytes(const std::string& hex_str) {
 }
 
 std::string Protocol::BytesToBase64(const std::vector<uint8_t>& bytes) {
-  static const char base64_chars[] =
-      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-  std::string result;
-  int i = 0;
-  uint8_t char_array_3[3];
-  uint8_t char_array_4[4];
-
-  for (uint8_t byte : bytes) {
-    char_array_3[i++] = byte;
-    if (i == 3) {
-      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-      char_array_4[1] =
-          ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-      char_array_4[2] =
-          ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-      char_array_4[3] = char_array_3[2] & 0x3f;
-
-      for (i = 0; i < 4; i++) {
-        result += base64_chars[char_array_4[i]];
-      }
-      i = 0;
-    }
-  }
-
-  if (i > 0) {
-    for (int j = i; j < 3; j++) {
-      char_array_3[j] = '\0';
-    }
-
-    char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-    char_array_4[1] =
-        ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-    char_array_4[2] =
-        ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-
-    for (int j = 0; j < i + 1; j++) {
-      result += base64_chars[char_array_4[j]];
-    }
-
-    while (i++ < 3) {
-      result += '=';
-    }
-  }
-
+  std::string result(Base64EncodedSize(bytes.size()), '\0');
+  BytesToBase64(bytes.data(), bytes.size(), &result[0]);
   return result;
 }
 
-std::vector<uint8_t> Protocol::Base64ToBytes(const std::string& base64_str) {
-  static const std::string base64_chars =
-      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-  std::vector<uint8_t> result;
-  int i = 0;
-  uint8_t char_array_4[4], char_array_3[3];
-
-  for (char c : base64_str) {
-    if (c == '=') break;
-    if (!isalnum(c) && c != '+' && c != '/') continue;
-
-    char_array_4[i++] = c;
-    if (i == 4) {
-      for (i = 0; i < 4; i++) {
-        char_array_4[i] =
-            static_cast<uint8_t>(base64_chars.find(char_array_4[i]));
-      }
-
-      char_array_3[0] =
-          (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-      char_array_3[1] =
-          ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-      char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-      for (i = 0; i < 3; i++) {
-        result.push_back(char_array_3[i]);
-      }
-      i = 0;
-    }
-  }
-
-  if (i > 0) {
-    for (int j = i; j < 4; j++) {
-      char_array_4[j] = 0;
-    }
-
-    for (int j = 0; j < 4; j++) {
-      char_array_4[j] =
-          static_cast<uint8_t>(base64_chars.find(char_array_4[j]));
-    }
-
-    char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-    char_array_3[1] =
-        ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-
-    for (int j = 0; j < i - 1; j++) {
-      result.push_back(char_array_3[j]);
-    }
-  }
+size_t Protocol::BytesToBase64(const uint8_t* bytes, size_t size, char* out) {
+  return Base64::Encode(bytes, size, out);
+}
 
+std::vector<uint8_t> Protocol::Base64ToBytes(const std::string& base64_str) {
+  std::vector<uint8_t> result(base64_str.size() / 4 * 3 + 3);
+  size_t size = 0;
+  Base64ToBytes(base64_str.data(), base64_str.size(), result.data(), result.size(), &size);
+  result.resize(size);
   return result;
 }
 
+bool Protocol::Base64ToBytes(const char* base64, size_t size, uint8_t* out,
+                             size_t capacity, size_t* out_size) {
+  return Base64::Decode(base64, size, out, capacity, out_size);
+}
+
 uint8_t Protocol::CalculateFrameChecksum(const ProtocolFrame& frame) {
   uint8_t checksum = 0;
   checksum += frame.control_code;
@@ -4,23 +4,39 @@
 #include <nlohmann/json.hpp>
 
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <sstream>
+#include <string_view>
 
 #include "config_db.h"
 #include "mqtt_manager.h"
-
-// 上行数据模板占位符
-#define PLACEHOLDER_DEV_EUI "{{DEV_EUI}}"
-#define PLACEHOLDER_DEV_ADDR "{{DEV_ADDR}}"
-#define PLACEHOLDER_DATA "{{DATA}}"
+#include "robot_frames.h"
+#include "sim_clock.h"
+#include "trace.h"
 
 // 上行数据模板文件路径
 #define UPLINK_TEMPLATE_FILE "doc/uplink_template.json"
 
 // 静态成员初始化
-std::string Robot::uplink_template_ = "";
+UplinkTemplate Robot::uplink_template_;
+UplinkProtobufEncoder Robot::uplink_protobuf_;
+
+// OTA固件升级状态（FD 70 升级开始时分配，升级结束时释放）
+struct Robot::UpgradeState {
+  bool in_progress = false;
+  uint8_t version_high = 0;
+  uint8_t version_low = 0;
+  size_t received_bytes = 0;
+  std::string save_path;
+  std::ofstream file;
+};
+
+// 单机器人常驻内存预算：10万台模拟机器人的对象本体约 140MB（x86_64/libstdc++ 实测
+// sizeof(Robot)=1400, sizeof(RobotData)=800），RobotData 不再有额外堆分配
+static_assert(sizeof(RobotData) <= 1024, "RobotData 超出单机器人内存预算");
+static_assert(sizeof(Robot) <= 2048, "Robot 超出单机器人内存预算");
 
 static bool IsWindProtectionEnabled(uint8_t protection_info) {
   return (protection_info & 0x80) != 0;
@@ -38,7 +54,96 @@ static bool IsAmbientTemperatureProtectionEnabled(uint8_t protection_info) {
   return (protection_info & 0x10) != 0;
 }
 
-Robot::Robot(const std::string& robot_id, uint16_t robot_number) : robot_id_(robot_id), sequence_(0) {
+using namespace robot_frames;
+
+// RobotData 参数结构与数据域字段值之间的转换
+static MotorParamsFields::Value ToWire(const MotorParams& mp) {
+  return MotorParamsFields::Value(
+      mp.walk_motor_speed, mp.brush_motor_speed, mp.windproof_motor_speed,
+      mp.walk_motor_max_current_ma, mp.brush_motor_max_current_ma, mp.windproof_motor_max_current_ma,
+      mp.walk_motor_warning_current_ma, mp.brush_motor_warning_current_ma,
+      mp.windproof_motor_warning_current_ma, mp.walk_motor_mileage_m, mp.brush_motor_timeout_s,
+      mp.windproof_motor_timeout_s, mp.reverse_time_s, mp.protection_angle);
+}
+
+static void FromWire(const MotorParamsFields::Value& value, MotorParams* mp) {
+  std::tie(mp->walk_motor_speed, mp->brush_motor_speed, mp->windproof_motor_speed,
+           mp->walk_motor_max_current_ma, mp->brush_motor_max_current_ma,
+           mp->windproof_motor_max_current_ma, mp->walk_motor_warning_current_ma,
+           mp->brush_motor_warning_current_ma, mp->windproof_motor_warning_current_ma,
+           mp->walk_motor_mileage_m, mp->brush_motor_timeout_s, mp->windproof_motor_timeout_s,
+           mp->reverse_time_s, mp->protection_angle) = value;
+}
+
+static BatteryParamsFields::Value ToWire(const TempVoltageProtection& tv) {
+  return BatteryParamsFields::Value(
+      tv.protection_current_ma, tv.high_temp_threshold, tv.low_temp_threshold, tv.protection_temp,
+      tv.recovery_temp, tv.protection_voltage, tv.recovery_voltage, tv.protection_battery_level,
+      tv.limit_run_battery_level, tv.recovery_battery_level);
+}
+
+// 仅更新电池参数部分，主板保护/恢复温度不在 A1 设置范围内
+static void FromWire(const BatteryParamsFields::Value& value, TempVoltageProtection* tv) {
+  std::tie(tv->protection_current_ma, tv->high_temp_threshold, tv->low_temp_threshold,
+           tv->protection_temp, tv->recovery_temp, tv->protection_voltage, tv->recovery_voltage,
+           tv->protection_battery_level, tv->limit_run_battery_level,
+           tv->recovery_battery_level) = value;
+}
+
+static ScheduleTaskFields::Value ToWire(const ScheduleTask& task) {
+  return ScheduleTaskFields::Value(task.weekday, task.hour, task.minute, task.run_count);
+}
+
+static ScheduleTableFields::Value ToWire(const ScheduleTaskList& tasks) {
+  ScheduleTableFields::Value value;
+  for (size_t i = 0; i < tasks.size(); ++i) value[i] = ToWire(tasks[i]);
+  return value;
+}
+
+// 记录F0/F1/F2请求回复（平台时间与保护信息），title 为日志标题
+static void ApplyRequestReply(const char* title, bool has_start_flag, uint8_t start_flag,
+                              const PlatformInfoFields::Value& info,
+                              RobotData::RequestReply* reply) {
+  const auto [year, month, day, hour, minute, second, weekday, wind_speed, comm_box_count,
+              robot_count, protection_info] = info;
+
+  reply->available = true;
+  reply->start_flag = start_flag;
+  reply->year = year;
+  reply->month = month;
+  reply->day = day;
+  reply->hour = hour;
+  reply->minute = minute;
+  reply->second = second;
+  reply->weekday = weekday;
+  reply->wind_speed = wind_speed;
+  reply->comm_box_count = comm_box_count;
+  reply->robot_count = robot_count;
+  reply->protection_info = protection_info;
+
+  TRACE(kRobot, 1) << "    === " << title << "解析 ===";
+  if (has_start_flag) {
+    TRACE(kRobot, 2) << "    启动运行标志: 0x" << std::hex << static_cast<int>(start_flag);
+  }
+  TRACE(kRobot, 2) << "    时间信息: 20" << std::dec << static_cast<int>(year)
+                   << "-" << std::setfill('0') << std::setw(2) << static_cast<int>(month)
+                   << "-" << std::setw(2) << static_cast<int>(day)
+                   << " " << std::setw(2) << static_cast<int>(hour)
+                   << ":" << std::setw(2) << static_cast<int>(minute)
+                   << ":" << std::setw(2) << static_cast<int>(second)
+                   << " 星期" << static_cast<int>(weekday);
+  TRACE(kRobot, 2) << "    当前风速: " << static_cast<int>(wind_speed);
+  TRACE(kRobot, 2) << "    通信箱数量: " << comm_box_count;
+  TRACE(kRobot, 2) << "    机器人数量: " << robot_count;
+  TRACE(kRobot, 2) << "    后台保护信息: 0x" << std::hex << static_cast<int>(protection_info);
+  TRACE(kRobot, 2) << "      - 大风保护: " << (IsWindProtectionEnabled(protection_info) ? "开启" : "关闭");
+  TRACE(kRobot, 2) << "      - 湿度保护: " << (IsHumidityProtectionEnabled(protection_info) ? "开启" : "关闭");
+  TRACE(kRobot, 2) << "      - 支架保护: " << (IsBracketProtectionEnabled(protection_info) ? "开启" : "关闭");
+  TRACE(kRobot, 2) << "      - 环境温度保护: " << (IsAmbientTemperatureProtectionEnabled(protection_info) ? "开启" : "关闭");
+}
+
+Robot::Robot(const std::string& robot_id, uint16_t robot_number)
+    : robot_id_(robot_id), robot_number_(robot_number), sequence_(0) {
   // 初始化机器人数据
   data_.alarm_fa = 0;
   data_.alarm_fb = 0;
@@ -64,8 +169,7 @@ Robot::Robot(const std::string& robot_id, uint16_t robot_number) : robot_id_(rob
   data_.direction = 0;
   data_.domestic_foreign_flag = 0;
 
-  // 初始化定时任务，保留7个元素
-  data_.schedule_tasks.resize(7);
+  // 初始化定时任务（固定7个元素）
   for (auto& task : data_.schedule_tasks) {
     task.weekday = 0;
     task.hour = 0;
@@ -75,21 +179,22 @@ Robot::Robot(const std::string& robot_id, uint16_t robot_number) : robot_id_(rob
 
   // 首次加载模板
   if (uplink_template_.empty()) {
-    uplink_template_ = LoadUplinkTemplate();
+    const std::string text = LoadUplinkTemplate();
+    uplink_template_.Parse(text);
+    if (!text.empty() && !uplink_protobuf_.Load(text)) {
+      LOG(WARNING) << "上行数据模板不是合法的 JSON，protobuf 封装不可用";
+    }
   }
 
-  // 初始化清扫记录，保留5条
-  data_.clean_records.resize(5);
-
-  // 初始化主/从机电流，保留16个元素
-  data_.master_currents.resize(16);
-  data_.slave_currents.resize(16);
+  // 预渲染本机器人的上行数据（devAddr 为机器人ID的后8个字符）
+  const size_t dev_addr_pos = robot_id_.length() >= 8 ? robot_id_.length() - 8 : 0;
+  uplink_envelope_ = uplink_template_.Bind(robot_id_, robot_id_.substr(dev_addr_pos));
 
   // 记录创建时间（用于计算工作时长）
-  creation_time_ = std::chrono::system_clock::now();
+  creation_time_ = SimClock::Instance().SystemNow();
 
   // 设置机器人序号（数字）
-  data_.robot_number = std::to_string(robot_number);
+  data_.robot_number = robot_number;
 
   // 将软件版本设为 CMake 中定义的 PROJECT_VERSION（如果存在）
 #ifdef PROJECT_VERSION
@@ -97,24 +202,28 @@ Robot::Robot(const std::string& robot_id, uint16_t robot_number) : robot_id_(rob
 #else
   data_.software_version = "0.0";
 #endif
+
+  PublishData();
 }
 
 Robot::~Robot() {
-  // 停止上报线程（stop_report_ 也会通知清扫任务线程退出）
+  // 停止上报定时器（同时中断进行中的清扫任务）
   StopReport();
 
-  // 等待清扫任务线程结束
-  if (cleaning_task_thread_.joinable()) {
-    cleaning_task_thread_.join();
+  // 释放车队模拟引擎/告警调度器槽位
+  if (fleet_sim_) {
+    fleet_sim_->Unregister(sim_slot_);
+  }
+  if (fleet_alarm_) {
+    fleet_alarm_->Unregister(alarm_slot_);
   }
 
   // 关闭未完成的固件升级文件
-  if (upgrade_file_.is_open()) {
-    upgrade_file_.close();
-  }
+  upgrade_.reset();
 }
 
 uint64_t Robot::BeginRequestReplyTracking() {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   std::lock_guard<std::mutex> lock(request_reply_mutex_);
   ++request_reply_token_;
   if (request_reply_token_ == 0) {
@@ -173,9 +282,17 @@ bool Robot::WaitForRequestReply(uint64_t request_id,
 }
 
 void Robot::MarkRequestReplyReceived() {
-  std::lock_guard<std::mutex> lock(request_reply_mutex_);
-  request_reply_completed_token_ = request_reply_token_;
-  request_reply_cv_.notify_all();
+  {
+    std::lock_guard<std::mutex> lock(request_reply_mutex_);
+    request_reply_completed_token_ = request_reply_token_;
+    request_reply_cv_.notify_all();
+  }
+
+  // 唤醒等待F0回复的清扫任务
+  const FleetScheduler::TimerId cleaning_timer = cleaning_timer_id_.load();
+  if (cleaning_timer != 0) {
+    FleetScheduler::Instance().WakeTimer(cleaning_timer);
+  }
 }
 
 void Robot::SetTopics(const std::string& publish_topic,
@@ -185,41 +302,87 @@ void Robot::SetTopics(const std::string& publish_topic,
 }
 
 std::string Robot::GenerateUplinkPayload(const std::string& data) {
-  if (uplink_template_.empty()) {
+  std::string result;
+  GenerateUplinkPayload(data.data(), data.size(), &result);
+  return result;
+}
+
+void Robot::GenerateUplinkPayload(const char* data, size_t size, std::string* out) {
+  if (uplink_envelope_.empty()) {
     LOG(ERROR) << "上行数据模板为空";
-    return "";
+    out->clear();
+    return;
   }
 
-  // 获取devAddr（机器人ID的后8个字符）
-  std::string dev_addr = robot_id_.length() >= 8
-                             ? robot_id_.substr(robot_id_.length() - 8)
-                             : robot_id_;
+  UplinkFields fields;
+  fields.data = data;
+  fields.data_size = size;
+  FillUplinkFields(&fields);
+  uplink_envelope_.Render(fields, out);
+}
+
+void Robot::FillUplinkFields(UplinkFields* fields) {
+  fields->time = SimClock::Instance().SystemNow();
+  fields->fcnt = uplink_fcnt_.fetch_add(1, std::memory_order_relaxed);
+
+  // 随机量由 (种子, 机器人编号, fCnt) 计算，相同种子可复现
+  const uint64_t seed = SimRng::GetGlobalSeed();
+  const SimRng::Block id = SimRng::Generate(seed, robot_number_, fields->fcnt, SimRng::kUplinkId);
+  std::copy(id.begin(), id.end(), fields->id);
+
+  // 信号质量：每台机器人固定的基准 RSSI（与网关的距离）加逐条消息的抖动，
+  // SNR 随 RSSI 线性变化（-40dBm 约 13.5dB，-110dBm 约 -7.5dB）
+  const SimRng::Block base = SimRng::Generate(seed, robot_number_, 0, SimRng::kUplinkRadioBase);
+  const SimRng::Block jitter = SimRng::Generate(seed, robot_number_, fields->fcnt, SimRng::kUplinkRadio);
+  const int rssi_base = -110 + static_cast<int>(SimRng::ToRange(base[0], 71));
+  fields->rssi = rssi_base - 3 + static_cast<int>(SimRng::ToRange(jitter[0], 7));
+  fields->snr_tenths = 135 + (rssi_base + 40) * 3 - 10 + static_cast<int>(SimRng::ToRange(jitter[1], 21));
+  fields->ns_delay_us = 5000 + SimRng::ToRange(jitter[2], 20000);  // 网关到网络服务器 5~25ms
+}
 
-  // 替换模板中的占位符
-  std::string result = uplink_template_;
+void Robot::EncodeUplink(EnvelopeFormat format, const uint8_t* frame, size_t size,
+                         std::string* out) {
+  switch (format) {
+    case EnvelopeFormat::kRaw:
+      out->assign(reinterpret_cast<const char*>(frame), size);
+      return;
 
-  // 替换devEui
-  const std::string placeholder_dev_eui = PLACEHOLDER_DEV_EUI;
-  size_t pos = result.find(placeholder_dev_eui);
-  if (pos != std::string::npos) {
-    result.replace(pos, placeholder_dev_eui.length(), robot_id_);
-  }
+    case EnvelopeFormat::kProtobuf: {
+      if (uplink_protobuf_.empty()) {
+        LOG(ERROR) << "上行数据模板为空";
+        out->clear();
+        return;
+      }
+      UplinkFields fields;
+      fields.data = reinterpret_cast<const char*>(frame);
+      fields.data_size = size;
+      FillUplinkFields(&fields);
+      const size_t dev_addr_pos = robot_id_.length() >= 8 ? robot_id_.length() - 8 : 0;
+      uplink_protobuf_.Encode(robot_id_, robot_id_.data() + dev_addr_pos,
+                              robot_id_.size() - dev_addr_pos, fields, out);
+      return;
+    }
 
-  // 替换devAddr
-  const std::string placeholder_dev_addr = PLACEHOLDER_DEV_ADDR;
-  pos = result.find(placeholder_dev_addr);
-  if (pos != std::string::npos) {
-    result.replace(pos, placeholder_dev_addr.length(), dev_addr);
+    case EnvelopeFormat::kJson:
+      break;
   }
 
-  // 替换data
-  const std::string placeholder_data = PLACEHOLDER_DATA;
-  pos = result.find(placeholder_data);
-  if (pos != std::string::npos) {
-    result.replace(pos, placeholder_data.length(), data);
+  if (size > kMaxFrameSize) {
+    LOG(ERROR) << "上行帧超出最大帧长度: " << size;
+    out->clear();
+    return;
   }
+  thread_local std::array<char, Protocol::Base64EncodedSize(kMaxFrameSize)> base64_buffer;
+  const size_t base64_size = Protocol::BytesToBase64(frame, size, base64_buffer.data());
+  TRACE_HOT(kProtocol, 2) << "  Base64编码: " << std::string_view(base64_buffer.data(), base64_size);
+  GenerateUplinkPayload(base64_buffer.data(), base64_size, out);
+}
 
-  return result;
+void Robot::PublishUplink(MqttManager* mqtt_manager, const uint8_t* frame, size_t size) {
+  // 编码缓冲区按线程复用（上报在调度器工作线程、回复在接收线程上执行）
+  thread_local std::string payload;
+  EncodeUplink(mqtt_manager->GetEnvelopeFormat(), frame, size, &payload);
+  mqtt_manager->EnqueueMessage(robot_id_, publish_topic_, payload, 1);
 }
 
 std::string Robot::LoadUplinkTemplate() {
@@ -241,6 +404,19 @@ void Robot::SetMqttManager(std::shared_ptr<MqttManager> manager) {
   mqtt_manager_ = manager;
   LOG(INFO) << "[Robot " << robot_id_ << "] MQTT管理器已设置";
 
+  // 在车队模拟引擎中分配槽位
+  if (!fleet_sim_) {
+    fleet_sim_ = manager->GetFleetSimEngine();
+    sim_slot_ = fleet_sim_->Register(robot_number_);
+  }
+  if (!fleet_alarm_) {
+    fleet_alarm_ = manager->GetFleetAlarmScheduler();
+    alarm_slot_ = fleet_alarm_->Register(this, robot_number_);
+  }
+  PublishData();
+  lazy_sim_ = manager->IsLazySimulation();
+  PublishSimMotion();
+
   // 自动启动定时上报
   StartReport();
 
@@ -254,10 +430,30 @@ void Robot::SetConfigDb(std::shared_ptr<ConfigDb> config_db) {
 }
 
 void Robot::UpdateAlarmsToDb() {
+  // 持锁发布并取出告警值与快照，数据库写入在锁外进行
+  std::function<void()> persist;
+  {
+    std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+    PublishData();
+    persist = MakeAlarmPersistTaskLocked();
+  }
+  if (persist) persist();
+}
+
+std::function<void()> Robot::ApplyAlarmFcBits(uint32_t set_bits, uint32_t clear_bits) {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  const uint32_t alarm_fc = (data_.alarm_fc & ~clear_bits) | set_bits;
+  if (alarm_fc == data_.alarm_fc) return nullptr;
+  data_.alarm_fc = alarm_fc;
+  PublishData();
+  return MakeAlarmPersistTaskLocked();
+}
+
+std::function<void()> Robot::MakeAlarmPersistTaskLocked() const {
   auto config_db = config_db_.lock();
   if (!config_db) {
     LOG(WARNING) << "[Robot " << robot_id_ << "] ConfigDb不可用，无法更新告警到数据库";
-    return;
+    return nullptr;
   }
 
   ConfigDb::AlarmData alarms;
@@ -266,900 +462,594 @@ void Robot::UpdateAlarmsToDb() {
   alarms.alarm_fc = data_.alarm_fc;
   alarms.alarm_fd = data_.alarm_fd;
 
-  if (config_db->UpdateRobotAlarms(robot_id_, alarms)) {
-    LOG(INFO) << "[Robot " << robot_id_ << "] 告警已更新到数据库: "
-              << "FA=0x" << std::hex << alarms.alarm_fa
-              << ", FB=0x" << alarms.alarm_fb
-              << ", FC=0x" << alarms.alarm_fc
-              << ", FD=0x" << alarms.alarm_fd;
+  return [config_db, robot_id = robot_id_, alarms, snapshot = SerializeDataSnapshot()]() {
+    if (config_db->UpdateRobotAlarms(robot_id, alarms)) {
+      LOG(INFO) << "[Robot " << robot_id << "] 告警已更新到数据库: "
+                << "FA=0x" << std::hex << alarms.alarm_fa
+                << ", FB=0x" << alarms.alarm_fb
+                << ", FC=0x" << alarms.alarm_fc
+                << ", FD=0x" << alarms.alarm_fd;
 
-    if (!config_db->UpdateRobotDataSnapshot(robot_id_, SerializeDataSnapshot())) {
-      LOG(WARNING) << "[Robot " << robot_id_ << "] 告警更新后写入快照失败";
+      if (!config_db->UpdateRobotDataSnapshot(robot_id, snapshot)) {
+        LOG(WARNING) << "[Robot " << robot_id << "] 告警更新后写入快照失败";
+      }
+    } else {
+      LOG(ERROR) << "[Robot " << robot_id << "] 告警更新到数据库失败";
     }
+  };
+}
+
+void Robot::HandleMessage(const uint8_t* data, size_t size) {
+  TRACE_HOT(kProtocol, 2) << "[Robot " << robot_id_ << "] 帧内容: " << HexDump(data, size);
+
+  // 零拷贝解析协议帧（数据域指向调用方缓冲区）
+  FrameView frame;
+  if (!Protocol::DecodeView(data, size, &frame)) {
+    LOG(INFO) << "[Robot " << robot_id_ << "] 收到消息";
+    LOG(ERROR) << "  协议解析失败";
+    std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+    PublishData();
+    return;
+  }
+  HandleFrame(frame);
+}
+
+const Robot::FrameHandlerTable& Robot::IdentifierHandlers() {
+  static const FrameHandlerTable table = {
+      {0xC0, "查询Lora参数&清扫设置", &Robot::HandleLoraCleanQuery},
+      {0xC1, "查询电机参数&温度电压参数", &Robot::HandleMotorParamsQuery},
+      {0xC2, "查询本地时间&环境信息", &Robot::HandleLocalTimeEnvQuery},
+      {0xA0, "电机参数设置", &Robot::HandleMotorParamsSet},
+      {0xA1, "电池参数设置", &Robot::HandleBatteryParamsSet},
+      {0xA2, "定时设置", &Robot::HandleScheduleSet},
+      {0xA3, "停机位设置", &Robot::HandleParkingPositionSet},
+      {0xA4, "LoRa参数设置", &Robot::HandleLoraParamsSet},
+      {0xA8, "广播参数设置", &Robot::HandleBroadcastSet},
+      {0xF0, "定时启动请求回复", &Robot::HandleScheduleStartReply},
+      {0xF1, "启动请求回复", &Robot::HandleStartReply},
+      {0xF2, "校时请求回复", &Robot::HandleTimeSyncReply},
+      {0xB0, "启用/解锁", &Robot::HandleControlCommand},
+      {0xB1, "停用/锁定", &Robot::HandleControlCommand},
+      {0xB2, "启动", &Robot::HandleControlCommand},
+      {0xB3, "前进", &Robot::HandleControlCommand},
+      {0xB4, "后退", &Robot::HandleControlCommand},
+      {0xB5, "停止", &Robot::HandleControlCommand},
+      {0xB6, "复位", &Robot::HandleControlCommand},
+      {0xBA, "重启", &Robot::HandleRestartCommand},
+      {0xFD, "固件升级开始命令", &Robot::HandleFirmwareUpgradeStart},
+  };
+  return table;
+}
+
+const Robot::FrameHandlerTable& Robot::ControlCodeHandlers() {
+  // 固件升级数据帧，数据域为原始固件字节（无标识）
+  static const FrameHandlerTable table = {
+      {0x50, "固件升级起始数据帧", &Robot::HandleFirmwareDataFrame},
+      {0x60, "固件升级中间数据帧", &Robot::HandleFirmwareDataFrame},
+      {0x70, "固件升级结束数据帧/结束命令", &Robot::HandleFirmwareDataFrame},
+  };
+  return table;
+}
+
+void Robot::HandleFrame(const FrameView& frame) {
+  TRACE_HOT(kProtocol, 2) << "[Robot " << robot_id_ << "] 协议解析成功 - 控制码: 0x" << std::hex
+                          << static_cast<int>(frame.control_code) << " 编号: 0x" << frame.number
+                          << " 帧计数: " << std::dec << static_cast<int>(frame.frame_count)
+                          << " 数据长度: " << static_cast<int>(frame.length);
+  TRACE_HOT(kProtocol, 2) << "    数据域: " << HexDump(frame.data.data(), frame.data.size());
+
+  // 处理函数与发布均持有写锁（与 HTTP 写入、上报/清扫定时器、告警调度器互斥）
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+
+  // 先按控制码分发（固件数据帧），否则按数据域首字节标识分发
+  const FrameHandlerTable* table = nullptr;
+  uint8_t key = 0;
+  if (ControlCodeHandlers().Find(frame.control_code) != nullptr) {
+    table = &ControlCodeHandlers();
+    key = frame.control_code;
+  } else if (!frame.data.empty()) {
+    table = &IdentifierHandlers();
+    key = frame.data[0];
+  }
+
+  if (table == nullptr) {
+    TRACE_HOT(kRobot, 1) << "[Robot " << robot_id_ << "] 收到消息 - 控制码: 0x" << std::hex
+                         << static_cast<int>(frame.control_code) << " (无数据域)";
+    PublishData();
+    return;
+  }
+
+  const auto* entry = table->Find(key);
+  TRACE_HOT(kRobot, 1) << "[Robot " << robot_id_ << "] 收到消息 - 控制码: 0x" << std::hex
+                       << static_cast<int>(frame.control_code)
+                       << (table == &IdentifierHandlers() ? " 标识符: 0x" : " 数据帧: 0x")
+                       << static_cast<int>(key) << " " << (entry ? entry->name : "未知命令");
+
+  const auto start = std::chrono::steady_clock::now();
+  if (entry == nullptr) {
+    LOG(WARNING) << "    未知命令标识: 0x" << std::hex << static_cast<int>(key);
   } else {
-    LOG(ERROR) << "[Robot " << robot_id_ << "] 告警更新到数据库失败";
+    try {
+      (this->*entry->handler)(frame);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "  处理消息异常: " << e.what();
+    }
   }
+  table->Record(key, std::chrono::steady_clock::now() - start);
+
+  // 发布处理后的数据
+  PublishData();
 }
 
-void Robot::HandleMessage(const std::string& data) {
-  LOG(INFO) << "[Robot " << robot_id_ << "] 收到消息";
-  LOG(INFO) << "  Base64内容: " << data;
+// 0xC2: 查询指令：本地时间&环境信息
+void Robot::HandleLocalTimeEnvQuery(const FrameView& frame) {
+  if (frame.control_code != CONTROL_CODE_UPLINK) {
+    LOG(INFO) << "    非平台下发控制码(0x"
+              << std::hex << static_cast<int>(frame.control_code)
+              << ")，忽略查询指令";
+    return;
+  }
 
-  try {
-    // Base64解码
-    std::vector<uint8_t> raw_bytes = Protocol::Base64ToBytes(data);
-    LOG(INFO) << "  解码后字节: " << Protocol::BytesToHexString(raw_bytes);
-
-    // 协议解码
-    ProtocolFrame frame;
-    if (protocol_.Decode(raw_bytes, frame)) {
-      LOG(INFO) << "  协议解析成功:";
-      LOG(INFO) << "    控制码: 0x" << std::hex << static_cast<int>(frame.control_code);
-      LOG(INFO) << "    编号: 0x" << std::hex << frame.number;
-      LOG(INFO) << "    帧计数: " << std::dec << static_cast<int>(frame.frame_count);
-      LOG(INFO) << "    数据长度: " << static_cast<int>(frame.length);
-      LOG(INFO) << "    数据域: " << Protocol::BytesToHexString(frame.data);
-
-      // 固件升级数据帧（控制码 0x50/0x60/0x70），数据域为原始固件字节
-      if (frame.control_code == 0x50 || frame.control_code == 0x60 || frame.control_code == 0x70) {
-        HandleFirmwareDataFrame(frame);
-      } else if (!frame.data.empty()) {  // 根据数据域的标识字段处理不同类型的命令
-        uint8_t identifier = frame.data[0];  // 第一个字节是标识
-        LOG(INFO) << "    标识符: 0x" << std::hex << static_cast<int>(identifier);
-
-        // 根据标识符处理不同的命令
-        switch (identifier) {
-          case 0xC2: {  // 查询指令：本地时间&环境信息
-            LOG(INFO) << "    命令类型: 查询本地时间&环境信息";
-
-            if (frame.control_code != CONTROL_CODE_UPLINK) {
-              LOG(INFO) << "    非平台下发控制码(0x"
-                        << std::hex << static_cast<int>(frame.control_code)
-                        << ")，忽略查询指令";
-              break;
-            }
-
-            // 查询指令仅包含标识符
-            if (frame.data.size() != 1) {
-              LOG(ERROR) << "    查询指令数据长度错误, 期望1, 实际: "
-                         << frame.data.size();
-              break;
-            }
-
-            auto mqtt_manager = mqtt_manager_.lock();
-            if (!mqtt_manager) {
-              LOG(ERROR) << "    MQTT管理器未初始化，无法回复查询指令";
-              break;
-            }
-
-            // 更新时间字段后再回复，确保返回当前本地时间
-            UpdateTimeFields();
-
-            // 构造响应数据域：标识(0xC2) + 本地时间(7字节) + 环境信息(7字节)
-            // 环境信息按协议：温度/湿度/环境温度各2字节 + 白夜状态1字节
-            std::vector<uint8_t> response_data;
-            response_data.reserve(15);
-            response_data.push_back(0xC2);
-
-            int year = data_.local_time.year % 100;
-            response_data.push_back(static_cast<uint8_t>(year & 0xFF));
-            response_data.push_back(static_cast<uint8_t>(data_.local_time.month));
-            response_data.push_back(static_cast<uint8_t>(data_.local_time.day));
-            response_data.push_back(static_cast<uint8_t>(data_.local_time.hour));
-            response_data.push_back(static_cast<uint8_t>(data_.local_time.minute));
-            response_data.push_back(static_cast<uint8_t>(data_.local_time.second));
-            response_data.push_back(static_cast<uint8_t>(data_.local_time.weekday));
-
-            uint16_t sensor_temp =
-                static_cast<uint16_t>(data_.environment_info.sensor_temperature);
-            uint16_t sensor_humidity =
-                static_cast<uint16_t>(data_.environment_info.sensor_humidity);
-            uint16_t ambient_temp =
-                static_cast<uint16_t>(data_.environment_info.ambient_temperature);
-
-            response_data.push_back(static_cast<uint8_t>(sensor_temp >> 8));
-            response_data.push_back(static_cast<uint8_t>(sensor_temp & 0xFF));
-            response_data.push_back(static_cast<uint8_t>(sensor_humidity >> 8));
-            response_data.push_back(static_cast<uint8_t>(sensor_humidity & 0xFF));
-            response_data.push_back(static_cast<uint8_t>(ambient_temp >> 8));
-            response_data.push_back(static_cast<uint8_t>(ambient_temp & 0xFF));
-            response_data.push_back(
-                static_cast<uint8_t>(data_.environment_info.day_night_status));
-
-            // 回复沿用请求中的编号与帧计数
-            std::vector<uint8_t> encoded =
-                protocol_.Encode(CONTROL_CODE_DOWNLINK, frame.number,
-                                 frame.frame_count, response_data);
-            std::string base64_data = Protocol::BytesToBase64(encoded);
-            std::string payload = GenerateUplinkPayload(base64_data);
-            mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-            LOG(INFO) << "    查询回复已发送: "
-                      << Protocol::BytesToHexString(encoded);
-            break;
-          }
-
-          case 0xC1: {  // 查询指令：电机参数&温度电压参数
-          LOG(INFO) << "    命令类型: 查询电机参数&温度电压参数";
-
-          if (frame.control_code != CONTROL_CODE_UPLINK) {
-            LOG(INFO) << "    非平台下发控制码(0x"
-                << std::hex << static_cast<int>(frame.control_code)
-                << ")，忽略查询指令";
-            break;
-          }
-
-          // 查询指令仅包含标识符
-          if (frame.data.size() != 1) {
-            LOG(ERROR) << "    查询指令数据长度错误, 期望1, 实际: "
-                 << frame.data.size();
-            break;
-          }
-
-          auto mqtt_manager = mqtt_manager_.lock();
-          if (!mqtt_manager) {
-            LOG(ERROR) << "    MQTT管理器未初始化，无法回复查询指令";
-            break;
-          }
-
-          // 构造响应数据域：标识(0xC1) + 电机参数(23字节) + 温度电压参数(15字节)
-          std::vector<uint8_t> response_data;
-          response_data.reserve(39);
-          response_data.push_back(0xC1);
-
-          // 电机参数 (23字节)
-          response_data.push_back(static_cast<uint8_t>(data_.motor_params.walk_motor_speed));
-          response_data.push_back(static_cast<uint8_t>(data_.motor_params.brush_motor_speed));
-          response_data.push_back(static_cast<uint8_t>(data_.motor_params.windproof_motor_speed));
-
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.walk_motor_max_current_ma >> 8));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.walk_motor_max_current_ma & 0xFF));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.brush_motor_max_current_ma >> 8));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.brush_motor_max_current_ma & 0xFF));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.windproof_motor_max_current_ma >> 8));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.windproof_motor_max_current_ma & 0xFF));
-
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.walk_motor_warning_current_ma >> 8));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.walk_motor_warning_current_ma & 0xFF));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.brush_motor_warning_current_ma >> 8));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.brush_motor_warning_current_ma & 0xFF));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.windproof_motor_warning_current_ma >> 8));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.windproof_motor_warning_current_ma & 0xFF));
-
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.walk_motor_mileage_m >> 8));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.walk_motor_mileage_m & 0xFF));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.brush_motor_timeout_s >> 8));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.brush_motor_timeout_s & 0xFF));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.windproof_motor_timeout_s >> 8));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.motor_params.windproof_motor_timeout_s & 0xFF));
-
-          response_data.push_back(static_cast<uint8_t>(data_.motor_params.reverse_time_s));
-          response_data.push_back(static_cast<uint8_t>(data_.motor_params.protection_angle));
-
-          // 温度电压参数 (15字节)
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.protection_current_ma >> 8));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.protection_current_ma & 0xFF));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.high_temp_threshold));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.low_temp_threshold));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.protection_temp));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.recovery_temp));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.protection_voltage));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.recovery_voltage));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.protection_battery_level));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.limit_run_battery_level));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.recovery_battery_level));
-
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.board_protection_temp >> 8));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.board_protection_temp & 0xFF));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.board_recovery_temp >> 8));
-          response_data.push_back(
-            static_cast<uint8_t>(data_.temp_voltage_protection.board_recovery_temp & 0xFF));
-
-          // 回复沿用请求中的编号与帧计数
-          std::vector<uint8_t> encoded =
-            protocol_.Encode(CONTROL_CODE_DOWNLINK, frame.number,
-                     frame.frame_count, response_data);
-          std::string base64_data = Protocol::BytesToBase64(encoded);
-          std::string payload = GenerateUplinkPayload(base64_data);
-          mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-          LOG(INFO) << "    查询回复已发送: "
-                << Protocol::BytesToHexString(encoded);
-          break;
-          }
-
-          case 0xC0: {  // 查询指令：Lora参数&清扫设置
-            LOG(INFO) << "    命令类型: 查询Lora参数&清扫设置";
-
-            if (frame.control_code != CONTROL_CODE_UPLINK) {
-              LOG(INFO) << "    非平台下发控制码(0x"
-                        << std::hex << static_cast<int>(frame.control_code)
-                        << ")，忽略查询指令";
-              break;
-            }
-
-            // 查询指令仅包含标识符
-            if (frame.data.size() != 1) {
-              LOG(ERROR) << "    查询指令数据长度错误, 期望1, 实际: "
-                         << frame.data.size();
-              break;
-            }
-
-            auto mqtt_manager = mqtt_manager_.lock();
-            if (!mqtt_manager) {
-              LOG(ERROR) << "    MQTT管理器未初始化，无法回复查询指令";
-              break;
-            }
-
-            // 构造响应数据域：标识(0xC0) + Lora参数 + 清扫设置
-            std::vector<uint8_t> response_data;
-            response_data.push_back(0xC0);
-
-            // Lora参数 (3字节)
-            response_data.push_back(static_cast<uint8_t>(data_.lora_params.power));
-            response_data.push_back(static_cast<uint8_t>(data_.lora_params.frequency));
-            response_data.push_back(static_cast<uint8_t>(data_.lora_params.rate));
-
-            // 机器人编号 (2字节)
-            uint16_t robot_num = 0;
-            try {
-              if (!data_.robot_number.empty()) {
-                robot_num = static_cast<uint16_t>(std::stoul(data_.robot_number));
-              }
-            } catch (...) {
-              robot_num = 0;
-            }
-            response_data.push_back(static_cast<uint8_t>(robot_num >> 8));
-            response_data.push_back(static_cast<uint8_t>(robot_num & 0xFF));
-
-            // 软件版本 (2字节)
-            uint8_t major_version = 1;
-            uint8_t minor_version = 0;
-            if (!data_.software_version.empty()) {
-              sscanf(data_.software_version.c_str(), "%hhu.%hhu", &major_version,
-                     &minor_version);
-            }
-            response_data.push_back(major_version);
-            response_data.push_back(minor_version);
-
-            // 启用/停用 + 保留 + 停机位 + 白天防误扫
-            response_data.push_back(0x00);
-            response_data.push_back(0x00);
-            response_data.push_back(static_cast<uint8_t>(data_.parking_position));
-            response_data.push_back(data_.daytime_scan_protect ? 0x01 : 0x00);
-
-            // 定时任务1-7 (每组4字节)
-            for (int i = 0; i < 7; ++i) {
-              const auto& task = data_.schedule_tasks[i];
-              response_data.push_back(static_cast<uint8_t>(task.weekday));
-              response_data.push_back(static_cast<uint8_t>(task.hour));
-              response_data.push_back(static_cast<uint8_t>(task.minute));
-              response_data.push_back(static_cast<uint8_t>(task.run_count));
-            }
-
-            // 回复沿用请求中的编号与帧计数
-            std::vector<uint8_t> encoded =
-                protocol_.Encode(CONTROL_CODE_DOWNLINK, frame.number,
-                                 frame.frame_count, response_data);
-            std::string base64_data = Protocol::BytesToBase64(encoded);
-            std::string payload = GenerateUplinkPayload(base64_data);
-            mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-            LOG(INFO) << "    查询回复已发送: "
-                      << Protocol::BytesToHexString(encoded);
-            break;
-          }
-
-          case 0xA0: {  // 电机参数设置
-            LOG(INFO) << "    命令类型: 电机参数设置";
-
-            if (frame.control_code != CONTROL_CODE_UPLINK) {
-              LOG(INFO) << "    非平台下发控制码(0x"
-                        << std::hex << static_cast<int>(frame.control_code)
-                        << ")，忽略电机参数写入";
-              break;
-            }
-
-            // 标识(1) + 参数(23) = 24字节
-            if (frame.data.size() != 24) {
-              LOG(ERROR) << "    电机参数数据长度错误, 期望24, 实际: "
-                         << frame.data.size();
-              break;
-            }
-
-            data_.motor_params.walk_motor_speed = frame.data[1];
-            data_.motor_params.brush_motor_speed = frame.data[2];
-            data_.motor_params.windproof_motor_speed = frame.data[3];
-
-            data_.motor_params.walk_motor_max_current_ma =
-                (static_cast<int>(frame.data[4]) << 8) | frame.data[5];
-            data_.motor_params.brush_motor_max_current_ma =
-                (static_cast<int>(frame.data[6]) << 8) | frame.data[7];
-            data_.motor_params.windproof_motor_max_current_ma =
-                (static_cast<int>(frame.data[8]) << 8) | frame.data[9];
-
-            data_.motor_params.walk_motor_warning_current_ma =
-                (static_cast<int>(frame.data[10]) << 8) | frame.data[11];
-            data_.motor_params.brush_motor_warning_current_ma =
-                (static_cast<int>(frame.data[12]) << 8) | frame.data[13];
-            data_.motor_params.windproof_motor_warning_current_ma =
-                (static_cast<int>(frame.data[14]) << 8) | frame.data[15];
-
-            data_.motor_params.walk_motor_mileage_m =
-                (static_cast<int>(frame.data[16]) << 8) | frame.data[17];
-            data_.motor_params.brush_motor_timeout_s =
-                (static_cast<int>(frame.data[18]) << 8) | frame.data[19];
-            data_.motor_params.windproof_motor_timeout_s =
-                (static_cast<int>(frame.data[20]) << 8) | frame.data[21];
-            data_.motor_params.reverse_time_s = frame.data[22];
-            data_.motor_params.protection_angle = frame.data[23];
-
-            LOG(INFO) << "    电机参数已更新 - 行走/毛刷/防风速率: "
-                      << data_.motor_params.walk_motor_speed << "/"
-                      << data_.motor_params.brush_motor_speed << "/"
-                      << data_.motor_params.windproof_motor_speed;
-
-            auto mqtt_manager = mqtt_manager_.lock();
-            if (!mqtt_manager) {
-              LOG(ERROR) << "    MQTT管理器未初始化，无法回复电机参数设置";
-              break;
-            }
-
-            // 按协议回复：数据域与下发一致，仅控制码改为0x82
-            std::vector<uint8_t> response_data = frame.data;
-            std::vector<uint8_t> encoded =
-                protocol_.Encode(CONTROL_CODE_DOWNLINK, frame.number,
-                                 frame.frame_count, response_data);
-            std::string base64_data = Protocol::BytesToBase64(encoded);
-            std::string payload = GenerateUplinkPayload(base64_data);
-            mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-            LOG(INFO) << "    电机参数设置回复已发送: "
-                      << Protocol::BytesToHexString(encoded);
-
-            auto config_db = config_db_.lock();
-            if (config_db && !config_db->UpdateRobotDataSnapshot(robot_id_, SerializeDataSnapshot())) {
-              LOG(WARNING) << "    电机参数设置后写入快照失败";
-            }
-            break;
-          }
-
-          case 0xA1: {  // 电池参数设置
-            LOG(INFO) << "    命令类型: 电池参数设置";
-
-            if (frame.control_code != CONTROL_CODE_UPLINK) {
-              LOG(INFO) << "    非平台下发控制码(0x"
-                        << std::hex << static_cast<int>(frame.control_code)
-                        << ")，忽略电池参数写入";
-              break;
-            }
-
-            // 标识(1) + 参数(11) = 12字节
-            if (frame.data.size() != 12) {
-              LOG(ERROR) << "    电池参数数据长度错误, 期望12, 实际: "
-                         << frame.data.size();
-              break;
-            }
-
-            data_.temp_voltage_protection.protection_current_ma =
-                (static_cast<int>(frame.data[1]) << 8) | frame.data[2];
-            data_.temp_voltage_protection.high_temp_threshold = frame.data[3];
-            data_.temp_voltage_protection.low_temp_threshold = frame.data[4];
-            data_.temp_voltage_protection.protection_temp = frame.data[5];
-            data_.temp_voltage_protection.recovery_temp = frame.data[6];
-            data_.temp_voltage_protection.protection_voltage = frame.data[7];
-            data_.temp_voltage_protection.recovery_voltage = frame.data[8];
-            data_.temp_voltage_protection.protection_battery_level = frame.data[9];
-            data_.temp_voltage_protection.limit_run_battery_level = frame.data[10];
-            data_.temp_voltage_protection.recovery_battery_level = frame.data[11];
-
-            LOG(INFO) << "    电池参数已更新 - 保护电流(mA): "
-                      << data_.temp_voltage_protection.protection_current_ma;
-
-            auto mqtt_manager = mqtt_manager_.lock();
-            if (!mqtt_manager) {
-              LOG(ERROR) << "    MQTT管理器未初始化，无法回复电池参数设置";
-              break;
-            }
-
-            std::vector<uint8_t> response_data = frame.data;
-            std::vector<uint8_t> encoded =
-                protocol_.Encode(CONTROL_CODE_DOWNLINK, frame.number,
-                                 frame.frame_count, response_data);
-            std::string base64_data = Protocol::BytesToBase64(encoded);
-            std::string payload = GenerateUplinkPayload(base64_data);
-            mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-            LOG(INFO) << "    电池参数设置回复已发送: "
-                      << Protocol::BytesToHexString(encoded);
-
-            auto config_db = config_db_.lock();
-            if (config_db &&
-                !config_db->UpdateRobotDataSnapshot(robot_id_, SerializeDataSnapshot())) {
-              LOG(WARNING) << "    电池参数设置后写入快照失败";
-            }
-            break;
-          }
-
-          case 0xA2: {  // 定时设置
-            LOG(INFO) << "    命令类型: 定时设置";
-
-            if (frame.control_code != CONTROL_CODE_UPLINK) {
-              LOG(INFO) << "    非平台下发控制码(0x"
-                        << std::hex << static_cast<int>(frame.control_code)
-                        << ")，忽略定时任务写入";
-              break;
-            }
-
-            // 标识(1) + 7组定时参数(每组4字节) = 29字节
-            if (frame.data.size() != 29) {
-              LOG(ERROR) << "    定时设置数据长度错误, 期望29, 实际: "
-                         << frame.data.size();
-              break;
-            }
-
-            if (data_.schedule_tasks.size() < 7) {
-              data_.schedule_tasks.resize(7);
-            }
-
-            for (size_t i = 0; i < 7; ++i) {
-              size_t offset = 1 + i * 4;
-              data_.schedule_tasks[i].weekday = frame.data[offset];
-              data_.schedule_tasks[i].hour = frame.data[offset + 1];
-              data_.schedule_tasks[i].minute = frame.data[offset + 2];
-              uint8_t run_count = frame.data[offset + 3];
-              data_.schedule_tasks[i].run_count =
-                  (run_count < 127) ? static_cast<int>(run_count * 2)
-                                    : static_cast<int>(run_count);
-            }
-
-            auto mqtt_manager = mqtt_manager_.lock();
-            if (!mqtt_manager) {
-              LOG(ERROR) << "    MQTT管理器未初始化，无法回复定时设置";
-              break;
-            }
-
-            // 按协议回复：数据域与下发一致，仅控制码改为0x82；
-            // 运行次数字段当值<127时，回包填充为请求值*2。
-            std::vector<uint8_t> response_data = frame.data;
-            for (size_t i = 0; i < 7; ++i) {
-              size_t run_count_index = 1 + i * 4 + 3;
-              uint8_t run_count = frame.data[run_count_index];
-              if (run_count < 127) {
-                response_data[run_count_index] = static_cast<uint8_t>(run_count * 2);
-              }
-            }
-
-            std::vector<uint8_t> encoded =
-                protocol_.Encode(CONTROL_CODE_DOWNLINK, frame.number,
-                                 frame.frame_count, response_data);
-            std::string base64_data = Protocol::BytesToBase64(encoded);
-            std::string payload = GenerateUplinkPayload(base64_data);
-            mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-            LOG(INFO) << "    定时设置回复已发送: "
-                      << Protocol::BytesToHexString(encoded);
-
-            auto config_db = config_db_.lock();
-            if (config_db &&
-                !config_db->UpdateRobotDataSnapshot(robot_id_, SerializeDataSnapshot())) {
-              LOG(WARNING) << "    定时设置后写入快照失败";
-            }
-            break;
-          }
-
-          case 0xA3: {  // 停机位设置
-            LOG(INFO) << "    命令类型: 停机位设置";
-
-            if (frame.control_code != CONTROL_CODE_UPLINK) {
-              LOG(INFO) << "    非平台下发控制码(0x"
-                        << std::hex << static_cast<int>(frame.control_code)
-                        << ")，忽略停机位写入";
-              break;
-            }
-
-            // 标识(1) + 参数(1) = 2字节
-            if (frame.data.size() != 2) {
-              LOG(ERROR) << "    停机位设置数据长度错误, 期望2, 实际: "
-                         << frame.data.size();
-              break;
-            }
-
-            data_.parking_position = frame.data[1];
-            LOG(INFO) << "    停机位已更新: " << data_.parking_position;
-
-            auto mqtt_manager = mqtt_manager_.lock();
-            if (!mqtt_manager) {
-              LOG(ERROR) << "    MQTT管理器未初始化，无法回复停机位设置";
-              break;
-            }
-
-            // 按协议回复：数据域与下发一致，仅控制码改为0x82
-            std::vector<uint8_t> response_data = frame.data;
-            std::vector<uint8_t> encoded =
-                protocol_.Encode(CONTROL_CODE_DOWNLINK, frame.number,
-                                 frame.frame_count, response_data);
-            std::string base64_data = Protocol::BytesToBase64(encoded);
-            std::string payload = GenerateUplinkPayload(base64_data);
-            mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-            LOG(INFO) << "    停机位设置回复已发送: "
-                      << Protocol::BytesToHexString(encoded);
-
-            auto config_db = config_db_.lock();
-            if (config_db &&
-                !config_db->UpdateRobotDataSnapshot(robot_id_, SerializeDataSnapshot())) {
-              LOG(WARNING) << "    停机位设置后写入快照失败";
-            }
-            break;
-          }
-
-          case 0xA8: {  // 广播参数设置
-            LOG(INFO) << "    命令类型: 广播参数设置";
-
-            if (frame.control_code != CONTROL_CODE_UPLINK) {
-              LOG(INFO) << "    非平台下发控制码(0x"
-                        << std::hex << static_cast<int>(frame.control_code)
-                        << ")，忽略广播参数写入";
-              break;
-            }
-
-            // 标识(1) + 时间(7) + 风速(1) + 通信箱数量(2) + 机器人数量(2) + 后台保护(1) = 14字节
-            if (frame.data.size() != 14) {
-              LOG(ERROR) << "    广播参数设置数据长度错误, 期望14, 实际: "
-                         << frame.data.size();
-              break;
-            }
-
-            uint8_t year = frame.data[1];
-            uint8_t month = frame.data[2];
-            uint8_t day = frame.data[3];
-            uint8_t hour = frame.data[4];
-            uint8_t minute = frame.data[5];
-            uint8_t second = frame.data[6];
-            uint8_t weekday = frame.data[7];
-            uint8_t wind_speed = frame.data[8];
-
-            uint16_t comm_box_count =
-                (static_cast<uint16_t>(frame.data[9]) << 8) | frame.data[10];
-            uint16_t robot_count =
-                (static_cast<uint16_t>(frame.data[11]) << 8) | frame.data[12];
-            uint8_t protection_info = frame.data[13];
-
-            data_.local_time.year = 2000 + year;
-            data_.local_time.month = month;
-            data_.local_time.day = day;
-            data_.local_time.hour = hour;
-            data_.local_time.minute = minute;
-            data_.local_time.second = second;
-            data_.local_time.weekday = weekday;
-            data_.current_timestamp.hour = hour;
-            data_.current_timestamp.minute = minute;
-            data_.current_timestamp.second = second;
-
-            LOG(INFO) << "    广播参数已更新 - 时间: 20" << std::setfill('0')
-                      << std::setw(2) << static_cast<int>(year) << "-"
-                      << std::setw(2) << static_cast<int>(month) << "-"
-                      << std::setw(2) << static_cast<int>(day) << " "
-                      << std::setw(2) << static_cast<int>(hour) << ":"
-                      << std::setw(2) << static_cast<int>(minute) << ":"
-                      << std::setw(2) << static_cast<int>(second)
-                      << " 星期" << static_cast<int>(weekday)
-                      << " 风速=" << static_cast<int>(wind_speed)
-                      << " 通信箱=" << comm_box_count
-                      << " 机器人数=" << robot_count
-                      << " 保护位=0x" << std::hex
-                      << static_cast<int>(protection_info);
-
-            // 广播指令按协议不回复
-            LOG(INFO) << "    广播参数设置按协议不回复";
-
-            auto config_db = config_db_.lock();
-            if (config_db &&
-                !config_db->UpdateRobotDataSnapshot(robot_id_, SerializeDataSnapshot())) {
-              LOG(WARNING) << "    广播参数设置后写入快照失败";
-            }
-            break;
-          }
-
-          case 0xA4:  // LoRa参数设置
-            LOG(INFO) << "    命令类型: LoRa参数设置";
-            // TODO: 解析参数并更新配置
-            break;
-
-          case 0xF0: {  // 定时启动请求回复
-            LOG(INFO) << "    命令类型: 定时启动请求回复";
-            if (frame.data.size() >= 15) {  // 标识(1) + 参数(14)
-              uint8_t start_flag = frame.data[1];           // 启动运行标志
-              uint8_t year = frame.data[2];                 // 年
-              uint8_t month = frame.data[3];                // 月
-              uint8_t day = frame.data[4];                  // 日
-              uint8_t hour = frame.data[5];                 // 时
-              uint8_t minute = frame.data[6];               // 分
-              uint8_t second = frame.data[7];               // 秒
-              uint8_t weekday = frame.data[8];              // 星期
-              uint8_t wind_speed = frame.data[9];           // 当前风速
-              uint16_t comm_box_count = (static_cast<uint16_t>(frame.data[10]) << 8) | frame.data[11];  // 通信箱数量
-              uint16_t robot_count = (static_cast<uint16_t>(frame.data[12]) << 8) | frame.data[13];     // 机器人数量
-              uint8_t protection_info = frame.data[14];     // 后台保护信息
-
-              data_.request_reply.available = true;
-              data_.request_reply.start_flag = start_flag;
-              data_.request_reply.year = year;
-              data_.request_reply.month = month;
-              data_.request_reply.day = day;
-              data_.request_reply.hour = hour;
-              data_.request_reply.minute = minute;
-              data_.request_reply.second = second;
-              data_.request_reply.weekday = weekday;
-              data_.request_reply.wind_speed = wind_speed;
-              data_.request_reply.comm_box_count = comm_box_count;
-              data_.request_reply.robot_count = robot_count;
-              data_.request_reply.protection_info = protection_info;
-
-              LOG(INFO) << "    === 定时启动请求回复解析 ===";
-              LOG(INFO) << "    启动运行标志: 0x" << std::hex << static_cast<int>(start_flag);
-              LOG(INFO) << "    时间信息: 20" << std::dec << static_cast<int>(year)
-                       << "-" << std::setfill('0') << std::setw(2) << static_cast<int>(month)
-                       << "-" << std::setw(2) << static_cast<int>(day)
-                       << " " << std::setw(2) << static_cast<int>(hour)
-                       << ":" << std::setw(2) << static_cast<int>(minute)
-                       << ":" << std::setw(2) << static_cast<int>(second)
-                       << " 星期" << static_cast<int>(weekday);
-              LOG(INFO) << "    当前风速: " << static_cast<int>(wind_speed);
-              LOG(INFO) << "    通信箱数量: " << comm_box_count;
-              LOG(INFO) << "    机器人数量: " << robot_count;
-              LOG(INFO) << "    后台保护信息: 0x" << std::hex << static_cast<int>(protection_info);
-              LOG(INFO) << "      - 大风保护: " << (IsWindProtectionEnabled(protection_info) ? "开启" : "关闭");
-              LOG(INFO) << "      - 湿度保护: " << (IsHumidityProtectionEnabled(protection_info) ? "开启" : "关闭");
-              LOG(INFO) << "      - 支架保护: " << (IsBracketProtectionEnabled(protection_info) ? "开启" : "关闭");
-              LOG(INFO) << "      - 环境温度保护: " << (IsAmbientTemperatureProtectionEnabled(protection_info) ? "开启" : "关闭");
-              MarkRequestReplyReceived();
-            } else {
-              LOG(ERROR) << "    定时启动回复数据长度不足";
-            }
-            break;
-          }
-
-          case 0xF1: {  // 启动请求回复
-            LOG(INFO) << "    命令类型: 启动请求回复";
-            if (frame.data.size() >= 15) {  // 标识(1) + 参数(14)
-              uint8_t start_flag = frame.data[1];           // 启动运行标志
-              uint8_t year = frame.data[2];                 // 年
-              uint8_t month = frame.data[3];                // 月
-              uint8_t day = frame.data[4];                  // 日
-              uint8_t hour = frame.data[5];                 // 时
-              uint8_t minute = frame.data[6];               // 分
-              uint8_t second = frame.data[7];               // 秒
-              uint8_t weekday = frame.data[8];              // 星期
-              uint8_t wind_speed = frame.data[9];           // 当前风速
-              uint16_t comm_box_count = (static_cast<uint16_t>(frame.data[10]) << 8) | frame.data[11];  // 通信箱数量
-              uint16_t robot_count = (static_cast<uint16_t>(frame.data[12]) << 8) | frame.data[13];     // 机器人数量
-              uint8_t protection_info = frame.data[14];     // 后台保护信息
-
-              data_.request_reply.available = true;
-              data_.request_reply.start_flag = start_flag;
-              data_.request_reply.year = year;
-              data_.request_reply.month = month;
-              data_.request_reply.day = day;
-              data_.request_reply.hour = hour;
-              data_.request_reply.minute = minute;
-              data_.request_reply.second = second;
-              data_.request_reply.weekday = weekday;
-              data_.request_reply.wind_speed = wind_speed;
-              data_.request_reply.comm_box_count = comm_box_count;
-              data_.request_reply.robot_count = robot_count;
-              data_.request_reply.protection_info = protection_info;
-
-              LOG(INFO) << "    === 启动请求回复解析 ===";
-              LOG(INFO) << "    启动运行标志: 0x" << std::hex << static_cast<int>(start_flag);
-              LOG(INFO) << "    时间信息: 20" << std::dec << static_cast<int>(year)
-                       << "-" << std::setfill('0') << std::setw(2) << static_cast<int>(month)
-                       << "-" << std::setw(2) << static_cast<int>(day)
-                       << " " << std::setw(2) << static_cast<int>(hour)
-                       << ":" << std::setw(2) << static_cast<int>(minute)
-                       << ":" << std::setw(2) << static_cast<int>(second)
-                       << " 星期" << static_cast<int>(weekday);
-              LOG(INFO) << "    当前风速: " << static_cast<int>(wind_speed);
-              LOG(INFO) << "    通信箱数量: " << comm_box_count;
-              LOG(INFO) << "    机器人数量: " << robot_count;
-              LOG(INFO) << "    后台保护信息: 0x" << std::hex << static_cast<int>(protection_info);
-              LOG(INFO) << "      - 大风保护: " << (IsWindProtectionEnabled(protection_info) ? "开启" : "关闭");
-              LOG(INFO) << "      - 湿度保护: " << (IsHumidityProtectionEnabled(protection_info) ? "开启" : "关闭");
-              LOG(INFO) << "      - 支架保护: " << (IsBracketProtectionEnabled(protection_info) ? "开启" : "关闭");
-              LOG(INFO) << "      - 环境温度保护: " << (IsAmbientTemperatureProtectionEnabled(protection_info) ? "开启" : "关闭");
-              MarkRequestReplyReceived();
-            } else {
-              LOG(ERROR) << "    启动请求回复数据长度不足";
-            }
-            break;
-          }
-
-          case 0xF2: {  // 校时请求回复
-            LOG(INFO) << "    命令类型: 校时请求回复";
-            if (frame.data.size() >= 14) {  // 标识(1) + 参数(13)
-              uint8_t year = frame.data[1];                 // 年
-              uint8_t month = frame.data[2];                // 月
-              uint8_t day = frame.data[3];                  // 日
-              uint8_t hour = frame.data[4];                 // 时
-              uint8_t minute = frame.data[5];               // 分
-              uint8_t second = frame.data[6];               // 秒
-              uint8_t weekday = frame.data[7];              // 星期
-              uint8_t wind_speed = frame.data[8];           // 当前风速
-              uint16_t comm_box_count = (static_cast<uint16_t>(frame.data[9]) << 8) | frame.data[10];   // 通信箱数量
-              uint16_t robot_count = (static_cast<uint16_t>(frame.data[11]) << 8) | frame.data[12];    // 机器人数量
-              uint8_t protection_info = frame.data[13];     // 后台保护信息
-
-              data_.request_reply.available = true;
-              data_.request_reply.start_flag = 0;
-              data_.request_reply.year = year;
-              data_.request_reply.month = month;
-              data_.request_reply.day = day;
-              data_.request_reply.hour = hour;
-              data_.request_reply.minute = minute;
-              data_.request_reply.second = second;
-              data_.request_reply.weekday = weekday;
-              data_.request_reply.wind_speed = wind_speed;
-              data_.request_reply.comm_box_count = comm_box_count;
-              data_.request_reply.robot_count = robot_count;
-              data_.request_reply.protection_info = protection_info;
-
-              LOG(INFO) << "    === 校时请求回复解析 ===";
-              LOG(INFO) << "    时间信息: 20" << std::dec << static_cast<int>(year)
-                       << "-" << std::setfill('0') << std::setw(2) << static_cast<int>(month)
-                       << "-" << std::setw(2) << static_cast<int>(day)
-                       << " " << std::setw(2) << static_cast<int>(hour)
-                       << ":" << std::setw(2) << static_cast<int>(minute)
-                       << ":" << std::setw(2) << static_cast<int>(second)
-                       << " 星期" << static_cast<int>(weekday);
-              LOG(INFO) << "    当前风速: " << static_cast<int>(wind_speed);
-              LOG(INFO) << "    通信箱数量: " << comm_box_count;
-              LOG(INFO) << "    机器人数量: " << robot_count;
-              LOG(INFO) << "    后台保护信息: 0x" << std::hex << static_cast<int>(protection_info);
-              LOG(INFO) << "      - 大风保护: " << (IsWindProtectionEnabled(protection_info) ? "开启" : "关闭");
-              LOG(INFO) << "      - 湿度保护: " << (IsHumidityProtectionEnabled(protection_info) ? "开启" : "关闭");
-              LOG(INFO) << "      - 支架保护: " << (IsBracketProtectionEnabled(protection_info) ? "开启" : "关闭");
-              LOG(INFO) << "      - 环境温度保护: " << (IsAmbientTemperatureProtectionEnabled(protection_info) ? "开启" : "关闭");
-              MarkRequestReplyReceived();
-            } else {
-              LOG(ERROR) << "    校时请求回复数据长度不足";
-            }
-            break;
-          }
-
-          // 控制类指令 (0xB0-0xB6)
-          case 0xB0:  // 启用/解锁
-            LOG(INFO) << "    命令类型: 启用/解锁";
-            ControlEnable();
-            SendControlResponse(0xB0);
-            break;
-
-          case 0xB1:  // 停用/锁定
-            LOG(INFO) << "    命令类型: 停用/锁定";
-            ControlDisable();
-            SendControlResponse(0xB1);
-            break;
-
-          case 0xB2:  // 启动
-            LOG(INFO) << "    命令类型: 启动";
-            ControlStart();
-            SendControlResponse(0xB2);
-            break;
-
-          case 0xB3:  // 前进
-            LOG(INFO) << "    命令类型: 前进";
-            ControlForward();
-            SendControlResponse(0xB3);
-            break;
-
-          case 0xB4:  // 后退
-            LOG(INFO) << "    命令类型: 后退";
-            ControlBackward();
-            SendControlResponse(0xB4);
-            break;
-
-          case 0xB5:  // 停止
-            LOG(INFO) << "    命令类型: 停止";
-            ControlStop();
-            SendControlResponse(0xB5);
-            break;
-
-          case 0xB6:  // 复位
-            LOG(INFO) << "    命令类型: 复位";
-            SendControlResponse(0xB6);
-            break;
-
-          case 0xBA:  // 重启指令
-            LOG(INFO) << "    命令类型: 重启";
-            // 发送简单响应（只包含标识符，不含机器人数据）
-            SendRestartResponse(0xBA);
-            break;
-
-          case 0xFD: {  // 固件升级开始命令 (控制码 0x41, FD 70 版本高 版本低)
-            LOG(INFO) << "    命令类型: 固件升级开始命令";
-            if (frame.data.size() < 4) {
-              LOG(ERROR) << "    升级命令数据不足, 期望>=4, 实际: " << frame.data.size();
-              break;
-            }
-            if (frame.data[1] != 0x70) {
-              LOG(WARNING) << "    未知升级子命令: 0x" << std::hex << static_cast<int>(frame.data[1]);
-              break;
-            }
-            upgrade_version_high_ = frame.data[2];
-            upgrade_version_low_  = frame.data[3];
-            upgrade_received_bytes_ = 0;
-            upgrade_in_progress_  = true;
-            upgrade_save_path_ = "firmware_" + robot_id_ + ".bin";
-
-            if (upgrade_file_.is_open()) upgrade_file_.close();
-            upgrade_file_.open(upgrade_save_path_, std::ios::binary | std::ios::trunc);
-            if (!upgrade_file_.is_open()) {
-              LOG(ERROR) << "    无法创建固件文件: " << upgrade_save_path_;
-              break;
-            }
-            LOG(INFO) << "    固件升级开始 - 版本: "
-                      << static_cast<int>(upgrade_version_high_) << "."
-                      << static_cast<int>(upgrade_version_low_)
-                      << " 保存至: " << upgrade_save_path_;
-            {
-              auto mqtt_manager_ota = mqtt_manager_.lock();
-              if (!mqtt_manager_ota) break;
-              uint16_t robot_num_ota = 0;
-              try { if (!data_.robot_number.empty()) robot_num_ota = static_cast<uint16_t>(std::stoul(data_.robot_number)); } catch (...) {}
-              std::vector<uint8_t> enc = protocol_.Encode(0x81, robot_num_ota, frame.frame_count, {});
-              mqtt_manager_ota->EnqueueMessage(publish_topic_, GenerateUplinkPayload(Protocol::BytesToBase64(enc)), 1);
-              sequence_.fetch_add(1);
-              LOG(INFO) << "    升级开始响应已发送 (0x81)";
-            }
-            break;
-          }
-
-          default:
-            LOG(WARNING) << "    未知命令标识: 0x" << std::hex << static_cast<int>(identifier);
-            break;
-        }
-      }
-    } else {
-      LOG(ERROR) << "  协议解析失败";
+  // 查询指令仅包含标识符
+  if (frame.data.size() != 1) {
+    LOG(ERROR) << "    查询指令数据长度错误, 期望1, 实际: "
+               << frame.data.size();
+    return;
+  }
+
+  auto mqtt_manager = mqtt_manager_.lock();
+  if (!mqtt_manager) {
+    LOG(ERROR) << "    MQTT管理器未初始化，无法回复查询指令";
+    return;
+  }
+
+  // 更新时间字段后再回复，确保返回当前本地时间
+  UpdateTimeFields();
+
+  // 构造响应数据域：标识(0xC2) + 本地时间(7字节) + 环境信息(7字节)
+  // 环境信息按协议：温度/湿度/环境温度各2字节 + 白夜状态1字节
+  // 回复沿用请求中的编号与帧计数
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  w.Begin(CONTROL_CODE_DOWNLINK, frame.number, frame.frame_count);
+  LocalTimeEnvReplySchema::Encode(
+      &w, data_.local_time.year % 100, data_.local_time.month, data_.local_time.day,
+      data_.local_time.hour, data_.local_time.minute, data_.local_time.second,
+      data_.local_time.weekday,
+      static_cast<uint16_t>(data_.environment_info.sensor_temperature),
+      static_cast<uint16_t>(data_.environment_info.sensor_humidity),
+      static_cast<uint16_t>(data_.environment_info.ambient_temperature),
+      data_.environment_info.day_night_status);
+
+  if (PublishFrame(mqtt_manager.get(), &w)) {
+    TRACE(kRobot, 1) << "    查询回复已发送";
+    TRACE(kProtocol, 2) << "    回复帧: " << HexDump(w.Data(), w.Size());
+  }
+}
+
+// 0xC1: 查询指令：电机参数&温度电压参数
+void Robot::HandleMotorParamsQuery(const FrameView& frame) {
+  if (frame.control_code != CONTROL_CODE_UPLINK) {
+    LOG(INFO) << "    非平台下发控制码(0x"
+        << std::hex << static_cast<int>(frame.control_code)
+        << ")，忽略查询指令";
+    return;
+  }
+
+  if (frame.data.size() != 1) {
+    LOG(ERROR) << "    查询指令数据长度错误, 期望1, 实际: "
+         << frame.data.size();
+    return;
+  }
+
+  auto mqtt_manager = mqtt_manager_.lock();
+  if (!mqtt_manager) {
+    LOG(ERROR) << "    MQTT管理器未初始化，无法回复查询指令";
+    return;
+  }
+
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  w.Begin(CONTROL_CODE_DOWNLINK, frame.number, frame.frame_count);
+  BuildMotorParamsField(0xC1, &w);
+
+  if (PublishFrame(mqtt_manager.get(), &w)) {
+    TRACE(kRobot, 1) << "    查询回复已发送";
+    TRACE(kProtocol, 2) << "    回复帧: " << HexDump(w.Data(), w.Size());
+  }
+}
+
+// 0xC0: 查询指令：Lora参数&清扫设置
+void Robot::HandleLoraCleanQuery(const FrameView& frame) {
+  if (frame.control_code != CONTROL_CODE_UPLINK) {
+    LOG(INFO) << "    非平台下发控制码(0x"
+              << std::hex << static_cast<int>(frame.control_code)
+              << ")，忽略查询指令";
+    return;
+  }
+
+  // 查询指令仅包含标识符
+  if (frame.data.size() != 1) {
+    LOG(ERROR) << "    查询指令数据长度错误, 期望1, 实际: "
+               << frame.data.size();
+    return;
+  }
+
+  auto mqtt_manager = mqtt_manager_.lock();
+  if (!mqtt_manager) {
+    LOG(ERROR) << "    MQTT管理器未初始化，无法回复查询指令";
+    return;
+  }
+
+  // 构造响应数据域：标识(0xC0) + Lora参数 + 清扫设置
+  // 回复沿用请求中的编号与帧计数
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  w.Begin(CONTROL_CODE_DOWNLINK, frame.number, frame.frame_count);
+  BuildLoraCleanField(0xC0, &w);
+
+  if (PublishFrame(mqtt_manager.get(), &w)) {
+    TRACE(kRobot, 1) << "    查询回复已发送";
+    TRACE(kProtocol, 2) << "    回复帧: " << HexDump(w.Data(), w.Size());
+  }
+}
+
+// 0xA0: 电机参数设置
+void Robot::HandleMotorParamsSet(const FrameView& frame) {
+  if (frame.control_code != CONTROL_CODE_UPLINK) {
+    LOG(INFO) << "    非平台下发控制码(0x"
+              << std::hex << static_cast<int>(frame.control_code)
+              << ")，忽略电机参数写入";
+    return;
+  }
+
+  // 标识(1) + 参数(23) = 24字节
+  if (frame.data.size() != MotorParamsSetSchema::kSize) {
+    LOG(ERROR) << "    电机参数数据长度错误, 期望" << MotorParamsSetSchema::kSize
+               << ", 实际: " << frame.data.size();
+    return;
+  }
+
+  FromWire(std::get<0>(MotorParamsSetSchema::Decode(frame.data)), &data_.motor_params);
+
+  LOG(INFO) << "    电机参数已更新 - 行走/毛刷/防风速率: "
+            << data_.motor_params.walk_motor_speed << "/"
+            << data_.motor_params.brush_motor_speed << "/"
+            << data_.motor_params.windproof_motor_speed;
+
+  auto mqtt_manager = mqtt_manager_.lock();
+  if (!mqtt_manager) {
+    LOG(ERROR) << "    MQTT管理器未初始化，无法回复电机参数设置";
+    return;
+  }
+
+  // 按协议回复：数据域与下发一致，仅控制码改为0x82
+  std::vector<uint8_t> response_data = frame.data.ToVector();
+  std::vector<uint8_t> encoded =
+      protocol_.Encode(CONTROL_CODE_DOWNLINK, frame.number,
+                       frame.frame_count, response_data);
+  PublishUplink(mqtt_manager.get(), encoded);
+
+  TRACE(kRobot, 1) << "    电机参数设置回复已发送";
+  TRACE(kProtocol, 2) << "    回复帧: " << HexDump(encoded);
+
+  PublishData();
+  auto config_db = config_db_.lock();
+  if (config_db && !config_db->UpdateRobotDataSnapshot(robot_id_, SerializeDataSnapshot())) {
+    LOG(WARNING) << "    电机参数设置后写入快照失败";
+  }
+}
+
+// 0xA1: 电池参数设置
+void Robot::HandleBatteryParamsSet(const FrameView& frame) {
+  if (frame.control_code != CONTROL_CODE_UPLINK) {
+    LOG(INFO) << "    非平台下发控制码(0x"
+              << std::hex << static_cast<int>(frame.control_code)
+              << ")，忽略电池参数写入";
+    return;
+  }
+
+  // 标识(1) + 参数(11) = 12字节
+  if (frame.data.size() != BatteryParamsSetSchema::kSize) {
+    LOG(ERROR) << "    电池参数数据长度错误, 期望" << BatteryParamsSetSchema::kSize
+               << ", 实际: " << frame.data.size();
+    return;
+  }
+
+  FromWire(std::get<0>(BatteryParamsSetSchema::Decode(frame.data)),
+           &data_.temp_voltage_protection);
+
+  LOG(INFO) << "    电池参数已更新 - 保护电流(mA): "
+            << data_.temp_voltage_protection.protection_current_ma;
+
+  auto mqtt_manager = mqtt_manager_.lock();
+  if (!mqtt_manager) {
+    LOG(ERROR) << "    MQTT管理器未初始化，无法回复电池参数设置";
+    return;
+  }
+
+  std::vector<uint8_t> response_data = frame.data.ToVector();
+  std::vector<uint8_t> encoded =
+      protocol_.Encode(CONTROL_CODE_DOWNLINK, frame.number,
+                       frame.frame_count, response_data);
+  PublishUplink(mqtt_manager.get(), encoded);
+
+  TRACE(kRobot, 1) << "    电池参数设置回复已发送";
+  TRACE(kProtocol, 2) << "    回复帧: " << HexDump(encoded);
+
+  PublishData();
+  auto config_db = config_db_.lock();
+  if (config_db &&
+      !config_db->UpdateRobotDataSnapshot(robot_id_, SerializeDataSnapshot())) {
+    LOG(WARNING) << "    电池参数设置后写入快照失败";
+  }
+}
+
+// 0xA2: 定时设置
+void Robot::HandleScheduleSet(const FrameView& frame) {
+  if (frame.control_code != CONTROL_CODE_UPLINK) {
+    LOG(INFO) << "    非平台下发控制码(0x"
+              << std::hex << static_cast<int>(frame.control_code)
+              << ")，忽略定时任务写入";
+    return;
+  }
+
+  // 标识(1) + 7组定时参数(每组4字节) = 29字节
+  if (frame.data.size() != ScheduleSetSchema::kSize) {
+    LOG(ERROR) << "    定时设置数据长度错误, 期望" << ScheduleSetSchema::kSize
+               << ", 实际: " << frame.data.size();
+    return;
+  }
+
+  const auto tasks = std::get<0>(ScheduleSetSchema::Decode(frame.data));
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    auto& task = data_.schedule_tasks[i];
+    uint8_t run_count = 0;
+    std::tie(task.weekday, task.hour, task.minute, run_count) = tasks[i];
+    task.run_count = (run_count < 127) ? static_cast<int>(run_count * 2)
+                                       : static_cast<int>(run_count);
+  }
+  NotifyScheduleChanged();
+
+  auto mqtt_manager = mqtt_manager_.lock();
+  if (!mqtt_manager) {
+    LOG(ERROR) << "    MQTT管理器未初始化，无法回复定时设置";
+    return;
+  }
+
+  // 按协议回复：数据域与下发一致，仅控制码改为0x82；
+  // 运行次数字段当值<127时，回包填充为请求值*2。
+  std::vector<uint8_t> response_data = frame.data.ToVector();
+  for (size_t i = 0; i < 7; ++i) {
+    size_t run_count_index = 1 + i * 4 + 3;
+    uint8_t run_count = frame.data[run_count_index];
+    if (run_count < 127) {
+      response_data[run_count_index] = static_cast<uint8_t>(run_count * 2);
     }
-  } catch (const std::exception& e) {
-    LOG(ERROR) << "  处理消息异常: " << e.what();
+  }
+
+  std::vector<uint8_t> encoded =
+      protocol_.Encode(CONTROL_CODE_DOWNLINK, frame.number,
+                       frame.frame_count, response_data);
+  PublishUplink(mqtt_manager.get(), encoded);
+
+  TRACE(kRobot, 1) << "    定时设置回复已发送";
+  TRACE(kProtocol, 2) << "    回复帧: " << HexDump(encoded);
+
+  PublishData();
+  auto config_db = config_db_.lock();
+  if (config_db &&
+      !config_db->UpdateRobotDataSnapshot(robot_id_, SerializeDataSnapshot())) {
+    LOG(WARNING) << "    定时设置后写入快照失败";
   }
 }
 
-void Robot::HandleFirmwareDataFrame(const ProtocolFrame& frame) {
+// 0xA3: 停机位设置
+void Robot::HandleParkingPositionSet(const FrameView& frame) {
+  if (frame.control_code != CONTROL_CODE_UPLINK) {
+    LOG(INFO) << "    非平台下发控制码(0x"
+              << std::hex << static_cast<int>(frame.control_code)
+              << ")，忽略停机位写入";
+    return;
+  }
+
+  // 标识(1) + 参数(1) = 2字节
+  if (frame.data.size() != ParkingSetSchema::kSize) {
+    LOG(ERROR) << "    停机位设置数据长度错误, 期望" << ParkingSetSchema::kSize
+               << ", 实际: " << frame.data.size();
+    return;
+  }
+
+  data_.parking_position = std::get<0>(ParkingSetSchema::Decode(frame.data));
+  LOG(INFO) << "    停机位已更新: " << data_.parking_position;
+
+  auto mqtt_manager = mqtt_manager_.lock();
+  if (!mqtt_manager) {
+    LOG(ERROR) << "    MQTT管理器未初始化，无法回复停机位设置";
+    return;
+  }
+
+  // 按协议回复：数据域与下发一致，仅控制码改为0x82
+  std::vector<uint8_t> response_data = frame.data.ToVector();
+  std::vector<uint8_t> encoded =
+      protocol_.Encode(CONTROL_CODE_DOWNLINK, frame.number,
+                       frame.frame_count, response_data);
+  PublishUplink(mqtt_manager.get(), encoded);
+
+  TRACE(kRobot, 1) << "    停机位设置回复已发送";
+  TRACE(kProtocol, 2) << "    回复帧: " << HexDump(encoded);
+
+  PublishData();
+  auto config_db = config_db_.lock();
+  if (config_db &&
+      !config_db->UpdateRobotDataSnapshot(robot_id_, SerializeDataSnapshot())) {
+    LOG(WARNING) << "    停机位设置后写入快照失败";
+  }
+}
+
+// 0xA8: 广播参数设置
+void Robot::HandleBroadcastSet(const FrameView& frame) {
+  if (frame.control_code != CONTROL_CODE_UPLINK) {
+    LOG(INFO) << "    非平台下发控制码(0x"
+              << std::hex << static_cast<int>(frame.control_code)
+              << ")，忽略广播参数写入";
+    return;
+  }
+
+  // 标识(1) + 时间(7) + 风速(1) + 通信箱数量(2) + 机器人数量(2) + 后台保护(1) = 14字节
+  if (frame.data.size() != BroadcastSetSchema::kSize) {
+    LOG(ERROR) << "    广播参数设置数据长度错误, 期望" << BroadcastSetSchema::kSize
+               << ", 实际: " << frame.data.size();
+    return;
+  }
+
+  const auto [year, month, day, hour, minute, second, weekday, wind_speed,
+              comm_box_count, robot_count, protection_info] =
+      std::get<0>(BroadcastSetSchema::Decode(frame.data));
+
+  data_.local_time.year = 2000 + year;
+  data_.local_time.month = month;
+  data_.local_time.day = day;
+  data_.local_time.hour = hour;
+  data_.local_time.minute = minute;
+  data_.local_time.second = second;
+  data_.local_time.weekday = weekday;
+  data_.current_timestamp.hour = hour;
+  data_.current_timestamp.minute = minute;
+  data_.current_timestamp.second = second;
+
+  LOG(INFO) << "    广播参数已更新 - 时间: 20" << std::setfill('0')
+            << std::setw(2) << static_cast<int>(year) << "-"
+            << std::setw(2) << static_cast<int>(month) << "-"
+            << std::setw(2) << static_cast<int>(day) << " "
+            << std::setw(2) << static_cast<int>(hour) << ":"
+            << std::setw(2) << static_cast<int>(minute) << ":"
+            << std::setw(2) << static_cast<int>(second)
+            << " 星期" << static_cast<int>(weekday)
+            << " 风速=" << static_cast<int>(wind_speed)
+            << " 通信箱=" << comm_box_count
+            << " 机器人数=" << robot_count
+            << " 保护位=0x" << std::hex
+            << static_cast<int>(protection_info);
+
+  // 广播指令按协议不回复
+  LOG(INFO) << "    广播参数设置按协议不回复";
+
+  PublishData();
+  auto config_db = config_db_.lock();
+  if (config_db &&
+      !config_db->UpdateRobotDataSnapshot(robot_id_, SerializeDataSnapshot())) {
+    LOG(WARNING) << "    广播参数设置后写入快照失败";
+  }
+}
+
+// 0xA4: LoRa参数设置
+void Robot::HandleLoraParamsSet(const FrameView& /*frame*/) {
+  // TODO: 解析参数并更新配置
+}
+
+// 0xF0: 定时启动请求回复
+void Robot::HandleScheduleStartReply(const FrameView& frame) {
+  if (frame.data.size() >= ScheduleStartReplySchema::kSize) {
+    const auto [start_flag, info] = ScheduleStartReplySchema::Decode(frame.data);
+    {
+      std::lock_guard<std::mutex> lock(request_reply_mutex_);
+      ApplyRequestReply("定时启动请求回复", true, start_flag, info, &data_.request_reply);
+    }
+    MarkRequestReplyReceived();
+  } else {
+    LOG(ERROR) << "    定时启动回复数据长度不足";
+  }
+}
+
+// 0xF1: 启动请求回复
+void Robot::HandleStartReply(const FrameView& frame) {
+  if (frame.data.size() >= StartReplySchema::kSize) {
+    const auto [start_flag, info] = StartReplySchema::Decode(frame.data);
+    {
+      std::lock_guard<std::mutex> lock(request_reply_mutex_);
+      ApplyRequestReply("启动请求回复", true, start_flag, info, &data_.request_reply);
+    }
+    MarkRequestReplyReceived();
+  } else {
+    LOG(ERROR) << "    启动请求回复数据长度不足";
+  }
+}
+
+// 0xF2: 校时请求回复
+void Robot::HandleTimeSyncReply(const FrameView& frame) {
+  if (frame.data.size() >= TimeSyncReplySchema::kSize) {
+    {
+      std::lock_guard<std::mutex> lock(request_reply_mutex_);
+      ApplyRequestReply("校时请求回复", false, 0,
+                        std::get<0>(TimeSyncReplySchema::Decode(frame.data)),
+                        &data_.request_reply);
+    }
+    MarkRequestReplyReceived();
+  } else {
+    LOG(ERROR) << "    校时请求回复数据长度不足";
+  }
+}
+
+// 0xB0-0xB6: 控制类指令，执行后回复控制响应（复位仅回复）
+void Robot::HandleControlCommand(const FrameView& frame) {
+  const uint8_t identifier = frame.data[0];
+  switch (identifier) {
+    case 0xB0: ControlEnable(); break;
+    case 0xB1: ControlDisable(); break;
+    case 0xB2: ControlStart(); break;
+    case 0xB3: ControlForward(); break;
+    case 0xB4: ControlBackward(); break;
+    case 0xB5: ControlStop(); break;
+    default: break;
+  }
+  SendControlResponse(identifier);
+}
+
+// 0xBA: 重启指令
+void Robot::HandleRestartCommand(const FrameView& frame) {
+  // 发送简单响应（只包含标识符，不含机器人数据）
+  SendRestartResponse(frame.data[0]);
+}
+
+// 0xFD: 固件升级开始命令 (控制码 0x41, FD 70 版本高 版本低)
+void Robot::HandleFirmwareUpgradeStart(const FrameView& frame) {
+  if (frame.data.size() < 4) {
+    LOG(ERROR) << "    升级命令数据不足, 期望>=4, 实际: " << frame.data.size();
+    return;
+  }
+  if (frame.data[1] != 0x70) {
+    LOG(WARNING) << "    未知升级子命令: 0x" << std::hex << static_cast<int>(frame.data[1]);
+    return;
+  }
+  // 升级状态仅在升级期间分配（旧的未完成升级随之关闭）
+  upgrade_ = std::make_unique<UpgradeState>();
+  upgrade_->version_high = frame.data[2];
+  upgrade_->version_low  = frame.data[3];
+  upgrade_->in_progress  = true;
+  upgrade_->save_path = "firmware_" + robot_id_ + ".bin";
+
+  upgrade_->file.open(upgrade_->save_path, std::ios::binary | std::ios::trunc);
+  if (!upgrade_->file.is_open()) {
+    LOG(ERROR) << "    无法创建固件文件: " << upgrade_->save_path;
+    return;
+  }
+  LOG(INFO) << "    固件升级开始 - 版本: "
+            << static_cast<int>(upgrade_->version_high) << "."
+            << static_cast<int>(upgrade_->version_low)
+            << " 保存至: " << upgrade_->save_path;
+  {
+    auto mqtt_manager_ota = mqtt_manager_.lock();
+    if (!mqtt_manager_ota) return;
+    uint16_t robot_num_ota = data_.robot_number;
+    std::vector<uint8_t> enc = protocol_.Encode(0x81, robot_num_ota, frame.frame_count, {});
+    PublishUplink(mqtt_manager_ota.get(), enc);
+    sequence_.fetch_add(1);
+    LOG(INFO) << "    升级开始响应已发送 (0x81)";
+  }
+}
+
+void Robot::HandleFirmwareDataFrame(const FrameView& frame) {
   auto mqtt_manager = mqtt_manager_.lock();
   if (!mqtt_manager) {
     LOG(ERROR) << "[OTA] MQTT管理器未初始化";
@@ -1170,11 +1060,7 @@ void Robot::HandleFirmwareDataFrame(const ProtocolFrame& frame) {
   uint8_t resp_ctrl;
   std::vector<uint8_t> resp_data;
 
-  uint16_t robot_num = 0;
-  try {
-    if (!data_.robot_number.empty())
-      robot_num = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {}
+  uint16_t robot_num = data_.robot_number;
 
   // 0x70 控制码可能是结束数据帧，也可能是升级结束命令（FD 71...）
   if (ctrl == 0x70 && frame.data.size() >= 2
@@ -1190,72 +1076,73 @@ void Robot::HandleFirmwareDataFrame(const ProtocolFrame& frame) {
                     |  frame.data[7];
     }
 
-    if (upgrade_file_.is_open()) upgrade_file_.close();
-    upgrade_in_progress_ = false;
+    const size_t received_bytes = upgrade_ ? upgrade_->received_bytes : 0;
+    const std::string save_path = upgrade_ ? upgrade_->save_path : std::string();
+    upgrade_.reset();  // 关闭文件并释放升级状态
 
     LOG(INFO) << "[OTA] 固件升级结束 - 版本: "
               << static_cast<int>(ver_h) << "." << static_cast<int>(ver_l)
               << " 期望大小: " << expected_size
-              << " 实际接收: " << upgrade_received_bytes_;
-    if (upgrade_received_bytes_ == expected_size) {
-      LOG(INFO) << "[OTA] 固件文件完整，已保存至: " << upgrade_save_path_;
+              << " 实际接收: " << received_bytes;
+    if (received_bytes == expected_size) {
+      LOG(INFO) << "[OTA] 固件文件完整，已保存至: " << save_path;
     } else {
       LOG(WARNING) << "[OTA] 固件大小不匹配 (差 "
                    << static_cast<int64_t>(expected_size)
-                      - static_cast<int64_t>(upgrade_received_bytes_)
+                      - static_cast<int64_t>(received_bytes)
                    << " 字节)";
     }
 
     // 响应: 0xB2，回显收到的数据
     resp_ctrl = 0xB2;
-    resp_data = frame.data;
+    resp_data = frame.data.ToVector();
   } else {
     // 普通固件数据帧：写入字节
     if (!frame.data.empty()) {
-      if (upgrade_file_.is_open()) {
-        upgrade_file_.write(
+      if (upgrade_ && upgrade_->file.is_open()) {
+        upgrade_->file.write(
             reinterpret_cast<const char*>(frame.data.data()),
             static_cast<std::streamsize>(frame.data.size()));
-        upgrade_received_bytes_ += frame.data.size();
-        if (ctrl == 0x70) upgrade_file_.flush();  // 结束帧时 flush
+        upgrade_->received_bytes += frame.data.size();
+        if (ctrl == 0x70) upgrade_->file.flush();  // 结束帧时 flush
       } else {
         LOG(WARNING) << "[OTA] 收到数据帧但文件未打开 (ctrl=0x"
                      << std::hex << static_cast<int>(ctrl) << ")";
       }
     }
+    const size_t received_bytes = upgrade_ ? upgrade_->received_bytes : 0;
 
     if (ctrl == 0x50) {
-      LOG(INFO) << "[OTA] 起始数据帧 frame_count=" << static_cast<int>(frame.frame_count)
-                << " 写入 " << frame.data.size()
-                << " 字节, 累计 " << upgrade_received_bytes_ << " 字节";
+      TRACE(kRobot, 1) << "[OTA] 起始数据帧 frame_count=" << static_cast<int>(frame.frame_count)
+                       << " 写入 " << frame.data.size()
+                       << " 字节, 累计 " << received_bytes << " 字节";
       resp_ctrl = 0x92;
       resp_data = {0x00};  // 状态 OK
     } else if (ctrl == 0x60) {
-      LOG(INFO) << "[OTA] 中间数据帧 frame_count=" << static_cast<int>(frame.frame_count)
-                << " 写入 " << frame.data.size()
-                << " 字节, 累计 " << upgrade_received_bytes_ << " 字节";
+      TRACE(kRobot, 1) << "[OTA] 中间数据帧 frame_count=" << static_cast<int>(frame.frame_count)
+                       << " 写入 " << frame.data.size()
+                       << " 字节, 累计 " << received_bytes << " 字节";
       resp_ctrl = 0xA2;
     } else {
-      LOG(INFO) << "[OTA] 结束数据帧 frame_count=" << static_cast<int>(frame.frame_count)
-                << " 写入 " << frame.data.size()
-                << " 字节, 累计 " << upgrade_received_bytes_ << " 字节";
+      TRACE(kRobot, 1) << "[OTA] 结束数据帧 frame_count=" << static_cast<int>(frame.frame_count)
+                       << " 写入 " << frame.data.size()
+                       << " 字节, 累计 " << received_bytes << " 字节";
       resp_ctrl = 0xB2;
     }
   }
 
   std::vector<uint8_t> encoded =
       protocol_.Encode(resp_ctrl, robot_num, frame.frame_count, resp_data);
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
+  PublishUplink(mqtt_manager.get(), encoded);
   sequence_.fetch_add(1);
-  LOG(INFO) << "[OTA] 应答已发送 (resp_ctrl=0x"
-            << std::hex << static_cast<int>(resp_ctrl) << ")";
+  TRACE(kRobot, 1) << "[OTA] 应答已发送 (resp_ctrl=0x"
+                   << std::hex << static_cast<int>(resp_ctrl) << ")";
 }
 
 void Robot::SetReportInterval(int interval_seconds) {
   robot_data_report_interval_s_ = interval_seconds;
   LOG(INFO) << "[Robot " << robot_id_ << "] 设置机器人数据上报间隔为 " << interval_seconds << " 秒";
+  WakeReportTimer();
 }
 
 void Robot::SetReportIntervals(int robot_data_s, int motor_params_s, int lora_clean_s) {
@@ -1264,6 +1151,7 @@ void Robot::SetReportIntervals(int robot_data_s, int motor_params_s, int lora_cl
   lora_clean_report_interval_s_ = lora_clean_s;
   LOG(INFO) << "[Robot " << robot_id_ << "] 设置上报间隔 - 机器人数据:" << robot_data_s
             << "s, 电机参数:" << motor_params_s << "s, Lora&清扫设置:" << lora_clean_s << "s";
+  WakeReportTimer();
 }
 
 void Robot::SetRobotIndex(int index) {
@@ -1272,17 +1160,23 @@ void Robot::SetRobotIndex(int index) {
 }
 
 void Robot::StartReport() {
-  // 如果线程已经在运行，先停止
-  if (report_thread_.joinable()) {
-    LOG(WARNING) << "[Robot " << robot_id_ << "] 上报线程已在运行，先停止";
+  // 如果定时器已经注册，先停止
+  if (report_timer_id_ != 0) {
+    LOG(WARNING) << "[Robot " << robot_id_ << "] 上报定时器已在运行，先停止";
     StopReport();
   }
 
-  // 重置停止标志
+  // 重置停止标志和计时状态（错峰偏移在首次触发时计算）
   stop_report_.store(false);
+  report_timer_started_ = false;
+  {
+    std::lock_guard<std::mutex> lock(lazy_sim_mutex_);
+    lazy_sim_started_ = false;
+  }
 
-  // 启动新线程
-  report_thread_ = std::thread(&Robot::ReportThreadFunc, this);
+  // 注册到全局调度器，立即触发一次以完成初始化
+  report_timer_id_ = FleetScheduler::Instance().AddTimer(
+      std::chrono::milliseconds(0), [this]() { return OnReportTimer(); });
   LOG(INFO) << "[Robot " << robot_id_ << "] 定时上报已启动";
 }
 
@@ -1290,270 +1184,333 @@ void Robot::StopReport() {
   LOG(INFO) << "[Robot " << robot_id_ << "] 正在停止定时上报...";
   stop_report_.store(true);
 
-  if (report_thread_.joinable()) {
-    report_thread_.join();
+  // 与 StartCleaningTask 在 data_mutex_ 下交接：此后不会再启动新的清扫定时器。
+  // CancelTimer 会等待正在执行的回调（回调持有 data_mutex_），须在锁外调用
+  FleetScheduler::TimerId cleaning_timer = 0;
+  {
+    std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+    cleaning_timer = cleaning_timer_id_.exchange(0);
+  }
+  if (cleaning_timer != 0) {
+    FleetScheduler::Instance().CancelTimer(cleaning_timer);
+    {
+      std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+      if (cleaning_task_running_.load()) {
+        LOG(INFO) << "[Robot " << robot_id_ << "] 清扫任务因机器人停止而中断";
+        cleaning_state_ = CleaningState::kIdle;
+        cleaning_task_running_.store(false);
+      }
+      // 退出启动排队并归还在途名额与模拟时间保持
+      cleaning_admitted_ = false;
+      FleetScheduler::Instance().ReleaseSimTime(cleaning_sim_hold_);
+      cleaning_sim_hold_ = 0;
+    }
+    if (auto mgr = mqtt_manager_.lock()) {
+      mgr->GetStartAdmission().Cancel(robot_id_);
+    }
+  }
+
+  // 停止产生新的模拟告警（已产生的告警仍按时清除）
+  if (fleet_alarm_) {
+    fleet_alarm_->Stop(alarm_slot_);
+  }
+
+  if (report_timer_id_ != 0) {
+    // 等待正在执行的回调结束，保证之后不会再访问本对象
+    FleetScheduler::Instance().CancelTimer(report_timer_id_);
+    report_timer_id_ = 0;
     LOG(INFO) << "[Robot " << robot_id_ << "] 定时上报已停止";
   }
 }
 
-void Robot::UpdateSimulatedData() {
+void Robot::WakeReportTimer() {
+  if (report_timer_id_ != 0) {
+    FleetScheduler::Instance().WakeTimer(report_timer_id_);
+  }
+}
+
+void Robot::NotifyScheduleChanged() {
   auto mgr = mqtt_manager_.lock();
-  if (!mgr) return;
-  const SimConfig sim = mgr->GetGlobalSimConfig();
+  if (mgr) {
+    std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+    mgr->UpdateScheduleIndex(robot_id_, data_.schedule_tasks);
+  }
+}
+
+void Robot::SetMoveDirection(int direction) {
+  // 惰性模式下先按旧方向结算到当前时刻
+  RefreshSimulatedState();
+  move_direction_.store(direction);
+  PublishSimMotion();
+  WakeReportTimer();
+}
+
+void Robot::PublishSimMotion() {
+  if (!fleet_sim_) return;
+  const bool is_moving = move_direction_.load() != 0;
+  fleet_sim_->SetMotion(sim_slot_, is_moving, data_.position == 0 && !is_moving);
+}
+
+void Robot::UpdateSimulatedData(const SimConfig& sim, int ticks) {
   if (!sim.enabled) return;
   const int dir = move_direction_.load();
   const bool is_moving = (dir != 0);
   const bool at_dock   = (data_.position == 0 && !is_moving);
 
-  auto rand_val = [&](float lo, float hi) -> float {
-    std::uniform_real_distribution<float> dist(lo, hi);
-    return dist(rng_);
-  };
-
-  // 主/从电机电流（运行时有值，否则为0）
-  if (is_moving) {
-    float main_a  = sim.main_current_random
-                    ? rand_val(sim.main_current_min, sim.main_current_max)
-                    : sim.main_current_fixed;
-    float slave_a = sim.slave_current_random
-                    ? rand_val(sim.slave_current_min, sim.slave_current_max)
-                    : sim.slave_current_fixed;
-    data_.main_motor_current  = static_cast<int>(std::round(main_a  * 10.0f));
-    data_.slave_motor_current = static_cast<int>(std::round(slave_a * 10.0f));
-  } else {
-    data_.main_motor_current  = 0;
-    data_.slave_motor_current = 0;
-  }
-
-  // 光伏输出（停靠时有值，否则为0）
-  if (at_dock) {
-    float sv = sim.solar_voltage_random
-               ? rand_val(sim.solar_voltage_min, sim.solar_voltage_max)
-               : sim.solar_voltage_fixed;
-    float sc = sim.solar_current_random
-               ? rand_val(sim.solar_current_min, sim.solar_current_max)
-               : sim.solar_current_fixed;
-    data_.solar_voltage = static_cast<int>(std::round(sv * 10.0f));
-    data_.solar_current = static_cast<int>(std::round(sc * 10.0f));
-  } else {
-    data_.solar_voltage = 0;
-    data_.solar_current = 0;
-  }
-
-  // 主板温度（始终有值）
-  {
-    float bt = sim.board_temp_random
-               ? rand_val(sim.board_temp_min, sim.board_temp_max)
-               : sim.board_temp_fixed;
-    data_.board_temperature = static_cast<int>(std::round(bt));
+  // 随机量由车队模拟引擎每 tick 统一生成，这里只读取本机器人槽位的最新采样
+  SimSample sample;
+  if (fleet_sim_ && fleet_sim_->ReadSample(sim_slot_, &sample)) {
+    ApplySimSample(sample);
   }
 
-  // 电池电压（始终有值）
-  {
-    float bv = sim.battery_voltage_random
-               ? rand_val(sim.battery_voltage_min, sim.battery_voltage_max)
-               : sim.battery_voltage_fixed;
-    data_.battery_voltage = static_cast<int>(std::round(bv * 10.0f));
+  // 电池电量（每600 tick 即每分钟更新一次）
+  battery_level_tick_ += ticks;
+  if (battery_level_tick_ >= 600) {
+    battery_level_tick_ = 0;
+    ApplyBatteryMinutes(sim, 1, is_moving, at_dock);
   }
+}
 
+void Robot::ApplySimSample(const SimSample& sample) {
+  data_.main_motor_current  = sample.main_motor_current;
+  data_.slave_motor_current = sample.slave_motor_current;
+  data_.solar_voltage       = sample.solar_voltage;
+  data_.solar_current       = sample.solar_current;
+  data_.board_temperature   = sample.board_temperature;
+  data_.battery_voltage     = sample.battery_voltage;
+  data_.battery_temperature = sample.battery_temperature;
   // 电池电流 = 主 + 从电机电流
   data_.battery_current = data_.main_motor_current + data_.slave_motor_current;
+}
 
-  // 电池温度（始终有值）
-  {
-    float t = sim.battery_temp_random
-              ? rand_val(sim.battery_temp_min, sim.battery_temp_max)
-              : sim.battery_temp_fixed;
-    data_.battery_temperature = static_cast<int>(std::round(t));
+void Robot::ApplyBatteryMinutes(const SimConfig& sim, int minutes, bool is_moving, bool at_dock) {
+  // 同一运动状态下变化方向不变，逐分钟累加再截断等价于一次累加后截断
+  float rate;
+  if (is_moving) {
+    rate = -sim.battery_discharge_run;
+  } else if (at_dock) {
+    rate = sim.battery_charge_rate;
+  } else {
+    rate = -sim.battery_discharge_stop;
   }
+  battery_level_f_ = std::clamp(battery_level_f_ + rate * static_cast<float>(minutes), 0.0f, 100.0f);
+  data_.battery_level = static_cast<int>(battery_level_f_);
+}
 
-  // 电池电量（每600 tick 即每分钟更新一次）
-  ++battery_level_tick_;
-  if (battery_level_tick_ >= 600) {
-    battery_level_tick_ = 0;
-    if (is_moving) {
-      battery_level_f_ -= sim.battery_discharge_run;
-    } else if (at_dock) {
-      battery_level_f_ += sim.battery_charge_rate;
-    } else {
-      battery_level_f_ -= sim.battery_discharge_stop;
-    }
-    battery_level_f_ = std::clamp(battery_level_f_, 0.0f, 100.0f);
-    data_.battery_level = static_cast<int>(battery_level_f_);
-  }
+std::chrono::milliseconds Robot::OnReportTimer() {
+  using namespace std::chrono;
+  if (stop_report_.load()) return milliseconds(-1);
 
-  // 告警模拟
-  ++total_ticks_;
-  ++alarm_sim_tick_;
-  const auto& alm = sim.alarm_sim;
+  // 读取全局模拟配置快照（无锁、不拷贝）；未关联管理器时使用默认配置（模拟关闭）
+  static const auto kDefaultSimConfig = std::make_shared<const SimConfig>();
+  auto mgr = mqtt_manager_.lock();
+  const auto sim_snapshot = mgr ? mgr->GetSimConfigSnapshot() : kDefaultSimConfig;
+  const SimConfig& sim = *sim_snapshot;
 
-  // 清除到期的模拟告警
-  for (auto it = alarm_entries_.begin(); it != alarm_entries_.end(); ) {
-    if (total_ticks_ >= it->expire_tick) {
-      data_.alarm_fc &= ~(static_cast<uint32_t>(1) << it->bit);
-      it = alarm_entries_.erase(it);
-    } else {
-      ++it;
+  // 告警调度器与管理器各自持锁（告警调度器持锁时会修改本机器人数据），须在取写锁之前调用
+  int total_robots = 1;
+  if (!report_timer_started_) {
+    // 告警模拟以上报定时器启动时刻为产生周期起点
+    if (fleet_alarm_) {
+      fleet_alarm_->Start(alarm_slot_);
     }
+    if (mgr) total_robots = mgr->GetRobotCount();
   }
 
-  // 每6000 tick（10分钟）产生新告警
-  if (alm.enabled && alarm_sim_tick_ >= 6000) {
-    alarm_sim_tick_ = 0;
-    std::vector<int> available_bits;
-    for (int b = 0; b < 32; ++b) {
-      if (alm.fc_bits_mask & (static_cast<uint32_t>(1) << b)) {
-        available_bits.push_back(b);
-      }
-    }
-    if (!available_bits.empty()) {
-      std::uniform_int_distribution<int> bit_dist(0, static_cast<int>(available_bits.size()) - 1);
-      int dur_lo = std::min(alm.duration_min, alm.duration_max);
-      int dur_hi = std::max(alm.duration_min, alm.duration_max);
-      if (dur_lo == dur_hi) ++dur_hi;
-      std::uniform_int_distribution<int> dur_dist(dur_lo, dur_hi);
-      for (int i = 0; i < alm.frequency; ++i) {
-        int bit    = available_bits[bit_dist(rng_)];
-        int expire = total_ticks_ + dur_dist(rng_) * 600;
-        data_.alarm_fc |= (static_cast<uint32_t>(1) << bit);
-        alarm_entries_.push_back({bit, expire});
-      }
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  if (!report_timer_started_) {
+    report_timer_started_ = true;
+    last_tick_time_ = SimClock::Instance().SteadyNow();
+
+    // 初始化浮点电量
+    battery_level_f_ = static_cast<float>(data_.battery_level);
+    if (lazy_sim_) {
+      std::lock_guard<std::mutex> lock(lazy_sim_mutex_);
+      lazy_sim_started_ = true;
+      lazy_sim_time_ = last_tick_time_;
     }
-  }
+    // 实时计算错峰偏移：索引 × 间隔 / 总数（首次触发时从 MqttManager 获取总数）
+    // 首次触发可能早于本机器人加入列表，总数至少为 索引+1
+    total_robots = std::max(total_robots, robot_index_ + 1);
+    const int rd_offset_ticks = robot_index_ * robot_data_report_interval_s_    * 10 / total_robots;
+    const int mp_offset_ticks = robot_index_ * motor_params_report_interval_s_  * 10 / total_robots;
+    const int lc_offset_ticks = robot_index_ * lora_clean_report_interval_s_    * 10 / total_robots;
+
+    LOG(INFO) << "[Robot " << robot_id_ << "] 上报定时器已启动 - 机器人数据:" << robot_data_report_interval_s_
+              << "s(+" << rd_offset_ticks / 10 << "s错峰), 电机参数:" << motor_params_report_interval_s_
+              << "s(+" << mp_offset_ticks / 10 << "s错峰), Lora&清扫:"
+              << lora_clean_report_interval_s_ << "s(+" << lc_offset_ticks / 10 << "s错峰)"
+              << " [索引" << robot_index_ << "/" << total_robots << "]";
+
+    // 各类型上报的计时器（初始为负数以实现错峰，累加到间隔ticks时触发）
+    robot_data_ticks_     = -rd_offset_ticks;
+    motor_params_ticks_   = -mp_offset_ticks;
+    lora_clean_ticks_     = -lc_offset_ticks;
+  }
+
+  // 按事件先后补齐自上次触发以来经过的 tick，每段区间内最多一个事件到期
+  int elapsed = static_cast<int>((SimClock::Instance().SteadyNow() - last_tick_time_) /
+                                 FleetScheduler::kTickInterval);
+  last_tick_time_ += FleetScheduler::kTickInterval * elapsed;
+  while (elapsed > 0 && !stop_report_.load()) {
+    const int step = std::min(elapsed, TicksUntilNextEvent(sim));
+    RunReportTicks(sim, step);
+    elapsed -= step;
+  }
+
+  PublishData();
+  const auto next_event = last_tick_time_ + FleetScheduler::kTickInterval * TicksUntilNextEvent(sim);
+  return duration_cast<milliseconds>(next_event - SimClock::Instance().SteadyNow());
 }
 
-void Robot::ReportThreadFunc() {
-  // 初始化浮点电量
-  battery_level_f_ = static_cast<float>(data_.battery_level);
-  // 实时计算错峰偏移：索引 × 间隔 / 总数（在线程启动时从 MqttManager 获取总数）
-  int total_robots = 1;
-  if (auto mgr = mqtt_manager_.lock()) {
-    total_robots = mgr->GetRobotCount();
-    if (total_robots <= 0) total_robots = 1;
+int Robot::TicksUntilNextEvent(const SimConfig& sim) const {
+  int ticks = std::min({robot_data_report_interval_s_ * 10 - robot_data_ticks_,
+                        motor_params_report_interval_s_ * 10 - motor_params_ticks_,
+                        lora_clean_report_interval_s_ * 10 - lora_clean_ticks_});
+  if (lazy_sim_) return std::max(ticks, 1);
+  // 停止时位置不变，位置计时器只需保持相位，无需唤醒
+  if (move_direction_.load() != 0) {
+    ticks = std::min(ticks, 300 - position_tick_);
   }
-  const int rd_offset_ticks = robot_index_ * robot_data_report_interval_s_    * 10 / total_robots;
-  const int mp_offset_ticks = robot_index_ * motor_params_report_interval_s_  * 10 / total_robots;
-  const int lc_offset_ticks = robot_index_ * lora_clean_report_interval_s_    * 10 / total_robots;
-
-  LOG(INFO) << "[Robot " << robot_id_ << "] 上报线程已启动 - 机器人数据:" << robot_data_report_interval_s_
-            << "s(+" << rd_offset_ticks / 10 << "s错峰), 电机参数:" << motor_params_report_interval_s_
-            << "s(+" << mp_offset_ticks / 10 << "s错峰), Lora&清扫:"
-            << lora_clean_report_interval_s_ << "s(+" << lc_offset_ticks / 10 << "s错峰)"
-            << " [索引" << robot_index_ << "/" << total_robots << "]";
+  if (sim.enabled) {
+    ticks = std::min(ticks, 600 - battery_level_tick_);
+  }
+  return std::max(ticks, 1);
+}
 
-  // 各类型上报的计时器（初始为负数以实现错峰，累加到间隔ticks时触发）
-  int robot_data_ticks    = -rd_offset_ticks;
-  int motor_params_ticks  = -mp_offset_ticks;
-  int lora_clean_ticks    = -lc_offset_ticks;
+void Robot::RunReportTicks(const SimConfig& sim, int ticks) {
+  robot_data_ticks_     += ticks;
+  motor_params_ticks_   += ticks;
+  lora_clean_ticks_     += ticks;
 
-  // 定时任务检查：记录上次触发的分钟，避免同一分钟重复触发
-  int schedule_check_ticks   = 0;  // 每600 ticks(60秒)检查一次
-  int last_schedule_minute   = -1; // 上次触发定时任务时的分钟数（防重复）
+  // 模拟数据与位置更新（惰性模式下在读取时推算）
+  if (!lazy_sim_) {
+    position_tick_ += ticks;
+    UpdateSimulatedData(sim, ticks);
 
-  while (!stop_report_.load()) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // 位置更新：前进/后退时每30秒清扫一个支架
+    if (position_tick_ >= 300) {
+      position_tick_ %= 300;
+      ApplyPositionSteps(move_direction_.load(), 1);
+    }
+  }
 
-    if (stop_report_.load()) break;
+  // 间隔在途中修改时由 WakeReportTimer 立即重新计算
+  // 机器人数据上报
+  if (robot_data_ticks_ >= robot_data_report_interval_s_ * 10) {
+    robot_data_ticks_ = 0;
+    SendRobotDataReport();
+  }
 
-    ++robot_data_ticks;
-    ++motor_params_ticks;
-    ++lora_clean_ticks;
-    ++position_tick_;
-    ++schedule_check_ticks;
+  // 电机参数上报
+  if (motor_params_ticks_ >= motor_params_report_interval_s_ * 10) {
+    motor_params_ticks_ = 0;
+    SendMotorParamsReport();
+  }
 
-    // 模拟数据更新（每 tick）
-    UpdateSimulatedData();
+  // Lora参数&清扫设置上报
+  if (lora_clean_ticks_ >= lora_clean_report_interval_s_ * 10) {
+    lora_clean_ticks_ = 0;
+    SendLoraAndCleanSettingsReport();
+  }
+}
 
-    // 位置更新：前进/后退时每30秒清扫一个支架
-    if (position_tick_ >= 300) {
-      position_tick_ = 0;
-      int dir = move_direction_.load();
-      if (dir == 1) {
-        // 前进
-        data_.position += 1;
-        if (data_.position > max_bracket_count_) {
-          // 到达末端，自动切换为后退
-          LOG(INFO) << "[Robot " << robot_id_ << "] 到达支架末端 (" << max_bracket_count_
-                    << "), 自动切换为后退";
-          data_.alarm_fa &= ~static_cast<uint32_t>(AlarmFA::kForward);
-          data_.alarm_fa |=  static_cast<uint32_t>(AlarmFA::kBackward);
-          move_direction_.store(-1);
-        }
-      } else if (dir == -1) {
-        // 后退
-        data_.position -= 1;
-        if (data_.position <= 0) {
-          data_.position = 0;
-          // 返回停靠位，自动停止
-          LOG(INFO) << "[Robot " << robot_id_ << "] 返回停靠位 (0), 自动停止";
-          const uint32_t clear_mask = static_cast<uint32_t>(AlarmFA::kAutoRunning)
-                                    | static_cast<uint32_t>(AlarmFA::kForward)
-                                    | static_cast<uint32_t>(AlarmFA::kBackward);
-          data_.alarm_fa &= ~clear_mask;
-          data_.alarm_fa |=  static_cast<uint32_t>(AlarmFA::kAutoCompleted)
-                          |  static_cast<uint32_t>(AlarmFA::kStopped);
-          move_direction_.store(0);
-        }
-      }
+void Robot::ApplyPositionSteps(int direction, int steps) {
+  if (direction == 1) {
+    // 前进
+    data_.position += steps;
+    if (data_.position > max_bracket_count_) {
+      // 到达末端，自动切换为后退
+      LOG(INFO) << "[Robot " << robot_id_ << "] 到达支架末端 (" << max_bracket_count_
+                << "), 自动切换为后退";
+      data_.alarm_fa &= ~static_cast<uint32_t>(AlarmFA::kForward);
+      data_.alarm_fa |=  static_cast<uint32_t>(AlarmFA::kBackward);
+      move_direction_.store(-1);
     }
-
-    // 定时任务检查（每60秒检查一次）
-    if (schedule_check_ticks >= 600) {
-      schedule_check_ticks = 0;
-      UpdateTimeFields();
-      int now_weekday = data_.local_time.weekday;
-      int now_hour    = data_.local_time.hour;
-      int now_minute  = data_.local_time.minute;
-      // 用"小时×60+分钟"作为唯一分钟标识，防止同一分钟重复触发
-      int now_min_id  = now_hour * 60 + now_minute;
-
-      if (now_min_id != last_schedule_minute) {
-        for (size_t i = 0; i < data_.schedule_tasks.size(); ++i) {
-          const auto& task = data_.schedule_tasks[i];
-          // run_count > 0 表示有效任务；weekday 0 表示每天
-          if (task.run_count > 0
-              && (task.weekday == 0 || task.weekday == now_weekday)
-              && task.hour   == now_hour
-              && task.minute == now_minute) {
-            uint8_t sid = static_cast<uint8_t>(i + 1);
-            LOG(INFO) << "[Robot " << robot_id_ << "] 定时任务 #" << static_cast<int>(sid)
-                      << " 触发 (weekday=" << task.weekday
-                      << " " << task.hour << ":" << task.minute << ")";
-            StartCleaningTask(sid);
-            last_schedule_minute = now_min_id;
-            break;  // 同一时刻只触发第一个匹配的定时任务
-          }
-        }
-      }
+  } else if (direction == -1) {
+    // 后退
+    data_.position -= steps;
+    if (data_.position <= 0) {
+      data_.position = 0;
+      // 返回停靠位，自动停止
+      LOG(INFO) << "[Robot " << robot_id_ << "] 返回停靠位 (0), 自动停止";
+      const uint32_t clear_mask = static_cast<uint32_t>(AlarmFA::kAutoRunning)
+                                | static_cast<uint32_t>(AlarmFA::kForward)
+                                | static_cast<uint32_t>(AlarmFA::kBackward);
+      data_.alarm_fa &= ~clear_mask;
+      data_.alarm_fa |=  static_cast<uint32_t>(AlarmFA::kAutoCompleted)
+                      |  static_cast<uint32_t>(AlarmFA::kStopped);
+      move_direction_.store(0);
     }
+  }
+  PublishSimMotion();
+}
 
-    // 每 tick 直接读成员变量，途中修改间隔立即生效
-    // 机器人数据上报
-    if (robot_data_ticks >= robot_data_report_interval_s_ * 10) {
-      robot_data_ticks = 0;
-      SendRobotDataReport();
-    }
+void Robot::RefreshSimulatedState() {
+  if (!lazy_sim_ || stop_report_.load()) return;
 
-    // 电机参数上报
-    if (motor_params_ticks >= motor_params_report_interval_s_ * 10) {
-      motor_params_ticks = 0;
-      SendMotorParamsReport();
-    }
+  static const auto kDefaultSimConfig = std::make_shared<const SimConfig>();
+  auto mgr = mqtt_manager_.lock();
+  const auto sim_snapshot = mgr ? mgr->GetSimConfigSnapshot() : kDefaultSimConfig;
+  const SimConfig& sim = *sim_snapshot;
+
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  std::lock_guard<std::mutex> lock(lazy_sim_mutex_);
+  if (!lazy_sim_started_) return;
+  const int ticks = static_cast<int>((SimClock::Instance().SteadyNow() - lazy_sim_time_) /
+                                     FleetScheduler::kTickInterval);
+  if (ticks <= 0) return;
+  lazy_sim_time_ += FleetScheduler::kTickInterval * ticks;
+
+  AdvanceLazyMotion(sim, ticks);
+  if (sim.enabled) {
+    total_ticks_ += ticks;
+
+    // 采样按需生成：与车队引擎同一规则，以本机器人累计 tick 作为随机数计数器
+    const bool is_moving = move_direction_.load() != 0;
+    SimSample sample;
+    FleetSimEngine::SampleOne(sim, robot_number_, static_cast<uint64_t>(total_ticks_), is_moving,
+                              data_.position == 0 && !is_moving, &sample);
+    ApplySimSample(sample);
+  }
+  PublishData();
+}
 
-    // Lora参数&清扫设置上报
-    if (lora_clean_ticks >= lora_clean_report_interval_s_ * 10) {
-      lora_clean_ticks = 0;
-      SendLoraAndCleanSettingsReport();
+void Robot::AdvanceLazyMotion(const SimConfig& sim, int ticks) {
+  while (ticks > 0) {
+    const int dir = move_direction_.load();
+    const bool is_moving = (dir != 0);
+    const bool at_dock   = (data_.position == 0 && !is_moving);
+
+    // 本段持续到方向变化（末端折返/回到停靠位）为止
+    int segment = ticks;
+    if (dir == 1) {
+      segment = std::min(segment, std::max(max_bracket_count_ + 1 - data_.position, 1) * 300 - position_tick_);
+    } else if (dir == -1) {
+      segment = std::min(segment, std::max(data_.position, 1) * 300 - position_tick_);
+    }
+    segment = std::max(segment, 1);
+    ticks -= segment;
+
+    // 电量先于位置结算（与逐 tick 模式同一 tick 内的顺序一致）
+    if (sim.enabled) {
+      battery_level_tick_ += segment;
+      const int minutes = battery_level_tick_ / 600;
+      battery_level_tick_ %= 600;
+      if (minutes > 0) ApplyBatteryMinutes(sim, minutes, is_moving, at_dock);
     }
-  }
 
-  LOG(INFO) << "[Robot " << robot_id_ << "] 上报线程已停止";
+    position_tick_ += segment;
+    const int steps = position_tick_ / 300;
+    position_tick_ %= 300;
+    if (steps > 0 && is_moving) ApplyPositionSteps(dir, steps);
+  }
 }
 
 // 更新时间相关字段（本地时间、当前时间戳、工作时长）
-void Robot::UpdateTimeFields() {
+void Robot::FillTimeFields(RobotData* data) const {
   using namespace std::chrono;
-  auto now = system_clock::now();
+  auto now = SimClock::Instance().SystemNow();
   std::time_t t = system_clock::to_time_t(now);
   std::tm tm;
 #ifdef _WIN32
@@ -1562,139 +1519,98 @@ void Robot::UpdateTimeFields() {
   localtime_r(&t, &tm);
 #endif
 
-  data_.local_time.year = tm.tm_year + 1900;
-  data_.local_time.month = tm.tm_mon + 1;
-  data_.local_time.day = tm.tm_mday;
-  data_.local_time.hour = tm.tm_hour;
-  data_.local_time.minute = tm.tm_min;
-  data_.local_time.second = tm.tm_sec;
-  data_.local_time.weekday = tm.tm_wday;  // 0-6
+  data->local_time.year = tm.tm_year + 1900;
+  data->local_time.month = tm.tm_mon + 1;
+  data->local_time.day = tm.tm_mday;
+  data->local_time.hour = tm.tm_hour;
+  data->local_time.minute = tm.tm_min;
+  data->local_time.second = tm.tm_sec;
+  data->local_time.weekday = tm.tm_wday;  // 0-6
 
-  data_.current_timestamp.hour = tm.tm_hour;
-  data_.current_timestamp.minute = tm.tm_min;
-  data_.current_timestamp.second = tm.tm_sec;
+  data->current_timestamp.hour = tm.tm_hour;
+  data->current_timestamp.minute = tm.tm_min;
+  data->current_timestamp.second = tm.tm_sec;
 
   // 工作时长：以小时为单位，从创建时间算起
   if (creation_time_.time_since_epoch().count() > 0) {
     auto dur = duration_cast<hours>(now - creation_time_);
-    data_.working_duration = static_cast<int>(dur.count());
+    data->working_duration = static_cast<int>(dur.count());
   } else {
-    data_.working_duration = 0;
+    data->working_duration = 0;
   }
 }
 
 // 构建机器人数据域（标识符 + 46字节机器人状态数据）
-std::vector<uint8_t> Robot::BuildRobotDataField(uint8_t identifier) {
-  // 在构建前更新时间字段与工作时长
+void Robot::BuildRobotDataField(uint8_t identifier, FrameWriter* writer) {
+  // 在构建前更新时间字段与工作时长，惰性模式下推算模拟状态
   UpdateTimeFields();
+  RefreshSimulatedState();
+
+  RobotDataReportSchema::EncodeAs(
+      identifier, writer,
+      data_.alarm_fa, data_.alarm_fb, data_.alarm_fc, data_.alarm_fd,
+      data_.main_motor_current, data_.slave_motor_current,  // 主/从电机电流（100mA）
+      data_.battery_voltage, data_.battery_current,         // 电池电压（100mV）/电流（100mA）
+      data_.battery_status, data_.battery_level, data_.battery_temperature,
+      data_.position, data_.working_duration,
+      data_.solar_voltage, data_.solar_current,             // 光伏板输出电压（100mV）/电流（100mA）
+      data_.total_run_count, data_.current_lap_count,
+      data_.current_timestamp.hour, data_.current_timestamp.minute,
+      data_.current_timestamp.second,
+      data_.board_temperature);
+}
 
-  std::vector<uint8_t> data_field;
+// 构建Lora参数&清扫设置数据域（E0上报与C0查询回复共用）
+void Robot::BuildLoraCleanField(uint8_t identifier, FrameWriter* writer) const {
+  // 软件版本 (2字节) - 例如 "1.0" -> 0x01 0x00
+  uint8_t major_version = 1;
+  uint8_t minor_version = 0;
+  if (!data_.software_version.empty()) {
+    sscanf(data_.software_version.c_str(), "%hhu.%hhu", &major_version, &minor_version);
+  }
+
+  LoraCleanReportSchema::EncodeAs(
+      identifier, writer,
+      data_.lora_params.power, data_.lora_params.frequency, data_.lora_params.rate,
+      data_.robot_number, major_version, minor_version,
+      0x00,  // 启用/停用
+      0x00,  // 保留
+      data_.parking_position, data_.daytime_scan_protect ? 0x01 : 0x00,
+      ToWire(data_.schedule_tasks));
+}
+
+// 构建电机参数&温度电压参数数据域（E1上报与C1查询回复共用）
+void Robot::BuildMotorParamsField(uint8_t identifier, FrameWriter* writer) const {
+  const auto& tv = data_.temp_voltage_protection;
+  MotorParamsReportSchema::EncodeAs(
+      identifier, writer, ToWire(data_.motor_params),
+      TempVoltageFields::Value(ToWire(tv), tv.board_protection_temp, tv.board_recovery_temp));
+}
+
+void Robot::BeginReportFrame(FrameWriter* writer) const {
+  writer->Begin(CONTROL_CODE_DOWNLINK, data_.robot_number,
+                static_cast<uint8_t>(sequence_.load() & 0xFF));
+}
+
+bool Robot::SendFrame(MqttManager* mqtt_manager, FrameWriter* writer) {
+  if (!PublishFrame(mqtt_manager, writer)) return false;
+
+  // 帧计数累加
+  sequence_.fetch_add(1);
+  return true;
+}
 
-  // 标识符
-  data_field.push_back(identifier);
+bool Robot::PublishFrame(MqttManager* mqtt_manager, FrameWriter* writer) {
+  const size_t frame_size = writer->Finish();
+  if (frame_size == 0) {
+    LOG(ERROR) << "  数据域超出帧长度限制，放弃发送";
+    return false;
+  }
+  TRACE_HOT(kProtocol, 2) << "  数据域长度: " << writer->DataSize() << " 字节";
+  TRACE_HOT(kProtocol, 2) << "  编码后数据: " << HexDump(writer->Data(), frame_size);
 
-  // FA告警 (4字节)
-  uint32_t fa = data_.alarm_fa;
-  data_field.push_back(static_cast<uint8_t>(fa >> 24));
-  data_field.push_back(static_cast<uint8_t>(fa >> 16));
-  data_field.push_back(static_cast<uint8_t>(fa >> 8));
-  data_field.push_back(static_cast<uint8_t>(fa));
-
-  // FB告警 (2字节)
-  uint16_t fb = data_.alarm_fb;
-  data_field.push_back(static_cast<uint8_t>(fb >> 8));
-  data_field.push_back(static_cast<uint8_t>(fb));
-
-  // FC告警 (4字节)
-  uint32_t fc = data_.alarm_fc;
-  data_field.push_back(static_cast<uint8_t>(fc >> 24));
-  data_field.push_back(static_cast<uint8_t>(fc >> 16));
-  data_field.push_back(static_cast<uint8_t>(fc >> 8));
-  data_field.push_back(static_cast<uint8_t>(fc));
-
-  // FD告警 (2字节)
-  uint16_t fd = data_.alarm_fd;
-  data_field.push_back(static_cast<uint8_t>(fd >> 8));
-  data_field.push_back(static_cast<uint8_t>(fd));
-
-  // 主电机电流 (2字节，单位100mA)
-  uint16_t main_current = static_cast<uint16_t>(data_.main_motor_current);
-  data_field.push_back(static_cast<uint8_t>(main_current >> 8));
-  data_field.push_back(static_cast<uint8_t>(main_current));
-
-  // 从电机电流 (2字节，单位100mA)
-  uint16_t slave_current = static_cast<uint16_t>(data_.slave_motor_current);
-  data_field.push_back(static_cast<uint8_t>(slave_current >> 8));
-  data_field.push_back(static_cast<uint8_t>(slave_current));
-
-  // 电池电压 (2字节，单位100mV)
-  uint16_t battery_volt = static_cast<uint16_t>(data_.battery_voltage);
-  data_field.push_back(static_cast<uint8_t>(battery_volt >> 8));
-  data_field.push_back(static_cast<uint8_t>(battery_volt));
-
-  // 电池电流 (2字节，单位100mA)
-  uint16_t battery_curr = static_cast<uint16_t>(data_.battery_current);
-  data_field.push_back(static_cast<uint8_t>(battery_curr >> 8));
-  data_field.push_back(static_cast<uint8_t>(battery_curr));
-
-  // 电池状态 (2字节)
-  uint16_t battery_status = static_cast<uint16_t>(data_.battery_status);
-  data_field.push_back(static_cast<uint8_t>(battery_status >> 8));
-  data_field.push_back(static_cast<uint8_t>(battery_status));
-
-  // 电池电量 (2字节)
-  uint16_t battery_level = static_cast<uint16_t>(data_.battery_level);
-  data_field.push_back(static_cast<uint8_t>(battery_level >> 8));
-  data_field.push_back(static_cast<uint8_t>(battery_level));
-
-  // 电池温度 (2字节)
-  uint16_t battery_temp = static_cast<uint16_t>(data_.battery_temperature);
-  data_field.push_back(static_cast<uint8_t>(battery_temp >> 8));
-  data_field.push_back(static_cast<uint8_t>(battery_temp));
-
-  // 位置信息 (2字节) - 使用position字段
-  uint16_t position = static_cast<uint16_t>(data_.position);
-  data_field.push_back(static_cast<uint8_t>(position >> 8));
-  data_field.push_back(static_cast<uint8_t>(position));
-
-  // 工作时长 (2字节)
-  uint16_t work_duration = static_cast<uint16_t>(data_.working_duration);
-  data_field.push_back(static_cast<uint8_t>(work_duration >> 8));
-  data_field.push_back(static_cast<uint8_t>(work_duration));
-
-  // 光伏板输出电压 (2字节，单位100mV)
-  uint16_t solar_volt = static_cast<uint16_t>(data_.solar_voltage);
-  data_field.push_back(static_cast<uint8_t>(solar_volt >> 8));
-  data_field.push_back(static_cast<uint8_t>(solar_volt));
-
-  // 光伏板输出电流 (2字节，单位100mA)
-  uint16_t solar_curr = static_cast<uint16_t>(data_.solar_current);
-  data_field.push_back(static_cast<uint8_t>(solar_curr >> 8));
-  data_field.push_back(static_cast<uint8_t>(solar_curr));
-
-  // 累计运行次数 (2字节)
-  uint16_t total_count = static_cast<uint16_t>(data_.total_run_count);
-  data_field.push_back(static_cast<uint8_t>(total_count >> 8));
-  data_field.push_back(static_cast<uint8_t>(total_count));
-
-  // 当前运行圈数 (4字节)
-  uint32_t lap_count = static_cast<uint32_t>(data_.current_lap_count);
-  data_field.push_back(static_cast<uint8_t>(lap_count >> 24));
-  data_field.push_back(static_cast<uint8_t>(lap_count >> 16));
-  data_field.push_back(static_cast<uint8_t>(lap_count >> 8));
-  data_field.push_back(static_cast<uint8_t>(lap_count));
-
-  // 当前实际时间戳 (3字节: 时、分、秒)
-  data_field.push_back(static_cast<uint8_t>(data_.current_timestamp.hour));
-  data_field.push_back(static_cast<uint8_t>(data_.current_timestamp.minute));
-  data_field.push_back(static_cast<uint8_t>(data_.current_timestamp.second));
-
-  // 主板温度 (2字节)
-  uint16_t board_temp = static_cast<uint16_t>(data_.board_temperature);
-  data_field.push_back(static_cast<uint8_t>(board_temp >> 8));
-  data_field.push_back(static_cast<uint8_t>(board_temp));
-
-  return data_field;
+  PublishUplink(mqtt_manager, writer->Data(), frame_size);
+  return true;
 }
 
 void Robot::SendMotorParamsRequest(
@@ -1706,6 +1622,7 @@ void Robot::SendMotorParamsRequest(
     uint16_t windproof_motor_warning_current_ma, uint16_t walk_motor_mileage_m,
     uint16_t brush_motor_timeout_s, uint16_t windproof_motor_timeout_s,
     uint8_t reverse_time_s, uint8_t protection_angle) {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   LOG(INFO) << "[Robot " << robot_id_ << "] 发送电机参数设置请求";
 
   auto mqtt_manager = mqtt_manager_.lock();
@@ -1714,53 +1631,20 @@ void Robot::SendMotorParamsRequest(
     return;
   }
 
-  std::vector<uint8_t> data_field = {
-      0xA0,  // 标识：电机参数设置
-      walk_motor_speed,
-      brush_motor_speed,
-      windproof_motor_speed,
-      static_cast<uint8_t>(walk_motor_max_current_ma >> 8),
-      static_cast<uint8_t>(walk_motor_max_current_ma & 0xFF),
-      static_cast<uint8_t>(brush_motor_max_current_ma >> 8),
-      static_cast<uint8_t>(brush_motor_max_current_ma & 0xFF),
-      static_cast<uint8_t>(windproof_motor_max_current_ma >> 8),
-      static_cast<uint8_t>(windproof_motor_max_current_ma & 0xFF),
-      static_cast<uint8_t>(walk_motor_warning_current_ma >> 8),
-      static_cast<uint8_t>(walk_motor_warning_current_ma & 0xFF),
-      static_cast<uint8_t>(brush_motor_warning_current_ma >> 8),
-      static_cast<uint8_t>(brush_motor_warning_current_ma & 0xFF),
-      static_cast<uint8_t>(windproof_motor_warning_current_ma >> 8),
-      static_cast<uint8_t>(windproof_motor_warning_current_ma & 0xFF),
-      static_cast<uint8_t>(walk_motor_mileage_m >> 8),
-      static_cast<uint8_t>(walk_motor_mileage_m & 0xFF),
-      static_cast<uint8_t>(brush_motor_timeout_s >> 8),
-      static_cast<uint8_t>(brush_motor_timeout_s & 0xFF),
-      static_cast<uint8_t>(windproof_motor_timeout_s >> 8),
-      static_cast<uint8_t>(windproof_motor_timeout_s & 0xFF),
-      reverse_time_s,
-      protection_angle,
-  };
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
+  MotorParamsSetSchema::Encode(
+      &w, MotorParamsFields::Value(
+              walk_motor_speed, brush_motor_speed, windproof_motor_speed,
+              walk_motor_max_current_ma, brush_motor_max_current_ma, windproof_motor_max_current_ma,
+              walk_motor_warning_current_ma, brush_motor_warning_current_ma,
+              windproof_motor_warning_current_ma, walk_motor_mileage_m, brush_motor_timeout_s,
+              windproof_motor_timeout_s, reverse_time_s, protection_angle));
 
-  uint16_t robot_num = 0;
-  try {
-    if (!data_.robot_number.empty()) {
-      robot_num = static_cast<uint16_t>(std::stoul(data_.robot_number));
-    }
-  } catch (...) {
-    robot_num = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE(kProtocol, 2) << "  电机参数设置编码后数据: " << HexDump(w.Data(), w.Size());
   }
-
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded =
-      protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_num, frame_count, data_field);
-
-  LOG(INFO) << "  电机参数设置编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendBatteryParamsRequest(uint16_t protection_current_ma,
@@ -1773,6 +1657,7 @@ void Robot::SendBatteryParamsRequest(uint16_t protection_current_ma,
                                      uint8_t protection_battery_level,
                                      uint8_t limit_run_battery_level,
                                      uint8_t recovery_battery_level) {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   LOG(INFO) << "[Robot " << robot_id_ << "] 发送电池参数设置请求";
 
   auto mqtt_manager = mqtt_manager_.lock();
@@ -1781,45 +1666,24 @@ void Robot::SendBatteryParamsRequest(uint16_t protection_current_ma,
     return;
   }
 
-  std::vector<uint8_t> data_field = {
-      0xA1,
-      static_cast<uint8_t>(protection_current_ma >> 8),
-      static_cast<uint8_t>(protection_current_ma & 0xFF),
-      high_temp_threshold,
-      low_temp_threshold,
-      protection_temp,
-      recovery_temp,
-      protection_voltage,
-      recovery_voltage,
-      protection_battery_level,
-      limit_run_battery_level,
-      recovery_battery_level,
-  };
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
+  BatteryParamsSetSchema::Encode(
+      &w, BatteryParamsFields::Value(protection_current_ma, high_temp_threshold,
+                                     low_temp_threshold, protection_temp, recovery_temp,
+                                     protection_voltage, recovery_voltage,
+                                     protection_battery_level, limit_run_battery_level,
+                                     recovery_battery_level));
 
-  uint16_t robot_num = 0;
-  try {
-    if (!data_.robot_number.empty()) {
-      robot_num = static_cast<uint16_t>(std::stoul(data_.robot_number));
-    }
-  } catch (...) {
-    robot_num = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE(kProtocol, 2) << "  电池参数设置编码后数据: " << HexDump(w.Data(), w.Size());
   }
-
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded =
-      protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_num, frame_count, data_field);
-
-  LOG(INFO) << "  电池参数设置编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendScheduleStartRequest(uint8_t schedule_id, uint8_t weekday,
                                      uint8_t hour, uint8_t minute, uint8_t run_count) {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   LOG(INFO) << "[Robot " << robot_id_ << "] 发送定时启动请求";
   LOG(INFO) << "  定时信息编号: " << static_cast<int>(schedule_id);
   LOG(INFO) << "  星期: " << static_cast<int>(weekday);
@@ -1833,43 +1697,21 @@ void Robot::SendScheduleStartRequest(uint8_t schedule_id, uint8_t weekday,
     return;
   }
 
-  // 构造数据域：标识(0xF0) + 参数(5字节)
-  std::vector<uint8_t> data_field = {
-    0xF0,         // 标识：定时启动请求
-    schedule_id,  // 定时信息编号
-    weekday,      // 星期
-    hour,         // 时
-    minute,       // 分
-    run_count     // 运行次数
-  };
+  // 构造数据域：标识(0xF0) + 定时信息编号 + 星期 + 时 + 分 + 运行次数
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
+  ScheduleStartRequestSchema::Encode(
+      &w, schedule_id, ScheduleTaskFields::Value(weekday, hour, minute, run_count));
 
-  // 使用Protocol编码：控制码0x82（机器人主动发送请求）
-  uint16_t robot_num = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_num = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_num = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE(kProtocol, 2) << "  编码后数据: " << HexDump(w.Data(), w.Size());
+    LOG(INFO) << "  定时启动请求已加入发送队列";
   }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_num, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  // 转换为Base64
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  LOG(INFO) << "  Base64编码: " << base64_data;
-
-  // 填入上行模板并发送
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  LOG(INFO) << "  定时启动请求已加入发送队列";
-
-  // 帧计数累加
-  sequence_.fetch_add(1);
 }
 
-void Robot::SendScheduleParamsRequest(const std::vector<ScheduleTask>& tasks) {
+void Robot::SendScheduleParamsRequest(const ScheduleTaskList& tasks) {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   LOG(INFO) << "[Robot " << robot_id_ << "] 发送定时设置请求";
 
   auto mqtt_manager = mqtt_manager_.lock();
@@ -1878,48 +1720,18 @@ void Robot::SendScheduleParamsRequest(const std::vector<ScheduleTask>& tasks) {
     return;
   }
 
-  std::vector<ScheduleTask> normalized_tasks(7);
-  for (size_t i = 0; i < 7; ++i) {
-    if (i < tasks.size()) {
-      normalized_tasks[i] = tasks[i];
-    }
-  }
-
-  std::vector<uint8_t> data_field;
-  data_field.reserve(29);
-  data_field.push_back(0xA2);  // 标识：定时设置
-
-  for (size_t i = 0; i < 7; ++i) {
-    const auto& task = normalized_tasks[i];
-    data_field.push_back(static_cast<uint8_t>(task.weekday));
-    data_field.push_back(static_cast<uint8_t>(task.hour));
-    data_field.push_back(static_cast<uint8_t>(task.minute));
-    data_field.push_back(static_cast<uint8_t>(task.run_count));
-  }
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
+  ScheduleSetSchema::Encode(&w, ToWire(tasks));
 
-  uint16_t robot_num = 0;
-  try {
-    if (!data_.robot_number.empty()) {
-      robot_num = static_cast<uint16_t>(std::stoul(data_.robot_number));
-    }
-  } catch (...) {
-    robot_num = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE(kProtocol, 2) << "  定时设置编码后数据: " << HexDump(w.Data(), w.Size());
   }
-
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded =
-      protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_num, frame_count, data_field);
-
-  LOG(INFO) << "  定时设置编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendParkingPositionRequest(uint8_t parking_position) {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   LOG(INFO) << "[Robot " << robot_id_ << "] 发送停机位设置请求";
   LOG(INFO) << "  停机位: " << static_cast<int>(parking_position);
 
@@ -1929,34 +1741,18 @@ void Robot::SendParkingPositionRequest(uint8_t parking_position) {
     return;
   }
 
-  std::vector<uint8_t> data_field = {
-      0xA3,  // 标识：停机位设置
-      parking_position,
-  };
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
+  ParkingSetSchema::Encode(&w, parking_position);
 
-  uint16_t robot_num = 0;
-  try {
-    if (!data_.robot_number.empty()) {
-      robot_num = static_cast<uint16_t>(std::stoul(data_.robot_number));
-    }
-  } catch (...) {
-    robot_num = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE(kProtocol, 2) << "  停机位设置编码后数据: " << HexDump(w.Data(), w.Size());
   }
-
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded =
-      protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_num, frame_count, data_field);
-
-  LOG(INFO) << "  停机位设置编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendStartRequest() {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   LOG(INFO) << "[Robot " << robot_id_ << "] 发送启动请求";
 
   auto mqtt_manager = mqtt_manager_.lock();
@@ -1966,37 +1762,19 @@ void Robot::SendStartRequest() {
   }
 
   // 构造数据域：标识(0xF1) + 无参数
-  std::vector<uint8_t> data_field = {
-    0xF1  // 标识：启动请求
-  };
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
+  StartRequestSchema::Encode(&w);
 
-  // 使用Protocol编码：控制码0x82（机器人主动发送请求）
-  uint16_t robot_num = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_num = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_num = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE(kProtocol, 2) << "  编码后数据: " << HexDump(w.Data(), w.Size());
+    LOG(INFO) << "  启动请求已加入发送队列";
   }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_num, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  // 转换为Base64
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  LOG(INFO) << "  Base64编码: " << base64_data;
-
-  // 填入上行模板并发送
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  LOG(INFO) << "  启动请求已加入发送队列";
-
-  // 帧计数累加
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendTimeSyncRequest() {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   LOG(INFO) << "[Robot " << robot_id_ << "] 发送校时请求";
 
   auto mqtt_manager = mqtt_manager_.lock();
@@ -2006,38 +1784,20 @@ void Robot::SendTimeSyncRequest() {
   }
 
   // 构造数据域：标识(0xF2) + 无参数
-  std::vector<uint8_t> data_field = {
-    0xF2  // 标识：校时请求
-  };
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
+  TimeSyncRequestSchema::Encode(&w);
 
-  // 使用Protocol编码：控制码0x82（机器人主动发送请求）
-  uint16_t robot_num = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_num = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_num = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE(kProtocol, 2) << "  编码后数据: " << HexDump(w.Data(), w.Size());
+    LOG(INFO) << "  校时请求已加入发送队列";
   }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_num, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  // 转换为Base64
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  LOG(INFO) << "  Base64编码: " << base64_data;
-
-  // 填入上行模板并发送
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  LOG(INFO) << "  校时请求已加入发送队列";
-
-  // 帧计数累加
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendLoraAndCleanSettingsReport() {
-  LOG(INFO) << "[Robot " << robot_id_ << "] 发送Lora参数&清扫设置上报";
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  TRACE_HOT(kRobot, 1) << "[Robot " << robot_id_ << "] 发送Lora参数&清扫设置上报";
 
   auto mqtt_manager = mqtt_manager_.lock();
   if (!mqtt_manager) {
@@ -2045,89 +1805,20 @@ void Robot::SendLoraAndCleanSettingsReport() {
     return;
   }
 
-  // 构造数据域：标识(0xE0) + Lora参数 + 清扫设置
-  std::vector<uint8_t> data_field;
-
-  // 标识符
-  data_field.push_back(0xE0);
-
-  // Lora参数 (3字节)
-  data_field.push_back(static_cast<uint8_t>(data_.lora_params.power));      // 功率
-  data_field.push_back(static_cast<uint8_t>(data_.lora_params.frequency));  // 频率
-  data_field.push_back(static_cast<uint8_t>(data_.lora_params.rate));       // 速率
-
-  // 机器人编号 (2字节) - 从data_.robot_number字符串转换为数字（若非数字则为0）
-  uint16_t robot_num = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_num = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_num = 0;
-  }
-  data_field.push_back(static_cast<uint8_t>(robot_num >> 8));   // 高字节
-  data_field.push_back(static_cast<uint8_t>(robot_num & 0xFF)); // 低字节
-
-  // 软件版本 (2字节) - 例如 "1.0" -> 0x01 0x00
-  uint8_t major_version = 1;
-  uint8_t minor_version = 0;
-  if (!data_.software_version.empty()) {
-    sscanf(data_.software_version.c_str(), "%hhu.%hhu", &major_version, &minor_version);
-  }
-  data_field.push_back(major_version);
-  data_field.push_back(minor_version);
-
-  // 启用/停用 (1字节)
-  data_field.push_back(0x00);
-
-  // 保留 (1字节) - 保留字段
-  data_field.push_back(0x00);
-
-  // 停机位 (1字节)
-  data_field.push_back(static_cast<uint8_t>(data_.parking_position));
-
-  // 白天防误扫开关 (1字节)
-  data_field.push_back(data_.daytime_scan_protect ? 0x01 : 0x00);
-
-  // 定时任务1-7 (每个4字节，共28字节)
-  for (int i = 0; i < 7; i++) {
-    const auto& task = data_.schedule_tasks[i];
-    data_field.push_back(static_cast<uint8_t>(task.weekday));
-    data_field.push_back(static_cast<uint8_t>(task.hour));
-    data_field.push_back(static_cast<uint8_t>(task.minute));
-    data_field.push_back(static_cast<uint8_t>(task.run_count));
-  }
-
-
-  LOG(INFO) << "  数据域长度: " << data_field.size() << " 字节";
-  LOG(INFO) << "  数据域内容: " << Protocol::BytesToHexString(data_field);
+  // 构造数据域：标识(0xE0) + Lora参数 + 清扫设置（直接写入帧）
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
+  BuildLoraCleanField(0xE0, &w);
 
-  // 使用Protocol编码：控制码0x82（机器人主动上报）
-  uint16_t robot_number = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_number = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_number = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE_HOT(kRobot, 1) << "  Lora参数&清扫设置上报已加入发送队列";
   }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_number, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  // 转换为Base64
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  LOG(INFO) << "  Base64编码: " << base64_data;
-
-  // 填入上行模板并发送
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  LOG(INFO) << "  Lora参数&清扫设置上报已加入发送队列";
-
-  // 帧计数累加
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendMotorParamsReport() {
-  LOG(INFO) << "[Robot " << robot_id_ << "] 发送电机参数主动上报";
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  TRACE_HOT(kRobot, 1) << "[Robot " << robot_id_ << "] 发送电机参数主动上报";
 
   auto mqtt_manager = mqtt_manager_.lock();
   if (!mqtt_manager) {
@@ -2136,82 +1827,19 @@ void Robot::SendMotorParamsReport() {
   }
 
   // 构造数据域：标识(0xE1) + 电机参数(23字节) + 温度电压参数(15字节)
-  std::vector<uint8_t> data_field;
-  data_field.reserve(39);
-  data_field.push_back(0xE1);  // 电机参数主动上报标识
-
-  // 电机参数 (23字节)
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.walk_motor_speed));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.brush_motor_speed));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.windproof_motor_speed));
-
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.walk_motor_max_current_ma >> 8));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.walk_motor_max_current_ma & 0xFF));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.brush_motor_max_current_ma >> 8));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.brush_motor_max_current_ma & 0xFF));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.windproof_motor_max_current_ma >> 8));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.windproof_motor_max_current_ma & 0xFF));
-
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.walk_motor_warning_current_ma >> 8));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.walk_motor_warning_current_ma & 0xFF));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.brush_motor_warning_current_ma >> 8));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.brush_motor_warning_current_ma & 0xFF));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.windproof_motor_warning_current_ma >> 8));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.windproof_motor_warning_current_ma & 0xFF));
-
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.walk_motor_mileage_m >> 8));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.walk_motor_mileage_m & 0xFF));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.brush_motor_timeout_s >> 8));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.brush_motor_timeout_s & 0xFF));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.windproof_motor_timeout_s >> 8));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.windproof_motor_timeout_s & 0xFF));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.reverse_time_s));
-  data_field.push_back(static_cast<uint8_t>(data_.motor_params.protection_angle));
-
-  // 温度电压参数 (15字节)
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.protection_current_ma >> 8));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.protection_current_ma & 0xFF));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.high_temp_threshold));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.low_temp_threshold));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.protection_temp));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.recovery_temp));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.protection_voltage));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.recovery_voltage));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.protection_battery_level));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.limit_run_battery_level));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.recovery_battery_level));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.board_protection_temp >> 8));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.board_protection_temp & 0xFF));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.board_recovery_temp >> 8));
-  data_field.push_back(static_cast<uint8_t>(data_.temp_voltage_protection.board_recovery_temp & 0xFF));
-
-  LOG(INFO) << "  数据域长度: " << data_field.size() << " 字节";
-  LOG(INFO) << "  数据域内容: " << Protocol::BytesToHexString(data_field);
-
-  uint16_t robot_number = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_number = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_number = 0;
-  }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_number, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  LOG(INFO) << "  Base64编码: " << base64_data;
-
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  LOG(INFO) << "  电机参数主动上报已加入发送队列";
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
+  BuildMotorParamsField(0xE1, &w);
 
-  sequence_.fetch_add(1);
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE_HOT(kRobot, 1) << "  电机参数主动上报已加入发送队列";
+  }
 }
 
 void Robot::SendRobotDataReport() {
-  LOG(INFO) << "[Robot " << robot_id_ << "] 发送机器人数据上报";
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  TRACE_HOT(kRobot, 1) << "[Robot " << robot_id_ << "] 发送机器人数据上报";
 
   auto mqtt_manager = mqtt_manager_.lock();
   if (!mqtt_manager) {
@@ -2220,39 +1848,19 @@ void Robot::SendRobotDataReport() {
   }
 
   // 构造数据域：标识(0xE4) + 机器人数据 (共46字节)
-  std::vector<uint8_t> data_field = BuildRobotDataField(0xE4);
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
+  BuildRobotDataField(0xE4, &w);
 
-  LOG(INFO) << "  数据域长度: " << data_field.size() << " 字节";
-  LOG(INFO) << "  数据域内容: " << Protocol::BytesToHexString(data_field);
-
-  // 使用Protocol编码：控制码0x82（机器人主动上报）
-  uint16_t robot_number = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_number = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_number = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE_HOT(kRobot, 1) << "  机器人数据上报已加入发送队列";
   }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_number, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  // 转换为Base64
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  LOG(INFO) << "  Base64编码: " << base64_data;
-
-  // 填入上行模板并发送
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  LOG(INFO) << "  机器人数据上报已加入发送队列";
-
-  // 帧计数累加
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendCleanRecordReport() {
-  LOG(INFO) << "[Robot " << robot_id_ << "] 发送清扫记录上报";
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  TRACE_HOT(kRobot, 1) << "[Robot " << robot_id_ << "] 发送清扫记录上报";
 
   auto mqtt_manager = mqtt_manager_.lock();
   if (!mqtt_manager) {
@@ -2261,148 +1869,73 @@ void Robot::SendCleanRecordReport() {
   }
 
   // 构造数据域：标识(0xE9) + 清扫记录 + 机器人编码信息 + 本地时间 + 主板温湿度
-  std::vector<uint8_t> data_field;
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
 
-  // 标识符
-  data_field.push_back(0xE9);
-
-  // 清扫记录5条，每条: 日(1) 时(1) 分(1) 清扫分钟数(2, 高字节先)
-  // `clean_records` 已在构造时初始化为5个元素，直接读取
-  for (size_t i = 0; i < 5; ++i) {
+  // 清扫记录5条，每条: 日(1) 时(1) 分(1) 清扫分钟数(2, 高字节先) 结果(1) 耗电量(1)
+  Array<CleanRecordFields, 5>::Value records;
+  for (size_t i = 0; i < records.size(); ++i) {
     const auto& rec = data_.clean_records[i];
-    data_field.push_back(static_cast<uint8_t>(rec.day));
-    data_field.push_back(static_cast<uint8_t>(rec.hour));
-    data_field.push_back(static_cast<uint8_t>(rec.minute));
-    uint16_t mins = static_cast<uint16_t>(rec.minutes);
-    data_field.push_back(static_cast<uint8_t>(mins >> 8));
-    data_field.push_back(static_cast<uint8_t>(mins & 0xFF));
-    // 清扫结果 (1字节)
-    data_field.push_back(static_cast<uint8_t>(rec.result));
-    // 耗电量 (1字节)
-    data_field.push_back(static_cast<uint8_t>(rec.energy));
+    records[i] = CleanRecordFields::Value(rec.day, rec.hour, rec.minute, rec.minutes, rec.result,
+                                          rec.energy);
   }
 
   // 机器人编码信息 6 字节：取 robot_id_ 的后6个字符（不足左填0）
-  std::string dev_addr = robot_id_.length() >= 6 ? robot_id_.substr(robot_id_.length() - 6) : robot_id_;
-  // 保证6字节
-  while (dev_addr.size() < 6) dev_addr = std::string("\0") + dev_addr;
-  for (size_t i = 0; i < 6; ++i) {
-    char c = dev_addr[i];
-    data_field.push_back(static_cast<uint8_t>(c));
-  }
+  Bytes<6>::Value robot_code{};
+  const size_t id_len = std::min<size_t>(robot_id_.length(), 6);
+  std::memcpy(robot_code.data() + robot_code.size() - id_len,
+              robot_id_.data() + robot_id_.length() - id_len, id_len);
 
   // 在上报前更新时间字段与工作时长
   UpdateTimeFields();
 
-  // 机器人本地时间 (年, 月, 日, 时, 分, 秒) - 年取两位
-  int year = data_.local_time.year % 100;
-  data_field.push_back(static_cast<uint8_t>(year));
-  data_field.push_back(static_cast<uint8_t>(data_.local_time.month));
-  data_field.push_back(static_cast<uint8_t>(data_.local_time.day));
-  data_field.push_back(static_cast<uint8_t>(data_.local_time.hour));
-  data_field.push_back(static_cast<uint8_t>(data_.local_time.minute));
-  data_field.push_back(static_cast<uint8_t>(data_.local_time.second));
-
-  // 主板温度 (2字节, 大端序)
-  uint16_t board_temp16 = static_cast<uint16_t>(data_.board_temperature);
-  data_field.push_back(static_cast<uint8_t>(board_temp16 >> 8));
-  data_field.push_back(static_cast<uint8_t>(board_temp16 & 0xFF));
-
-  // 主板湿度 (1字节)
-  data_field.push_back(static_cast<uint8_t>(data_.board_humidity & 0xFF));
+  // 机器人本地时间 (年, 月, 日, 时, 分, 秒) - 年取两位；主板温度(2字节)；主板湿度(1字节)
+  CleanRecordReportSchema::Encode(
+      &w, records, robot_code, data_.local_time.year % 100, data_.local_time.month,
+      data_.local_time.day, data_.local_time.hour, data_.local_time.minute,
+      data_.local_time.second, data_.board_temperature, data_.board_humidity & 0xFF);
 
-  LOG(INFO) << "  数据域长度: " << data_field.size() << " 字节";
-  LOG(INFO) << "  数据域内容: " << Protocol::BytesToHexString(data_field);
-
-  // 使用Protocol编码：控制码0x82（机器人主动上报）
-  uint16_t robot_number = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_number = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_number = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE_HOT(kRobot, 1) << "  清扫记录上报已加入发送队列";
   }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_number, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  // 转换为Base64并发送
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  LOG(INFO) << "  清扫记录上报已加入发送队列";
-
-  // 帧计数累加
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendCurrentDataReport() {
-  LOG(INFO) << "[Robot " << robot_id_ << "] 发送电流数据上报 (0xE5)";
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  TRACE_HOT(kRobot, 1) << "[Robot " << robot_id_ << "] 发送电流数据上报 (0xE5)";
 
   auto mqtt_manager = mqtt_manager_.lock();
   if (!mqtt_manager) {
     LOG(ERROR) << "  MQTT管理器未初始化";
     return;
   }
+  RefreshSimulatedState();
 
   // 构造数据域：标识(0xE5) + 当前位置(2) + 当前方向(1)
   // + 电流上报间隔(2,大端) + 10组主/从机电流(各1字节交叉排列)
-  std::vector<uint8_t> data_field;
-  data_field.reserve(26);
-
-  // 标识符
-  data_field.push_back(0xE5);
-
-  // 当前位置 (2字节，大端)
-  uint16_t pos = static_cast<uint16_t>(data_.position);
-  data_field.push_back(static_cast<uint8_t>(pos >> 8));
-  data_field.push_back(static_cast<uint8_t>(pos & 0xFF));
-
-  // 当前方向 (1字节)
-  data_field.push_back(static_cast<uint8_t>(data_.direction));
-
-  // 电流上报间隔（手动触发时填0）
-  uint16_t interval = 0;
-  data_field.push_back(static_cast<uint8_t>(interval >> 8));
-  data_field.push_back(static_cast<uint8_t>(interval & 0xFF));
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
 
   // 10组主/从机电流，交叉排列：主机电流1, 从机电流1, ..., 主机电流10, 从机电流10
   // 每路各1字节
-  // master_currents 和 slave_currents 均已初始化丶16个元素
-  for (int i = 0; i < 10; ++i) {
-    data_field.push_back(static_cast<uint8_t>(data_.master_currents[i]));
-    data_field.push_back(static_cast<uint8_t>(data_.slave_currents[i]));
+  Array<CurrentPairFields, 10>::Value currents;
+  for (size_t i = 0; i < currents.size(); ++i) {
+    currents[i] = CurrentPairFields::Value(data_.master_currents[i], data_.slave_currents[i]);
   }
 
-  LOG(INFO) << "  数据域长度: " << data_field.size() << " 字节";
-  LOG(INFO) << "  数据域内容: " << Protocol::BytesToHexString(data_field);
+  // 当前位置(2字节) + 当前方向(1字节) + 电流上报间隔（手动触发时填0）
+  CurrentDataReportSchema::Encode(&w, data_.position, data_.direction, 0, currents);
 
-  // 使用Protocol编码：控制砃0x82（机器人主动上报）
-  uint16_t robot_number = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_number = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_number = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE_HOT(kRobot, 1) << "  电流数据上报已加入发送队列";
   }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_number, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  // 转换为Base64并发送
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  LOG(INFO) << "  电流数据上报已加入发送队列";
-
-  // 帧计数累加
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendScheduledNotRunReport() {
-  LOG(INFO) << "[Robot " << robot_id_ << "] 发送定时请求/未运行原因上报 (0xE6)";
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  TRACE_HOT(kRobot, 1) << "[Robot " << robot_id_ << "] 发送定时请求/未运行原因上报 (0xE6)";
 
   auto mqtt_manager = mqtt_manager_.lock();
   if (!mqtt_manager) {
@@ -2411,20 +1944,17 @@ void Robot::SendScheduledNotRunReport() {
   }
 
   // 构造数据域：标识(1) + 定时器编号(1) + 周(1) + 时(1) + 分(1) + 运行次数(1) + 原因(1) + 故障信息(4) = 11字节
-  std::vector<uint8_t> data_field;
-  data_field.reserve(11);
-
-  // 标识符
-  data_field.push_back(0xE6);
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
 
   // 定时器编号 (1字节, 1~7)
   uint8_t sid = data_.scheduled_not_run_id;
-  data_field.push_back(sid);
 
   // 从 schedule_tasks 读取对应定时任务参数
   uint8_t weekday = 0, hour = 0, minute = 0;
   uint8_t run_count = 0;
-  if (sid >= 1 && sid <= 7 && data_.schedule_tasks.size() >= static_cast<size_t>(sid)) {
+  if (sid >= 1 && sid <= 7) {
     const auto& task = data_.schedule_tasks[sid - 1];
     weekday   = static_cast<uint8_t>(task.weekday);
     hour      = static_cast<uint8_t>(task.hour);
@@ -2433,51 +1963,26 @@ void Robot::SendScheduledNotRunReport() {
     int rc = task.run_count;
     run_count = (rc < 127) ? static_cast<uint8_t>(rc / 2) : static_cast<uint8_t>(rc);
   }
-  data_field.push_back(weekday);
-  data_field.push_back(hour);
-  data_field.push_back(minute);
-  data_field.push_back(run_count);
-
-  // 未运行原因 (1字节)
-  data_field.push_back(data_.scheduled_not_run_reason);
-
-  // 故障信息 (4字节, 取 e6_alarm)
-  uint32_t fa = data_.e6_alarm;
-  data_field.push_back(static_cast<uint8_t>(fa >> 24));
-  data_field.push_back(static_cast<uint8_t>(fa >> 16));
-  data_field.push_back(static_cast<uint8_t>(fa >> 8));
-  data_field.push_back(static_cast<uint8_t>(fa));
-
-  LOG(INFO) << "  定时器编号:" << static_cast<int>(sid)
-            << " 周" << static_cast<int>(weekday)
-            << " " << static_cast<int>(hour) << ":" << static_cast<int>(minute)
-            << " 运行次数:" << static_cast<int>(run_count)
-            << " 原因:0x" << std::hex << static_cast<int>(data_.scheduled_not_run_reason);
-  LOG(INFO) << "  数据域长度: " << data_field.size() << " 字节";
-  LOG(INFO) << "  数据域内容: " << Protocol::BytesToHexString(data_field);
-
-  uint16_t robot_number = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_number = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_number = 0;
-  }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_number, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
 
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
+  // 未运行原因 (1字节)；故障信息 (4字节, 取 e6_alarm)
+  ScheduledNotRunReportSchema::Encode(
+      &w, sid, ScheduleTaskFields::Value(weekday, hour, minute, run_count),
+      data_.scheduled_not_run_reason, data_.e6_alarm);
 
-  LOG(INFO) << "  定时请求/未运行原因上报已加入发送队列";
+  TRACE_HOT(kRobot, 1) << "  定时器编号:" << static_cast<int>(sid)
+                       << " 周" << static_cast<int>(weekday)
+                       << " " << static_cast<int>(hour) << ":" << static_cast<int>(minute)
+                       << " 运行次数:" << static_cast<int>(run_count)
+                       << " 原因:0x" << std::hex << static_cast<int>(data_.scheduled_not_run_reason);
 
-  sequence_.fetch_add(1);
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE_HOT(kRobot, 1) << "  定时请求/未运行原因上报已加入发送队列";
+  }
 }
 
 void Robot::SendNotStartedReport() {
-  LOG(INFO) << "[Robot " << robot_id_ << "] 发送未启动原因上报 (0xE7)";
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  TRACE_HOT(kRobot, 1) << "[Robot " << robot_id_ << "] 发送未启动原因上报 (0xE7)";
 
   auto mqtt_manager = mqtt_manager_.lock();
   if (!mqtt_manager) {
@@ -2486,50 +1991,26 @@ void Robot::SendNotStartedReport() {
   }
 
   // 构造数据域：标识(1) + 原因(1) + 故障信息(4) = 6字节
-  std::vector<uint8_t> data_field;
-  data_field.reserve(6);
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
 
-  // 标识符
-  data_field.push_back(0xE7);
-
-  // 未启动原因 (1字节)
-  data_field.push_back(data_.not_started_reason);
-
-  // 故障信息 (4字节大端, 取 alarm_fa)
+  // 未启动原因 (1字节) + 故障信息 (4字节大端, 取 alarm_fa)
   uint32_t fa = data_.alarm_fa;
   data_.e7_alarm = fa;  // 快照当前故障信息
-  data_field.push_back(static_cast<uint8_t>(fa >> 24));
-  data_field.push_back(static_cast<uint8_t>(fa >> 16));
-  data_field.push_back(static_cast<uint8_t>(fa >> 8));
-  data_field.push_back(static_cast<uint8_t>(fa));
+  NotStartedReportSchema::Encode(&w, data_.not_started_reason, fa);
 
-  LOG(INFO) << "  未启动原因:0x" << std::hex << static_cast<int>(data_.not_started_reason)
-            << " 故障信息:0x" << std::hex << fa;
-  LOG(INFO) << "  数据域长度: " << data_field.size() << " 字节";
-  LOG(INFO) << "  数据域内容: " << Protocol::BytesToHexString(data_field);
+  TRACE_HOT(kRobot, 1) << "  未启动原因:0x" << std::hex << static_cast<int>(data_.not_started_reason)
+                       << " 故障信息:0x" << std::hex << fa;
 
-  uint16_t robot_number = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_number = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_number = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE_HOT(kRobot, 1) << "  未启动原因上报已加入发送队列";
   }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_number, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  LOG(INFO) << "  未启动原因上报已加入发送队列";
-
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendStartupConfirmReport() {
-  LOG(INFO) << "[Robot " << robot_id_ << "] 发送启动请求回复接收后确认 (0xE8)";
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  TRACE_HOT(kRobot, 1) << "[Robot " << robot_id_ << "] 发送启动请求回复接收后确认 (0xE8)";
 
   auto mqtt_manager = mqtt_manager_.lock();
   if (!mqtt_manager) {
@@ -2538,43 +2019,25 @@ void Robot::SendStartupConfirmReport() {
   }
 
   // 构造数据域：标识(1) + 定时器编号(1) = 2字节
-  std::vector<uint8_t> data_field;
-  data_field.reserve(2);
-
-  // 标识符
-  data_field.push_back(0xE8);
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
 
   // 定时器编号 (1字节)
-  data_field.push_back(data_.startup_confirm_id);
+  StartupConfirmReportSchema::Encode(&w, data_.startup_confirm_id);
   data_.e8_alarm = data_.alarm_fa;  // 快照当前故障信息
 
-  LOG(INFO) << "  定时器编号:" << static_cast<int>(data_.startup_confirm_id);
-  LOG(INFO) << "  数据域长度: " << data_field.size() << " 字节";
-  LOG(INFO) << "  数据域内容: " << Protocol::BytesToHexString(data_field);
+  TRACE_HOT(kRobot, 1) << "  定时器编号:" << static_cast<int>(data_.startup_confirm_id);
 
-  uint16_t robot_number = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_number = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_number = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE_HOT(kRobot, 1) << "  启动请求回复接收后确认已加入发送队列";
   }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_number, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  LOG(INFO) << "  启动请求回复接收后确认已加入发送队列";
-
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendControlResponse(uint8_t control_identifier) {
-  LOG(INFO) << "[Robot " << robot_id_ << "] 发送控制响应 (标识符: 0x"
-            << std::hex << static_cast<int>(control_identifier) << ")";
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  TRACE(kRobot, 1) << "[Robot " << robot_id_ << "] 发送控制响应 (标识符: 0x"
+                   << std::hex << static_cast<int>(control_identifier) << ")";
 
   auto mqtt_manager = mqtt_manager_.lock();
   if (!mqtt_manager) {
@@ -2584,40 +2047,20 @@ void Robot::SendControlResponse(uint8_t control_identifier) {
 
   // 构造数据域：标识(control_identifier) + 机器人数据 (共46字节)
   // 与SendRobotDataReport相同格式，只有标识符不同
-  std::vector<uint8_t> data_field = BuildRobotDataField(control_identifier);
-
-  LOG(INFO) << "  数据域长度: " << data_field.size() << " 字节";
-  LOG(INFO) << "  数据域内容: " << Protocol::BytesToHexString(data_field);
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
+  BuildRobotDataField(control_identifier, &w);
 
-  // 使用Protocol编码：控制码0x82（机器人主动上报）
-  uint16_t robot_number = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_number = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_number = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE(kRobot, 1) << "  控制响应已加入发送队列";
   }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_number, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  // 转换为Base64
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  LOG(INFO) << "  Base64编码: " << base64_data;
-
-  // 填入上行模板并发送
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  LOG(INFO) << "  控制响应已加入发送队列";
-
-  // 帧计数累加
-  sequence_.fetch_add(1);
 }
 
 void Robot::SendRestartResponse(uint8_t control_identifier) {
-  LOG(INFO) << "[Robot " << robot_id_ << "] 发送重启响应 (标识符: 0x"
-            << std::hex << static_cast<int>(control_identifier) << ")";
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  TRACE(kRobot, 1) << "[Robot " << robot_id_ << "] 发送重启响应 (标识符: 0x"
+                   << std::hex << static_cast<int>(control_identifier) << ")";
 
   auto mqtt_manager = mqtt_manager_.lock();
   if (!mqtt_manager) {
@@ -2626,49 +2069,30 @@ void Robot::SendRestartResponse(uint8_t control_identifier) {
   }
 
   // 构造数据域：仅包含标识符（1字节）
-  std::vector<uint8_t> data_field = {control_identifier};
-
-  LOG(INFO) << "  数据域长度: " << data_field.size() << " 字节";
-  LOG(INFO) << "  数据域内容: " << Protocol::BytesToHexString(data_field);
+  FrameBuffer buffer;
+  FrameWriter w(buffer);
+  BeginReportFrame(&w);
+  w.PutU8(control_identifier);
 
-  // 使用Protocol编码：控制码0x82（机器人主动上报）
-  uint16_t robot_number = 0;
-  try {
-    if (!data_.robot_number.empty()) robot_number = static_cast<uint16_t>(std::stoul(data_.robot_number));
-  } catch (...) {
-    robot_number = 0;
+  if (SendFrame(mqtt_manager.get(), &w)) {
+    TRACE(kRobot, 1) << "  重启响应已加入发送队列";
   }
-  uint8_t frame_count = static_cast<uint8_t>(sequence_.load() & 0xFF);
-  std::vector<uint8_t> encoded = protocol_.Encode(CONTROL_CODE_DOWNLINK, robot_number, frame_count, data_field);
-
-  LOG(INFO) << "  编码后数据: " << Protocol::BytesToHexString(encoded);
-
-  // 转换为Base64
-  std::string base64_data = Protocol::BytesToBase64(encoded);
-  LOG(INFO) << "  Base64编码: " << base64_data;
-
-  // 填入上行模板并发送
-  std::string payload = GenerateUplinkPayload(base64_data);
-  mqtt_manager->EnqueueMessage(publish_topic_, payload, 1);
-
-  LOG(INFO) << "  重启响应已加入发送队列";
-
-  // 帧计数累加
-  sequence_.fetch_add(1);
 }
 
 // ── 控制指令动作函数 ────────────────────────────────────────────────────────
 
 void Robot::ControlEnable() {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   data_.enabled = true;
   data_.alarm_fa |= static_cast<uint32_t>(AlarmFA::kDeviceEnabled);
   LOG(INFO) << "[Robot " << robot_id_ << "] 已启用";
 }
 
 void Robot::ControlDisable() {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   data_.enabled = false;
   data_.alarm_fa &= ~static_cast<uint32_t>(AlarmFA::kDeviceEnabled);
-  move_direction_.store(0);
+  SetMoveDirection(0);
   LOG(INFO) << "[Robot " << robot_id_ << "] 已停用";
 }
 
@@ -2678,172 +2102,243 @@ void Robot::ControlStart() {
 }
 
 void Robot::StartCleaningTask(uint8_t schedule_id) {
-  if (cleaning_task_running_.load()) {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+  // 已停止（StopReport 在同一把锁下取走定时器编号）时不再挂新的清扫定时器
+  if (stop_report_.load()) {
+    LOG(WARNING) << "[Robot " << robot_id_ << "] 机器人已停止，忽略清扫启动请求";
+    return;
+  }
+  bool expected = false;
+  if (!cleaning_task_running_.compare_exchange_strong(expected, true)) {
     LOG(WARNING) << "[Robot " << robot_id_ << "] 清扫任务已在运行，忽略本次启动请求";
     return;
   }
 
-  // 等待上一次线程结束（如已结束则立即返回）
-  if (cleaning_task_thread_.joinable()) {
-    cleaning_task_thread_.join();
-  }
+  // 定时启动按机器人编号错开启动时刻（手动启动不抖动），随后进入准入排队
+  std::chrono::milliseconds jitter(0);
+  auto mgr = mqtt_manager_.lock();
+  if (mgr && schedule_id != 0) {
+    jitter = mgr->GetStartAdmission().JitterFor(robot_number_, schedule_id);
+  }
+  cleaning_schedule_id_ = schedule_id;
+  cleaning_admitted_ = false;
+  cleaning_state_ = CleaningState::kWaitAdmission;
+  cleaning_timer_id_.store(FleetScheduler::Instance().AddTimer(jitter, [this]() {
+    std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
+    const auto next_delay = OnCleaningTimer();
+    PublishData();
+    return next_delay;
+  }));
+  LOG(INFO) << "[Robot " << robot_id_ << "] 清扫任务已启动 (schedule_id=" << static_cast<int>(schedule_id) << ")";
+}
 
-  cleaning_task_running_.store(true);
-  cleaning_task_thread_ = std::thread(&Robot::CleaningTaskThreadFunc, this, schedule_id);
-  LOG(INFO) << "[Robot " << robot_id_ << "] 清扫任务线程已启动 (schedule_id=" << static_cast<int>(schedule_id) << ")";
+void Robot::ReleaseStartAdmission() {
+  FleetScheduler::Instance().ReleaseSimTime(cleaning_sim_hold_);
+  cleaning_sim_hold_ = 0;
+  if (!cleaning_admitted_) return;
+  cleaning_admitted_ = false;
+  if (auto mgr = mqtt_manager_.lock()) {
+    mgr->GetStartAdmission().Release(robot_id_);
+  }
 }
 
-void Robot::CleaningTaskThreadFunc(uint8_t schedule_id) {
-  LOG(INFO) << "[Robot " << robot_id_ << "] === 清扫任务开始 ===";
+std::chrono::milliseconds Robot::FinishCleaningTask() {
+  ReleaseStartAdmission();
+  cleaning_state_ = CleaningState::kIdle;
+  cleaning_timer_id_.store(0);
+  cleaning_task_running_.store(false);
+  return std::chrono::milliseconds(-1);  // 移除定时器
+}
 
-  // Step 1: 发送F0请求，向平台确认是否允许运行
-  {
-    // 取定时任务信息（若为手动启动则使用默认值）
-    uint8_t weekday = 0, hour = 0, minute = 0, run_count = 0;
-    uint8_t sid = schedule_id;
-    if (sid >= 1 && sid <= 7 && data_.schedule_tasks.size() >= static_cast<size_t>(sid)) {
-      const auto& task = data_.schedule_tasks[sid - 1];
-      weekday   = static_cast<uint8_t>(task.weekday);
-      hour      = static_cast<uint8_t>(task.hour);
-      minute    = static_cast<uint8_t>(task.minute);
-      int rc    = task.run_count;
-      run_count = (rc < 127) ? static_cast<uint8_t>(rc / 2) : static_cast<uint8_t>(rc);
+std::chrono::milliseconds Robot::OnCleaningTimer() {
+  using namespace std::chrono;
+  const auto now = SimClock::Instance().SteadyNow();
+  const uint8_t schedule_id = cleaning_schedule_id_;
+
+  switch (cleaning_state_) {
+    case CleaningState::kIdle:
+      return milliseconds(-1);
+
+    case CleaningState::kWaitAdmission: {
+      // Step 0: 申请启动许可，未获准时按建议延迟重试（轮到本机器人时会被提前唤醒）
+      if (auto mgr = mqtt_manager_.lock()) {
+        milliseconds retry_after(0);
+        // 唤醒函数可能在本机器人 Cancel（甚至析构）之后才被其他机器人调用，只捕获定时器编号：
+        // 编号不会复用，定时器已取消时 WakeTimer 什么也不做
+        const FleetScheduler::TimerId cleaning_timer = cleaning_timer_id_.load();
+        auto wake = [cleaning_timer]() {
+          if (cleaning_timer != 0) FleetScheduler::Instance().WakeTimer(cleaning_timer);
+        };
+        if (!mgr->GetStartAdmission().TryAcquire(robot_id_, wake, &retry_after)) {
+          return retry_after;
+        }
+        cleaning_admitted_ = true;
+      }
+      cleaning_state_ = CleaningState::kSendStartRequest;
+      return milliseconds(0);
     }
 
-    uint64_t token = BeginRequestReplyTracking();
-    SendScheduleStartRequest(sid, weekday, hour, minute, run_count);
-    LOG(INFO) << "[Robot " << robot_id_ << "] F0请求已发送，等待平台响应 (超时30秒)";
-
-    RobotData::RequestReply reply{};
-    bool received = false;
-    WaitForRequestReply(token, 30000, &reply, &received);
-
-    if (!received) {
-      // 超时未收到响应
-      LOG(WARNING) << "[Robot " << robot_id_ << "] F0请求超时，上报E6并结束任务";
-      data_.alarm_fa |= static_cast<uint32_t>(AlarmFA::kAutoRequestTimeout);
-      data_.scheduled_not_run_id     = schedule_id;
-      data_.scheduled_not_run_reason = 0x05;  // 原因：请求超时
-      data_.e6_alarm                 = data_.alarm_fa;
-      SendScheduledNotRunReport();
-      cleaning_task_running_.store(false);
-      return;
-    }
+    case CleaningState::kSendStartRequest: {
+      // Step 1: 发送F0请求，向平台确认是否允许运行
+      LOG(INFO) << "[Robot " << robot_id_ << "] === 清扫任务开始 ===";
+
+      // 取定时任务信息（若为手动启动则使用默认值）
+      uint8_t weekday = 0, hour = 0, minute = 0, run_count = 0;
+      uint8_t sid = schedule_id;
+      if (sid >= 1 && sid <= 7) {
+        const auto& task = data_.schedule_tasks[sid - 1];
+        weekday   = static_cast<uint8_t>(task.weekday);
+        hour      = static_cast<uint8_t>(task.hour);
+        minute    = static_cast<uint8_t>(task.minute);
+        int rc    = task.run_count;
+        run_count = (rc < 127) ? static_cast<uint8_t>(rc / 2) : static_cast<uint8_t>(rc);
+      }
 
-    if (reply.start_flag == 0x00) {
-      // 平台不允许运行
-      LOG(WARNING) << "[Robot " << robot_id_ << "] 平台不允许运行 (start_flag=0)，上报E6并结束任务";
-      data_.alarm_fa |= static_cast<uint32_t>(AlarmFA::kPlatformNotAllowed);
-      data_.scheduled_not_run_id     = schedule_id;
-      data_.scheduled_not_run_reason = 0x01;  // 原因：平台不允许
-      data_.e6_alarm                 = data_.alarm_fa;
-      SendScheduledNotRunReport();
-      cleaning_task_running_.store(false);
-      return;
+      // 先切换状态再发送，避免回复先于状态切换到达。平台回复按真实时间到达，
+      // 截止时间按真实时间计算；离散事件模式下等待期间保持模拟时间不跳跃
+      const auto real_now = steady_clock::now();
+      cleaning_reply_token_ = BeginRequestReplyTracking();
+      cleaning_reply_deadline_ = real_now + seconds(30);
+      cleaning_sim_hold_ = FleetScheduler::Instance().HoldSimTime(cleaning_reply_deadline_);
+      cleaning_state_ = CleaningState::kWaitStartReply;
+      SendScheduleStartRequest(sid, weekday, hour, minute, run_count);
+      LOG(INFO) << "[Robot " << robot_id_ << "] F0请求已发送，等待平台响应 (超时30秒)";
+      return ceil<milliseconds>(SimClock::Instance().ToSimDuration(cleaning_reply_deadline_ - real_now));
     }
 
-    LOG(INFO) << "[Robot " << robot_id_ << "] 平台允许运行 (start_flag=0x"
-              << std::hex << static_cast<int>(reply.start_flag) << ")，开始清扫";
-  }
+    case CleaningState::kWaitStartReply: {
+      RobotData::RequestReply reply{};
+      bool received = false;
+      GetRequestReplyStatus(cleaning_reply_token_, &reply, &received);
 
-  // Step 2: 启动清扫（设置运行状态位）
-  {
-    const uint32_t clear_mask = static_cast<uint32_t>(AlarmFA::kStopped)
-                              | static_cast<uint32_t>(AlarmFA::kForward)
-                              | static_cast<uint32_t>(AlarmFA::kBackward)
-                              | static_cast<uint32_t>(AlarmFA::kAutoCompleted)
-                              | static_cast<uint32_t>(AlarmFA::kAutoFailed)
-                              | static_cast<uint32_t>(AlarmFA::kPlatformNotAllowed)
-                              | static_cast<uint32_t>(AlarmFA::kAutoRequestTimeout);
-    data_.alarm_fa &= ~clear_mask;
-    data_.alarm_fa |= static_cast<uint32_t>(AlarmFA::kAutoRunning)
-                    | static_cast<uint32_t>(AlarmFA::kForward);
-    move_direction_.store(1);
-  }
-
-  // Step 3: 清扫期间定时上报E5电流数据，持续 clean_task_duration_min_ 分钟
-  const int total_duration_s    = clean_task_duration_min_ * 60;
-  const int report_interval_s   = clean_current_report_interval_s_;
-  int elapsed_s                 = 0;
-  int next_report_s             = report_interval_s;  // 首次上报时机
-
-  LOG(INFO) << "[Robot " << robot_id_ << "] 清扫持续时间: " << clean_task_duration_min_
-            << " 分钟, E5上报间隔: " << report_interval_s << " 秒";
-
-  while (elapsed_s < total_duration_s && !stop_report_.load()) {
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    ++elapsed_s;
-
-    if (elapsed_s >= next_report_s) {
-      LOG(INFO) << "[Robot " << robot_id_ << "] 清扫中，发送E5电流数据 (已用时 " << elapsed_s << "s)";
-      SendCurrentDataReport();
-      next_report_s += report_interval_s;
+      const auto real_now = steady_clock::now();
+      if (!received && real_now < cleaning_reply_deadline_) {
+        // 非F0回复事件唤醒（或定时器按模拟时间换算略早触发），继续等待到截止时间
+        return ceil<milliseconds>(SimClock::Instance().ToSimDuration(cleaning_reply_deadline_ - real_now));
+      }
+      // F0请求已结束（收到回复或超时），归还在途名额与模拟时间保持
+      ReleaseStartAdmission();
+
+      if (!received) {
+        // 超时未收到响应
+        LOG(WARNING) << "[Robot " << robot_id_ << "] F0请求超时，上报E6并结束任务";
+        data_.alarm_fa |= static_cast<uint32_t>(AlarmFA::kAutoRequestTimeout);
+        data_.scheduled_not_run_id     = schedule_id;
+        data_.scheduled_not_run_reason = 0x05;  // 原因：请求超时
+        data_.e6_alarm                 = data_.alarm_fa;
+        SendScheduledNotRunReport();
+        return FinishCleaningTask();
+      }
+
+      if (reply.start_flag == 0x00) {
+        // 平台不允许运行
+        LOG(WARNING) << "[Robot " << robot_id_ << "] 平台不允许运行 (start_flag=0)，上报E6并结束任务";
+        data_.alarm_fa |= static_cast<uint32_t>(AlarmFA::kPlatformNotAllowed);
+        data_.scheduled_not_run_id     = schedule_id;
+        data_.scheduled_not_run_reason = 0x01;  // 原因：平台不允许
+        data_.e6_alarm                 = data_.alarm_fa;
+        SendScheduledNotRunReport();
+        return FinishCleaningTask();
+      }
+
+      LOG(INFO) << "[Robot " << robot_id_ << "] 平台允许运行 (start_flag=0x"
+                << std::hex << static_cast<int>(reply.start_flag) << std::dec << ")，开始清扫";
+
+      // Step 2: 启动清扫（设置运行状态位）
+      const uint32_t clear_mask = static_cast<uint32_t>(AlarmFA::kStopped)
+                                | static_cast<uint32_t>(AlarmFA::kForward)
+                                | static_cast<uint32_t>(AlarmFA::kBackward)
+                                | static_cast<uint32_t>(AlarmFA::kAutoCompleted)
+                                | static_cast<uint32_t>(AlarmFA::kAutoFailed)
+                                | static_cast<uint32_t>(AlarmFA::kPlatformNotAllowed)
+                                | static_cast<uint32_t>(AlarmFA::kAutoRequestTimeout);
+      data_.alarm_fa &= ~clear_mask;
+      data_.alarm_fa |= static_cast<uint32_t>(AlarmFA::kAutoRunning)
+                      | static_cast<uint32_t>(AlarmFA::kForward);
+      SetMoveDirection(1);
+
+      // Step 3: 清扫期间定时上报E5电流数据，持续 clean_task_duration_min_ 分钟
+      cleaning_run_start_ = now;
+      cleaning_next_report_s_ = clean_current_report_interval_s_;  // 首次上报时机
+      cleaning_state_ = CleaningState::kRunning;
+      LOG(INFO) << "[Robot " << robot_id_ << "] 清扫持续时间: " << clean_task_duration_min_
+                << " 分钟, E5上报间隔: " << clean_current_report_interval_s_ << " 秒";
+      return seconds(std::min(cleaning_next_report_s_, clean_task_duration_min_ * 60));
     }
-  }
 
-  if (stop_report_.load()) {
-    LOG(INFO) << "[Robot " << robot_id_ << "] 清扫任务因机器人停止而中断";
-    cleaning_task_running_.store(false);
-    return;
-  }
+    case CleaningState::kRunning: {
+      const int total_duration_s = clean_task_duration_min_ * 60;
+      const int elapsed_s = static_cast<int>(duration_cast<seconds>(now - cleaning_run_start_).count());
 
-  // Step 4: 清扫完成，停止运行并上报E9清扫记录
-  LOG(INFO) << "[Robot " << robot_id_ << "] 清扫完成，停止运行并上报E9";
-  {
-    const uint32_t clear_mask = static_cast<uint32_t>(AlarmFA::kAutoRunning)
-                              | static_cast<uint32_t>(AlarmFA::kForward)
-                              | static_cast<uint32_t>(AlarmFA::kBackward);
-    data_.alarm_fa &= ~clear_mask;
-    data_.alarm_fa |= static_cast<uint32_t>(AlarmFA::kAutoCompleted)
-                    | static_cast<uint32_t>(AlarmFA::kStopped);
-    move_direction_.store(0);
-  }
+      if (elapsed_s < total_duration_s) {
+        if (elapsed_s >= cleaning_next_report_s_) {
+          TRACE_HOT(kRobot, 1) << "[Robot " << robot_id_ << "] 清扫中，发送E5电流数据 (已用时 " << elapsed_s << "s)";
+          SendCurrentDataReport();
+          cleaning_next_report_s_ += clean_current_report_interval_s_;
+        }
+        const auto next_s = seconds(std::min(cleaning_next_report_s_, total_duration_s));
+        return duration_cast<milliseconds>(cleaning_run_start_ + next_s - now);
+      }
 
-  // 填写最新一条清扫记录（写入 clean_records[0]，循环覆盖）
-  {
-    UpdateTimeFields();
-    RobotData::CleanRecord record;
-    record.day     = static_cast<uint8_t>(data_.local_time.day);
-    record.hour    = static_cast<uint8_t>(data_.local_time.hour);
-    record.minute  = static_cast<uint8_t>(data_.local_time.minute);
-    record.minutes = static_cast<uint16_t>(clean_task_duration_min_);
-    record.result  = 0x01;  // 成功
-    record.energy  = 0x00;  // 耗电量（暂填0）
-
-    // 向前滚动，最多保留5条
-    if (data_.clean_records.size() < 5) {
-      data_.clean_records.resize(5);
-    }
-    for (int i = 4; i > 0; --i) {
-      data_.clean_records[i] = data_.clean_records[i - 1];
-    }
-    data_.clean_records[0] = record;
-    data_.total_run_count++;
-  }
+      // Step 4: 清扫完成，停止运行并上报E9清扫记录
+      LOG(INFO) << "[Robot " << robot_id_ << "] 清扫完成，停止运行并上报E9";
+      {
+        const uint32_t clear_mask = static_cast<uint32_t>(AlarmFA::kAutoRunning)
+                                  | static_cast<uint32_t>(AlarmFA::kForward)
+                                  | static_cast<uint32_t>(AlarmFA::kBackward);
+        data_.alarm_fa &= ~clear_mask;
+        data_.alarm_fa |= static_cast<uint32_t>(AlarmFA::kAutoCompleted)
+                        | static_cast<uint32_t>(AlarmFA::kStopped);
+        SetMoveDirection(0);
+      }
 
-  SendCleanRecordReport();
-  LOG(INFO) << "[Robot " << robot_id_ << "] === 清扫任务结束 ===";
+      // 填写最新一条清扫记录（写入 clean_records[0]，循环覆盖）
+      {
+        UpdateTimeFields();
+        RobotData::CleanRecord record;
+        record.day     = static_cast<uint8_t>(data_.local_time.day);
+        record.hour    = static_cast<uint8_t>(data_.local_time.hour);
+        record.minute  = static_cast<uint8_t>(data_.local_time.minute);
+        record.minutes = static_cast<uint16_t>(clean_task_duration_min_);
+        record.result  = 0x01;  // 成功
+        record.energy  = 0x00;  // 耗电量（暂填0）
+
+        // 向前滚动，最多保留5条
+        for (int i = 4; i > 0; --i) {
+          data_.clean_records[i] = data_.clean_records[i - 1];
+        }
+        data_.clean_records[0] = record;
+        data_.total_run_count++;
+      }
 
-  cleaning_task_running_.store(false);
+      SendCleanRecordReport();
+      LOG(INFO) << "[Robot " << robot_id_ << "] === 清扫任务结束 ===";
+      return FinishCleaningTask();
+    }
+  }
+  return milliseconds(-1);
 }
 
 void Robot::ControlForward() {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   data_.alarm_fa &= ~static_cast<uint32_t>(AlarmFA::kBackward);
   data_.alarm_fa |= static_cast<uint32_t>(AlarmFA::kAutoRunning)
                   | static_cast<uint32_t>(AlarmFA::kForward);
-  move_direction_.store(1);
+  SetMoveDirection(1);
   LOG(INFO) << "[Robot " << robot_id_ << "] 前进";
 }
 
 void Robot::ControlBackward() {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   data_.alarm_fa &= ~static_cast<uint32_t>(AlarmFA::kForward);
   data_.alarm_fa |= static_cast<uint32_t>(AlarmFA::kAutoRunning)
                   | static_cast<uint32_t>(AlarmFA::kBackward);
-  move_direction_.store(-1);
+  SetMoveDirection(-1);
   LOG(INFO) << "[Robot " << robot_id_ << "] 后退";
 }
 
 void Robot::ControlStop() {
+  std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
   // 清除 Bit2-Bit8（kAutoManual~kBackward）
   const uint32_t clear_mask = static_cast<uint32_t>(AlarmFA::kAutoManual)
                             | static_cast<uint32_t>(AlarmFA::kStartFailed)
@@ -2854,57 +2349,80 @@ void Robot::ControlStop() {
                             | static_cast<uint32_t>(AlarmFA::kBackward);
   data_.alarm_fa &= ~clear_mask;
   data_.alarm_fa |= static_cast<uint32_t>(AlarmFA::kStopped);
-  move_direction_.store(0);
+  SetMoveDirection(0);
   LOG(INFO) << "[Robot " << robot_id_ << "] 停止运行";
 }
 
+std::shared_ptr<const RobotData> Robot::GetDataSnapshot() const {
+  return std::atomic_load_explicit(&published_data_, std::memory_order_acquire);
+}
+
+void Robot::PublishData() {
+  std::lock_guard<std::recursive_mutex> lock(data_mutex_);
+
+  std::shared_ptr<RobotData> next;
+  if (spare_data_ && spare_data_.use_count() == 1) {
+    // 上一个缓冲已无读取方持有，复用其内存
+    std::atomic_thread_fence(std::memory_order_acquire);
+    next = std::move(spare_data_);
+    *next = data_;
+  } else {
+    next = std::make_shared<RobotData>(data_);
+  }
+  std::shared_ptr<const RobotData> prev = std::atomic_exchange_explicit(
+      &published_data_, std::shared_ptr<const RobotData>(next), std::memory_order_acq_rel);
+  spare_data_ = std::const_pointer_cast<RobotData>(prev);
+  data_version_.fetch_add(1, std::memory_order_acq_rel);
+}
+
 std::string Robot::SerializeDataSnapshot() const {
-  // 在序列化前更新时间字段（允许修改内部缓存以保证返回的是最新时间）
-  const_cast<Robot*>(this)->UpdateTimeFields();
+  // 基于已发布的快照序列化，并在副本上刷新时间字段
+  RobotData data = *GetDataSnapshot();
+  FillTimeFields(&data);
 
   nlohmann::json d;
-  d["alarm_fa"] = data_.alarm_fa;
-  d["alarm_fb"] = data_.alarm_fb;
-  d["alarm_fc"] = data_.alarm_fc;
-  d["alarm_fd"] = data_.alarm_fd;
-  d["main_motor_current"] = data_.main_motor_current;
-  d["slave_motor_current"] = data_.slave_motor_current;
-  d["battery_voltage"] = data_.battery_voltage;
-  d["battery_current"] = data_.battery_current;
-  d["battery_status"] = data_.battery_status;
-  d["battery_level"] = data_.battery_level;
-  d["battery_temperature"] = data_.battery_temperature;
-  d["position_info"] = data_.position_info;
-  d["working_duration"] = data_.working_duration;
-  d["total_run_count"] = data_.total_run_count;
-  d["current_lap_count"] = data_.current_lap_count;
-  d["solar_voltage"] = data_.solar_voltage;
-  d["solar_current"] = data_.solar_current;
+  d["alarm_fa"] = data.alarm_fa;
+  d["alarm_fb"] = data.alarm_fb;
+  d["alarm_fc"] = data.alarm_fc;
+  d["alarm_fd"] = data.alarm_fd;
+  d["main_motor_current"] = data.main_motor_current;
+  d["slave_motor_current"] = data.slave_motor_current;
+  d["battery_voltage"] = data.battery_voltage;
+  d["battery_current"] = data.battery_current;
+  d["battery_status"] = data.battery_status;
+  d["battery_level"] = data.battery_level;
+  d["battery_temperature"] = data.battery_temperature;
+  d["position_info"] = data.position_info;
+  d["working_duration"] = data.working_duration;
+  d["total_run_count"] = data.total_run_count;
+  d["current_lap_count"] = data.current_lap_count;
+  d["solar_voltage"] = data.solar_voltage;
+  d["solar_current"] = data.solar_current;
 
   // timestamp
   d["current_timestamp"] = {
-    {"hour", data_.current_timestamp.hour},
-    {"minute", data_.current_timestamp.minute},
-    {"second", data_.current_timestamp.second}
+    {"hour", data.current_timestamp.hour},
+    {"minute", data.current_timestamp.minute},
+    {"second", data.current_timestamp.second}
   };
 
-  d["board_temperature"] = data_.board_temperature;
+  d["board_temperature"] = data.board_temperature;
 
   // 配置参数
   d["lora_params"] = {
-    {"power", data_.lora_params.power},
-    {"frequency", data_.lora_params.frequency},
-    {"rate", data_.lora_params.rate}
+    {"power", data.lora_params.power},
+    {"frequency", data.lora_params.frequency},
+    {"rate", data.lora_params.rate}
   };
 
-  d["robot_number"] = data_.robot_number;
-  d["software_version"] = data_.software_version;
-  d["parking_position"] = data_.parking_position;
-  d["daytime_scan_protect"] = data_.daytime_scan_protect;
+  d["robot_number"] = std::to_string(data.robot_number);
+  d["software_version"] = data.software_version;
+  d["parking_position"] = data.parking_position;
+  d["daytime_scan_protect"] = data.daytime_scan_protect;
 
   // schedule tasks
   nlohmann::json tasks = nlohmann::json::array();
-  for (const auto& t : data_.schedule_tasks) {
+  for (const auto& t : data.schedule_tasks) {
     tasks.push_back({
       {"weekday", t.weekday}, {"hour", t.hour}, {"minute", t.minute}, {"run_count", t.run_count}
     });
@@ -2913,7 +2431,7 @@ std::string Robot::SerializeDataSnapshot() const {
 
   // 清扫记录序列化
   nlohmann::json clean_arr = nlohmann::json::array();
-  for (const auto& r : data_.clean_records) {
+  for (const auto& r : data.clean_records) {
     clean_arr.push_back({
       {"day", r.day}, {"hour", r.hour}, {"minute", r.minute},
       {"minutes", r.minutes}, {"result", r.result}, {"energy", r.energy}
@@ -2921,78 +2439,78 @@ std::string Robot::SerializeDataSnapshot() const {
   }
   d["clean_records"] = clean_arr;
 
-  d["enabled"] = data_.enabled;
+  d["enabled"] = data.enabled;
 
   // 电机参数
   d["motor_params"] = {
-    {"walk_motor_speed", data_.motor_params.walk_motor_speed},
-    {"brush_motor_speed", data_.motor_params.brush_motor_speed},
-    {"windproof_motor_speed", data_.motor_params.windproof_motor_speed},
-    {"walk_motor_max_current_ma", data_.motor_params.walk_motor_max_current_ma},
-    {"brush_motor_max_current_ma", data_.motor_params.brush_motor_max_current_ma},
-    {"windproof_motor_max_current_ma", data_.motor_params.windproof_motor_max_current_ma},
-    {"walk_motor_warning_current_ma", data_.motor_params.walk_motor_warning_current_ma},
-    {"brush_motor_warning_current_ma", data_.motor_params.brush_motor_warning_current_ma},
-    {"windproof_motor_warning_current_ma", data_.motor_params.windproof_motor_warning_current_ma},
-    {"walk_motor_mileage_m", data_.motor_params.walk_motor_mileage_m},
-    {"brush_motor_timeout_s", data_.motor_params.brush_motor_timeout_s},
-    {"windproof_motor_timeout_s", data_.motor_params.windproof_motor_timeout_s},
-    {"reverse_time_s", data_.motor_params.reverse_time_s},
-    {"protection_angle", data_.motor_params.protection_angle}
+    {"walk_motor_speed", data.motor_params.walk_motor_speed},
+    {"brush_motor_speed", data.motor_params.brush_motor_speed},
+    {"windproof_motor_speed", data.motor_params.windproof_motor_speed},
+    {"walk_motor_max_current_ma", data.motor_params.walk_motor_max_current_ma},
+    {"brush_motor_max_current_ma", data.motor_params.brush_motor_max_current_ma},
+    {"windproof_motor_max_current_ma", data.motor_params.windproof_motor_max_current_ma},
+    {"walk_motor_warning_current_ma", data.motor_params.walk_motor_warning_current_ma},
+    {"brush_motor_warning_current_ma", data.motor_params.brush_motor_warning_current_ma},
+    {"windproof_motor_warning_current_ma", data.motor_params.windproof_motor_warning_current_ma},
+    {"walk_motor_mileage_m", data.motor_params.walk_motor_mileage_m},
+    {"brush_motor_timeout_s", data.motor_params.brush_motor_timeout_s},
+    {"windproof_motor_timeout_s", data.motor_params.windproof_motor_timeout_s},
+    {"reverse_time_s", data.motor_params.reverse_time_s},
+    {"protection_angle", data.motor_params.protection_angle}
   };
 
   // 保护参数
   d["temp_voltage_protection"] = {
-    {"protection_current_ma", data_.temp_voltage_protection.protection_current_ma},
-    {"high_temp_threshold", data_.temp_voltage_protection.high_temp_threshold},
-    {"low_temp_threshold", data_.temp_voltage_protection.low_temp_threshold},
-    {"protection_temp", data_.temp_voltage_protection.protection_temp},
-    {"recovery_temp", data_.temp_voltage_protection.recovery_temp},
-    {"protection_voltage", data_.temp_voltage_protection.protection_voltage},
-    {"recovery_voltage", data_.temp_voltage_protection.recovery_voltage},
-    {"protection_battery_level", data_.temp_voltage_protection.protection_battery_level},
-    {"limit_run_battery_level", data_.temp_voltage_protection.limit_run_battery_level},
-    {"recovery_battery_level", data_.temp_voltage_protection.recovery_battery_level},
-    {"board_protection_temp", data_.temp_voltage_protection.board_protection_temp},
-    {"board_recovery_temp", data_.temp_voltage_protection.board_recovery_temp}
+    {"protection_current_ma", data.temp_voltage_protection.protection_current_ma},
+    {"high_temp_threshold", data.temp_voltage_protection.high_temp_threshold},
+    {"low_temp_threshold", data.temp_voltage_protection.low_temp_threshold},
+    {"protection_temp", data.temp_voltage_protection.protection_temp},
+    {"recovery_temp", data.temp_voltage_protection.recovery_temp},
+    {"protection_voltage", data.temp_voltage_protection.protection_voltage},
+    {"recovery_voltage", data.temp_voltage_protection.recovery_voltage},
+    {"protection_battery_level", data.temp_voltage_protection.protection_battery_level},
+    {"limit_run_battery_level", data.temp_voltage_protection.limit_run_battery_level},
+    {"recovery_battery_level", data.temp_voltage_protection.recovery_battery_level},
+    {"board_protection_temp", data.temp_voltage_protection.board_protection_temp},
+    {"board_recovery_temp", data.temp_voltage_protection.board_recovery_temp}
   };
 
   // 本地时间
   d["local_time"] = {
-    {"year", data_.local_time.year}, {"month", data_.local_time.month}, {"day", data_.local_time.day},
-    {"hour", data_.local_time.hour}, {"minute", data_.local_time.minute}, {"second", data_.local_time.second},
-    {"weekday", data_.local_time.weekday}
+    {"year", data.local_time.year}, {"month", data.local_time.month}, {"day", data.local_time.day},
+    {"hour", data.local_time.hour}, {"minute", data.local_time.minute}, {"second", data.local_time.second},
+    {"weekday", data.local_time.weekday}
   };
 
   // 环境信息
   d["environment_info"] = {
-    {"sensor_temperature", data_.environment_info.sensor_temperature},
-    {"sensor_humidity", data_.environment_info.sensor_humidity},
-    {"ambient_temperature", data_.environment_info.ambient_temperature},
-    {"day_night_status", data_.environment_info.day_night_status}
+    {"sensor_temperature", data.environment_info.sensor_temperature},
+    {"sensor_humidity", data.environment_info.sensor_humidity},
+    {"ambient_temperature", data.environment_info.ambient_temperature},
+    {"day_night_status", data.environment_info.day_night_status}
   };
 
   // 数组数据
-  d["master_currents"] = data_.master_currents;
-  d["slave_currents"] = data_.slave_currents;
-  d["position"] = data_.position;
-  d["direction"] = data_.direction;
+  d["master_currents"] = data.master_currents;
+  d["slave_currents"] = data.slave_currents;
+  d["position"] = data.position;
+  d["direction"] = data.direction;
 
   // 设备标识
-  d["module_eui"] = data_.module_eui;
-  d["domestic_foreign_flag"] = data_.domestic_foreign_flag;
-  d["country_code"] = data_.country_code;
-  d["region_code"] = data_.region_code;
-  d["project_code"] = data_.project_code;
-
-  d["board_humidity"] = data_.board_humidity;
-  d["scheduled_not_run_id"]     = data_.scheduled_not_run_id;
-  d["scheduled_not_run_reason"] = data_.scheduled_not_run_reason;
-  d["e6_alarm"]                  = data_.e6_alarm;
-  d["not_started_reason"]       = data_.not_started_reason;
-  d["e7_alarm"]                  = data_.e7_alarm;
-  d["startup_confirm_id"]        = data_.startup_confirm_id;
-  d["e8_alarm"]                  = data_.e8_alarm;
+  d["module_eui"] = data.module_eui;
+  d["domestic_foreign_flag"] = data.domestic_foreign_flag;
+  d["country_code"] = data.country_code;
+  d["region_code"] = data.region_code;
+  d["project_code"] = data.project_code;
+
+  d["board_humidity"] = data.board_humidity;
+  d["scheduled_not_run_id"]     = data.scheduled_not_run_id;
+  d["scheduled_not_run_reason"] = data.scheduled_not_run_reason;
+  d["e6_alarm"]                  = data.e6_alarm;
+  d["not_started_reason"]       = data.not_started_reason;
+  d["e7_alarm"]                  = data.e7_alarm;
+  d["startup_confirm_id"]        = data.startup_confirm_id;
+  d["e8_alarm"]                  = data.e8_alarm;
 
   return d.dump();
 }
@@ -3005,6 +2523,7 @@ bool Robot::LoadDataSnapshot(const std::string& data_json) {
   try {
     nlohmann::json d = nlohmann::json::parse(data_json);
 
+    std::lock_guard<std::recursive_mutex> data_lock(data_mutex_);
     data_.alarm_fa = d.value("alarm_fa", data_.alarm_fa);
     data_.alarm_fb = d.value("alarm_fb", data_.alarm_fb);
     data_.alarm_fc = d.value("alarm_fc", data_.alarm_fc);
@@ -3038,35 +2557,49 @@ bool Robot::LoadDataSnapshot(const std::string& data_json) {
       data_.lora_params.rate = lora.value("rate", data_.lora_params.rate);
     }
 
-    data_.robot_number = d.value("robot_number", data_.robot_number);
+    // 快照中机器人序号以字符串保存（兼容旧版本）
+    if (d.contains("robot_number")) {
+      const auto& rn = d["robot_number"];
+      if (rn.is_number_unsigned()) {
+        data_.robot_number = rn.get<uint16_t>();
+      } else if (rn.is_string()) {
+        try {
+          data_.robot_number = static_cast<uint16_t>(std::stoul(rn.get<std::string>()));
+        } catch (...) {
+          data_.robot_number = 0;
+        }
+      }
+    }
     data_.software_version = d.value("software_version", data_.software_version);
     data_.parking_position = d.value("parking_position", data_.parking_position);
     data_.daytime_scan_protect = d.value("daytime_scan_protect", data_.daytime_scan_protect);
     data_.enabled = d.value("enabled", data_.enabled);
 
     if (d.contains("schedule_tasks") && d["schedule_tasks"].is_array()) {
-      data_.schedule_tasks.clear();
-      for (const auto& item : d["schedule_tasks"]) {
-        ScheduleTask task;
+      const auto& arr = d["schedule_tasks"];
+      data_.schedule_tasks = ScheduleTaskList{};
+      for (size_t i = 0; i < data_.schedule_tasks.size() && i < arr.size(); ++i) {
+        const auto& item = arr[i];
+        ScheduleTask& task = data_.schedule_tasks[i];
         task.weekday = item.value("weekday", 0);
         task.hour = item.value("hour", 0);
         task.minute = item.value("minute", 0);
         task.run_count = item.value("run_count", 0);
-        data_.schedule_tasks.push_back(task);
       }
     }
 
     if (d.contains("clean_records") && d["clean_records"].is_array()) {
-      data_.clean_records.clear();
-      for (const auto& item : d["clean_records"]) {
-        RobotData::CleanRecord record;
+      const auto& arr = d["clean_records"];
+      data_.clean_records.fill(RobotData::CleanRecord{});
+      for (size_t i = 0; i < data_.clean_records.size() && i < arr.size(); ++i) {
+        const auto& item = arr[i];
+        RobotData::CleanRecord& record = data_.clean_records[i];
         record.day = static_cast<uint8_t>(item.value("day", 0));
         record.hour = static_cast<uint8_t>(item.value("hour", 0));
         record.minute = static_cast<uint8_t>(item.value("minute", 0));
         record.minutes = static_cast<uint16_t>(item.value("minutes", 0));
         record.result = static_cast<uint8_t>(item.value("result", 0));
         record.energy = static_cast<uint8_t>(item.value("energy", 0));
-        data_.clean_records.push_back(record);
       }
     }
 
@@ -3124,16 +2657,18 @@ bool Robot::LoadDataSnapshot(const std::string& data_json) {
     }
 
     if (d.contains("master_currents") && d["master_currents"].is_array()) {
-      data_.master_currents.clear();
-      for (const auto& value : d["master_currents"]) {
-        data_.master_currents.push_back(value.get<int>());
+      const auto& arr = d["master_currents"];
+      data_.master_currents.fill(0);
+      for (size_t i = 0; i < data_.master_currents.size() && i < arr.size(); ++i) {
+        data_.master_currents[i] = arr[i].get<int>();
       }
     }
 
     if (d.contains("slave_currents") && d["slave_currents"].is_array()) {
-      data_.slave_currents.clear();
-      for (const auto& value : d["slave_currents"]) {
-        data_.slave_currents.push_back(value.get<int>());
+      const auto& arr = d["slave_currents"];
+      data_.slave_currents.fill(0);
+      for (size_t i = 0; i < data_.slave_currents.size() && i < arr.size(); ++i) {
+        data_.slave_currents[i] = arr[i].get<int>();
       }
     }
 
@@ -3152,6 +2687,7 @@ bool Robot::LoadDataSnapshot(const std::string& data_json) {
     data_.e7_alarm                  = d.value("e7_alarm",                  data_.e7_alarm);
     data_.startup_confirm_id        = d.value("startup_confirm_id",        data_.startup_confirm_id);
     data_.e8_alarm                  = d.value("e8_alarm",                  data_.e8_alarm);
+    PublishData();
 
     return true;
   } catch (const std::exception& e) {
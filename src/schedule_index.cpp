@@ -0,0 +1,81 @@
+#include "schedule_index.h"
+
+#include <algorithm>
+
+void ScheduleIndex::Update(const std::string& robot_id, const ScheduleTaskList& tasks) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RemoveLocked(robot_id);
+
+  std::vector<int> keys;
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    const auto& task = tasks[i];
+    // 与逐分钟匹配规则一致：weekday 0 表示每天，否则须等于 tm_wday（1~6 才可能命中）
+    if (task.run_count <= 0 || task.weekday < 0 || task.weekday > 6 ||
+        task.hour < 0 || task.hour > 23 || task.minute < 0 || task.minute > 59) {
+      continue;
+    }
+    const int key = task.weekday * kMinutesPerDay + task.hour * 60 + task.minute;
+    buckets_[key].push_back(Entry{robot_id, static_cast<uint8_t>(i + 1), task.weekday});
+    if (std::find(keys.begin(), keys.end(), key) == keys.end()) keys.push_back(key);
+    ++entry_count_;
+  }
+  if (!keys.empty()) {
+    robot_buckets_[robot_id] = std::move(keys);
+  }
+}
+
+void ScheduleIndex::Remove(const std::string& robot_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RemoveLocked(robot_id);
+}
+
+void ScheduleIndex::RemoveLocked(const std::string& robot_id) {
+  auto it = robot_buckets_.find(robot_id);
+  if (it == robot_buckets_.end()) return;
+  for (int key : it->second) {
+    auto bucket = buckets_.find(key);
+    if (bucket == buckets_.end()) continue;
+    auto& entries = bucket->second;
+    const size_t before = entries.size();
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [&](const Entry& e) { return e.robot_id == robot_id; }),
+                  entries.end());
+    entry_count_ -= before - entries.size();
+    if (entries.empty()) buckets_.erase(bucket);
+  }
+  robot_buckets_.erase(it);
+}
+
+std::vector<ScheduleIndex::Match> ScheduleIndex::Find(int weekday, int hour, int minute) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const int minute_of_day = hour * 60 + minute;
+
+  std::unordered_map<std::string, size_t> robot_pos;  // 机器人 -> result 下标
+  std::vector<Match> result;
+  auto collect = [&](int key) {
+    auto bucket = buckets_.find(key);
+    if (bucket == buckets_.end()) return;
+    for (const auto& e : bucket->second) {
+      auto it = robot_pos.find(e.robot_id);
+      if (it == robot_pos.end()) {
+        robot_pos.emplace(e.robot_id, result.size());
+        result.push_back(Match{e.robot_id, e.schedule_id, e.weekday});
+      } else if (e.schedule_id < result[it->second].schedule_id) {
+        // 同一时刻只触发编号最小（第一个匹配）的定时任务
+        result[it->second].schedule_id = e.schedule_id;
+        result[it->second].weekday = e.weekday;
+      }
+    }
+  };
+
+  collect(minute_of_day);
+  if (weekday != 0) {
+    collect(weekday * kMinutesPerDay + minute_of_day);
+  }
+  return result;
+}
+
+size_t ScheduleIndex::GetEntryCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entry_count_;
+}
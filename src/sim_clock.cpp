@@ -0,0 +1,88 @@
+#include "sim_clock.h"
+
+SimClock& SimClock::Instance() {
+  static SimClock instance;
+  return instance;
+}
+
+SimClock::SimClock()
+    : real_base_(std::chrono::steady_clock::now()),
+      wall_base_(std::chrono::system_clock::now()) {}
+
+void SimClock::Configure(Mode mode, double speed) {
+  mode_ = mode;
+  speed_ = (mode == Mode::kAccelerated && speed > 0.0) ? speed : 1.0;
+  real_base_ = std::chrono::steady_clock::now();
+  wall_base_ = std::chrono::system_clock::now();
+  discrete_elapsed_ns_.store(0);
+}
+
+bool SimClock::ParseMode(const std::string& name, Mode* mode) {
+  if (name == "realtime") {
+    *mode = Mode::kRealtime;
+  } else if (name == "accelerated") {
+    *mode = Mode::kAccelerated;
+  } else if (name == "discrete") {
+    *mode = Mode::kDiscreteEvent;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* SimClock::ModeName(Mode mode) {
+  switch (mode) {
+    case Mode::kRealtime:      return "realtime";
+    case Mode::kAccelerated:   return "accelerated";
+    case Mode::kDiscreteEvent: return "discrete";
+  }
+  return "unknown";
+}
+
+std::chrono::steady_clock::time_point SimClock::SteadyNow() const {
+  using namespace std::chrono;
+  switch (mode_) {
+    case Mode::kRealtime:
+      return steady_clock::now();
+    case Mode::kAccelerated:
+      return real_base_ + duration_cast<steady_clock::duration>(
+                              (steady_clock::now() - real_base_) * speed_);
+    case Mode::kDiscreteEvent:
+      return real_base_ + nanoseconds(discrete_elapsed_ns_.load());
+  }
+  return steady_clock::now();
+}
+
+std::chrono::system_clock::time_point SimClock::SystemNow() const {
+  using namespace std::chrono;
+  if (mode_ == Mode::kRealtime) return system_clock::now();
+  return wall_base_ + duration_cast<system_clock::duration>(SteadyNow() - real_base_);
+}
+
+std::chrono::steady_clock::time_point SimClock::ToRealDeadline(
+    std::chrono::steady_clock::time_point sim_time) const {
+  using namespace std::chrono;
+  switch (mode_) {
+    case Mode::kRealtime:
+      return sim_time;
+    case Mode::kAccelerated:
+      return real_base_ + duration_cast<steady_clock::duration>((sim_time - real_base_) / speed_);
+    case Mode::kDiscreteEvent:
+      return steady_clock::now();
+  }
+  return sim_time;
+}
+
+std::chrono::steady_clock::duration SimClock::ToSimDuration(
+    std::chrono::steady_clock::duration real) const {
+  if (mode_ != Mode::kAccelerated) return real;
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(real * speed_);
+}
+
+void SimClock::AdvanceTo(std::chrono::steady_clock::time_point sim_time) {
+  const int64_t target = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             sim_time - real_base_).count();
+  int64_t current = discrete_elapsed_ns_.load();
+  while (target > current && !discrete_elapsed_ns_.compare_exchange_weak(current, target)) {
+  }
+}
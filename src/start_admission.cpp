@@ -0,0 +1,162 @@
+#include "start_admission.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "sim_clock.h"
+#include "sim_rng.h"
+
+constexpr std::array<int64_t, 5> StartAdmission::kDelayBucketsMs;
+
+namespace {
+// 排队中且无法预知放行时刻时的兜底重试间隔：成为队首或在途名额归还时由 wake 唤醒，
+// 兜底间隔只防止唤醒丢失，不参与正常放行，因此取得较长
+constexpr std::chrono::milliseconds kWaitFallbackInterval{30000};
+}  // namespace
+
+void StartAdmission::SetConfig(const Config& config) {
+  std::function<void()> wake;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    config_.max_inflight = std::max(config_.max_inflight, 0);
+    config_.rate_per_second = std::max(config_.rate_per_second, 0);
+    config_.jitter_max_ms = std::max(config_.jitter_max_ms, 0);
+    tokens_ = std::min(tokens_, static_cast<double>(std::max(config_.rate_per_second, 1)));
+    wake = HeadWakeLocked();
+  }
+  // 放宽限制后让队首立即重试
+  if (wake) wake();
+}
+
+StartAdmission::Config StartAdmission::GetConfig() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return config_;
+}
+
+void StartAdmission::RefillLocked(std::chrono::steady_clock::time_point now) {
+  if (config_.rate_per_second <= 0) return;
+  if (last_refill_.time_since_epoch().count() == 0) {
+    tokens_ = 1.0;
+  } else {
+    const double elapsed_s = std::chrono::duration<double>(now - last_refill_).count();
+    // 桶容量为1秒的配额（至少1个），允许小幅突发
+    tokens_ = std::min(tokens_ + elapsed_s * config_.rate_per_second,
+                       static_cast<double>(std::max(config_.rate_per_second, 1)));
+  }
+  last_refill_ = now;
+}
+
+std::function<void()> StartAdmission::HeadWakeLocked() const {
+  if (waiting_.empty()) return nullptr;
+  return waiting_.front().wake;
+}
+
+bool StartAdmission::TryAcquire(const std::string& robot_id, std::function<void()> wake,
+                                std::chrono::milliseconds* retry_after) {
+  using namespace std::chrono;
+  std::function<void()> next_wake;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto now = SimClock::Instance().SteadyNow();
+    RefillLocked(now);
+
+    auto index_it = waiter_index_.find(robot_id);
+    if (index_it == waiter_index_.end()) {
+      waiting_.push_back(Waiter{robot_id, now, std::move(wake)});
+      index_it = waiter_index_.emplace(robot_id, std::prev(waiting_.end())).first;
+    } else {
+      index_it->second->wake = std::move(wake);
+    }
+    auto it = index_it->second;
+
+    // 严格按到达顺序放行
+    if (it != waiting_.begin()) {
+      *retry_after = kWaitFallbackInterval;
+      return false;
+    }
+    if (config_.max_inflight > 0 &&
+        inflight_.size() >= static_cast<size_t>(config_.max_inflight)) {
+      *retry_after = kWaitFallbackInterval;
+      return false;
+    }
+    if (config_.rate_per_second > 0) {
+      if (tokens_ < 1.0) {
+        const double wait_s = (1.0 - tokens_) / config_.rate_per_second;
+        *retry_after = milliseconds(static_cast<int64_t>(std::ceil(wait_s * 1000.0)));
+        return false;
+      }
+      tokens_ -= 1.0;
+    }
+
+    // 获准：记录排队延迟
+    const int64_t delay_ms = duration_cast<milliseconds>(now - it->enqueue_time).count();
+    waiting_.pop_front();
+    waiter_index_.erase(index_it);
+    inflight_.insert(robot_id);
+    ++metrics_.admitted;
+    if (delay_ms > 0) ++metrics_.delayed;
+    total_delay_ms_ += static_cast<double>(delay_ms);
+    metrics_.max_delay_ms = std::max(metrics_.max_delay_ms, delay_ms);
+    metrics_.last_delay_ms = delay_ms;
+    size_t bucket = 0;
+    while (bucket < kDelayBucketsMs.size() && delay_ms > kDelayBucketsMs[bucket]) ++bucket;
+    ++metrics_.delay_histogram[bucket];
+
+    next_wake = HeadWakeLocked();
+  }
+  // 新的队首可能可以立即放行
+  if (next_wake) next_wake();
+  return true;
+}
+
+void StartAdmission::Release(const std::string& robot_id) {
+  std::function<void()> wake;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (inflight_.erase(robot_id) == 0) return;
+    wake = HeadWakeLocked();
+  }
+  if (wake) wake();
+}
+
+void StartAdmission::Cancel(const std::string& robot_id) {
+  std::function<void()> wake;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool changed = inflight_.erase(robot_id) > 0;
+    auto it = waiter_index_.find(robot_id);
+    if (it != waiter_index_.end()) {
+      waiting_.erase(it->second);
+      waiter_index_.erase(it);
+      ++metrics_.cancelled;
+      changed = true;
+    }
+    if (!changed) return;
+    wake = HeadWakeLocked();
+  }
+  if (wake) wake();
+}
+
+std::chrono::milliseconds StartAdmission::JitterFor(uint32_t serial, uint8_t schedule_id) const {
+  int jitter_max_ms;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jitter_max_ms = config_.jitter_max_ms;
+  }
+  if (jitter_max_ms <= 0) return std::chrono::milliseconds(0);
+  const SimRng::Block r = SimRng::Generate(SimRng::GetGlobalSeed(), serial, schedule_id,
+                                           SimRng::kStartJitter);
+  return std::chrono::milliseconds(
+      SimRng::ToRange(r[0], static_cast<uint32_t>(jitter_max_ms) + 1));
+}
+
+StartAdmission::Metrics StartAdmission::GetMetrics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Metrics m = metrics_;
+  m.waiting = waiting_.size();
+  m.inflight = inflight_.size();
+  m.avg_delay_ms = m.admitted > 0 ? total_delay_ms_ / static_cast<double>(m.admitted) : 0.0;
+  return m;
+}
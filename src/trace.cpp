@@ -0,0 +1,86 @@
+#include "trace.h"
+
+#include <sstream>
+
+std::atomic<int> Trace::levels_[static_cast<int>(TraceModule::kCount)] = {
+    {kDefaultLevel}, {kDefaultLevel}, {kDefaultLevel}, {kDefaultLevel}};
+
+static const char* const kModuleNames[] = {"protocol", "robot", "mqtt", "http"};
+static_assert(sizeof(kModuleNames) / sizeof(kModuleNames[0]) ==
+                  static_cast<size_t>(TraceModule::kCount),
+              "每个追踪模块都需要名称");
+
+int Trace::GetLevel(TraceModule module) {
+  return levels_[static_cast<int>(module)].load(std::memory_order_relaxed);
+}
+
+void Trace::SetLevel(TraceModule module, int level) {
+  levels_[static_cast<int>(module)].store(level, std::memory_order_relaxed);
+}
+
+const char* Trace::ModuleName(TraceModule module) {
+  return kModuleNames[static_cast<int>(module)];
+}
+
+bool Trace::ParseModule(const std::string& name, TraceModule* module) {
+  for (int i = 0; i < static_cast<int>(TraceModule::kCount); ++i) {
+    if (name == kModuleNames[i]) {
+      *module = static_cast<TraceModule>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Trace::Configure(const std::string& spec) {
+  // 先完整解析，全部合法后再生效
+  int levels[static_cast<int>(TraceModule::kCount)];
+  for (int i = 0; i < static_cast<int>(TraceModule::kCount); ++i) {
+    levels[i] = GetLevel(static_cast<TraceModule>(i));
+  }
+
+  std::istringstream iss(spec);
+  std::string item;
+  while (std::getline(iss, item, ',')) {
+    if (item.empty()) continue;
+    const size_t eq = item.find('=');
+    if (eq == std::string::npos) return false;
+    TraceModule module;
+    if (!ParseModule(item.substr(0, eq), &module)) return false;
+    const std::string value = item.substr(eq + 1);
+    if (value.size() != 1 || value[0] < '0' || value[0] > '0' + kDetail) return false;
+    levels[static_cast<int>(module)] = value[0] - '0';
+  }
+
+  for (int i = 0; i < static_cast<int>(TraceModule::kCount); ++i) {
+    SetLevel(static_cast<TraceModule>(i), levels[i]);
+  }
+  return true;
+}
+
+std::string Trace::ToString() {
+  std::string result;
+  for (int i = 0; i < static_cast<int>(TraceModule::kCount); ++i) {
+    if (i > 0) result += ',';
+    result += kModuleNames[i];
+    result += '=';
+    result += std::to_string(GetLevel(static_cast<TraceModule>(i)));
+  }
+  return result;
+}
+
+std::ostream& operator<<(std::ostream& os, const HexDump& dump) {
+  static const char kDigits[] = "0123456789ABCDEF";
+  char hex[3] = {' ', 0, 0};
+  for (size_t i = 0; i < dump.size_; ++i) {
+    hex[1] = kDigits[dump.data_[i] >> 4];
+    hex[2] = kDigits[dump.data_[i] & 0x0F];
+    // 首字节前不加空格
+    if (i == 0) {
+      os.write(hex + 1, 2);
+    } else {
+      os.write(hex, 3);
+    }
+  }
+  return os;
+}
@@ -0,0 +1,275 @@
+#include "uplink_template.h"
+
+#include <glog/logging.h>
+
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+struct Placeholder {
+  const char* name;
+  size_t size;
+};
+
+#define PLACEHOLDER(text) {text, sizeof(text) - 1}
+
+// 下标与 UplinkTemplate::SegmentType 一致（kLiteral 无占位符）
+constexpr Placeholder kPlaceholders[] = {
+    {nullptr, 0},
+    PLACEHOLDER("{{DEV_EUI}}"),
+    PLACEHOLDER("{{DEV_ADDR}}"),
+    PLACEHOLDER("{{DATA}}"),
+    PLACEHOLDER("{{DEDUPLICATION_ID}}"),
+    PLACEHOLDER("{{TIME}}"),
+    PLACEHOLDER("{{GW_TIME}}"),
+    PLACEHOLDER("{{NS_TIME}}"),
+    PLACEHOLDER("{{GPS_TIME}}"),
+    PLACEHOLDER("{{FCNT}}"),
+    PLACEHOLDER("{{RSSI}}"),
+    PLACEHOLDER("{{SNR}}"),
+};
+
+#undef PLACEHOLDER
+
+// GPS 纪元（1980-01-06）与 Unix 纪元相差的秒数，以及当前的闰秒数
+constexpr int64_t kGpsEpochOffset = 315964800;
+constexpr int64_t kGpsLeapSeconds = 18;
+
+// 按秒缓存的 "YYYY-MM-DDTHH:MM:SS"（UTC），同一秒内的消息只需拼接小数部分
+const char* FormatSecond(int64_t second) {
+  struct Cache {
+    int64_t second = INT64_MIN;
+    char text[24];
+  };
+  thread_local Cache cache;
+  if (cache.second != second) {
+    const time_t t = static_cast<time_t>(second);
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    strftime(cache.text, sizeof(cache.text), "%Y-%m-%dT%H:%M:%S", &tm);
+    cache.second = second;
+  }
+  return cache.text;
+}
+
+// 定宽十进制（左侧补零）
+char* WriteFixed(char* p, uint64_t value, int width) {
+  for (int i = width - 1; i >= 0; --i) {
+    p[i] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  return p + width;
+}
+
+char* WriteInt(char* p, char* end, int64_t value) {
+  return std::to_chars(p, end, value).ptr;
+}
+
+// ISO-8601 时间：<秒>.<digits 位小数>+00:00
+char* WriteIsoTime(char* p, int64_t ns, int digits) {
+  int64_t second = ns / 1000000000;
+  int64_t fraction = ns % 1000000000;
+  if (fraction < 0) {
+    fraction += 1000000000;
+    --second;
+  }
+  std::memcpy(p, FormatSecond(second), 19);
+  p += 19;
+  *p++ = '.';
+  int64_t scale = 1;
+  for (int i = digits; i < 9; ++i) scale *= 10;
+  p = WriteFixed(p, static_cast<uint64_t>(fraction / scale), digits);
+  std::memcpy(p, "+00:00", 6);
+  return p + 6;
+}
+
+}  // namespace
+
+void UplinkFields::FormatId(char* out) const {
+  static const char kDigits[] = "0123456789abcdef";
+  // 第 i 个字节的两位十六进制在文本中的位置（第 8/13/18/23 位为 '-'）
+  static const uint8_t kOffsets[16] = {0, 2, 4, 6, 9, 11, 14, 16, 19, 21, 24, 26, 28, 30, 32, 34};
+  for (int i = 0; i < 16; ++i) {
+    uint8_t byte = static_cast<uint8_t>(id[i / 4] >> (24 - 8 * (i % 4)));
+    if (i == 6) byte = static_cast<uint8_t>((byte & 0x0F) | 0x40);  // 版本 4
+    if (i == 8) byte = static_cast<uint8_t>((byte & 0x3F) | 0x80);  // RFC 4122 变体
+    out[kOffsets[i]] = kDigits[byte >> 4];
+    out[kOffsets[i] + 1] = kDigits[byte & 0x0F];
+  }
+  out[8] = out[13] = out[18] = out[23] = '-';
+}
+
+int64_t UplinkFields::GpsTimeNs() const {
+  return TimeNs() - (kGpsEpochOffset - kGpsLeapSeconds) * 1000000000;
+}
+
+bool UplinkTemplate::Parse(const std::string& source) {
+  segments_.clear();
+  if (source.empty()) return false;
+
+  bool has_data = false;
+  size_t literal_start = 0;
+  size_t pos = source.find("{{");
+  while (pos != std::string::npos) {
+    SegmentType type = SegmentType::kLiteral;
+    for (int i = 1; i < static_cast<int>(SegmentType::kCount); ++i) {
+      const Placeholder& placeholder = kPlaceholders[i];
+      if (source.compare(pos, placeholder.size, placeholder.name, placeholder.size) == 0) {
+        type = static_cast<SegmentType>(i);
+        break;
+      }
+    }
+    if (type == SegmentType::kData) {
+      if (has_data) type = SegmentType::kLiteral;
+      has_data = true;
+    }
+
+    if (type == SegmentType::kLiteral) {
+      pos = source.find("{{", pos + 2);
+      continue;
+    }
+    if (pos > literal_start) {
+      segments_.push_back({SegmentType::kLiteral, source.substr(literal_start, pos - literal_start)});
+    }
+    segments_.push_back({type, std::string()});
+    literal_start = pos + kPlaceholders[static_cast<int>(type)].size;
+    pos = source.find("{{", literal_start);
+  }
+  if (literal_start < source.size()) {
+    segments_.push_back({SegmentType::kLiteral, source.substr(literal_start)});
+  }
+
+  if (!has_data) {
+    LOG(WARNING) << "上行数据模板中没有 {{DATA}} 占位符，上行消息将不包含帧数据";
+  }
+  return true;
+}
+
+UplinkEnvelope UplinkTemplate::Bind(const std::string& dev_eui,
+                                    const std::string& dev_addr) const {
+  UplinkEnvelope envelope;
+  size_t total = 0;
+  size_t slot_count = 0;
+  for (const auto& segment : segments_) {
+    switch (segment.type) {
+      case SegmentType::kLiteral: total += segment.text.size(); break;
+      case SegmentType::kDevEui: total += dev_eui.size(); break;
+      case SegmentType::kDevAddr: total += dev_addr.size(); break;
+      default: ++slot_count; break;
+    }
+  }
+
+  std::string& text = envelope.text_;
+  text.reserve(total);
+  envelope.slots_.reserve(slot_count);
+  for (const auto& segment : segments_) {
+    switch (segment.type) {
+      case SegmentType::kLiteral: text += segment.text; break;
+      case SegmentType::kDevEui: text += dev_eui; break;
+      case SegmentType::kDevAddr: text += dev_addr; break;
+      default:
+        envelope.slots_.push_back({static_cast<uint32_t>(text.size()), segment.type});
+        envelope.slot_mask_ |= 1u << static_cast<int>(segment.type);
+        break;
+    }
+  }
+  return envelope;
+}
+
+std::string UplinkEnvelope::Render(const UplinkFields& fields) const {
+  std::string result;
+  Render(fields, &result);
+  return result;
+}
+
+void UplinkEnvelope::Render(const UplinkFields& fields, std::string* out) const {
+  using Type = UplinkTemplate::SegmentType;
+  constexpr int kCount = static_cast<int>(Type::kCount);
+
+  // 先格式化模板中用到的字段
+  char buffer[256];
+  const char* values[kCount] = {};
+  size_t sizes[kCount] = {};
+  char* p = buffer;
+  char* const end = buffer + sizeof(buffer);
+  auto used = [this](Type type) { return (slot_mask_ & (1u << static_cast<int>(type))) != 0; };
+  auto finish = [&](Type type, char* field_start) {
+    values[static_cast<int>(type)] = field_start;
+    sizes[static_cast<int>(type)] = static_cast<size_t>(p - field_start);
+  };
+
+  values[static_cast<int>(Type::kData)] = fields.data;
+  sizes[static_cast<int>(Type::kData)] = fields.data_size;
+
+  const int64_t time_ns = fields.TimeNs();
+  if (used(Type::kDeduplicationId)) {
+    char* start = p;
+    fields.FormatId(p);
+    p += UplinkFields::kIdSize;
+    finish(Type::kDeduplicationId, start);
+  }
+  if (used(Type::kTime)) {
+    char* start = p;
+    p = WriteIsoTime(p, time_ns, 3);
+    finish(Type::kTime, start);
+  }
+  if (used(Type::kGwTime)) {
+    char* start = p;
+    p = WriteIsoTime(p, time_ns, 6);
+    finish(Type::kGwTime, start);
+  }
+  if (used(Type::kNsTime)) {
+    char* start = p;
+    p = WriteIsoTime(p, time_ns + fields.ns_delay_us * 1000, 9);
+    finish(Type::kNsTime, start);
+  }
+  if (used(Type::kGpsTime)) {
+    char* start = p;
+    const int64_t gps_ms = fields.GpsTimeNs() / 1000000;
+    p = WriteInt(p, end, gps_ms / 1000);
+    *p++ = '.';
+    p = WriteFixed(p, static_cast<uint64_t>(gps_ms % 1000), 3);
+    *p++ = 's';
+    finish(Type::kGpsTime, start);
+  }
+  if (used(Type::kFCnt)) {
+    char* start = p;
+    p = WriteInt(p, end, fields.fcnt);
+    finish(Type::kFCnt, start);
+  }
+  if (used(Type::kRssi)) {
+    char* start = p;
+    p = WriteInt(p, end, fields.rssi);
+    finish(Type::kRssi, start);
+  }
+  if (used(Type::kSnr)) {
+    char* start = p;
+    const int snr = fields.snr_tenths;
+    if (snr < 0) *p++ = '-';
+    const int magnitude = snr < 0 ? -snr : snr;
+    p = WriteInt(p, end, magnitude / 10);
+    *p++ = '.';
+    *p++ = static_cast<char>('0' + magnitude % 10);
+    finish(Type::kSnr, start);
+  }
+
+  // 按最终长度调整（容量足够时不重新分配），再依次拷贝文本段与字段
+  size_t total = text_.size();
+  for (const auto& slot : slots_) total += sizes[static_cast<int>(slot.type)];
+  out->resize(total);
+
+  char* dst = &(*out)[0];
+  size_t copied = 0;
+  for (const auto& slot : slots_) {
+    std::memcpy(dst, text_.data() + copied, slot.offset - copied);
+    dst += slot.offset - copied;
+    copied = slot.offset;
+    const size_t size = sizes[static_cast<int>(slot.type)];
+    if (size > 0) std::memcpy(dst, values[static_cast<int>(slot.type)], size);
+    dst += size;
+  }
+  std::memcpy(dst, text_.data() + copied, text_.size() - copied);
+}